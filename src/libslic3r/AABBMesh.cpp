@@ -8,6 +8,7 @@
 #include <libslic3r/AABBTreeIndirect.hpp>
 #include <libslic3r/TriangleMesh.hpp>
 
+#include <array>
 #include <numeric>
 
 #ifdef SLIC3R_HOLE_RAYCASTER
@@ -44,6 +45,17 @@ public:
                                                   m_tree, s, dir, hit, m_triangle_ray_epsilon);
     }
 
+    void intersect_rays(const indexed_triangle_set &its,
+                        const Vec3d *               s,
+                        const Vec3d *               dir,
+                        size_t                      n,
+                        igl::Hit *                  hits)
+    {
+        AABBTreeIndirect::intersect_rays_first_hit(its.vertices, its.indices,
+                                                   m_tree, s, dir, n, hits,
+                                                   m_triangle_ray_epsilon);
+    }
+
     void intersect_ray(const indexed_triangle_set &its,
                        const Vec3d &               s,
                        const Vec3d &               dir,
@@ -181,6 +193,45 @@ AABBMesh::query_ray_hit(const Vec3d &s, const Vec3d &dir) const
     return ret;
 }
 
+void AABBMesh::query_ray_hit(const Vec3d *s,
+                             const Vec3d *dir,
+                             size_t       n,
+                             hit_result  *out) const
+{
+#ifdef SLIC3R_HOLE_RAYCASTER
+    if (! m_holes.empty()) {
+        for (size_t i = 0; i < n; ++i)
+            out[i] = query_ray_hit(s[i], dir[i]);
+
+        return;
+    }
+#endif
+
+    // Small on-stack buffer for the typical batches of beams and pinheads
+    static constexpr size_t BufSize = 32;
+    std::array<igl::Hit, BufSize> hits;
+
+    for (size_t begin = 0; begin < n; begin += BufSize) {
+        size_t cnt = std::min(BufSize, n - begin);
+        m_aabb->intersect_rays(*m_tm, s + begin, dir + begin, cnt, hits.data());
+
+        for (size_t i = 0; i < cnt; ++i) {
+            const igl::Hit &hit = hits[i];
+            hit_result     &ret = out[begin + i];
+            assert(is_approx(dir[begin + i].norm(), 1.));
+
+            ret          = hit_result(*this);
+            ret.m_t      = double(hit.t);
+            ret.m_dir    = dir[begin + i];
+            ret.m_source = s[begin + i];
+            if (!std::isinf(hit.t) && !std::isnan(hit.t)) {
+                ret.m_normal  = this->normal_by_face_id(hit.id);
+                ret.m_face_id = hit.id;
+            }
+        }
+    }
+}
+
 std::vector<AABBMesh::hit_result>
 AABBMesh::query_ray_hits(const Vec3d &s, const Vec3d &dir) const
 {
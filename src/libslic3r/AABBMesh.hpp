@@ -121,6 +121,12 @@ public:
     // Casting a ray on the mesh, returns the distance where the hit occures.
     hit_result query_ray_hit(const Vec3d &s, const Vec3d &dir) const;
     
+    // Casting a batch of n rays on the mesh. The rays are traversed in
+    // packets, which is much faster than casting them one by one if they are
+    // coherent, like the rays sampling a beam or a pinhead. The results are
+    // the same as the ones of the single ray query.
+    void query_ray_hit(const Vec3d *s, const Vec3d *dir, size_t n, hit_result *out) const;
+
     // Casts a ray on the mesh and returns all hits
     std::vector<hit_result> query_ray_hits(const Vec3d &s, const Vec3d &dir) const;
 
@@ -11,6 +11,8 @@
 #define slic3r_AABBTreeIndirect_hpp_
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <limits>
 #include <type_traits>
 #include <vector>
@@ -474,6 +476,134 @@ namespace detail {
 		}
 	}
 
+    // Packet of rays traversing the tree together. The ray data are stored
+    // as a structure of arrays, so that the ray-box tests of all the rays
+    // may be vectorized by the compiler.
+    template<size_t N, typename VectorType>
+    struct RayPacket {
+        using Scalar = typename VectorType::Scalar;
+
+        std::array<Scalar, N> ox, oy, oz;
+        std::array<Scalar, N> ix, iy, iz;
+        // Current closest hit of each ray, rays with a hit closer than
+        // the node's bounding box are not tested against it.
+        std::array<Scalar, N> tmax;
+    };
+
+    // The same test as ray_box_intersect_invdir() with t0 = 0 and t1 = tmax
+    // for all the rays of the packet. It is written without branches so
+    // that the loop over the rays vectorizes, the results are identical
+    // to the scalar version. Returns a bit mask of the rays hitting the box.
+    template<size_t N, typename VectorType, typename BoxScalar>
+    inline uint32_t ray_box_intersect_invdir_packet(
+        const RayPacket<N, VectorType>         &packet,
+        const Eigen::AlignedBox<BoxScalar, 3>  &box,
+        uint32_t                                mask)
+    {
+        using Scalar = typename VectorType::Scalar;
+        static_assert(N <= 32, "Ray packet is too big for the mask");
+
+        const Scalar minx = Scalar(box.min().x()), maxx = Scalar(box.max().x());
+        const Scalar miny = Scalar(box.min().y()), maxy = Scalar(box.max().y());
+        const Scalar minz = Scalar(box.min().z()), maxz = Scalar(box.max().z());
+
+        std::array<int, N> hit;
+        for (size_t i = 0; i < N; ++ i) {
+            // The slab distances, swapped for the negative directions.
+            const Scalar tx1 = (minx - packet.ox[i]) * packet.ix[i], tx2 = (maxx - packet.ox[i]) * packet.ix[i];
+            const Scalar ty1 = (miny - packet.oy[i]) * packet.iy[i], ty2 = (maxy - packet.oy[i]) * packet.iy[i];
+            const Scalar tz1 = (minz - packet.oz[i]) * packet.iz[i], tz2 = (maxz - packet.oz[i]) * packet.iz[i];
+            const bool   sx = packet.ix[i] < 0, sy = packet.iy[i] < 0, sz = packet.iz[i] < 0;
+            Scalar tmin  = sx ? tx2 : tx1, tmax  = sx ? tx1 : tx2;
+            Scalar tymin = sy ? ty2 : ty1, tymax = sy ? ty1 : ty2;
+            Scalar tzmin = sz ? tz2 : tz1, tzmax = sz ? tz1 : tz2;
+            int    ok    = int(! (tmin > tymax)) & int(! (tymin > tmax));
+            tmin = tymin > tmin ? tymin : tmin;
+            tmax = tymax < tmax ? tymax : tmax;
+            ok &= int(! (tzmin > tmax)) & int(! (tmin > tzmax));
+            tmin = tzmin > tmin ? tzmin : tmin;
+            tmax = tzmax < tmax ? tzmax : tmax;
+            hit[i] = ok & int(tmin < packet.tmax[i]) & int(tmax > Scalar(0));
+        }
+
+        uint32_t ret = 0;
+        for (size_t i = 0; i < N; ++ i)
+            ret |= uint32_t(hit[i]) << i;
+
+        return ret & mask;
+    }
+
+    inline int popcount(uint32_t v) { int n = 0; for (; v; v &= v - 1) ++ n; return n; }
+
+    // Depth first traversal of the tree by a packet of rays, visiting the
+    // nodes in the same order as intersect_ray_recursive_first_hit() does.
+    // Each ray sees exactly the nodes it would see if cast alone, thus the
+    // resulting hits are the same.
+    template<size_t N, typename RayIntersectorType>
+    inline void intersect_ray_packet_first_hit(
+        const RayIntersectorType                                           &ray_intersector,
+        const typename RayIntersectorType::VectorType                      *origins,
+        const typename RayIntersectorType::VectorType                      *dirs,
+        RayPacket<N, typename RayIntersectorType::VectorType>              &packet,
+        uint32_t                                                            mask,
+        igl::Hit                                                           *hits)
+    {
+        // Each entry holds a node index and the rays which have reached it.
+        std::array<std::pair<size_t, uint32_t>, 128> stack;
+        size_t depth = 0;
+        stack[depth ++] = { 0, mask };
+
+        while (depth > 0) {
+            auto [node_idx, node_mask] = stack[-- depth];
+            const auto &node = ray_intersector.tree.node(node_idx);
+            assert(node.is_valid());
+
+            node_mask = ray_box_intersect_invdir_packet(packet, node.bbox, node_mask);
+            if (node_mask == 0)
+                continue;
+
+            if (popcount(node_mask) <= 2) {
+                // Only a few rays are left in this subtree, traversing it
+                // by the rays one by one is cheaper.
+                for (size_t i = 0; i < N; ++ i)
+                    if (node_mask & (uint32_t(1) << i)) {
+                        RayIntersectorType single { ray_intersector.vertices, ray_intersector.faces, ray_intersector.tree,
+                                                    origins[i], dirs[i], dirs[i].cwiseInverse(), ray_intersector.eps };
+                        igl::Hit hit;
+                        if (intersect_ray_recursive_first_hit(single, node_idx, packet.tmax[i], hit) && hit.t < packet.tmax[i]) {
+                            hits[i]        = hit;
+                            packet.tmax[i] = hit.t;
+                        }
+                    }
+                continue;
+            }
+
+            if (node.is_leaf()) {
+                auto face = ray_intersector.faces[node.idx];
+                const auto &v0 = ray_intersector.vertices[face(0)];
+                const auto &v1 = ray_intersector.vertices[face(1)];
+                const auto &v2 = ray_intersector.vertices[face(2)];
+                for (size_t i = 0; i < N; ++ i) {
+                    if (! (node_mask & (uint32_t(1) << i)))
+                        continue;
+                    double t, u, v;
+                    if (intersect_triangle(origins[i], dirs[i], v0, v1, v2, t, u, v, ray_intersector.eps) && t > 0.) {
+                        float ft = float(t);
+                        if (ft < packet.tmax[i]) {
+                            hits[i] = igl::Hit { int(node.idx), -1, float(u), float(v), ft };
+                            packet.tmax[i] = ft;
+                        }
+                    }
+                }
+            } else {
+                assert(depth + 2 <= stack.size());
+                // Push the right child first, so that the left one is processed first.
+                stack[depth ++] = { node_idx * 2 + 2, node_mask };
+                stack[depth ++] = { node_idx * 2 + 1, node_mask };
+            }
+        }
+    }
+
     // Real-time collision detection, Ericson, Chapter 5
     template<typename Vector>
     static inline Vector closest_point_to_triangle(const Vector &p, const Vector &a, const Vector &b, const Vector &c)
@@ -791,6 +921,91 @@ inline bool intersect_ray_all_hits(
 	return ! hits.empty();
 }
 
+// Default number of rays traversing the tree together. The slab tests of a packet pay off only if the compiler
+// vectorizes them into at least 4 doubles wide operations. With the 2 doubles wide SSE2 the packets are about as fast
+// as the single rays for coherent rays and slower for rays fanning out from a point, thus the rays are cast one by one.
+// See the "Raycaster - batch of rays benchmark" in sla_print tests.
+#ifdef __AVX__
+static constexpr size_t ray_packet_size_default = 8;
+#else
+static constexpr size_t ray_packet_size_default = 1;
+#endif
+
+// Find the first intersections of a batch of rays with indexed triangle set.
+// The rays are traversed in packets of PacketSize rays, so that a node of the tree
+// is loaded and tested once for the whole packet. This pays off if the rays are
+// coherent, i.e. if they start close to each other and point in similar directions.
+// With PacketSize == 1, the rays are cast one by one.
+// The hits are identical to the ones returned by intersect_ray_first_hit()
+// for the individual rays. Misses are returned as hits with id == -1 and infinite t.
+// Returns the number of rays which hit the mesh.
+template<size_t PacketSize = ray_packet_size_default, typename VertexType, typename IndexedFaceType, typename TreeType, typename VectorType>
+inline size_t intersect_rays_first_hit(
+	// Indexed triangle set - 3D vertices.
+	const std::vector<VertexType> 		&vertices,
+	// Indexed triangle set - triangular faces, references to vertices.
+	const std::vector<IndexedFaceType> 	&faces,
+	// AABBTreeIndirect::Tree over vertices & faces, bounding boxes built with the accuracy of vertices.
+	const TreeType 						&tree,
+	// Origins of the rays.
+	const VectorType					*origins,
+	// Directions of the rays.
+	const VectorType 					*dirs,
+	// Number of the rays.
+	size_t                               count,
+	// First intersections of the rays with the indexed triangle set.
+	igl::Hit 							*hits,
+	// Epsilon for the ray-triangle intersection, it should be proportional to an average triangle edge length.
+	const double 						 eps = 0.000001)
+{
+    using Scalar = typename VectorType::Scalar;
+
+    for (size_t i = 0; i < count; ++ i)
+        hits[i] = igl::Hit { -1, -1, 0.f, 0.f, std::numeric_limits<float>::infinity() };
+
+    if (tree.empty())
+        return 0;
+
+    if constexpr (PacketSize == 1) {
+        size_t num_hits = 0;
+        for (size_t i = 0; i < count; ++ i)
+            if (igl::Hit hit; intersect_ray_first_hit(vertices, faces, tree, origins[i], dirs[i], hit, eps)) {
+                hits[i] = hit;
+                ++ num_hits;
+            }
+        return num_hits;
+    }
+
+    auto ray_intersector = detail::RayIntersector<VertexType, IndexedFaceType, TreeType, VectorType> {
+        vertices, faces, tree, VectorType::Zero(), VectorType::Zero(), VectorType::Zero(), eps
+    };
+
+    for (size_t begin = 0; begin < count; begin += PacketSize) {
+        const size_t n = std::min(PacketSize, count - begin);
+
+        // The unused lanes repeat the last ray, their results are thrown away.
+        std::array<VectorType, PacketSize> o, d;
+        std::array<igl::Hit, PacketSize>   h;
+        detail::RayPacket<PacketSize, VectorType> packet;
+        for (size_t i = 0; i < PacketSize; ++ i) {
+            const size_t j = begin + std::min(i, n - 1);
+            o[i] = origins[j];
+            d[i] = dirs[j];
+            h[i] = hits[j];
+            VectorType invdir = d[i].cwiseInverse();
+            packet.ox[i] = o[i].x(); packet.oy[i] = o[i].y(); packet.oz[i] = o[i].z();
+            packet.ix[i] = invdir.x(); packet.iy[i] = invdir.y(); packet.iz[i] = invdir.z();
+            packet.tmax[i] = std::numeric_limits<Scalar>::infinity();
+        }
+
+        const uint32_t mask = n == 32 ? ~uint32_t(0) : (uint32_t(1) << n) - 1;
+        detail::intersect_ray_packet_first_hit(ray_intersector, o.data(), d.data(), packet, mask, h.data());
+        std::copy(h.begin(), h.begin() + n, hits + begin);
+    }
+
+    return size_t(std::count_if(hits, hits + count, [](const igl::Hit &h) { return h.id >= 0; }));
+}
+
 // Finding a closest triangle, its closest point and squared distance to the closest point
 // on a 3D indexed triangle set using a pre-built AABBTreeIndirect::Tree.
 // Closest point to triangle test will be performed with the accuracy of VectorType::Scalar
@@ -40,13 +40,13 @@ void model_to_csgmesh(const ModelObject &mo,
             ((do_positives && vol->is_model_part()) ||
              (do_negatives && vol->is_negative_volume()))) {
 
-            if (do_splits && its_is_splittable(vol->mesh().its)) {
+            if (do_splits && vol->mesh().is_splittable()) {
                 CSGPart part_begin{{}, vol->is_model_part() ? CSGType::Union : CSGType::Difference};
                 part_begin.stack_operation = CSGStackOp::Push;
                 *out = std::move(part_begin);
                 ++out;
 
-                its_split(vol->mesh().its, SplitOutputFn{[&out, &vol, &trafo](indexed_triangle_set &&its) {
+                its_split(vol->mesh().its, *vol->mesh().face_patches(), SplitOutputFn{[&out, &vol, &trafo](indexed_triangle_set &&its) {
                               if (its.empty())
                                   return;
 
@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "CSGMesh.hpp"
+#include "VoxelizeCSGMesh.hpp"
 
 #include "libslic3r/Execution/ExecutionTBB.hpp"
 //#include "libslic3r/Execution/ExecutionSeq.hpp"
@@ -206,6 +207,44 @@ MeshBoolean::cgal::CGALMeshPtr perform_csgmesh_booleans(const Range<It> &csgpart
     return ret;
 }
 
+enum class BooleanBackend {
+    // Exact booleans of CGAL surface meshes. The parts have to be closed and
+    // must not self intersect, see check_csgmesh_booleans().
+    CGAL,
+    // Approximate booleans of signed distance grids, see voxel_csgmesh_booleans().
+    Voxel
+};
+
+// Process the sequence of CSG parts with the given backend and return the
+// resulting mesh, which is empty if the booleans failed. The parts are not
+// checked for the CGAL backend, callers are expected to run
+// check_csgmesh_booleans() first. voxparams and voxel_adaptivity are only used
+// by the Voxel backend.
+template<class It>
+indexed_triangle_set perform_csgmesh_booleans(const Range<It>      &csgparts,
+                                              BooleanBackend        backend,
+                                              const VoxelizeParams &voxparams = {},
+                                              double                voxel_adaptivity = 0.)
+{
+    indexed_triangle_set ret;
+
+    switch (backend) {
+    case BooleanBackend::CGAL:
+        try {
+            if (auto cgalm = perform_csgmesh_booleans(csgparts))
+                ret = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalm);
+        } catch (...) {
+            // return an empty mesh
+        }
+        break;
+    case BooleanBackend::Voxel:
+        ret = voxel_csgmesh_booleans(csgparts, voxparams, voxel_adaptivity);
+        break;
+    }
+
+    return ret;
+}
+
 } // namespace csg
 } // namespace Slic3r
 
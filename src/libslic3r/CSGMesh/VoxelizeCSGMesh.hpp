@@ -116,6 +116,26 @@ VoxelGridPtr voxelize_csgmesh(const Range<It>      &csgrange,
     return ret;
 }
 
+// Perform the boolean operations of the csgrange on voxel grids and convert
+// the result back to a triangle mesh. Contrary to the CGAL booleans, this
+// works for meshes which are not closed or which self intersect, and the time
+// depends on the voxel count rather than on the complexity of the meshes.
+// The result is an approximation: features smaller than the voxel size
+// (1 / params.voxel_scale()) are lost and sharp edges get chamfered.
+// Adaptivity in the range [0, 1] merges the triangles of flat regions.
+template<class It>
+indexed_triangle_set voxel_csgmesh_booleans(const Range<It>      &csgrange,
+                                            const VoxelizeParams &params = {},
+                                            double                adaptivity = 0.)
+{
+    VoxelGridPtr grid = voxelize_csgmesh(csgrange, params);
+
+    if (!grid || (params.statusfn() && params.statusfn()(-1)))
+        return {};
+
+    return grid_to_mesh(*grid, 0., adaptivity);
+}
+
 }} // namespace Slic3r::csg
 
 #endif // VOXELIZECSGMESH_HPP
@@ -2636,8 +2636,8 @@ namespace Slic3r {
         bool _add_thumbnail_file_to_archive(mz_zip_archive& archive, const ThumbnailData& thumbnail_data);
         bool _add_relationships_file_to_archive(mz_zip_archive& archive);
         bool _add_model_file_to_archive(const std::string& filename, mz_zip_archive& archive, const Model& model, IdToObjectDataMap& objects_data);
-        bool _add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
-        bool _add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
+        bool _add_object_to_model_stream(MZ_StagedParallelWriter &writer, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets);
+        bool _add_mesh_to_object_stream(MZ_StagedParallelWriter &writer, ModelObject& object, VolumeToOffsetsMap& volumes_offsets);        
         bool _add_build_to_model_stream(std::stringstream& stream, const BuildItemsList& build_items);
         bool _add_cut_information_file_to_archive(mz_zip_archive& archive, Model& model);
         bool _add_layer_height_profile_file_to_archive(mz_zip_archive& archive, Model& model);
@@ -2868,6 +2868,9 @@ namespace Slic3r {
             return false;
         }
 
+        // The model file is deflated in parallel by chunks of MZ_StagedParallelWriter::ChunkSize.
+        MZ_StagedParallelWriter writer(context);
+
         {
             std::stringstream stream;
             reset_stream(stream);
@@ -2899,7 +2902,7 @@ namespace Slic3r {
             stream << " <" << METADATA_TAG << " name=\"Application\">" << SLIC3R_APP_KEY << "-" << SLIC3R_VERSION << "</" << METADATA_TAG << ">\n";
             stream << " <" << RESOURCES_TAG << ">\n";
             std::string buf = stream.str();
-            if (! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) {
+            if (! buf.empty() && ! writer.add(buf)) {
                 add_error("Unable to add model file to archive");
                 return false;
             }
@@ -2922,7 +2925,7 @@ namespace Slic3r {
             // Store geometry of all ModelVolumes contained in a single ModelObject into a single 3MF indexed triangle set object.
             // object_it->second.volumes_offsets will contain the offsets of the ModelVolumes in that single indexed triangle set.
             // object_id will be increased to point to the 1st instance of the next ModelObject.
-            if (!_add_object_to_model_stream(context, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
+            if (!_add_object_to_model_stream(writer, object_id, *obj, build_items, object_it->second.volumes_offsets)) {
                 add_error("Unable to add object to archive");
                 mz_zip_writer_add_staged_finish(&context);
                 return false;
@@ -2945,7 +2948,8 @@ namespace Slic3r {
            
             std::string buf = stream.str();
 
-            if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
+            if ((! buf.empty() && ! writer.add(buf)) ||
+                ! writer.flush() ||
                 ! mz_zip_writer_add_staged_finish(&context)) {
                 add_error("Unable to add model file to archive");
                 return false;
@@ -2955,7 +2959,7 @@ namespace Slic3r {
         return true;
     }
 
-    bool _3MF_Exporter::_add_object_to_model_stream(mz_zip_writer_staged_context &context, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_object_to_model_stream(MZ_StagedParallelWriter &writer, unsigned int& object_id, ModelObject& object, BuildItemsList& build_items, VolumeToOffsetsMap& volumes_offsets)
     {
         std::stringstream stream;
         reset_stream(stream);
@@ -2971,8 +2975,8 @@ namespace Slic3r {
             if (id == 0) {
                 std::string buf = stream.str();
                 reset_stream(stream);
-                if ((! buf.empty() && ! mz_zip_writer_add_staged_data(&context, buf.data(), buf.size())) ||
-                    ! _add_mesh_to_object_stream(context, object, volumes_offsets)) {
+                if ((! buf.empty() && ! writer.add(buf)) ||
+                    ! _add_mesh_to_object_stream(writer, object, volumes_offsets)) {
                     add_error("Unable to add mesh to archive");
                     return false;
                 }
@@ -2995,7 +2999,7 @@ namespace Slic3r {
 
         object_id += id;
         std::string buf = stream.str();
-        return buf.empty() || mz_zip_writer_add_staged_data(&context, buf.data(), buf.size());
+        return buf.empty() || writer.add(buf);
     }
 
 #if EXPORT_3MF_USE_SPIRIT_KARMA_FP
@@ -3018,7 +3022,7 @@ namespace Slic3r {
     using coordinate_type_scientific = boost::spirit::karma::real_generator<float, coordinate_policy_scientific<float>>;
 #endif // EXPORT_3MF_USE_SPIRIT_KARMA_FP
 
-    bool _3MF_Exporter::_add_mesh_to_object_stream(mz_zip_writer_staged_context &context, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
+    bool _3MF_Exporter::_add_mesh_to_object_stream(MZ_StagedParallelWriter &writer, ModelObject& object, VolumeToOffsetsMap& volumes_offsets)
     {
         std::string output_buffer;
         output_buffer += "   <";
@@ -3027,9 +3031,9 @@ namespace Slic3r {
         output_buffer += VERTICES_TAG;
         output_buffer += ">\n";
 
-        auto flush = [this, &output_buffer, &context](bool force = false) {
+        auto flush = [this, &output_buffer, &writer](bool force = false) {
             if ((force && ! output_buffer.empty()) || output_buffer.size() >= 65536 * 16) {
-                if (! mz_zip_writer_add_staged_data(&context, output_buffer.data(), output_buffer.size())) {
+                if (! writer.add(output_buffer)) {
                     add_error("Error during writing or compression");
                     return false;
                 }
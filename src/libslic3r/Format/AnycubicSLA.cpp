@@ -502,7 +502,7 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
                                const ThumbnailsList &thumbnails,
                                const std::string    &/*projectname*/)
 {
-    std::uint32_t layer_count = m_layers.size();
+    std::uint32_t layer_count = this->layer_count();
 
     anycubicsla_format_intro         intro = {};
     anycubicsla_format_header        header = {};
@@ -542,8 +542,7 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
         //layers
         layer_images.reserve(layer_count * LAYER_SIZE_ESTIMATE);
         image_offset = intro.image_data_offset;
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
+        for_each_layer([&](const sla::EncodedRaster &rst, size_t i) {
             anycubicsla_format_layer l;
             std::memset(&l, 0, sizeof(l));
             l.image_offset = image_offset;
@@ -565,8 +564,7 @@ void AnycubicSLAArchive::export_print(const std::string     fname,
             const char* img_start = reinterpret_cast<const char*>(rst.data());
             const char* img_end = img_start + rst.size();
             std::copy(img_start, img_end, std::back_inserter(layer_images));
-            i++;
-        }
+        });
         const char* img_buffer = reinterpret_cast<const char*>(layer_images.data());
         out.write(img_buffer, layer_images.size());
         out.close();
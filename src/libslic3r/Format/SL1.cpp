@@ -274,7 +274,9 @@ std::unique_ptr<sla::RasterBase> SL1Archive::create_raster() const
 
     double gamma = m_cfg.gamma_correction.getFloat();
 
-    return sla::create_raster_grayscale_aa(res, pxdim, gamma, tr);
+    // The layer images are PNG encoded straight from the run-length
+    // encoded raster rows, no full framebuffer is allocated.
+    return sla::create_raster_grayscale_rle(res, pxdim, gamma, tr);
 }
 
 sla::RasterEncoder SL1Archive::get_encoder() const
@@ -326,14 +328,12 @@ void SL1Archive::export_print(Zipper               &zipper,
         zipper.add_entry("config.json");
         zipper << to_json(print, iniconf);
 
-        size_t i = 0;
-        for (const sla::EncodedRaster &rst : m_layers) {
-
-            std::string imgname = project + string_printf("%.5d", i++) + "." +
+        for_each_layer([&zipper, &project](const sla::EncodedRaster &rst, size_t i) {
+            std::string imgname = project + string_printf("%.5d", int(i)) + "." +
                                   rst.extension();
 
             zipper.add_entry(imgname.c_str(), rst.data(), rst.size());
-        }
+        });
 
         for (const ThumbnailData& data : thumbnails)
             if (data.is_valid())
@@ -6,8 +6,77 @@
 #include "SLAArchiveWriter.hpp"
 #include "SLAArchiveFormatRegistry.hpp"
 
+#include <algorithm>
+#include <thread>
+
+// See GCode.cpp for the reasoning behind supporting both TBB APIs.
+#if ! defined(TBB_VERSION_MAJOR)
+    #include <tbb/version.h>
+#endif
+#if ! defined(TBB_VERSION_MAJOR)
+    static_assert(false, "TBB_VERSION_MAJOR not defined");
+#endif
+#if TBB_VERSION_MAJOR >= 2021
+    #include <tbb/parallel_pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter_mode;
+#else
+    #include <tbb/pipeline.h>
+    using slic3r_tbb_filtermode = tbb::filter;
+#endif
+
 namespace Slic3r {
 
+void SLAArchiveWriter::for_each_layer(const LayerSink &sink,
+                                      size_t max_layers_in_flight) const
+{
+    if (!m_deferred_drawfn) {
+        for (size_t i = 0; i < m_layers.size(); ++i)
+            sink(m_layers[i], i);
+
+        return;
+    }
+
+    if (max_layers_in_flight == 0)
+        max_layers_in_flight = 2 * std::max(1u, std::thread::hardware_concurrency());
+
+    size_t next_layer = 0;
+
+    auto source = tbb::make_filter<void, size_t>(
+        slic3r_tbb_filtermode::serial_in_order,
+        [this, &next_layer](tbb::flow_control &fc) -> size_t {
+            if (next_layer >= m_deferred_layer_num) {
+                fc.stop();
+                return 0;
+            }
+
+            if (m_deferred_cancelfn)
+                m_deferred_cancelfn();
+
+            return next_layer++;
+        });
+
+    auto rasterize = tbb::make_filter<size_t, std::pair<size_t, sla::EncodedRaster>>(
+        slic3r_tbb_filtermode::parallel,
+        [this](size_t idx) {
+            auto rst = create_raster();
+            m_deferred_drawfn(*rst, idx);
+
+            return std::make_pair(idx, rst->encode(get_encoder()));
+        });
+
+    auto output = tbb::make_filter<std::pair<size_t, sla::EncodedRaster>, void>(
+        slic3r_tbb_filtermode::serial_in_order,
+        [this, &sink](const std::pair<size_t, sla::EncodedRaster> &lyr) {
+            sink(lyr.second, lyr.first);
+
+            if (m_deferred_progressfn)
+                m_deferred_progressfn(lyr.first + 1);
+        });
+
+    // The number of tokens bounds the number of layers alive at any moment.
+    tbb::parallel_pipeline(max_layers_in_flight, source & rasterize & output);
+}
+
 std::unique_ptr<SLAArchiveWriter>
 SLAArchiveWriter::create(const std::string &archtype, const SLAPrinterConfig &cfg)
 {
@@ -6,6 +6,7 @@
 #define SLAARCHIVE_HPP
 
 #include <vector>
+#include <functional>
 
 #include "libslic3r/SLA/RasterBase.hpp"
 #include "libslic3r/Execution/ExecutionTBB.hpp"
@@ -17,15 +18,49 @@ class SLAPrint;
 class SLAPrinterConfig;
 
 class SLAArchiveWriter {
+public:
+    // void(const sla::EncodedRaster &layer, size_t lyrid)
+    using LayerSink = std::function<void(const sla::EncodedRaster &, size_t)>;
+
+    // void(sla::RasterBase& raster, size_t lyrid), has to be thread safe.
+    using DrawFn = std::function<void(sla::RasterBase &, size_t)>;
+
+    // void(), throws if the export was canceled.
+    using TryCancelFn = std::function<void()>;
+
+    // void(size_t layers_done), called after each layer was handed over.
+    using ProgressFn = std::function<void(size_t)>;
+
 protected:
     std::vector<sla::EncodedRaster> m_layers;
 
+    // Streaming mode: the layers are only rasterized when exporting, see
+    // draw_layers_deferred() and for_each_layer().
+    DrawFn      m_deferred_drawfn;
+    TryCancelFn m_deferred_cancelfn;
+    ProgressFn  m_deferred_progressfn;
+    size_t      m_deferred_layer_num = 0;
+
     virtual std::unique_ptr<sla::RasterBase> create_raster() const = 0;
     virtual sla::RasterEncoder get_encoder() const = 0;
 
+    size_t layer_count() const
+    {
+        return m_deferred_drawfn ? m_deferred_layer_num : m_layers.size();
+    }
+
+    // Hands over the encoded layers to sink in ascending order. In streaming
+    // mode the layers are rasterized and encoded in parallel with at most
+    // max_layers_in_flight of them held in memory at once, each one being
+    // passed to the sink (and released) as soon as all previous layers were.
+    void for_each_layer(const LayerSink &sink,
+                        size_t max_layers_in_flight = 0) const;
+
 public:
     virtual ~SLAArchiveWriter() = default;
 
+    bool is_streaming() const { return bool(m_deferred_drawfn); }
+
     // Fn have to be thread safe: void(sla::RasterBase& raster, size_t lyrid);
     template<class Fn, class CancelFn, class EP = ExecutionTBB>
     void draw_layers(
@@ -34,6 +69,10 @@ public:
         CancelFn cancelfn = []() { return false; },
         const EP & ep       = {})
     {
+        m_deferred_drawfn = {};
+        m_deferred_cancelfn = {};
+        m_deferred_progressfn = {};
+        m_deferred_layer_num = 0;
         m_layers.resize(layer_num);
         execution::for_each(
             ep, size_t(0), m_layers.size(),
@@ -48,6 +87,22 @@ public:
             execution::max_concurrency(ep));
     }
 
+    // Only remember how to draw the layers, the rasterization itself will be
+    // done on the fly while exporting. The functions have to stay valid until
+    // the export, drawfn is called from multiple threads. The export checks
+    // cancelfn before each layer and reports progressfn in the layer order.
+    void draw_layers_deferred(size_t      layer_num,
+                              DrawFn      drawfn,
+                              TryCancelFn cancelfn   = {},
+                              ProgressFn  progressfn = {})
+    {
+        m_layers = {};
+        m_deferred_layer_num = layer_num;
+        m_deferred_drawfn = std::move(drawfn);
+        m_deferred_cancelfn = std::move(cancelfn);
+        m_deferred_progressfn = std::move(progressfn);
+    }
+
     // Export the print into an archive using the provided filename.
     virtual void export_print(const std::string     fname,
                               const SLAPrint       &print,
@@ -976,6 +976,10 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
         m_find_replace = make_unique<GCodeFindReplace>(print.config());
         file.set_find_replace(m_find_replace.get(), false);
     }
+    if (GCodePostProcessPlugins::has_plugins(print.full_print_config())) {
+        m_post_process_plugins = make_unique<GCodePostProcessPlugins>(print.full_print_config());
+        file.set_post_process_plugins(m_post_process_plugins.get(), false);
+    }
 
     // resets analyzer's tracking data
     m_last_height  = 0.f;
@@ -1080,7 +1084,7 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
     if (print.config().remaining_times.value)
         file.write_format(";%s\n", GCodeProcessor::reserved_tag(GCodeProcessor::ETags::First_Line_M73_Placeholder).c_str());
 
-    // Starting now, the G-code find / replace post-processor will be enabled.
+    // Starting now, the G-code find / replace post-processor and the post-processing plugins will be enabled.
     file.find_replace_enable();
 
     // Prepare the helper object for replacing placeholders in custom G-code and output filename.
@@ -1396,7 +1400,7 @@ void GCodeGenerator::_do_export(Print& print, GCodeOutputStream &file, Thumbnail
     file.write(m_writer.update_progress(m_layer_count, m_layer_count, true)); // 100%
     file.write(m_writer.postamble());
 
-    // From now to the end of G-code, the G-code find / replace post-processor will be disabled.
+    // From now to the end of G-code, the G-code find / replace post-processor and the post-processing plugins will be disabled.
     // Thus the PrusaSlicer generated config will NOT be processed by the G-code post-processor, see GH issue #7952.
     file.find_replace_supress();
 
@@ -1559,6 +1563,10 @@ void GCodeGenerator::process_layers(
         [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
         });
+    const auto post_process_plugins = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [post_process_plugins = this->m_post_process_plugins.get()](std::string s) -> std::string {
+            return post_process_plugins->process_layer(std::move(s));
+        });
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
         [&output_stream](std::string s) { output_stream.write(s); }
     );
@@ -1572,6 +1580,8 @@ void GCodeGenerator::process_layers(
     tbb::filter<LayerResult, std::string> pipeline_to_string = cooling;
     if (m_find_replace)
         pipeline_to_string = pipeline_to_string & find_replace;
+    if (m_post_process_plugins)
+        pipeline_to_string = pipeline_to_string & post_process_plugins;
 
     // It registers a handler that sets locales to "C" before any TBB thread starts participating in tbb::parallel_pipeline.
     // Handler is unregistered when the destructor is called.
@@ -1652,6 +1662,10 @@ void GCodeGenerator::process_layers(
         [find_replace = this->m_find_replace.get()](std::string s) -> std::string {
             return find_replace->process_layer(std::move(s));
         });
+    const auto post_process_plugins = tbb::make_filter<std::string, std::string>(slic3r_tbb_filtermode::serial_in_order,
+        [post_process_plugins = this->m_post_process_plugins.get()](std::string s) -> std::string {
+            return post_process_plugins->process_layer(std::move(s));
+        });
     const auto output = tbb::make_filter<std::string, void>(slic3r_tbb_filtermode::serial_in_order,
         [&output_stream](std::string s) { output_stream.write(s); }
     );
@@ -1665,6 +1679,8 @@ void GCodeGenerator::process_layers(
     tbb::filter<LayerResult, std::string> pipeline_to_string = cooling;
     if (m_find_replace)
         pipeline_to_string = pipeline_to_string & find_replace;
+    if (m_post_process_plugins)
+        pipeline_to_string = pipeline_to_string & post_process_plugins;
 
     // It registers a handler that sets locales to "C" before any TBB thread starts participating in tbb::parallel_pipeline.
     // Handler is unregistered when the destructor is called.
@@ -3175,6 +3191,8 @@ void GCodeGenerator::GCodeOutputStream::write(const char *what)
     if (what != nullptr) {
         //FIXME don't allocate a string, maybe process a batch of lines?
         std::string gcode(m_find_replace ? m_find_replace->process_layer(what) : what);
+        if (m_post_process_plugins)
+            gcode = m_post_process_plugins->process_layer(std::move(gcode));
         // writes string to file
         fwrite(gcode.c_str(), 1, gcode.size(), this->f);
         m_processor.process_buffer(gcode);
@@ -27,6 +27,7 @@
 #include "GCode/AvoidCrossingPerimeters.hpp"
 #include "GCode/CoolingBuffer.hpp"
 #include "GCode/FindReplace.hpp"
+#include "GCode/PostProcessPlugin.hpp"
 #include "GCode/GCodeWriter.hpp"
 #include "GCode/LabelObjects.hpp"
 #include "GCode/PressureEqualizer.hpp"
@@ -192,8 +193,11 @@ private:
         // It is being set to null inside process_layers(), because the find-replace process
         // is being called on a secondary thread to improve performance.
         void set_find_replace(GCodeFindReplace *find_replace, bool enabled) { m_find_replace_backup = find_replace; m_find_replace = enabled ? find_replace : nullptr; }
-        void find_replace_enable() { m_find_replace = m_find_replace_backup; }
-        void find_replace_supress() { m_find_replace = nullptr; }
+        // Set the in-process post-processing plugins to be called after the find-replace post-processor.
+        // They are enabled and suppressed together with the find-replace post-processor.
+        void set_post_process_plugins(GCodePostProcessPlugins *plugins, bool enabled) { m_post_process_plugins_backup = plugins; m_post_process_plugins = enabled ? plugins : nullptr; }
+        void find_replace_enable() { m_find_replace = m_find_replace_backup; m_post_process_plugins = m_post_process_plugins_backup; }
+        void find_replace_supress() { m_find_replace = nullptr; m_post_process_plugins = nullptr; }
 
         bool is_open() const { return f; }
         bool is_error() const;
@@ -219,6 +223,9 @@ private:
         GCodeFindReplace *m_find_replace { nullptr };
         // If suppressed, the backoup holds m_find_replace.
         GCodeFindReplace *m_find_replace_backup { nullptr };
+        // In-process post-processing plugins to be called after the find-replace post-processor.
+        GCodePostProcessPlugins *m_post_process_plugins { nullptr };
+        GCodePostProcessPlugins *m_post_process_plugins_backup { nullptr };
         GCodeProcessor   &m_processor;
     };
     void            _do_export(Print &print, GCodeOutputStream &file, ThumbnailsGeneratorCallback thumbnail_cb);
@@ -442,6 +449,7 @@ private:
     std::unique_ptr<CoolingBuffer>      m_cooling_buffer;
     std::unique_ptr<SpiralVase>         m_spiral_vase;
     std::unique_ptr<GCodeFindReplace>   m_find_replace;
+    std::unique_ptr<GCodePostProcessPlugins> m_post_process_plugins;
     std::unique_ptr<PressureEqualizer>  m_pressure_equalizer;
     std::unique_ptr<GCode::WipeTowerIntegration> m_wipe_tower;
 
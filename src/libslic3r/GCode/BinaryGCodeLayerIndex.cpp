@@ -0,0 +1,293 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "BinaryGCodeLayerIndex.hpp"
+
+#include "GCodeProcessor.hpp"
+#include "libslic3r/Exception.hpp"
+#include "libslic3r/LocalesUtils.hpp"
+#include "libslic3r/format.hpp"
+
+#include <boost/algorithm/string/predicate.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <deque>
+
+namespace Slic3r {
+
+// Comment lines storing the index at the end of the G-code:
+// "; layer_index = <number of layers>" followed by lines "; layer_index_data = <layer> <layer> ...",
+// each layer being stored as "z:block_offset:tags_to_skip:moves_count:first_line_id".
+static const std::string IndexHeaderLine = "; layer_index = ";
+static const std::string IndexDataLine   = "; layer_index_data =";
+// Keep the lines well below the maximum line length accepted by the binarizer.
+static constexpr const size_t LayersPerIndexLine = 256;
+
+static const std::string& layer_change_tag()
+{
+    static const std::string tag = ";" + GCodeProcessor::reserved_tag(GCodeProcessor::ETags::Layer_Change);
+    return tag;
+}
+
+static bool is_layer_change_line(std::string_view line)
+{
+    const std::string& tag = layer_change_tag();
+    return boost::starts_with(line, tag) && (line.size() == tag.size() || line[tag.size()] == '\n' || line[tag.size()] == '\r');
+}
+
+static bool is_move_line(std::string_view line)
+{
+    return line.size() >= 2 && line[0] == 'G' && line[1] >= '0' && line[1] <= '3' &&
+        (line.size() == 2 || !(line[2] >= '0' && line[2] <= '9'));
+}
+
+// Calls fn for each line of gcode, end of line included.
+template<typename Fn>
+static void for_each_line(std::string_view gcode, Fn fn)
+{
+    size_t line_begin = 0;
+    while (line_begin < gcode.size()) {
+        size_t line_end = gcode.find('\n', line_begin);
+        line_end = (line_end == std::string_view::npos) ? gcode.size() : line_end + 1;
+        fn(gcode.substr(line_begin, line_end - line_begin), line_end);
+        line_begin = line_end;
+    }
+}
+
+size_t BinaryGCodeLayerIndex::layer_id_at(float z) const
+{
+    return std::find_if(m_layers.begin(), m_layers.end(), [z](const Layer& layer) { return layer.z >= z; }) - m_layers.begin();
+}
+
+size_t BinaryGCodeLayerIndex::layer_id_at_line(size_t line_id) const
+{
+    auto it = std::upper_bound(m_layers.begin(), m_layers.end(), line_id, [](size_t id, const Layer& layer) { return id < layer.first_line_id; });
+    return it == m_layers.begin() ? m_layers.size() : size_t(it - m_layers.begin()) - 1;
+}
+
+bgcode::core::EResult BinaryGCodeLayerIndex::append_gcode(bgcode::binarize::Binarizer& binarizer, FILE& out, const std::string& gcode)
+{
+    using namespace bgcode::core;
+    // begin of the part of gcode not yet sent to the binarizer
+    size_t begin = 0;
+    EResult res = EResult::Success;
+    for_each_line(gcode, [&](std::string_view line, size_t line_end) {
+        if (res != EResult::Success)
+            return;
+        ++m_lines_count;
+        if (m_z_pending) {
+            m_z_pending = false;
+            if (boost::starts_with(line, ";Z:"))
+                m_layers.back().z = string_to_float_decimal_point(line.substr(3));
+        }
+        if (is_move_line(line)) {
+            if (!m_layers.empty())
+                ++m_layers.back().moves_count;
+        }
+        else if (is_layer_change_line(line)) {
+            // Send the gcode up to the tag, so that the tag is the last line in the cache of the binarizer.
+            // The binarizer writes a block before caching a line which does not fit into it, thus the block containing
+            // the tag will start at the current end of the file.
+            res = binarizer.append_gcode(gcode.substr(begin, line_end - begin));
+            begin = line_end;
+            const long block_offset = ftell(&out);
+            const unsigned int tags_to_skip = (!m_layers.empty() && m_layers.back().block_offset == block_offset) ?
+                m_layers.back().tags_to_skip + 1 : 0;
+            m_layers.push_back({ 0.0f, block_offset, tags_to_skip, 0, m_lines_count });
+            m_z_pending = true;
+        }
+    });
+    if (res == EResult::Success && begin < gcode.size())
+        res = binarizer.append_gcode(gcode.substr(begin));
+    return res;
+}
+
+bgcode::core::EResult BinaryGCodeLayerIndex::append_index(bgcode::binarize::Binarizer& binarizer) const
+{
+    std::string out = IndexHeaderLine + std::to_string(m_layers.size()) + "\n";
+    for (size_t i = 0; i < m_layers.size(); i += LayersPerIndexLine) {
+        out += IndexDataLine;
+        for (size_t j = i; j < std::min(i + LayersPerIndexLine, m_layers.size()); ++j) {
+            const Layer& layer = m_layers[j];
+            out += " " + float_to_string_decimal_point(layer.z) + ":" + std::to_string(layer.block_offset) + ":" +
+                std::to_string(layer.tags_to_skip) + ":" + std::to_string(layer.moves_count) + ":" + std::to_string(layer.first_line_id);
+        }
+        out += "\n";
+    }
+    return binarizer.append_gcode(out);
+}
+
+// Parses the layers of a "; layer_index_data =" line, returns false if malformed.
+static bool parse_index_data(std::string_view data, std::vector<BinaryGCodeLayerIndex::Layer>& layers)
+{
+    size_t pos = 0;
+    while (pos < data.size()) {
+        while (pos < data.size() && (data[pos] == ' ' || data[pos] == '\n' || data[pos] == '\r'))
+            ++pos;
+        if (pos == data.size())
+            break;
+        const size_t end = std::min(data.find_first_of(" \r\n", pos), data.size());
+        const std::string item(data.substr(pos, end - pos));
+        pos = end;
+
+        BinaryGCodeLayerIndex::Layer layer;
+        size_t z_end = 0;
+        layer.z = string_to_float_decimal_point(item, &z_end);
+        char *next = nullptr;
+        if (z_end == 0 || z_end >= item.size() || item[z_end] != ':')
+            return false;
+        layer.block_offset = std::strtol(item.c_str() + z_end + 1, &next, 10);
+        if (*next != ':')
+            return false;
+        layer.tags_to_skip = unsigned(std::strtoul(next + 1, &next, 10));
+        if (*next != ':')
+            return false;
+        layer.moves_count = unsigned(std::strtoul(next + 1, &next, 10));
+        if (*next != ':')
+            return false;
+        layer.first_line_id = size_t(std::strtoull(next + 1, &next, 10));
+        if (*next != '\0')
+            return false;
+        layers.push_back(layer);
+    }
+    return true;
+}
+
+BinaryGCodeLayerIndex BinaryGCodeLayerIndex::load(FILE& file)
+{
+    using namespace bgcode::core;
+    using namespace bgcode::binarize;
+
+    fseek(&file, 0, SEEK_END);
+    const long file_size = ftell(&file);
+    rewind(&file);
+
+    FileHeader file_header;
+    EResult res = read_header(file, file_header, nullptr);
+    if (res != EResult::Success)
+        throw Slic3r::RuntimeError(format("Invalid binary gcode: %1%", std::string(translate_result(res))));
+
+    // collect the positions of the gcode blocks, reading only the headers of the blocks
+    std::vector<long> gcode_blocks;
+    BlockHeader block_header;
+    while (ftell(&file) < file_size) {
+        const long position = ftell(&file);
+        res = read_next_block_header(file, file_header, block_header, nullptr, 0);
+        if (res == EResult::Success && (EBlockType)block_header.type == EBlockType::GCode)
+            gcode_blocks.push_back(position);
+        if (res == EResult::Success)
+            res = skip_block(file, file_header, block_header);
+        if (res != EResult::Success)
+            throw Slic3r::RuntimeError(format("Error reading binary gcode: %1%", std::string(translate_result(res))));
+    }
+
+    // The index is at the end of the gcode and it may span several blocks.
+    // Decode the blocks from the last one, until the header line of the index is found.
+    std::vector<std::string_view> data_lines;
+    // data of the decoded blocks, referenced by data_lines
+    std::deque<std::string>       blocks_data;
+    size_t                        layers_count = 0;
+    bool                          header_found = false;
+    for (auto it = gcode_blocks.rbegin(); it != gcode_blocks.rend() && !header_found; ++it) {
+        fseek(&file, *it, SEEK_SET);
+        res = read_next_block_header(file, file_header, block_header, nullptr, 0);
+        GCodeBlock block;
+        if (res == EResult::Success)
+            res = block.read_data(file, file_header, block_header);
+        if (res != EResult::Success)
+            throw Slic3r::RuntimeError(format("Error reading binary gcode: %1%", std::string(translate_result(res))));
+        const std::string& raw_data = blocks_data.emplace_back(std::move(block.raw_data));
+
+        std::vector<std::string_view> block_data_lines;
+        for_each_line(raw_data, [&](std::string_view line, size_t) {
+            if (boost::starts_with(line, IndexHeaderLine)) {
+                header_found = true;
+                layers_count = size_t(std::strtoul(std::string(line.substr(IndexHeaderLine.size())).c_str(), nullptr, 10));
+                // data lines preceding the header do not belong to the index
+                block_data_lines.clear();
+            }
+            else if (boost::starts_with(line, IndexDataLine))
+                block_data_lines.push_back(line.substr(IndexDataLine.size()));
+        });
+        if (block_data_lines.empty() && !header_found)
+            // no index lines at the end of the gcode
+            break;
+        data_lines.insert(data_lines.begin(), block_data_lines.begin(), block_data_lines.end());
+    }
+
+    BinaryGCodeLayerIndex out;
+    if (!header_found)
+        return out;
+    for (std::string_view data : data_lines) {
+        if (!parse_index_data(data, out.m_layers)) {
+            out.m_layers.clear();
+            return out;
+        }
+    }
+    if (out.m_layers.size() != layers_count)
+        out.m_layers.clear();
+    return out;
+}
+
+void BinaryGCodeLayerIndex::read_layers(FILE& file, size_t first_layer_id, size_t last_layer_id,
+    const std::function<void(std::string_view line)>& line_callback) const
+{
+    using namespace bgcode::core;
+    using namespace bgcode::binarize;
+
+    if (first_layer_id > last_layer_id || last_layer_id >= m_layers.size())
+        throw Slic3r::InvalidArgument("Invalid range of layers of binary gcode");
+
+    fseek(&file, 0, SEEK_END);
+    const long file_size = ftell(&file);
+    rewind(&file);
+
+    FileHeader file_header;
+    EResult res = read_header(file, file_header, nullptr);
+    if (res != EResult::Success)
+        throw Slic3r::RuntimeError(format("Invalid binary gcode: %1%", std::string(translate_result(res))));
+
+    // jump to the block containing the first layer
+    fseek(&file, m_layers[first_layer_id].block_offset, SEEK_SET);
+    unsigned int tags_to_skip = m_layers[first_layer_id].tags_to_skip;
+    size_t       layer_id     = first_layer_id;
+    bool         started      = false;
+    bool         finished     = false;
+    std::vector<std::byte> cs_buffer(65536);
+    BlockHeader block_header;
+    while (!finished && ftell(&file) < file_size) {
+        res = read_next_block_header(file, file_header, block_header, cs_buffer.data(), cs_buffer.size());
+        if (res != EResult::Success)
+            throw Slic3r::RuntimeError(format("Error reading binary gcode: %1%", std::string(translate_result(res))));
+        if ((EBlockType)block_header.type != EBlockType::GCode)
+            break;
+        GCodeBlock block;
+        res = block.read_data(file, file_header, block_header);
+        if (res != EResult::Success)
+            throw Slic3r::RuntimeError(format("Error reading binary gcode: %1%", std::string(translate_result(res))));
+
+        for_each_line(block.raw_data, [&](std::string_view line, size_t) {
+            if (finished)
+                return;
+            if (is_layer_change_line(line)) {
+                if (!started) {
+                    if (tags_to_skip > 0) {
+                        --tags_to_skip;
+                        return;
+                    }
+                    started = true;
+                }
+                else if (++layer_id > last_layer_id) {
+                    finished = true;
+                    return;
+                }
+            }
+            if (started && !boost::starts_with(line, IndexHeaderLine) && !boost::starts_with(line, IndexDataLine))
+                line_callback(line);
+        });
+    }
+}
+
+} // namespace Slic3r
@@ -0,0 +1,72 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_BinaryGCodeLayerIndex_hpp_
+#define slic3r_BinaryGCodeLayerIndex_hpp_
+
+#include <LibBGCode/binarize/binarize.hpp>
+
+#include <cstdio>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Slic3r {
+
+// Index of the layers of a binary G-code, allowing to read a range of layers by decoding only the G-code blocks containing them.
+// GCodeProcessor::post_process() builds it while sending the G-code to the binarizer and stores it as comments at the end
+// of the G-code (see append_index()). Binary G-codes without the index are still valid, load() returns an empty index for them.
+class BinaryGCodeLayerIndex
+{
+public:
+    struct Layer
+    {
+        float        z{ 0.0f };
+        // Position in the file of the header of the G-code block containing the ;LAYER_CHANGE tag starting the layer.
+        long         block_offset{ 0 };
+        // Number of ;LAYER_CHANGE tags preceding the one of this layer in its block.
+        unsigned int tags_to_skip{ 0 };
+        // Number of G0, G1, G2 and G3 lines of the layer.
+        unsigned int moves_count{ 0 };
+        // 1-based id of the ;LAYER_CHANGE line among the lines of the G-code blocks, as numbered by GCodeProcessorResult::lines_ends.
+        size_t       first_line_id{ 0 };
+    };
+
+    bool                      empty() const { return m_layers.empty(); }
+    size_t                    size() const { return m_layers.size(); }
+    const Layer&              operator[](size_t layer_id) const { return m_layers[layer_id]; }
+    const std::vector<Layer>& layers() const { return m_layers; }
+    // Index of the first layer with z greater or equal to the given one, size() if there is none.
+    // Layers are printed by increasing z, unless the objects are printed sequentially.
+    size_t                    layer_id_at(float z) const;
+    // Index of the layer containing the line with the given 1-based id, size() if the line precedes the first layer.
+    size_t                    layer_id_at_line(size_t line_id) const;
+
+    // Sends gcode to the binarizer writing into out, recording the layers starting in it.
+    bgcode::core::EResult     append_gcode(bgcode::binarize::Binarizer& binarizer, FILE& out, const std::string& gcode);
+    // Sends the index to the binarizer, to be called after all the G-code was appended.
+    bgcode::core::EResult     append_index(bgcode::binarize::Binarizer& binarizer) const;
+
+    // Reads the index from the end of the given binary G-code file.
+    // Throws Slic3r::RuntimeError if the file is not a valid binary G-code.
+    static BinaryGCodeLayerIndex load(FILE& file);
+
+    // Calls line_callback with the lines, ends of line included, of the layers [first_layer_id, last_layer_id] of the given
+    // binary G-code file, which has to be the one this index was loaded from. The first line passed has id first_line_id
+    // of the first layer. The last layer extends to the end of the G-code, excluding the index itself.
+    // Throws Slic3r::RuntimeError if the file cannot be read.
+    void read_layers(FILE& file, size_t first_layer_id, size_t last_layer_id, const std::function<void(std::string_view line)>& line_callback) const;
+
+private:
+    std::vector<Layer> m_layers;
+    // Set when the last line sent to append_gcode() was a ;LAYER_CHANGE tag, the z of the layer is on the following line.
+    bool               m_z_pending{ false };
+    // Number of lines sent to append_gcode().
+    size_t             m_lines_count{ 0 };
+};
+
+} // namespace Slic3r
+
+#endif // slic3r_BinaryGCodeLayerIndex_hpp_
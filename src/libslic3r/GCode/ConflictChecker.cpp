@@ -5,96 +5,18 @@
 ///|/
 #include "ConflictChecker.hpp"
 
+#include "libslic3r/AABBTreeLines.hpp"
+
 #include <tbb/parallel_for.h>
-#include <tbb/concurrent_vector.h>
 
 #include <map>
 #include <functional>
 #include <atomic>
+#include <limits>
+#include <numeric>
 
 namespace Slic3r {
 
-namespace RasterizationImpl {
-using IndexPair = std::pair<int64_t, int64_t>;
-using Grids     = std::vector<IndexPair>;
-
-inline constexpr int64_t RasteXDistance = scale_(1);
-inline constexpr int64_t RasteYDistance = scale_(1);
-
-inline IndexPair point_map_grid_index(const Point &pt, int64_t xdist, int64_t ydist)
-{
-    auto x = pt.x() / xdist;
-    auto y = pt.y() / ydist;
-    return std::make_pair(x, y);
-}
-
-inline bool nearly_equal(const Point &p1, const Point &p2) { return std::abs(p1.x() - p2.x()) < SCALED_EPSILON && std::abs(p1.y() - p2.y()) < SCALED_EPSILON; }
-
-inline Grids line_rasterization(const Line &line, int64_t xdist = RasteXDistance, int64_t ydist = RasteYDistance)
-{
-    Grids     res;
-    Point     rayStart     = line.a;
-    Point     rayEnd       = line.b;
-    IndexPair currentVoxel = point_map_grid_index(rayStart, xdist, ydist);
-    IndexPair lastVoxel    = point_map_grid_index(rayEnd, xdist, ydist);
-
-    Point ray = rayEnd - rayStart;
-
-    double stepX = ray.x() >= 0 ? 1 : -1;
-    double stepY = ray.y() >= 0 ? 1 : -1;
-
-    double nextVoxelBoundaryX = (currentVoxel.first + stepX) * xdist;
-    double nextVoxelBoundaryY = (currentVoxel.second + stepY) * ydist;
-
-    if (stepX < 0) { nextVoxelBoundaryX += xdist; }
-    if (stepY < 0) { nextVoxelBoundaryY += ydist; }
-
-    double tMaxX = ray.x() != 0 ? (nextVoxelBoundaryX - rayStart.x()) / ray.x() : DBL_MAX;
-    double tMaxY = ray.y() != 0 ? (nextVoxelBoundaryY - rayStart.y()) / ray.y() : DBL_MAX;
-
-    double tDeltaX = ray.x() != 0 ? static_cast<double>(xdist) / ray.x() * stepX : DBL_MAX;
-    double tDeltaY = ray.y() != 0 ? static_cast<double>(ydist) / ray.y() * stepY : DBL_MAX;
-
-    res.push_back(currentVoxel);
-
-    double tx = tMaxX;
-    double ty = tMaxY;
-
-    while (lastVoxel != currentVoxel) {
-        if (lastVoxel.first == currentVoxel.first) {
-            for (int64_t i = currentVoxel.second; i != lastVoxel.second; i += (int64_t) stepY) {
-                currentVoxel.second += (int64_t) stepY;
-                res.push_back(currentVoxel);
-            }
-            break;
-        }
-        if (lastVoxel.second == currentVoxel.second) {
-            for (int64_t i = currentVoxel.first; i != lastVoxel.first; i += (int64_t) stepX) {
-                currentVoxel.first += (int64_t) stepX;
-                res.push_back(currentVoxel);
-            }
-            break;
-        }
-
-        if (tx < ty) {
-            currentVoxel.first += (int64_t) stepX;
-            tx += tDeltaX;
-        } else {
-            currentVoxel.second += (int64_t) stepY;
-            ty += tDeltaY;
-        }
-        res.push_back(currentVoxel);
-        if (res.size() >= 100000) { // bug
-            assert(0);
-        }
-    }
-
-    return res;
-}
-} // namespace RasterizationImpl
-
-
-
 static std::vector<ExtrusionPaths> getFakeExtrusionPathsFromWipeTower(const WipeTowerData& wtd)
 {
     float h = wtd.height;
@@ -226,6 +148,15 @@ LineWithIDs LinesBucketQueue::getCurLines() const
     return lines;
 }
 
+std::vector<std::pair<const LinesBucket *, unsigned>> LinesBucketQueue::getCurPiles() const
+{
+    std::vector<std::pair<const LinesBucket *, unsigned>> piles;
+    for (const LinesBucket &bucket : _buckets)
+        if (bucket.valid())
+            piles.emplace_back(&bucket, bucket.curPileIdx());
+    return piles;
+}
+
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths)
 {
     std::function<void(const ExtrusionEntityCollection *, ExtrusionPaths &)> getExtrusionPathImpl = [&](const ExtrusionEntityCollection *entity, ExtrusionPaths &paths) {
@@ -274,19 +205,66 @@ std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>> getAllLayers
 
 ConflictComputeOpt ConflictChecker::find_inter_of_lines(const LineWithIDs &lines)
 {
-    using namespace RasterizationImpl;
-    std::map<IndexPair, std::vector<int>> indexToLine;
-
-    for (int i = 0; i < (int)lines.size(); ++i) {
-        const LineWithID &l1      = lines[i];
-        auto              indexes = line_rasterization(l1._line);
-        for (auto index : indexes) {
-            const auto &possibleIntersectIdxs = indexToLine[index];
-            for (auto possibleIntersectIdx : possibleIntersectIdxs) {
-                const LineWithID &l2 = lines[possibleIntersectIdx];
-                if (auto interRes = line_intersect(l1, l2); interRes.has_value()) { return interRes; }
-            }
-            indexToLine[index].push_back(i);
+    // Lines of a single object instance are never tested against each other, thus the lines are grouped by instances
+    // and only the pairs of groups with overlapping bounding boxes are tested. The lines of the smaller group
+    // are then tested against an AABB tree of the lines of the bigger group.
+    struct InstanceLines
+    {
+        std::vector<size_t>                 line_ids;
+        Lines                               lines;
+        BoundingBox                         bbox;
+        AABBTreeIndirect::Tree<2, coord_t>  tree;
+    };
+    std::vector<InstanceLines> instances;
+    {
+        std::map<std::pair<int, int>, size_t> instance_map;
+        for (size_t i = 0; i < lines.size(); ++i) {
+            const LineWithID &l  = lines[i];
+            auto              it = instance_map.emplace(std::make_pair(l._obj_id, l._inst_id), instances.size()).first;
+            if (it->second == instances.size())
+                instances.emplace_back();
+            InstanceLines &instance = instances[it->second];
+            instance.line_ids.emplace_back(i);
+            instance.lines.emplace_back(l._line);
+            instance.bbox.merge(l._line.a);
+            instance.bbox.merge(l._line.b);
+        }
+    }
+    if (instances.size() < 2)
+        return {};
+
+    using TreeBBox = AABBTreeIndirect::Tree<2, coord_t>::BoundingBox;
+    auto intersect_instances = [&lines](InstanceLines &small, InstanceLines &big) -> ConflictComputeOpt {
+        if (big.tree.empty())
+            big.tree = AABBTreeLines::build_aabb_tree_over_indexed_lines(big.lines);
+        ConflictComputeOpt out;
+        for (size_t i = 0; i < small.lines.size() && ! out; ++i) {
+            const Line &line = small.lines[i];
+            TreeBBox    line_bbox(line.a, line.a);
+            line_bbox.extend(line.b);
+            AABBTreeIndirect::traverse(big.tree, AABBTreeIndirect::intersecting(line_bbox), [&](const auto &node) {
+                out = line_intersect(lines[small.line_ids[i]], lines[big.line_ids[node.idx]]);
+                // Stop the traversal at the first intersection.
+                return ! out;
+            });
+        }
+        return out;
+    };
+
+    // Sweep the instances sorted by the left side of their bounding boxes.
+    std::vector<size_t> order(instances.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&instances](size_t l, size_t r) { return instances[l].bbox.min.x() < instances[r].bbox.min.x(); });
+    for (size_t i = 0; i < order.size(); ++i) {
+        InstanceLines &instance1 = instances[order[i]];
+        for (size_t j = i + 1; j < order.size() && instances[order[j]].bbox.min.x() <= instance1.bbox.max.x(); ++j) {
+            InstanceLines &instance2 = instances[order[j]];
+            if (! instance1.bbox.overlap(instance2.bbox))
+                continue;
+            ConflictComputeOpt interRes = instance1.lines.size() < instance2.lines.size() ?
+                intersect_instances(instance1, instance2) : intersect_instances(instance2, instance1);
+            if (interRes.has_value())
+                return interRes;
         }
     }
     return {};
@@ -308,49 +286,54 @@ ConflictResultOpt ConflictChecker::find_inter_of_lines_in_diff_objs(SpanOfConstP
         std::vector<ExtrusionPaths> wtpaths = getFakeExtrusionPathsFromWipeTower(wipe_tower_data);
         conflictQueue.emplace_back_bucket(std::move(wtpaths), &wtptr, Points{Point(plate_origin)});
     }
-    for (const PrintObject *obj : objs) {
-        std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>> layers = getAllLayersExtrusionPathsFromObject(obj);
+    std::vector<std::pair<std::vector<ExtrusionPaths>, std::vector<ExtrusionPaths>>> objsLayers(objs.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, objs.size()), [&objs, &objsLayers](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++i)
+            objsLayers[i] = getAllLayersExtrusionPathsFromObject(objs[i]);
+    });
+    for (size_t i = 0; i < objs.size(); ++i) {
+        const PrintObject *obj = objs[i];
 
         Points instances_shifts;
         for (const PrintInstance& inst : obj->instances())
             instances_shifts.emplace_back(inst.shift);
 
-        conflictQueue.emplace_back_bucket(std::move(layers.first), obj, instances_shifts);
-        conflictQueue.emplace_back_bucket(std::move(layers.second), obj, instances_shifts);
+        conflictQueue.emplace_back_bucket(std::move(objsLayers[i].first), obj, instances_shifts);
+        conflictQueue.emplace_back_bucket(std::move(objsLayers[i].second), obj, instances_shifts);
     }
     conflictQueue.build_queue();
 
-    std::vector<LineWithIDs> layersLines;
-    std::vector<double>      heights;
+    // Only record the piles forming each layer, the lines are produced by the parallel workers below.
+    std::vector<std::vector<std::pair<const LinesBucket *, unsigned>>> layersPiles;
+    std::vector<double>                                                 heights;
     while (conflictQueue.valid()) {
-        LineWithIDs lines     = conflictQueue.getCurLines();
-        double      curHeight = conflictQueue.removeLowests();
-        heights.push_back(curHeight);
-        layersLines.push_back(std::move(lines));
+        layersPiles.push_back(conflictQueue.getCurPiles());
+        heights.push_back(conflictQueue.removeLowests());
     }
 
-    bool                                   find = false;
-    tbb::concurrent_vector<std::pair<ConflictComputeResult,double>> conflict;
-
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersLines.size()), [&](tbb::blocked_range<size_t> range) {
-        for (size_t i = range.begin(); i < range.end(); i++) {
-            auto interRes = find_inter_of_lines(layersLines[i]);
-            if (interRes.has_value()) {
-                find = true;
-                conflict.emplace_back(*interRes, heights[i]);
+    // Index of the lowest layer with a conflict. Layers above a conflict already found are not processed.
+    std::atomic<size_t>             conflictLayer{ std::numeric_limits<size_t>::max() };
+    std::vector<ConflictComputeOpt> conflicts(layersPiles.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layersPiles.size()), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end() && i < conflictLayer.load(std::memory_order_relaxed); i++) {
+            LineWithIDs lines;
+            for (const auto &[bucket, pileIdx] : layersPiles[i]) {
+                LineWithIDs pileLines = bucket->pileLines(pileIdx);
+                lines.insert(lines.end(), pileLines.begin(), pileLines.end());
+            }
+            if (auto interRes = find_inter_of_lines(lines); interRes.has_value()) {
+                conflicts[i] = interRes;
+                for (size_t lowest = conflictLayer.load(); i < lowest && ! conflictLayer.compare_exchange_weak(lowest, i););
                 break;
             }
         }
     });
 
-    if (find) {
-        std::sort(conflict.begin(), conflict.end(), [](const std::pair<ConflictComputeResult, double>& i1, const std::pair<ConflictComputeResult, double>& i2) {
-            return i1.second < i2.second;
-        });
-
-        const void *ptr1           = conflictQueue.idToObjsPtr(conflict[0].first._obj1);
-        const void *ptr2           = conflictQueue.idToObjsPtr(conflict[0].first._obj2);
-        double      conflictHeight = conflict[0].second;
+    if (size_t layerIdx = conflictLayer.load(); layerIdx < layersPiles.size()) {
+        const ConflictComputeResult &conflict       = *conflicts[layerIdx];
+        const void                  *ptr1           = conflictQueue.idToObjsPtr(conflict._obj1);
+        const void                  *ptr2           = conflictQueue.idToObjsPtr(conflict._obj2);
+        double                       conflictHeight = heights[layerIdx];
         if (ptr1 == &wtptr || ptr2 == &wtptr) {
             assert(! wipe_tower_data.z_and_depth_pairs.empty());
             if (ptr2 == &wtptr) { std::swap(ptr1, ptr2); }
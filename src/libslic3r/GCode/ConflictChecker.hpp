@@ -50,10 +50,12 @@ public:
         }
     }
     double      curHeight() const { return _curHeight; }
-    LineWithIDs curLines() const
+    unsigned    curPileIdx() const { return _curPileIdx; }
+    LineWithIDs curLines() const { return pileLines(_curPileIdx); }
+    LineWithIDs pileLines(unsigned pileIdx) const
     {
         LineWithIDs lines;
-        for (const ExtrusionPath &path : _piles[_curPileIdx]) {
+        for (const ExtrusionPath &path : _piles[pileIdx]) {
             Polyline check_polyline;
             for (int i = 0; i < (int)_offsets.size(); ++i) {
                 check_polyline = path.polyline;
@@ -96,6 +98,8 @@ public:
     }
     double      removeLowests();
     LineWithIDs getCurLines() const;
+    // Current piles of the valid buckets, the lines of which are returned by getCurLines().
+    std::vector<std::pair<const LinesBucket *, unsigned>> getCurPiles() const;
 };
 
 void getExtrusionPathsFromEntity(const ExtrusionEntityCollection *entity, ExtrusionPaths &paths);
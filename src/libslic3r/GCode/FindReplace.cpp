@@ -5,7 +5,9 @@
 #include "FindReplace.hpp"
 #include "../Utils.hpp"
 
+#include <algorithm>
 #include <cctype> // isalpha
+#include <cstring>
 #include <boost/algorithm/string/replace.hpp>
 
 namespace Slic3r {
@@ -57,6 +59,184 @@ GCodeFindReplace::GCodeFindReplace(const std::vector<std::string> &gcode_substit
         }
         m_substitutions.emplace_back(std::move(out));
     }
+
+    m_matcher.build(m_substitutions);
+}
+
+static inline unsigned char ascii_tolower(unsigned char c)
+{
+    return c >= 'A' && c <= 'Z' ? c - 'A' + 'a' : c;
+}
+
+static boost::match_flag_type regexp_match_flags(bool single_line)
+{
+    return single_line ? boost::match_single_line | boost::match_default : boost::match_not_dot_newline | boost::match_default;
+}
+
+void GCodeFindReplace::Matcher::build(const std::vector<Substitution> &substitutions)
+{
+    // Classes of characters of the plain patterns, class 0 are the characters not present in any pattern.
+    m_char_class.fill(0);
+    m_num_char_classes = 1;
+    for (const Substitution &substitution : substitutions)
+        if (! substitution.regexp)
+            for (char c : substitution.plain_pattern) {
+                unsigned char lower = ascii_tolower(c);
+                if (m_char_class[lower] == 0)
+                    m_char_class[lower] = uint16_t(m_num_char_classes ++);
+            }
+    for (int c = 'A'; c <= 'Z'; ++ c)
+        m_char_class[c] = m_char_class[ascii_tolower(c)];
+
+    // Trie of the lower case plain patterns. Missing transitions are marked with zero, the root is never a target of a trie edge.
+    m_transitions.assign(m_num_char_classes, 0);
+    std::vector<std::vector<uint32_t>> outputs(1);
+    for (uint32_t idx = 0; idx < uint32_t(substitutions.size()); ++ idx) {
+        const Substitution &substitution = substitutions[idx];
+        if (substitution.regexp || substitution.plain_pattern.empty())
+            continue;
+        uint32_t state = 0;
+        for (char c : substitution.plain_pattern) {
+            uint32_t &next = m_transitions[state * m_num_char_classes + m_char_class[(unsigned char)c]];
+            if (next == 0) {
+                next = uint32_t(outputs.size());
+                outputs.emplace_back();
+                // May reallocate m_transitions, thus next is not valid anymore.
+                m_transitions.resize(m_transitions.size() + m_num_char_classes, 0);
+            }
+            state = m_transitions[state * m_num_char_classes + m_char_class[(unsigned char)c]];
+        }
+        outputs[state].emplace_back(idx);
+    }
+
+    // Turn the trie into a deterministic automaton by following the failure links, breadth first.
+    std::vector<uint32_t> failure(outputs.size(), 0);
+    std::vector<uint32_t> queue;
+    queue.reserve(outputs.size());
+    for (size_t c = 0; c < m_num_char_classes; ++ c)
+        if (uint32_t next = m_transitions[c]; next != 0)
+            queue.emplace_back(next);
+    for (size_t i = 0; i < queue.size(); ++ i) {
+        const uint32_t state = queue[i];
+        // The patterns ending in the longest proper suffix of this state end in this state as well.
+        append(outputs[state], outputs[failure[state]]);
+        for (size_t c = 0; c < m_num_char_classes; ++ c) {
+            uint32_t &next = m_transitions[state * m_num_char_classes + c];
+            const uint32_t fallback = m_transitions[failure[state] * m_num_char_classes + c];
+            if (next == 0)
+                next = fallback;
+            else {
+                failure[next] = fallback;
+                queue.emplace_back(next);
+            }
+        }
+    }
+
+    m_outputs_begin.clear();
+    m_outputs.clear();
+    for (const std::vector<uint32_t> &out : outputs) {
+        m_outputs_begin.emplace_back(uint32_t(m_outputs.size()));
+        append(m_outputs, out);
+    }
+    m_outputs_begin.emplace_back(uint32_t(m_outputs.size()));
+    m_max_pattern_length = 0;
+    for (const Substitution &substitution : substitutions)
+        if (! substitution.regexp)
+            m_max_pattern_length = std::max(m_max_pattern_length, substitution.plain_pattern.size());
+
+    // Merge the regular expressions into a single alternation, with the flags of each expression applied to its branch only.
+    // Expressions with back references, recursion, \G or \Q are tested one by one, as merging them would change their meaning.
+    static const boost::regex not_mergeable(R"(\\[0-9gGkKQ]|\(\?[P|R&(+0-9])");
+    std::string merged;
+    m_merged_regexps.clear();
+    m_standalone_regexps.clear();
+    for (uint32_t idx = 0; idx < uint32_t(substitutions.size()); ++ idx) {
+        const Substitution &substitution = substitutions[idx];
+        if (! substitution.regexp)
+            continue;
+        const std::string pattern = substitution.regexp_pattern.str();
+        if (boost::regex_search(pattern, not_mergeable))
+            m_standalone_regexps.emplace_back(idx);
+        else {
+            if (! merged.empty())
+                merged += '|';
+            merged += std::string("(?") + (substitution.case_insensitive ? "i" : "") + (substitution.single_line ? "s" : "-s") + ":" + pattern + ")";
+            m_merged_regexps.emplace_back(idx);
+        }
+    }
+    if (m_merged_regexps.size() < 2) {
+        // Nothing to be gained by merging a single regular expression.
+        append(m_standalone_regexps, std::move(m_merged_regexps));
+        m_merged_regexps.clear();
+    } else {
+        try {
+            m_merged_regexp.assign(merged, boost::regex::optimize);
+        } catch (const std::exception &) {
+            append(m_standalone_regexps, std::move(m_merged_regexps));
+            m_merged_regexps.clear();
+        }
+    }
+}
+
+void GCodeFindReplace::Matcher::find_candidates(
+    const std::string &text, const std::vector<Substitution> &substitutions, size_t first_substitution, std::vector<char> &candidates) const
+{
+    std::fill(candidates.begin() + first_substitution, candidates.end(), 0);
+    this->find_plain_candidates(text, 0, text.size(), substitutions, first_substitution, candidates);
+    this->find_regexp_candidates(text, first_substitution, candidates);
+}
+
+void GCodeFindReplace::Matcher::update_candidates(const std::string &text, size_t changed_begin, size_t changed_end,
+    const std::vector<Substitution> &substitutions, size_t first_substitution, std::vector<char> &candidates) const
+{
+    // A new match of a plain pattern overlaps the modified span or it is adjacent to it, if it is a whole word match.
+    this->find_plain_candidates(text,
+        changed_begin > m_max_pattern_length ? changed_begin - m_max_pattern_length : 0,
+        std::min(changed_end + m_max_pattern_length, text.size()),
+        substitutions, first_substitution, candidates);
+    // The merged regular expressions are all candidates or none of them. A match may span any part of the text.
+    if (! m_merged_regexps.empty() && m_merged_regexps.back() >= first_substitution &&
+        ! candidates[*std::lower_bound(m_merged_regexps.begin(), m_merged_regexps.end(), uint32_t(first_substitution))])
+        this->find_regexp_candidates(text, first_substitution, candidates);
+}
+
+void GCodeFindReplace::Matcher::find_plain_candidates(const std::string &text, size_t begin, size_t end,
+    const std::vector<Substitution> &substitutions, size_t first_substitution, std::vector<char> &candidates) const
+{
+    if (m_outputs.empty())
+        return;
+    uint32_t state = 0;
+    for (size_t match_end = begin + 1; match_end <= end; ++ match_end) {
+        state = m_transitions[state * m_num_char_classes + m_char_class[(unsigned char)text[match_end - 1]]];
+        for (uint32_t i = m_outputs_begin[state]; i < m_outputs_begin[state + 1]; ++ i) {
+            const uint32_t idx = m_outputs[i];
+            if (idx < first_substitution || candidates[idx])
+                continue;
+            const Substitution &substitution = substitutions[idx];
+            const size_t match_begin = match_end - substitution.plain_pattern.size();
+            // The automaton ignores the case of ASCII letters.
+            if (! substitution.case_insensitive && memcmp(text.data() + match_begin, substitution.plain_pattern.data(), substitution.plain_pattern.size()) != 0)
+                continue;
+            // Same test as in find_and_replace_whole_word().
+            if (substitution.whole_word && ! ((match_begin == 0 || ! std::isalnum(text[match_begin - 1])) && (match_end == text.size() || ! std::isalnum(text[match_end]))))
+                continue;
+            candidates[idx] = 1;
+        }
+    }
+}
+
+void GCodeFindReplace::Matcher::find_regexp_candidates(const std::string &text, size_t first_substitution, std::vector<char> &candidates) const
+{
+    // The merged regular expression matches if any of its branches matches. Its branches are searched with the multi-line
+    // semantics of ^ and $ even for the single line expressions, thus it may report a match, which is not there.
+    if (! m_merged_regexps.empty() && m_merged_regexps.back() >= first_substitution &&
+        boost::regex_search(text.begin(), text.end(), m_merged_regexp, boost::match_default))
+        for (uint32_t idx : m_merged_regexps)
+            if (idx >= first_substitution)
+                candidates[idx] = 1;
+    for (uint32_t idx : m_standalone_regexps)
+        if (idx >= first_substitution)
+            candidates[idx] = 1;
 }
 
 class ToStringIterator 
@@ -114,23 +294,30 @@ std::string GCodeFindReplace::process_layer(const std::string &ain)
     std::string out;
     const std::string *in = &ain;
     std::string temp;
-    temp.reserve(in->size());
 
-    for (const Substitution &substitution : m_substitutions) {
+    // Substitutions, which may match the current text. Updated around the modified part of the text after a substitution
+    // modifies it, as the modification may create matches of the following substitutions.
+    std::vector<char> candidates(m_substitutions.size(), 0);
+    m_matcher.find_candidates(ain, m_substitutions, 0, candidates);
+
+    for (size_t idx = 0; idx < m_substitutions.size(); ++ idx) {
+        if (! candidates[idx])
+            continue;
+        const Substitution &substitution = m_substitutions[idx];
         if (substitution.regexp) {
+            const boost::match_flag_type flags = regexp_match_flags(substitution.single_line);
+            if (! boost::regex_search(in->begin(), in->end(), substitution.regexp_pattern, flags))
+                continue;
             temp.clear();
             temp.reserve(in->size());
             boost::regex_replace(ToStringIterator(temp), in->begin(), in->end(),
-                substitution.regexp_pattern, substitution.format, 
-                (substitution.single_line ? boost::match_single_line | boost::match_default : boost::match_not_dot_newline | boost::match_default) | boost::format_all);
-            std::swap(out, temp);
+                substitution.regexp_pattern, substitution.format, flags | boost::format_all);
         } else {
-            if (in == &ain)
-                out = ain;
+            temp = *in;
             // Plain substitution
             if (substitution.case_insensitive) {
                 if (substitution.whole_word)
-                    find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
+                    find_and_replace_whole_word(temp, substitution.plain_pattern, substitution.format,
                         [](const std::string &str, size_t start_pos, const std::string &match) {
                             auto begin = str.begin() + start_pos;
                             boost::iterator_range<std::string::const_iterator> r1(begin, str.end());
@@ -139,22 +326,31 @@ std::string GCodeFindReplace::process_layer(const std::string &ain)
                             return res ? std::make_pair(size_t(res.begin() - str.begin()), size_t(res.end() - str.begin())) : std::make_pair(std::string::npos, std::string::npos);
                         });
                 else
-                    boost::ireplace_all(out, substitution.plain_pattern, substitution.format);
+                    boost::ireplace_all(temp, substitution.plain_pattern, substitution.format);
             } else {
                 if (substitution.whole_word)
-                    find_and_replace_whole_word(out, substitution.plain_pattern, substitution.format,
+                    find_and_replace_whole_word(temp, substitution.plain_pattern, substitution.format,
                         [](const std::string &str, size_t start_pos, const std::string &match) { 
                             size_t pos = str.find(match, start_pos);
                             return std::make_pair(pos, pos + (pos == std::string::npos ? 0 : match.size()));
                         });
                 else
-                    boost::replace_all(out, substitution.plain_pattern, substitution.format);
+                    boost::replace_all(temp, substitution.plain_pattern, substitution.format);
             }
         }
+        // Span of temp differing from the current text: common prefix and suffix are skipped.
+        const size_t prefix = std::mismatch(temp.begin(), temp.begin() + std::min(temp.size(), in->size()), in->begin()).first - temp.begin();
+        if (prefix == temp.size() && prefix == in->size())
+            // The substitution did not modify the text.
+            continue;
+        const size_t max_suffix = std::min(temp.size(), in->size()) - prefix;
+        const size_t suffix = std::mismatch(temp.rbegin(), temp.rbegin() + max_suffix, in->rbegin()).first - temp.rbegin();
+        std::swap(out, temp);
         in = &out;
+        m_matcher.update_candidates(out, prefix, out.size() - suffix, m_substitutions, idx + 1, candidates);
     }
 
-    return out;
+    return in == &ain ? ain : out;
 }
 
 }
@@ -9,6 +9,8 @@
 
 #include <boost/regex.hpp>
 
+#include <array>
+
 namespace Slic3r {
 
 class GCodeFindReplace {
@@ -32,6 +34,48 @@ private:
         bool            single_line { false };
     };
     std::vector<Substitution> m_substitutions;
+
+    // Finds in a single pass over the G-code the substitutions, which may modify it:
+    // The plain patterns are compiled into a single Aho-Corasick automaton, the regular expressions are merged
+    // into a single alternation. The substitutions are still applied one after the other by process_layer()
+    // and only to the text they match, thus the output is the same as if all of them were applied.
+    class Matcher {
+    public:
+        void build(const std::vector<Substitution> &substitutions);
+        // Sets candidates[i] for i >= first_substitution if substitution i may match text, clears it otherwise.
+        void find_candidates(const std::string &text, const std::vector<Substitution> &substitutions,
+                             size_t first_substitution, std::vector<char> &candidates) const;
+        // Updates the candidates found by find_candidates() after the text was modified in [changed_begin, changed_end) only,
+        // by searching the plain patterns around the modified span. Candidates, which matched the unmodified text only, are kept.
+        void update_candidates(const std::string &text, size_t changed_begin, size_t changed_end, const std::vector<Substitution> &substitutions,
+                               size_t first_substitution, std::vector<char> &candidates) const;
+
+    private:
+        // Sets candidates of the plain patterns matching text in [begin, end).
+        void find_plain_candidates(const std::string &text, size_t begin, size_t end, const std::vector<Substitution> &substitutions,
+                                   size_t first_substitution, std::vector<char> &candidates) const;
+        // Sets candidates of the regular expressions, which may match text.
+        void find_regexp_candidates(const std::string &text, size_t first_substitution, std::vector<char> &candidates) const;
+
+        // Input characters are mapped to classes of characters, which are not distinguished by the plain patterns.
+        // ASCII letters of both cases map to the same class, matches of case sensitive patterns are verified.
+        std::array<uint16_t, 256>   m_char_class;
+        size_t                      m_num_char_classes { 0 };
+        // Transitions of the automaton, m_num_char_classes per state. State 0 is the root.
+        std::vector<uint32_t>       m_transitions;
+        // Indices of the plain substitutions with a pattern ending in state i are
+        // m_outputs[m_outputs_begin[i]] to m_outputs[m_outputs_begin[i + 1]].
+        std::vector<uint32_t>       m_outputs_begin;
+        std::vector<uint32_t>       m_outputs;
+        // Length of the longest plain pattern.
+        size_t                      m_max_pattern_length { 0 };
+        // Alternation of the regular expressions of m_merged_regexps.
+        boost::regex                m_merged_regexp;
+        std::vector<uint32_t>       m_merged_regexps;
+        // Regular expressions, which cannot be merged (using back references for example). They are always tested.
+        std::vector<uint32_t>       m_standalone_regexps;
+    };
+    Matcher                   m_matcher;
 };
 
 }
@@ -12,6 +12,7 @@
 #include "libslic3r/I18N.hpp"
 #include "libslic3r/Geometry/ArcWelder.hpp"
 #include "GCodeProcessor.hpp"
+#include "BinaryGCodeLayerIndex.hpp"
 
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/log/trivial.hpp>
@@ -30,6 +31,7 @@
 #endif
 
 #include <chrono>
+#include <unordered_map>
 
 static const float DEFAULT_TOOLPATH_WIDTH = 0.4f;
 static const float DEFAULT_TOOLPATH_HEIGHT = 0.2f;
@@ -515,9 +517,143 @@ void GCodeProcessor::UsedFilaments::process_caches(const GCodeProcessor* process
     process_role_cache(processor);
 }
 
+void GCodeProcessorResult::CompactMoves::build(const std::vector<MoveVertex>& moves)
+{
+    this->clear();
+
+    m_type.reserve(moves.size());
+    m_extrusion_role.reserve(moves.size());
+    m_extruder_id.reserve(moves.size());
+    m_cp_color_id.reserve(moves.size());
+    m_gcode_id.reserve(moves.size());
+    m_position.reserve(moves.size());
+    m_delta_extruder.reserve(moves.size());
+    m_actual_feedrate.reserve(moves.size());
+    m_attributes.reserve(moves.size());
+    m_time.reserve(moves.size());
+
+    // The palette is looked up by the bit patterns of the attributes, to have a well defined equality also for NaNs.
+    using AttributesKey = std::array<uint32_t, 6>;
+    struct AttributesKeyHash {
+        size_t operator()(const AttributesKey& key) const {
+            size_t seed = 0;
+            for (uint32_t v : key)
+                seed ^= std::hash<uint32_t>()(v) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+            return seed;
+        }
+    };
+    std::unordered_map<AttributesKey, uint32_t, AttributesKeyHash> palette_map;
+    auto bits = [](float value) { uint32_t out; memcpy(&out, &value, sizeof(out)); return out; };
+
+    for (const MoveVertex& move : moves) {
+        // Offset of the move from the origin of the current block, in microns.
+        auto position_offset = [&move](const Block& block, std::array<int16_t, 3>& offset) {
+            for (int i = 0; i < 3; ++i) {
+                const float microns = std::round((move.position[i] - block.origin[i]) * 1000.0f);
+                if (!(std::abs(microns) <= float(std::numeric_limits<int16_t>::max())))
+                    return false;
+                offset[i] = int16_t(microns);
+            }
+            return true;
+        };
+
+        std::array<int16_t, 3> offset;
+        if (m_blocks.empty() || m_blocks.back().layer_id != move.layer_id ||
+            move.gcode_id < m_blocks.back().gcode_id || move.gcode_id - m_blocks.back().gcode_id > std::numeric_limits<uint16_t>::max() ||
+            !position_offset(m_blocks.back(), offset)) {
+            m_blocks.push_back({ m_type.size(), move.position, move.gcode_id, move.layer_id });
+            offset = { 0, 0, 0 };
+        }
+        const Block& block = m_blocks.back();
+
+        const AttributesKey key = { bits(move.feedrate), bits(move.width), bits(move.height), bits(move.mm3_per_mm),
+                                    bits(move.fan_speed), bits(move.temperature) };
+        auto [it, inserted] = palette_map.insert({ key, uint32_t(m_palette.size()) });
+        if (inserted)
+            m_palette.push_back({ move.feedrate, move.width, move.height, move.mm3_per_mm, move.fan_speed, move.temperature });
+
+        m_type.emplace_back(static_cast<unsigned char>(move.type) | (move.internal_only ? 0x80 : 0));
+        m_extrusion_role.emplace_back(move.extrusion_role);
+        m_extruder_id.emplace_back(move.extruder_id);
+        m_cp_color_id.emplace_back(move.cp_color_id);
+        m_gcode_id.emplace_back(uint16_t(move.gcode_id - block.gcode_id));
+        m_position.emplace_back(offset);
+        m_delta_extruder.emplace_back(move.delta_extruder);
+        m_actual_feedrate.emplace_back(move.actual_feedrate);
+        m_attributes.emplace_back(it->second);
+        m_time.emplace_back(move.time);
+    }
+
+    m_blocks.shrink_to_fit();
+    m_palette.shrink_to_fit();
+}
+
+void GCodeProcessorResult::CompactMoves::clear()
+{
+    m_blocks.clear();
+    m_palette.clear();
+    m_type.clear();
+    m_extrusion_role.clear();
+    m_extruder_id.clear();
+    m_cp_color_id.clear();
+    m_gcode_id.clear();
+    m_position.clear();
+    m_delta_extruder.clear();
+    m_actual_feedrate.clear();
+    m_attributes.clear();
+    m_time.clear();
+}
+
+size_t GCodeProcessorResult::CompactMoves::memory_used() const
+{
+    auto used = [](const auto& v) { return v.capacity() * sizeof(typename std::decay_t<decltype(v)>::value_type); };
+    return used(m_blocks) + used(m_palette) + used(m_type) + used(m_extrusion_role) + used(m_extruder_id) + used(m_cp_color_id) +
+           used(m_gcode_id) + used(m_position) + used(m_delta_extruder) + used(m_actual_feedrate) + used(m_attributes) + used(m_time);
+}
+
+GCodeProcessorResult::MoveVertex GCodeProcessorResult::CompactMoves::get(size_t id, size_t& block_hint) const
+{
+    assert(id < this->size());
+    auto contains = [this, id](size_t block_id) {
+        return block_id < m_blocks.size() && m_blocks[block_id].begin <= id &&
+            (block_id + 1 == m_blocks.size() || id < m_blocks[block_id + 1].begin);
+    };
+    if (!contains(block_hint)) {
+        if (contains(block_hint + 1))
+            ++ block_hint;
+        else
+            block_hint = std::upper_bound(m_blocks.begin(), m_blocks.end(), id,
+                [](size_t i, const Block& block) { return i < block.begin; }) - m_blocks.begin() - 1;
+    }
+    const Block&      block      = m_blocks[block_hint];
+    const Attributes& attributes = m_palette[m_attributes[id]];
+    const std::array<int16_t, 3>& offset = m_position[id];
+
+    MoveVertex move;
+    move.gcode_id        = block.gcode_id + m_gcode_id[id];
+    move.type            = static_cast<EMoveType>(m_type[id] & 0x7F);
+    move.extrusion_role  = m_extrusion_role[id];
+    move.extruder_id     = m_extruder_id[id];
+    move.cp_color_id     = m_cp_color_id[id];
+    move.position        = block.origin + 0.001f * Vec3f(float(offset[0]), float(offset[1]), float(offset[2]));
+    move.delta_extruder  = m_delta_extruder[id];
+    move.feedrate        = attributes.feedrate;
+    move.actual_feedrate = m_actual_feedrate[id];
+    move.width           = attributes.width;
+    move.height          = attributes.height;
+    move.mm3_per_mm      = attributes.mm3_per_mm;
+    move.fan_speed       = attributes.fan_speed;
+    move.temperature     = attributes.temperature;
+    move.time            = m_time[id];
+    move.layer_id        = block.layer_id;
+    move.internal_only   = (m_type[id] & 0x80) != 0;
+    return move;
+}
+
 void GCodeProcessorResult::reset() {
     is_binary_file = false;
     moves.clear();
+    compact_moves.clear();
     lines_ends.clear();
     bed_shape = Pointfs();
     max_print_height = 0.0f;
@@ -1386,6 +1522,10 @@ void GCodeProcessor::finalize(bool perform_post_process)
 
     if (perform_post_process)
         post_process();
+
+    // pack the moves, the processing is over
+    m_result.compact_moves.build(m_result.moves);
+    m_result.moves = std::vector<GCodeProcessorResult::MoveVertex>();
 }
 
 float GCodeProcessor::get_time(PrintEstimatedStatistics::ETimeMode mode) const
@@ -3899,6 +4039,7 @@ void GCodeProcessor::post_process()
         size_t m_out_file_pos{ 0 };
 
         bgcode::binarize::Binarizer& m_binarizer;
+        BinaryGCodeLayerIndex m_layer_index;
 
     public:
         ExportLines(bgcode::binarize::Binarizer& binarizer, EWriteType type,
@@ -4051,7 +4192,7 @@ void GCodeProcessor::post_process()
             }
 
             if (m_binarizer.is_enabled()) {
-                if (m_binarizer.append_gcode(out_string) != bgcode::core::EResult::Success)
+                if (m_layer_index.append_gcode(m_binarizer, *out.f, out_string) != bgcode::core::EResult::Success)
                     throw Slic3r::RuntimeError("Error while sending gcode to the binarizer.");
             }
             else {
@@ -4074,7 +4215,7 @@ void GCodeProcessor::post_process()
 #endif // NDEBUG
 
             if (m_binarizer.is_enabled()) {
-                if (m_binarizer.append_gcode(out_string) != bgcode::core::EResult::Success)
+                if (m_layer_index.append_gcode(m_binarizer, *out.f, out_string) != bgcode::core::EResult::Success)
                     throw Slic3r::RuntimeError("Error while sending gcode to the binarizer.");
             }
             else {
@@ -4095,6 +4236,7 @@ void GCodeProcessor::post_process()
         }
 
         size_t get_size() const { return m_size; }
+        const BinaryGCodeLayerIndex& get_layer_index() const { return m_layer_index; }
 
     private:
         void write_to_file(FilePtr& out, const std::string& out_string, GCodeProcessorResult& result, const std::string& out_path) {
@@ -4427,6 +4569,9 @@ void GCodeProcessor::post_process()
     export_lines.flush(out, m_result, out_path);
 
     if (m_binarizer.is_enabled()) {
+        // store the index of the layers at the end of the gcode, to allow to read ranges of layers without decoding the whole file
+        if (export_lines.get_layer_index().append_index(m_binarizer) != bgcode::core::EResult::Success)
+            throw Slic3r::RuntimeError("Error while sending gcode to the binarizer.");
         if (m_binarizer.finalize() != bgcode::core::EResult::Success)
             throw Slic3r::RuntimeError("Error while finalizing the gcode binarizer.");
     }
@@ -17,6 +17,7 @@
 
 #include <cstdint>
 #include <array>
+#include <iterator>
 #include <vector>
 #include <string>
 #include <string_view>
@@ -139,10 +140,127 @@ namespace Slic3r {
             float actual_volumetric_rate() const { return actual_feedrate * mm3_per_mm; }
         };
 
+        // Columnar storage of the moves of a processed G-code, taking less than half the memory of std::vector<MoveVertex>.
+        // The moves are split into blocks, each one belonging to a single layer. Positions are stored as offsets in microns
+        // from the origin of their block and gcode ids as offsets from the first gcode id of their block, a new block is started
+        // whenever an offset does not fit. Feedrate, width, height, mm3_per_mm, fan speed and temperature are stored as an index
+        // into a palette of their distinct combinations.
+        // The moves are decoded on the fly, sequential access through const_iterator takes constant time.
+        class CompactMoves
+        {
+        public:
+            class const_iterator
+            {
+            public:
+                using iterator_category = std::random_access_iterator_tag;
+                using value_type        = MoveVertex;
+                using difference_type   = std::ptrdiff_t;
+                using pointer           = void;
+                using reference         = MoveVertex;
+
+                const_iterator() = default;
+                const_iterator(const CompactMoves *moves, size_t id) : m_moves(moves), m_id(id) {}
+
+                MoveVertex      operator*() const { return m_moves->get(m_id, m_block_hint); }
+                MoveVertex      operator[](difference_type n) const { return m_moves->get(m_id + n, m_block_hint); }
+                size_t          id() const { return m_id; }
+
+                const_iterator& operator++() { ++ m_id; return *this; }
+                const_iterator  operator++(int) { const_iterator out = *this; ++ m_id; return out; }
+                const_iterator& operator--() { -- m_id; return *this; }
+                const_iterator  operator--(int) { const_iterator out = *this; -- m_id; return out; }
+                const_iterator& operator+=(difference_type n) { m_id += n; return *this; }
+                const_iterator& operator-=(difference_type n) { m_id -= n; return *this; }
+                friend const_iterator  operator+(const_iterator it, difference_type n) { return it += n; }
+                friend const_iterator  operator+(difference_type n, const_iterator it) { return it += n; }
+                friend const_iterator  operator-(const_iterator it, difference_type n) { return it -= n; }
+                friend difference_type operator-(const const_iterator &lhs, const const_iterator &rhs)
+                    { return difference_type(lhs.m_id) - difference_type(rhs.m_id); }
+
+                bool operator==(const const_iterator &rhs) const { return m_id == rhs.m_id; }
+                bool operator!=(const const_iterator &rhs) const { return m_id != rhs.m_id; }
+                bool operator< (const const_iterator &rhs) const { return m_id <  rhs.m_id; }
+                bool operator> (const const_iterator &rhs) const { return m_id >  rhs.m_id; }
+                bool operator<=(const const_iterator &rhs) const { return m_id <= rhs.m_id; }
+                bool operator>=(const const_iterator &rhs) const { return m_id >= rhs.m_id; }
+
+            private:
+                const CompactMoves *m_moves{ nullptr };
+                size_t              m_id{ 0 };
+                // Block of the last decoded move, speeds up the lookup of the block of the next one.
+                mutable size_t      m_block_hint{ 0 };
+            };
+
+            CompactMoves() = default;
+            explicit CompactMoves(const std::vector<MoveVertex> &moves) { this->build(moves); }
+
+            // Replaces the content with the given moves.
+            void           build(const std::vector<MoveVertex> &moves);
+            void           clear();
+
+            bool           empty() const { return m_type.empty(); }
+            size_t         size() const { return m_type.size(); }
+            // Takes logarithmic time in the number of blocks.
+            MoveVertex     operator[](size_t id) const { size_t block_hint = 0; return this->get(id, block_hint); }
+            MoveVertex     front() const { return (*this)[0]; }
+            MoveVertex     back() const { return (*this)[this->size() - 1]; }
+            const_iterator begin() const { return { this, 0 }; }
+            const_iterator end() const { return { this, this->size() }; }
+
+            size_t         blocks_count() const { return m_blocks.size(); }
+            size_t         palette_size() const { return m_palette.size(); }
+            // Memory allocated by the columns, the palette and the blocks, in bytes.
+            size_t         memory_used() const;
+
+        private:
+            struct Block
+            {
+                // Index of the first move of the block.
+                size_t       begin;
+                Vec3f        origin;
+                unsigned int gcode_id;
+                unsigned int layer_id;
+            };
+
+            struct Attributes
+            {
+                float feedrate;
+                float width;
+                float height;
+                float mm3_per_mm;
+                float fan_speed;
+                float temperature;
+            };
+
+            // Decodes the move with the given index. block_hint is the block of a previously decoded move,
+            // it is updated to the block of the decoded move.
+            MoveVertex get(size_t id, size_t &block_hint) const;
+
+            std::vector<Block>                    m_blocks;
+            std::vector<Attributes>               m_palette;
+            // EMoveType in the lower 7 bits, internal_only in the highest bit.
+            std::vector<unsigned char>            m_type;
+            std::vector<GCodeExtrusionRole>       m_extrusion_role;
+            std::vector<unsigned char>            m_extruder_id;
+            std::vector<unsigned char>            m_cp_color_id;
+            // Offsets from Block::gcode_id.
+            std::vector<uint16_t>                 m_gcode_id;
+            // Offsets from Block::origin, in microns.
+            std::vector<std::array<int16_t, 3>>   m_position;
+            std::vector<float>                    m_delta_extruder;
+            std::vector<float>                    m_actual_feedrate;
+            // Indices into m_palette.
+            std::vector<uint32_t>                 m_attributes;
+            std::vector<std::array<float, static_cast<size_t>(PrintEstimatedStatistics::ETimeMode::Count)>> m_time;
+        };
+
         std::string filename;
         bool is_binary_file;
         unsigned int id;
+        // Moves collected while processing the G-code. GCodeProcessor::finalize() packs them into compact_moves and releases them.
         std::vector<MoveVertex> moves;
+        // Moves of the processed G-code.
+        CompactMoves compact_moves;
         // Positions of ends of lines of the final G-code this->filename after TimeProcessor::post_process() finalizes the G-code.
         // Binarized gcodes usually have several gcode blocks. Each block has its own list on ends of lines.
         // Ascii gcodes have only one list on ends of lines
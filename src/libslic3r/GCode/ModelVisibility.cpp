@@ -118,6 +118,9 @@ std::vector<float> raycast_visibility(
                     &raycasting_tree, &result, &samples, &params](tbb::blocked_range<size_t> r) {
                 // Maintaining hits memory outside of the loop, so it does not have to be reallocated for each query.
                 std::vector<igl::Hit> hits;
+                // Rays of a single sample point, which are cast together as they share the origin.
+                std::vector<Vec3f> ray_dirs;
+                std::vector<Vec3d> ray_origins_d, ray_dirs_d;
                 for (size_t s_idx = r.begin(); s_idx < r.end(); ++s_idx) {
                     result[s_idx] = 1.0f;
                     const float decrease_step = 1.0f
@@ -129,49 +132,60 @@ std::vector<float> raycast_visibility(
                     Frame f;
                     f.set_from_z(normal);
 
-                    for (const auto &dir : precomputed_sample_directions) {
-                        Vec3f final_ray_dir = (f.to_world(dir));
-                        if (!model_contains_negative_parts) {
-                            igl::Hit hitpoint;
-                            // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
-                            // direction.
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            bool hit = AABBTreeIndirect::intersect_ray_first_hit(triangles.vertices,
-                                    triangles.indices, raycasting_tree, ray_origin_d, final_ray_dir_d, hitpoint);
-                            if (hit && its_face_normal(triangles, hitpoint.id).dot(final_ray_dir) <= 0) {
+                    if (!model_contains_negative_parts) {
+                        // FIXME: This AABBTTreeIndirect query will not compile for float ray origin and
+                        // direction.
+                        const size_t rays_count = precomputed_sample_directions.size();
+                        ray_dirs.clear();
+                        ray_dirs_d.clear();
+                        for (const auto &dir : precomputed_sample_directions) {
+                            ray_dirs.emplace_back(f.to_world(dir));
+                            ray_dirs_d.emplace_back(ray_dirs.back().cast<double>());
+                        }
+                        ray_origins_d.assign(rays_count, (center + normal * 0.01f).cast<double>()); // start above surface.
+                        hits.resize(rays_count);
+                        AABBTreeIndirect::intersect_rays_first_hit(triangles.vertices, triangles.indices, raycasting_tree,
+                                ray_origins_d.data(), ray_dirs_d.data(), rays_count, hits.data());
+                        for (size_t ray_idx = 0; ray_idx < rays_count; ++ray_idx) {
+                            const igl::Hit &hitpoint = hits[ray_idx];
+                            if (hitpoint.id >= 0 && its_face_normal(triangles, hitpoint.id).dot(ray_dirs[ray_idx]) <= 0) {
                                 result[s_idx] -= decrease_step;
                             }
-                        } else { //TODO improve logic for order based boolean operations - consider order of volumes
-                            bool casting_from_negative_volume = samples.triangle_indices[s_idx]
-                                    >= negative_volumes_start_index;
-
-                            Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
-                            if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
-                                final_ray_dir = -1.0 * final_ray_dir;
-                                ray_origin_d = (center - normal * 0.01f).cast<double>();
-                            }
-                            Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
-                            bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
-                                    triangles.indices, raycasting_tree,
-                                    ray_origin_d, final_ray_dir_d, hits);
-                            if (some_hit) {
-                                int counter = 0;
-                                // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
-                                //  It cannot be inside model, and it cannot be inside negative volume
-                                for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
-                                    Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
-                                    if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
-                                        counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
-                                        // which in reverse hit analysis means, that we are entering negative space :) and vice versa
-                                    } else {
-                                        counter += sgn(face_normal.dot(final_ray_dir));
-                                    }
-                                }
-                                if (counter == 0) {
-                                    result[s_idx] -= decrease_step;
+                        }
+                        continue;
+                    }
+
+                    //TODO improve logic for order based boolean operations - consider order of volumes
+                    bool casting_from_negative_volume = samples.triangle_indices[s_idx]
+                            >= negative_volumes_start_index;
+
+                    for (const auto &dir : precomputed_sample_directions) {
+                        Vec3f final_ray_dir = (f.to_world(dir));
+                        Vec3d ray_origin_d = (center + normal * 0.01f).cast<double>(); // start above surface.
+                        if (casting_from_negative_volume) { // if casting from negative volume face, invert direction, change start pos
+                            final_ray_dir = -1.0 * final_ray_dir;
+                            ray_origin_d = (center - normal * 0.01f).cast<double>();
+                        }
+                        Vec3d final_ray_dir_d = final_ray_dir.cast<double>();
+                        bool some_hit = AABBTreeIndirect::intersect_ray_all_hits(triangles.vertices,
+                                triangles.indices, raycasting_tree,
+                                ray_origin_d, final_ray_dir_d, hits);
+                        if (some_hit) {
+                            int counter = 0;
+                            // NOTE: iterating in reverse, from the last hit for one simple reason: We know the state of the ray at that point;
+                            //  It cannot be inside model, and it cannot be inside negative volume
+                            for (int hit_index = int(hits.size()) - 1; hit_index >= 0; --hit_index) {
+                                Vec3f face_normal = its_face_normal(triangles, hits[hit_index].id);
+                                if (hits[hit_index].id >= int(negative_volumes_start_index)) { //negative volume hit
+                                    counter -= sgn(face_normal.dot(final_ray_dir)); // if volume face aligns with ray dir, we are leaving negative space
+                                    // which in reverse hit analysis means, that we are entering negative space :) and vice versa
+                                } else {
+                                    counter += sgn(face_normal.dot(final_ray_dir));
                                 }
                             }
+                            if (counter == 0) {
+                                result[s_idx] -= decrease_step;
+                            }
                         }
                     }
                 }
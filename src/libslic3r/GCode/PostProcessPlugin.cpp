@@ -0,0 +1,171 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "PostProcessPlugin.hpp"
+
+#include "libslic3r/PrintConfig.hpp"
+#include "libslic3r/Exception.hpp"
+#include "libslic3r/format.hpp"
+
+#include <boost/algorithm/string.hpp>
+#include <boost/dll/shared_library.hpp>
+#include <boost/log/trivial.hpp>
+
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <type_traits>
+
+namespace Slic3r {
+
+bool is_post_process_plugin(const std::string &aline, std::string *path, std::string *args)
+{
+    const std::string line = boost::trim_copy(aline);
+    if (! boost::starts_with(line, PostProcessPluginPrefix))
+        return false;
+    const std::string rest = boost::trim_left_copy(line.substr(strlen(PostProcessPluginPrefix)));
+    // A malformed line is still a plugin, it fails loading with an error message rather than being executed as a script.
+    std::string p, a;
+    if (boost::starts_with(rest, "\"")) {
+        // Quoted path, which may contain spaces.
+        size_t end = rest.find('"', 1);
+        p = rest.substr(1, end == std::string::npos ? std::string::npos : end - 1);
+        a = end == std::string::npos ? std::string() : rest.substr(end + 1);
+    } else {
+        size_t end = rest.find_first_of(" \t");
+        p = rest.substr(0, end);
+        a = end == std::string::npos ? std::string() : rest.substr(end);
+    }
+    if (path)
+        *path = std::move(p);
+    if (args)
+        *args = boost::trim_copy(a);
+    return true;
+}
+
+// Lines of the "post_process" option, which are in-process plugins.
+static std::vector<std::string> post_process_plugin_lines(const DynamicPrintConfig &config)
+{
+    std::vector<std::string> out;
+    if (const auto *post_process = config.opt<ConfigOptionStrings>("post_process"); post_process != nullptr)
+        for (const std::string &scripts : post_process->values) {
+            std::vector<std::string> lines;
+            boost::split(lines, scripts, boost::is_any_of("\r\n"));
+            for (const std::string &line : lines)
+                if (is_post_process_plugin(line))
+                    out.emplace_back(line);
+        }
+    return out;
+}
+
+struct GCodePostProcessPlugins::Library
+{
+    boost::dll::shared_library library;
+    slic3r_pp_begin_fn         begin   { nullptr };
+    slic3r_pp_process_fn       process { nullptr };
+    slic3r_pp_error_fn         error   { nullptr };
+    slic3r_pp_end_fn           end     { nullptr };
+};
+
+// Loads the plugin on first use. The plugins are never unloaded, so that the exports do not pay for loading them again.
+const GCodePostProcessPlugins::Library& GCodePostProcessPlugins::load_library(const std::string &path)
+{
+    static std::mutex                                      mutex;
+    static std::map<std::string, std::unique_ptr<Library>> libraries;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    if (auto it = libraries.find(path); it != libraries.end())
+        return *it->second;
+
+    auto out = std::make_unique<Library>();
+    try {
+        out->library.load(path);
+    } catch (const std::exception &ex) {
+        throw Slic3r::RuntimeError(format("Failed loading post-processing plugin %1%: %2%", path, ex.what()));
+    }
+    auto get = [&out, &path](const char *name, auto &fn) {
+        if (! out->library.has(name))
+            throw Slic3r::RuntimeError(format("Post-processing plugin %1% does not export %2%", path, name));
+        fn = &out->library.get<std::remove_pointer_t<std::decay_t<decltype(fn)>>>(name);
+    };
+    slic3r_pp_api_version_fn api_version = nullptr;
+    get("slic3r_pp_api_version", api_version);
+    if (int version = api_version(); version != SLIC3R_PP_PLUGIN_API_VERSION)
+        throw Slic3r::RuntimeError(format("Post-processing plugin %1% implements version %2% of the plugin interface, version %3% is required",
+            path, version, SLIC3R_PP_PLUGIN_API_VERSION));
+    get("slic3r_pp_begin", out->begin);
+    get("slic3r_pp_process", out->process);
+    get("slic3r_pp_error", out->error);
+    get("slic3r_pp_end", out->end);
+    BOOST_LOG_TRIVIAL(info) << "Loaded post-processing plugin " << path;
+
+    return *libraries.emplace(path, std::move(out)).first->second;
+}
+
+bool GCodePostProcessPlugins::has_plugins(const DynamicPrintConfig &config)
+{
+    return ! post_process_plugin_lines(config).empty();
+}
+
+GCodePostProcessPlugins::GCodePostProcessPlugins(const DynamicPrintConfig &config)
+{
+    std::vector<std::string> keys = config.keys();
+    std::vector<std::string> values;
+    values.reserve(keys.size());
+    for (const std::string &key : keys)
+        values.emplace_back(config.opt_serialize(key));
+    std::vector<const char*> keys_c, values_c;
+    keys_c.reserve(keys.size());
+    values_c.reserve(keys.size());
+    for (size_t i = 0; i < keys.size(); ++ i) {
+        keys_c.emplace_back(keys[i].c_str());
+        values_c.emplace_back(values[i].c_str());
+    }
+
+    try {
+        for (const std::string &line : post_process_plugin_lines(config)) {
+            Session session;
+            std::string args;
+            is_post_process_plugin(line, &session.path, &args);
+            session.library = &load_library(session.path);
+            session.data    = session.library->begin(args.c_str(), keys_c.data(), values_c.data(), keys_c.size());
+            if (session.data == nullptr)
+                throw Slic3r::RuntimeError(format("Post-processing plugin %1% failed to start", session.path));
+            m_sessions.emplace_back(std::move(session));
+        }
+    } catch (...) {
+        // The destructor is not called if the constructor throws.
+        for (Session &session : m_sessions)
+            session.library->end(session.data);
+        throw;
+    }
+}
+
+GCodePostProcessPlugins::~GCodePostProcessPlugins()
+{
+    for (Session &session : m_sessions)
+        session.library->end(session.data);
+}
+
+static void emit_to_string(void *emit_data, const char *gcode, size_t size)
+{
+    static_cast<std::string*>(emit_data)->append(gcode, size);
+}
+
+std::string GCodePostProcessPlugins::process_layer(std::string gcode)
+{
+    std::string out;
+    for (const Session &session : m_sessions) {
+        out.clear();
+        out.reserve(gcode.size());
+        if (session.library->process(session.data, gcode.data(), gcode.size(), emit_to_string, &out) != 0) {
+            const char *error = session.library->error(session.data);
+            throw Slic3r::RuntimeError(format("Post-processing plugin %1% failed: %2%", session.path, error ? error : "unknown error"));
+        }
+        gcode.swap(out);
+    }
+    return gcode;
+}
+
+} // namespace Slic3r
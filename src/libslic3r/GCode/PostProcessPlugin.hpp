@@ -0,0 +1,88 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_GCode_PostProcessPlugin_hpp_
+#define slic3r_GCode_PostProcessPlugin_hpp_
+
+#include <cstddef>
+
+// C interface of the in-process G-code post-processing plugins.
+//
+// A plugin is a shared library (.so, .dylib or .dll) listed in the "post_process" option on a line starting with "plugin:",
+// followed by the path to the library (quoted if it contains spaces) and optional arguments.
+// Contrary to the post-processing scripts, which run on the exported G-code file,
+// a plugin receives the G-code while it is being generated, in chunks of whole lines (usually a layer at a time).
+// Its output is written into the G-code file and it is seen by the G-code processor (time estimates, preview).
+// The plugins run in the order they are listed, before the post-processing scripts.
+//
+// A plugin exports the following functions with C linkage. All of them are called from the G-code export thread
+// or from the export pipeline, never concurrently for the same plugin data.
+extern "C" {
+
+#define SLIC3R_PP_PLUGIN_API_VERSION 1
+
+// Called by a plugin to append G-code to the output of slic3r_pp_process().
+typedef void (*slic3r_pp_emit_fn)(void *emit_data, const char *gcode, size_t size);
+
+// Returns SLIC3R_PP_PLUGIN_API_VERSION the plugin was compiled against.
+typedef int         (*slic3r_pp_api_version_fn)();
+// Called once for each exported G-code. args are the arguments following the plugin path in the "post_process" option,
+// config_keys and config_values the print configuration as key / serialized value pairs.
+// Returns data to be passed to the other functions, null on error.
+typedef void*       (*slic3r_pp_begin_fn)(const char *args, const char *const *config_keys, const char *const *config_values, size_t config_size);
+// Processes a chunk of G-code made of whole lines. The processed G-code is passed to emit, which may be called any number of times.
+// Returns zero on success.
+typedef int         (*slic3r_pp_process_fn)(void *data, const char *gcode, size_t size, slic3r_pp_emit_fn emit, void *emit_data);
+// Returns a description of the last error of slic3r_pp_process(), which may be null.
+typedef const char* (*slic3r_pp_error_fn)(void *data);
+// Called at the end of the export, including a failed or canceled one. Releases data.
+typedef void        (*slic3r_pp_end_fn)(void *data);
+
+} // extern "C"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace Slic3r {
+
+class DynamicPrintConfig;
+
+// Prefix of the lines of the "post_process" option, which are in-process plugins rather than scripts.
+static constexpr const char *PostProcessPluginPrefix = "plugin:";
+
+// Is the line of the "post_process" option an in-process plugin (starting with PostProcessPluginPrefix) rather than a post-processing script?
+// If so and path / args are not null, fills in the path to the shared library and the arguments following it.
+extern bool is_post_process_plugin(const std::string &line, std::string *path = nullptr, std::string *args = nullptr);
+
+// In-process post-processing plugins of a single G-code export.
+// The shared libraries are loaded on first use and kept loaded until the application exits.
+class GCodePostProcessPlugins {
+public:
+    // Loads the plugins listed in the "post_process" option of config and starts their export.
+    // Throws Slic3r::RuntimeError if a plugin cannot be loaded or fails to start.
+    GCodePostProcessPlugins(const DynamicPrintConfig &config);
+    ~GCodePostProcessPlugins();
+
+    static bool has_plugins(const DynamicPrintConfig &config);
+
+    // Passes the G-code through all the plugins.
+    // Throws Slic3r::RuntimeError if a plugin fails.
+    std::string process_layer(std::string gcode);
+
+private:
+    struct Library;
+    static const Library& load_library(const std::string &path);
+
+    struct Session {
+        const Library *library { nullptr };
+        std::string    path;
+        void          *data { nullptr };
+    };
+    std::vector<Session> m_sessions;
+};
+
+} // namespace Slic3r
+
+#endif /* slic3r_GCode_PostProcessPlugin_hpp_ */
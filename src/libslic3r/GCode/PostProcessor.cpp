@@ -4,6 +4,7 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include "PostProcessor.hpp"
+#include "PostProcessPlugin.hpp"
 
 #include "libslic3r/Utils.hpp"
 #include "libslic3r/format.hpp"
@@ -195,6 +196,7 @@ namespace Slic3r {
 // Run post processing script / scripts if defined.
 // Returns true if a post-processing script was executed.
 // Returns false if no post-processing script was defined.
+// The in-process post-processing plugins listed in the "post_process" option are skipped, they run during the G-code export.
 // Throws an exception on error.
 // host is one of "File", "PrusaLink", "Repetier", "SL1Host", "OctoPrint", "FlashAir", "Duet", "AstroBox" ...
 // For a "File" target, a temp file will be created for src_path by adding a ".pp" suffix and src_path will be updated.
@@ -211,6 +213,21 @@ bool run_post_process_scripts(std::string &src_path, bool make_copy, const std::
         post_process->values.empty())
         return false;
 
+    // The in-process plugins were already run while exporting the G-code, see GCodePostProcessPlugins.
+    std::vector<std::string> scripts;
+    for (const std::string &value : post_process->values) {
+        std::vector<std::string> lines;
+        boost::split(lines, value, boost::is_any_of("\r\n"));
+        for (std::string &script : lines) {
+            // Ignore empty post processing script lines.
+            boost::trim(script);
+            if (! script.empty() && ! is_post_process_plugin(script))
+                scripts.emplace_back(std::move(script));
+        }
+    }
+    if (scripts.empty())
+        return false;
+
     std::string path;
     if (make_copy) {
         // Don't run the post-processing script on the input file, it will be memory mapped by the G-code viewer.
@@ -268,33 +285,25 @@ bool run_post_process_scripts(std::string &src_path, bool make_copy, const std::
     remove_output_name_file();
 
     try {
-        for (const std::string &scripts : post_process->values) {
-    		std::vector<std::string> lines;
-    		boost::split(lines, scripts, boost::is_any_of("\r\n"));
-            for (std::string script : lines) {
-                // Ignore empty post processing script lines.
-                boost::trim(script);
-                if (script.empty())
-                    continue;
-                BOOST_LOG_TRIVIAL(info) << "Executing script " << script << " on file " << path;
-                std::string std_err;
-                const int result = run_script(script, gcode_file.string(), std_err);
-                if (result != 0) {
-                    const std::string msg = std_err.empty() ? (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%") % script % path % result).str()
-                        : (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%\nOutput:\n%4%") % script % path % result % std_err).str();
-                    BOOST_LOG_TRIVIAL(error) << msg;
-                    delete_copy();
-                    throw Slic3r::RuntimeError(msg);
-                }
-                if (! boost::filesystem::exists(gcode_file)) {
-                    const std::string msg = (boost::format(_u8L(
-                        "Post-processing script %1% failed.\n\n"
-                        "The post-processing script is expected to change the G-code file %2% in place, but the G-code file was deleted and likely saved under a new name.\n"
-                        "Please adjust the post-processing script to change the G-code in place and consult the manual on how to optionally rename the post-processed G-code file.\n"))
-                        % script % path).str();
-                    BOOST_LOG_TRIVIAL(error) << msg;
-                    throw Slic3r::RuntimeError(msg);
-                }
+        for (const std::string &script : scripts) {
+            BOOST_LOG_TRIVIAL(info) << "Executing script " << script << " on file " << path;
+            std::string std_err;
+            const int result = run_script(script, gcode_file.string(), std_err);
+            if (result != 0) {
+                const std::string msg = std_err.empty() ? (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%") % script % path % result).str()
+                    : (boost::format("Post-processing script %1% on file %2% failed.\nError code: %3%\nOutput:\n%4%") % script % path % result % std_err).str();
+                BOOST_LOG_TRIVIAL(error) << msg;
+                delete_copy();
+                throw Slic3r::RuntimeError(msg);
+            }
+            if (! boost::filesystem::exists(gcode_file)) {
+                const std::string msg = (boost::format(_u8L(
+                    "Post-processing script %1% failed.\n\n"
+                    "The post-processing script is expected to change the G-code file %2% in place, but the G-code file was deleted and likely saved under a new name.\n"
+                    "Please adjust the post-processing script to change the G-code in place and consult the manual on how to optionally rename the post-processed G-code file.\n"))
+                    % script % path).str();
+                BOOST_LOG_TRIVIAL(error) << msg;
+                throw Slic3r::RuntimeError(msg);
             }
         }
         if (boost::filesystem::exists(path_output_name)) {
@@ -15,6 +15,7 @@ namespace Slic3r {
 // Run post processing script / scripts if defined.
 // Returns true if a post-processing script was executed.
 // Returns false if no post-processing script was defined.
+// The in-process post-processing plugins listed in the "post_process" option are skipped, they run during the G-code export.
 // Throws an exception on error.
 // host is one of "File", "PrusaLink", "Repetier", "SL1Host", "OctoPrint", "FlashAir", "Duet", "AstroBox" ...
 // If make_copy, then a temp file will be created for src_path by adding a ".pp" suffix and src_path will be updated.
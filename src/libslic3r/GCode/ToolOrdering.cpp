@@ -21,6 +21,8 @@
 
 #include <boost/log/trivial.hpp>
 
+#include <tbb/parallel_for.h>
+
 #include <libslic3r.h>
 
 namespace Slic3r {
@@ -253,9 +255,12 @@ void ToolOrdering::collect_extruders(
 
     std::vector<std::pair<double, unsigned int>>::const_iterator it_per_layer_color_changes = per_layer_color_changes.begin();
 
-    // Collect the object extruders.
+    // Assign the object layers to LayerTools and apply the extruder overrides and color changes, which are ordered by print_z.
+    std::vector<LayerTools*> layer_tools_per_layer;
+    layer_tools_per_layer.reserve(object.layers().size());
     for (auto layer : object.layers()) {
         LayerTools &layer_tools = this->tools_for_layer(layer->print_z);
+        layer_tools_per_layer.emplace_back(&layer_tools);
 
         // Override extruder with the next 
     	for (; it_per_layer_extruder_override != per_layer_extruder_switches.end() && it_per_layer_extruder_override->first < layer->print_z + EPSILON; ++ it_per_layer_extruder_override)
@@ -272,71 +277,101 @@ void ToolOrdering::collect_extruders(
                 layer_tools.extruders.emplace_back(it_per_layer_color_changes->second);
             }
         }
+    }
 
-        // What extruders are required to print this object layer?
-        for (const LayerRegion *layerm : layer->regions()) {
-            const PrintRegion &region = layerm->region();
+    // What extruders are required to print the object layers? Iterating over all extrusions of an object is expensive,
+    // thus the layers are processed in parallel into a temporary storage. LayerTools are only read here,
+    // as multiple object layers may map to a single LayerTools.
+    struct ObjectLayerExtruders {
+        std::vector<unsigned int> extruders;
+        bool                      has_object { false };
+        bool                      something_overridable { false };
+    };
+    std::vector<ObjectLayerExtruders> object_layer_extruders(object.layers().size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, object.layers().size()),
+        [this, &object, &layer_tools_per_layer, &object_layer_extruders](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+            const Layer          &layer             = *object.layers()[layer_idx];
+            const LayerTools     &layer_tools       = *layer_tools_per_layer[layer_idx];
+            const unsigned int    extruder_override = layer_tools.extruder_override;
+            ObjectLayerExtruders &out               = object_layer_extruders[layer_idx];
+            for (const LayerRegion *layerm : layer.regions()) {
+                const PrintRegion &region = layerm->region();
+
+                if (! layerm->perimeters().empty()) {
+                    bool something_nonoverriddable = true;
+
+                    if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
+                        something_nonoverriddable = false;
+                        for (const ExtrusionEntity *eec : layerm->perimeters()) // let's check if there are nonoverriddable entities
+                            if (is_overriddable(dynamic_cast<const ExtrusionEntityCollection&>(*eec), layer_tools, *m_print_config_ptr, object, region))
+                                out.something_overridable = true;
+                            else
+                                something_nonoverriddable = true;
+                    }
 
-            if (! layerm->perimeters().empty()) {
-                bool something_nonoverriddable = true;
+                    if (something_nonoverriddable)
+                        out.extruders.emplace_back(extruder_override == 0 ? region.config().perimeter_extruder.value : extruder_override);
 
-                if (m_print_config_ptr) { // in this case complete_objects is false (see ToolOrdering constructors)
-                    something_nonoverriddable = false;
-                    for (const ExtrusionEntity *eec : layerm->perimeters()) // let's check if there are nonoverriddable entities
-                        if (is_overriddable(dynamic_cast<const ExtrusionEntityCollection&>(*eec), layer_tools, *m_print_config_ptr, object, region))
-                            layer_tools.wiping_extrusions_nonconst().set_something_overridable();
+                    out.has_object = true;
+                }
+
+                bool has_infill       = false;
+                bool has_solid_infill = false;
+                bool something_nonoverriddable = false;
+                for (const ExtrusionEntity *ee : layerm->fills()) {
+                    // fill represents infill extrusions of a single island.
+                    const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
+                    ExtrusionRole role = fill->entities.empty() ? ExtrusionRole::None : fill->entities.front()->role();
+                    if (role.is_solid_infill())
+                        has_solid_infill = true;
+                    else if (role != ExtrusionRole::None)
+                        has_infill = true;
+
+                    if (m_print_config_ptr) {
+                        if (is_overriddable(*fill, layer_tools, *m_print_config_ptr, object, region))
+                            out.something_overridable = true;
                         else
                             something_nonoverriddable = true;
+                    }
                 }
 
-                if (something_nonoverriddable)
-               		layer_tools.extruders.emplace_back(extruder_override == 0 ? region.config().perimeter_extruder.value : extruder_override);
-
-                layer_tools.has_object = true;
-            }
-
-            bool has_infill       = false;
-            bool has_solid_infill = false;
-            bool something_nonoverriddable = false;
-            for (const ExtrusionEntity *ee : layerm->fills()) {
-                // fill represents infill extrusions of a single island.
-                const auto *fill = dynamic_cast<const ExtrusionEntityCollection*>(ee);
-                ExtrusionRole role = fill->entities.empty() ? ExtrusionRole::None : fill->entities.front()->role();
-                if (role.is_solid_infill())
-                    has_solid_infill = true;
-                else if (role != ExtrusionRole::None)
-                    has_infill = true;
-
-                if (m_print_config_ptr) {
-                    if (is_overriddable(*fill, layer_tools, *m_print_config_ptr, object, region))
-                        layer_tools.wiping_extrusions_nonconst().set_something_overridable();
-                    else
-                        something_nonoverriddable = true;
+                if (something_nonoverriddable || !m_print_config_ptr) {
+                    if (extruder_override == 0) {
+                        if (has_solid_infill)
+                            out.extruders.emplace_back(region.config().solid_infill_extruder);
+                        if (has_infill)
+                            out.extruders.emplace_back(region.config().infill_extruder);
+                    } else if (has_solid_infill || has_infill)
+                        out.extruders.emplace_back(extruder_override);
                 }
+                if (has_solid_infill || has_infill)
+                    out.has_object = true;
             }
-
-            if (something_nonoverriddable || !m_print_config_ptr) {
-            	if (extruder_override == 0) {
-	                if (has_solid_infill)
-	                    layer_tools.extruders.emplace_back(region.config().solid_infill_extruder);
-	                if (has_infill)
-	                    layer_tools.extruders.emplace_back(region.config().infill_extruder);
-            	} else if (has_solid_infill || has_infill)
-            		layer_tools.extruders.emplace_back(extruder_override);
-            }
-            if (has_solid_infill || has_infill)
-                layer_tools.has_object = true;
         }
+    });
+
+    for (size_t layer_idx = 0; layer_idx < object_layer_extruders.size(); ++ layer_idx) {
+        LayerTools                 &layer_tools = *layer_tools_per_layer[layer_idx];
+        const ObjectLayerExtruders &in          = object_layer_extruders[layer_idx];
+        append(layer_tools.extruders, in.extruders);
+        if (in.has_object)
+            layer_tools.has_object = true;
+        if (in.something_overridable)
+            layer_tools.wiping_extrusions_nonconst().set_something_overridable();
     }
 
-    for (auto& layer : m_layer_tools) {
-        // Sort and remove duplicates
-        sort_remove_duplicates(layer.extruders);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_layer_tools.size()), [this](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            LayerTools &layer = m_layer_tools[i];
+            // Sort and remove duplicates
+            sort_remove_duplicates(layer.extruders);
 
-        // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
-        if (layer.extruders.empty() && layer.has_object)
-            layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
-    }
+            // make sure that there are some tools for each object layer (e.g. tall wiping object will result in empty extruders vector)
+            if (layer.extruders.empty() && layer.has_object)
+                layer.extruders.emplace_back(0); // 0="dontcare" extruder - it will be taken care of in reorder_extruders
+        }
+    });
 }
 
 // Reorder extruders to minimize layer changes.
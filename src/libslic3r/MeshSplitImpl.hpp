@@ -9,6 +9,8 @@
 #include "libnest2d/tools/benchmark.h"
 #include "Execution/ExecutionTBB.hpp"
 
+#include <atomic>
+
 namespace Slic3r {
 
 template<class ExPolicy>
@@ -32,69 +34,74 @@ template<> struct ItsWithNeighborsIndex_<indexed_triangle_set> {
     }
 };
 
-// Discover connected patches of facets one by one.
-template<class NeighborIndex>
-struct NeighborVisitor {
-    NeighborVisitor(const indexed_triangle_set &its, const NeighborIndex &neighbor_index) : 
-        its(its), neighbor_index(neighbor_index) {
-        m_visited.assign(its.indices.size(), false);
-        m_facestack.reserve(its.indices.size());
+// Union-find of faces safe to be updated concurrently. Each set is represented by its face with the lowest index,
+// the parent of a face has always a lower index than the face, thus the updates never create a cycle.
+class ConcurrentFaceUnionFind {
+public:
+    ConcurrentFaceUnionFind(size_t num_faces) : m_parent(num_faces) {
+        for (size_t i = 0; i < num_faces; ++ i)
+            m_parent[i].store(int(i), std::memory_order_relaxed);
     }
-    NeighborVisitor(const indexed_triangle_set &its, NeighborIndex &&aneighbor_index) : 
-        its(its), neighbor_index(m_neighbor_index_data), m_neighbor_index_data(std::move(aneighbor_index)) {
-        m_visited.assign(its.indices.size(), false);
-        m_facestack.reserve(its.indices.size());
+
+    int find(int face_idx) {
+        for (;;) {
+            int parent = m_parent[face_idx].load(std::memory_order_relaxed);
+            if (parent == face_idx)
+                return face_idx;
+            int grandparent = m_parent[parent].load(std::memory_order_relaxed);
+            // Path halving. If another thread updated the parent meanwhile, it pointed it to a face with even lower index.
+            if (grandparent != parent)
+                m_parent[face_idx].compare_exchange_weak(parent, grandparent, std::memory_order_relaxed);
+            face_idx = grandparent;
+        }
     }
 
-    template<typename Visitor>
-    void visit(Visitor visitor)
-    {
-        // find the next unvisited facet and push the index
-        auto facet = std::find(m_visited.begin() + m_seed, m_visited.end(), false);
-        m_seed = facet - m_visited.begin();
-
-        if (facet != m_visited.end()) {
-            // Skip this element in the next round.
-            auto idx = m_seed ++;
-            if (! visitor(idx))
+    void unite(int face_a, int face_b) {
+        for (;;) {
+            face_a = this->find(face_a);
+            face_b = this->find(face_b);
+            if (face_a == face_b)
+                return;
+            if (face_a < face_b)
+                std::swap(face_a, face_b);
+            // Attach the root with the higher index. Retry if it stopped being a root meanwhile.
+            if (int expected = face_a; m_parent[face_a].compare_exchange_strong(expected, face_b, std::memory_order_relaxed))
                 return;
-            this->push(idx);
-            m_visited[idx] = true;
-            while (! m_facestack.empty()) {
-                size_t facet_idx = this->pop();
-                for (auto neighbor_idx : neighbor_index[facet_idx]) {
-                    assert(neighbor_idx < int(m_visited.size()));
-                    if (neighbor_idx >= 0 && !m_visited[neighbor_idx]) {
-                        if (! visitor(size_t(neighbor_idx)))
-                            return;
-                        m_visited[neighbor_idx] = true;
-                        this->push(stack_el(neighbor_idx));
-                    }
-                }
-            }
         }
     }
 
-    const indexed_triangle_set  &its;
-    const NeighborIndex         &neighbor_index;
-
 private:
-    // If initialized with &&neighbor_index, take the ownership of the data.
-    const NeighborIndex          m_neighbor_index_data;
-
-    std::vector<char>            m_visited;
-
-    using                        stack_el = size_t;
-    std::vector<stack_el>        m_facestack;
-    void                         push(const stack_el &s) { m_facestack.emplace_back(s); }
-    stack_el                     pop() { stack_el ret = m_facestack.back(); m_facestack.pop_back(); return ret; }
-
-    // Last face visited.
-    size_t                       m_seed { 0 };
+    std::vector<std::atomic<int>> m_parent;
 };
 
 } // namespace meshsplit_detail
 
+// Label connected patches of faces with a parallel union-find over the face neighbors.
+// Patches are numbered in the order of their first face.
+template<class ExPolicy, class NeighborIndex>
+FacePatches its_face_patches(ExPolicy &&ex, const NeighborIndex &neighbor_index, size_t num_faces)
+{
+    meshsplit_detail::ConcurrentFaceUnionFind union_find(num_faces);
+    execution::for_each(ex, size_t(0), num_faces,
+        [&neighbor_index, &union_find](size_t face_idx) {
+            for (auto neighbor_idx : neighbor_index[face_idx])
+                if (int(neighbor_idx) > int(face_idx))
+                    union_find.unite(int(face_idx), int(neighbor_idx));
+        }, execution::max_concurrency(ex));
+
+    FacePatches out;
+    out.face_patch.assign(num_faces, 0);
+    execution::for_each(ex, size_t(0), num_faces,
+        [&out, &union_find](size_t face_idx) { out.face_patch[face_idx] = union_find.find(int(face_idx)); },
+        execution::max_concurrency(ex));
+    // Roots precede the other faces of their patch, number them in a single pass.
+    for (size_t face_idx = 0; face_idx < num_faces; ++ face_idx) {
+        int &patch = out.face_patch[face_idx];
+        patch = patch == int(face_idx) ? int(out.num_patches ++) : out.face_patch[patch];
+    }
+    return out;
+}
+
 // Funky wrapper for timinig of its_split() using various neighbor index creating methods, see sandboxes/its_neighbor_index/main.cpp
 template<class IndexT> struct ItsNeighborsWrapper
 {
@@ -127,58 +134,67 @@ struct SplitOutputFn {
     SplitOutputFn& operator++() { return *this; };
 };
 
-// Splits a mesh into multiple meshes when possible.
-template<class Its, class OutputIt>
-void its_split(const Its &m, OutputIt out_it)
+// Splits a mesh into its patches labeled by its_face_patches(), the patches are built in parallel.
+template<class OutputIt>
+void its_split(const indexed_triangle_set &its, const FacePatches &patches, OutputIt out_it)
 {
-    using namespace meshsplit_detail;
-
-    const indexed_triangle_set &its = ItsWithNeighborsIndex_<Its>::get_its(m);
-
-    struct VertexConv {
-        size_t part_id      = std::numeric_limits<size_t>::max();
-        size_t vertex_image;
-    };
-    std::vector<VertexConv> vidx_conv(its.vertices.size());
-
-    meshsplit_detail::NeighborVisitor visitor(its, meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    
-    std::vector<size_t> facets;
-    for (size_t part_id = 0;; ++part_id) {
-        // Collect all faces of the next patch.
-        facets.clear();
-        visitor.visit([&facets](size_t idx) { facets.emplace_back(idx); return true; });
-        if (facets.empty())
-            break;
-
-        // Create a new mesh for the part that was just split off.
-        indexed_triangle_set mesh;
-        mesh.indices.reserve(facets.size());
-        mesh.vertices.reserve(std::min(facets.size() * 3, its.vertices.size()));
-
-        // Assign the facets to the new mesh.
-        for (size_t face_id : facets) {
-            const auto &face = its.indices[face_id];
-            Vec3i       new_face;
-            for (size_t v = 0; v < 3; ++v) {
-                auto vi = face(v);
-
-                if (vidx_conv[vi].part_id != part_id) {
-                    vidx_conv[vi] = {part_id, mesh.vertices.size()};
-                    mesh.vertices.emplace_back(its.vertices[size_t(vi)]);
-                }
+    assert(patches.face_patch.size() == its.indices.size());
+
+    // Sort the faces by patches.
+    std::vector<size_t> patch_start(patches.num_patches + 1, 0);
+    for (int patch : patches.face_patch)
+        ++ patch_start[patch + 1];
+    for (size_t i = 1; i < patch_start.size(); ++ i)
+        patch_start[i] += patch_start[i - 1];
+    std::vector<size_t> patch_faces(its.indices.size());
+    {
+        std::vector<size_t> patch_end(patch_start.begin(), patch_start.end() - 1);
+        for (size_t face_idx = 0; face_idx < its.indices.size(); ++ face_idx)
+            patch_faces[patch_end[patches.face_patch[face_idx]] ++] = face_idx;
+    }
 
-                new_face(v) = vidx_conv[vi].vertex_image;
+    std::vector<indexed_triangle_set> meshes(patches.num_patches);
+    execution::for_each(ex_tbb, size_t(0), patches.num_patches,
+        [&its, &patch_start, &patch_faces, &meshes](size_t patch) {
+            auto faces_begin = patch_faces.begin() + patch_start[patch];
+            auto faces_end   = patch_faces.begin() + patch_start[patch + 1];
+            // Vertices of the patch, sorted by their index in the source mesh.
+            std::vector<int> vertices;
+            vertices.reserve(3 * (faces_end - faces_begin));
+            for (auto it = faces_begin; it != faces_end; ++ it)
+                for (int i = 0; i < 3; ++ i)
+                    vertices.emplace_back(its.indices[*it](i));
+            sort_remove_duplicates(vertices);
+
+            indexed_triangle_set &mesh = meshes[patch];
+            mesh.vertices.reserve(vertices.size());
+            for (int vertex_idx : vertices)
+                mesh.vertices.emplace_back(its.vertices[vertex_idx]);
+            mesh.indices.reserve(faces_end - faces_begin);
+            for (auto it = faces_begin; it != faces_end; ++ it) {
+                const stl_triangle_vertex_indices &face = its.indices[*it];
+                Vec3i new_face;
+                for (int i = 0; i < 3; ++ i)
+                    new_face(i) = int(std::lower_bound(vertices.begin(), vertices.end(), face(i)) - vertices.begin());
+                mesh.indices.emplace_back(new_face);
             }
+        });
 
-            mesh.indices.emplace_back(new_face);
-        }
-
+    for (indexed_triangle_set &mesh : meshes) {
         *out_it = std::move(mesh);
-        ++out_it;
+        ++ out_it;
     }
 }
 
+// Splits a mesh into multiple meshes when possible.
+template<class Its, class OutputIt>
+void its_split(const Its &m, OutputIt out_it)
+{
+    using namespace meshsplit_detail;
+    const indexed_triangle_set &its = ItsWithNeighborsIndex_<Its>::get_its(m);
+    its_split(its, its_face_patches(ex_tbb, ItsWithNeighborsIndex_<Its>::get_index(m), its.indices.size()), out_it);
+}
+
 template<class Its>
 std::vector<indexed_triangle_set> its_split(const Its &its)
 {
@@ -188,34 +204,17 @@ std::vector<indexed_triangle_set> its_split(const Its &its)
     return ret;
 }
 
-template<class Its> 
-bool its_is_splittable(const Its &m)
+template<class Its>
+size_t its_number_of_patches(const Its &m)
 {
-    meshsplit_detail::NeighborVisitor visitor(meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_its(m), meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    bool has_some = false;
-    bool has_some2 = false;
-    // Traverse the 1st patch fully.
-    visitor.visit([&has_some](size_t idx) { has_some = true; return true; });
-    if (has_some)
-        // Just check whether there is any face of the 2nd patch.
-        visitor.visit([&has_some2](size_t idx) { has_some2 = true; return false; });
-    return has_some && has_some2;
+    using namespace meshsplit_detail;
+    return its_face_patches(ex_tbb, ItsWithNeighborsIndex_<Its>::get_index(m), ItsWithNeighborsIndex_<Its>::get_its(m).indices.size()).num_patches;
 }
 
-template<class Its>
-size_t its_number_of_patches(const Its &m)
+template<class Its> 
+bool its_is_splittable(const Its &m)
 {
-    meshsplit_detail::NeighborVisitor visitor(meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_its(m), meshsplit_detail::ItsWithNeighborsIndex_<Its>::get_index(m));
-    size_t num_patches = 0;
-    for (;;) {
-        bool has_some = false;
-        // Traverse the 1st patch fully.
-        visitor.visit([&has_some](size_t idx) { has_some = true; return true; });
-        if (! has_some)
-            break;
-        ++ num_patches;
-    }
-    return num_patches;
+    return its_number_of_patches(m) > 1;
 }
 
 template<class ExPolicy>
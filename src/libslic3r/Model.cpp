@@ -1080,7 +1080,7 @@ BoundingBoxf3 ModelObject::instance_bounding_box(size_t instance_idx, bool dont_
 }
 
 // Calculate 2D convex hull of of a projection of the transformed printable volumes into the XY plane.
-// This method is cheap in that it does not make any unnecessary copy of the volume meshes.
+// This method is cheap in that it works on the convex hulls of the volumes, which are cached.
 // This method is used by the auto arrange function.
 Polygon ModelObject::convex_hull_2d(const Transform3d& trafo_instance) const
 {
@@ -1090,7 +1090,7 @@ Polygon ModelObject::convex_hull_2d(const Transform3d& trafo_instance) const
         for (size_t i = range.begin(); i < range.end(); ++i) {
             const ModelVolume* v = volumes[i];
             if (v->is_model_part())
-                chs.emplace_back(its_convex_hull_2d_above(v->mesh().its, (trafo_instance * v->get_matrix()).cast<float>(), 0.0f));
+                chs.emplace_back(v->convex_hull_2d(trafo_instance * v->get_matrix()));
         }
     });
 
@@ -1583,8 +1583,15 @@ unsigned int ModelObject::update_instances_print_volume_state(const BuildVolume
         unsigned int inside_outside = 0;
         for (const ModelVolume* vol : this->volumes)
             if (vol->is_model_part()) {
-                const Transform3d matrix = model_instance->get_matrix() * vol->get_matrix();
-                BuildVolume::ObjectState state = build_volume.object_state(vol->mesh().its, matrix.cast<float>(), true /* may be below print bed */);
+                const Transform3f matrix = (model_instance->get_matrix() * vol->get_matrix()).cast<float>();
+                // The mesh lies inside its own convex hull, thus the volume is inside if its convex hull is inside and it is below the bed
+                // if its convex hull is. BuildVolume::object_state() tests a box, a cylinder or the convex hull of a custom bed, into which
+                // the convex hull of the volume fits if its vertices do. Otherwise the state is decided on the full mesh,
+                // a non-convex volume may not collide even if its convex hull does.
+                BuildVolume::ObjectState state = vol->get_convex_hull_shared_ptr() ?
+                    build_volume.object_state(vol->get_convex_hull().its, matrix, true /* may be below print bed */) : BuildVolume::ObjectState::Colliding;
+                if (state != BuildVolume::ObjectState::Inside && state != BuildVolume::ObjectState::Below)
+                    state = build_volume.object_state(vol->mesh().its, matrix, true /* may be below print bed */);
                 if (state == BuildVolume::ObjectState::Inside)
                     // Volume is completely inside.
                     inside_outside |= INSIDE;
@@ -1755,9 +1762,9 @@ int ModelVolume::extruder_id() const
 
 bool ModelVolume::is_splittable() const
 {
-    // the call mesh.is_splittable() is expensive, so cache the value to calculate it only once
+    // the face patches are cached by the mesh, they are reused by split()
     if (m_is_splittable == -1)
-        m_is_splittable = its_is_splittable(this->mesh().its);
+        m_is_splittable = this->mesh().is_splittable();
 
     return m_is_splittable == 1;
 }
@@ -1771,6 +1778,7 @@ void ModelVolume::center_geometry_after_creation(bool update_source_offset)
         	const_cast<TriangleMesh*>(m_mesh.get())->translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
         if (m_convex_hull)
 			const_cast<TriangleMesh*>(m_convex_hull.get())->translate(-(float)shift(0), -(float)shift(1), -(float)shift(2));
+        m_convex_hull_2d_cache.convex_hull.reset();
         translate(shift);
     }
 
@@ -1797,6 +1805,43 @@ const TriangleMesh& ModelVolume::get_convex_hull() const
     return *m_convex_hull.get();
 }
 
+Polygon ModelVolume::convex_hull_2d(const Transform3d &trafo) const
+{
+    if (! m_convex_hull || m_convex_hull->empty())
+        return its_convex_hull_2d_above(this->mesh().its, trafo.cast<float>(), 0.0f);
+
+    // The XY offset only translates the hull.
+    Transform3d trafo_no_offset = trafo;
+    trafo_no_offset.translation().head<2>() = Vec2d::Zero();
+
+    Polygon hull;
+    bool    cached = false;
+    {
+        std::lock_guard<std::mutex> lock(m_convex_hull_2d_cache.mutex);
+        if (m_convex_hull_2d_cache.convex_hull == m_convex_hull && m_convex_hull_2d_cache.trafo.matrix() == trafo_no_offset.matrix()) {
+            hull   = m_convex_hull_2d_cache.hull;
+            cached = true;
+        }
+    }
+
+    if (! cached) {
+        const Transform3f trafof = trafo_no_offset.cast<float>();
+        // Above the bed, the projection of the convex hull is the projection of the mesh. Below the bed, the convex hull clipped
+        // by the bed may be larger than the hull of the clipped mesh, thus the mesh is clipped.
+        const bool below_bed = std::any_of(m_convex_hull->its.vertices.begin(), m_convex_hull->its.vertices.end(),
+            [&trafof](const stl_vertex &v) { return (trafof * v).z() < 0.f; });
+        hull = its_convex_hull_2d_above(below_bed ? this->mesh().its : m_convex_hull->its, trafof, 0.0f);
+
+        std::lock_guard<std::mutex> lock(m_convex_hull_2d_cache.mutex);
+        m_convex_hull_2d_cache.convex_hull = m_convex_hull;
+        m_convex_hull_2d_cache.trafo       = trafo_no_offset;
+        m_convex_hull_2d_cache.hull        = hull;
+    }
+
+    hull.translate(Point::new_scale(trafo.translation().x(), trafo.translation().y()));
+    return hull;
+}
+
 ModelVolumeType ModelVolume::type_from_string(const std::string &s)
 {
     // Legacy support
@@ -1960,6 +2005,7 @@ void ModelVolume::scale_geometry_after_creation(const Vec3f& versor)
 {
 	const_cast<TriangleMesh*>(m_mesh.get())->scale(versor);
 	const_cast<TriangleMesh*>(m_convex_hull.get())->scale(versor);
+    m_convex_hull_2d_cache.convex_hull.reset();
 }
 
 void ModelVolume::transform_this_mesh(const Transform3d &mesh_trafo, bool fix_left_handed)
@@ -2041,20 +2087,77 @@ void ModelInstance::transform_polygon(Polygon* polygon) const
     polygon->scale(get_scaling_factor(X), get_scaling_factor(Y)); // scale around polygon origin
 }
 
+// TriangleSelector deserialized from the splitting data of a FacetsAnnotation of a given timestamp over a given mesh,
+// with the facets of the states requested so far.
+struct FacetsAnnotation::ResolvedFacets
+{
+    ResolvedFacets(std::shared_ptr<const TriangleMesh> mesh, Timestamp timestamp, const TriangleSelector::TriangleSplittingData &data) :
+        mesh(std::move(mesh)), timestamp(timestamp), selector(*this->mesh)
+    {
+        // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
+        selector.deserialize(data, false);
+    }
+
+    std::shared_ptr<const indexed_triangle_set> facets(TriangleStateType type, bool strict)
+    {
+        const std::pair<TriangleStateType, bool> key(type, strict);
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (auto it = facets_by_type.find(key); it != facets_by_type.end())
+                return it->second;
+        }
+        // Concurrent requests of the same facets are resolved in parallel, the first one is kept.
+        auto out = std::make_shared<const indexed_triangle_set>(strict ? selector.get_facets_strict(type) : selector.get_facets(type));
+        std::lock_guard<std::mutex> lock(mutex);
+        return facets_by_type.emplace(key, std::move(out)).first->second;
+    }
+
+    // Keeps the mesh referenced by the selector alive, also identifies the mesh of the ModelVolume the cache is valid for.
+    const std::shared_ptr<const TriangleMesh>                                                   mesh;
+    const Timestamp                                                                             timestamp;
+    TriangleSelector                                                                            selector;
+    std::mutex                                                                                  mutex;
+    std::map<std::pair<TriangleStateType, bool>, std::shared_ptr<const indexed_triangle_set>>   facets_by_type;
+};
+
+std::shared_ptr<FacetsAnnotation::ResolvedFacets> FacetsAnnotation::resolve(const ModelVolume& mv) const
+{
+    const std::shared_ptr<const TriangleMesh> &mesh = mv.get_mesh_shared_ptr();
+    if (! m_resolved_cache)
+        // Moved from.
+        return std::make_shared<ResolvedFacets>(mesh, this->timestamp(), m_data);
+    std::lock_guard<std::mutex> lock(m_resolved_cache->mutex);
+    if (std::shared_ptr<ResolvedFacets> &resolved = m_resolved_cache->resolved; ! resolved || resolved->timestamp != this->timestamp() || resolved->mesh != mesh)
+        resolved = std::make_shared<ResolvedFacets>(mesh, this->timestamp(), m_data);
+    return m_resolved_cache->resolved;
+}
+
 indexed_triangle_set FacetsAnnotation::get_facets(const ModelVolume& mv, TriangleStateType type) const
 {
-    TriangleSelector selector(mv.mesh());
-    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
-    selector.deserialize(m_data, false);
-    return selector.get_facets(type);
+    if (this->empty() && type != TriangleStateType::NONE)
+        // Not painted, don't resolve and cache anything.
+        return {};
+    return *this->resolve(mv)->facets(type, false);
+}
+
+std::shared_ptr<const indexed_triangle_set> FacetsAnnotation::get_facets_shared(const ModelVolume& mv, TriangleStateType type) const
+{
+    if (this->empty() && type != TriangleStateType::NONE)
+        return std::make_shared<const indexed_triangle_set>();
+    return this->resolve(mv)->facets(type, false);
 }
 
 indexed_triangle_set FacetsAnnotation::get_facets_strict(const ModelVolume& mv, TriangleStateType type) const
 {
-    TriangleSelector selector(mv.mesh());
-    // Reset of TriangleSelector is done inside TriangleSelector's constructor, so we don't need it to perform it again in deserialize().
-    selector.deserialize(m_data, false);
-    return selector.get_facets_strict(type);
+    if (this->empty() && type != TriangleStateType::NONE)
+        return {};
+    return *this->resolve(mv)->facets(type, true);
+}
+
+void FacetsAnnotation::copy_to_selector(const ModelVolume& mv, TriangleSelector& selector) const
+{
+    if (! this->empty())
+        selector.copy_state(this->resolve(mv)->selector);
 }
 
 bool FacetsAnnotation::has_facets(const ModelVolume& mv, TriangleStateType type) const
@@ -2067,6 +2170,7 @@ bool FacetsAnnotation::set(const TriangleSelector& selector)
     TriangleSelector::TriangleSplittingData sel_map = selector.serialize();
     if (sel_map != m_data) {
         m_data = std::move(sel_map);
+        this->invalidate_resolved();
         this->touch();
         return true;
     }
@@ -2077,6 +2181,7 @@ void FacetsAnnotation::reset()
 {
     m_data.triangles_to_split.clear();
     m_data.bitstream.clear();
+    this->invalidate_resolved();
     this->touch();
 }
 
@@ -2113,6 +2218,8 @@ void FacetsAnnotation::set_triangle_from_string(int triangle_id, const std::stri
 {
     assert(! str.empty());
     assert(m_data.triangles_to_split.empty() || m_data.triangles_to_split.back().triangle_idx < triangle_id);
+    if (m_data.triangles_to_split.empty())
+        this->invalidate_resolved();
     m_data.triangles_to_split.emplace_back(triangle_id, int(m_data.bitstream.size()));
 
     const size_t bitstream_start_idx = m_data.bitstream.size();
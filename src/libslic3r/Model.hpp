@@ -31,6 +31,7 @@
 
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <utility>
 #include <vector>
@@ -664,12 +665,19 @@ enum class ConversionType : int {
 class FacetsAnnotation final : public ObjectWithTimestamp {
 public:
     // Assign the content if the timestamp differs, don't assign an ObjectID.
-    void assign(const FacetsAnnotation &rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; this->copy_timestamp(rhs); } }
-    void assign(FacetsAnnotation &&rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); this->copy_timestamp(rhs); } }
+    void assign(const FacetsAnnotation &rhs) { if (! this->timestamp_matches(rhs)) { m_data = rhs.m_data; m_resolved_cache = rhs.m_resolved_cache; this->copy_timestamp(rhs); } }
+    void assign(FacetsAnnotation &&rhs) { if (! this->timestamp_matches(rhs)) { m_data = std::move(rhs.m_data); m_resolved_cache = rhs.m_resolved_cache; this->copy_timestamp(rhs); } }
     const TriangleSelector::TriangleSplittingData &get_data() const noexcept { return m_data; }
     bool set(const TriangleSelector& selector);
+    // The facets are resolved from the splitting data by a TriangleSelector, which is cached together with the facets
+    // until the data or the mesh of mv changes. The cache is shared by the copies of this FacetsAnnotation,
+    // thus by the painting gizmos, the Model of the background processing and the Print steps using the paint.
     indexed_triangle_set get_facets(const ModelVolume& mv, TriangleStateType type) const;
     indexed_triangle_set get_facets_strict(const ModelVolume& mv, TriangleStateType type) const;
+    // Same as get_facets(), returns the cached facets without copying them.
+    std::shared_ptr<const indexed_triangle_set> get_facets_shared(const ModelVolume& mv, TriangleStateType type) const;
+    // Loads the splitting data into selector, which has to be a newly created selector over the mesh of mv.
+    void copy_to_selector(const ModelVolume& mv, TriangleSelector& selector) const;
     bool has_facets(const ModelVolume& mv, TriangleStateType type) const;
     bool empty() const { return m_data.triangles_to_split.empty(); }
 
@@ -708,7 +716,18 @@ private:
 
     template<class Archive> void serialize(Archive &ar) { ar(cereal::base_class<ObjectWithTimestamp>(this), m_data); }
 
+    struct ResolvedFacets;
+    struct ResolvedFacetsCache {
+        // Held while deserializing the selector, so that concurrent requests deserialize it just once.
+        std::mutex                      mutex;
+        std::shared_ptr<ResolvedFacets> resolved;
+    };
+    std::shared_ptr<ResolvedFacets> resolve(const ModelVolume &mv) const;
+    // Detaches from the cache shared with the copies, to be called when m_data is modified.
+    void                            invalidate_resolved() { m_resolved_cache = std::make_shared<ResolvedFacetsCache>(); }
+
     TriangleSelector::TriangleSplittingData m_data;
+    std::shared_ptr<ResolvedFacetsCache>    m_resolved_cache { std::make_shared<ResolvedFacetsCache>() };
 
     // To access set_new_unique_id() when copy / pasting a ModelVolume.
     friend class ModelVolume;
@@ -856,6 +875,9 @@ public:
     void                calculate_convex_hull();
     const TriangleMesh& get_convex_hull() const;
     const std::shared_ptr<const TriangleMesh>& get_convex_hull_shared_ptr() const { return m_convex_hull; }
+    // 2D convex hull of the projection into the XY plane of the part of this volume transformed by trafo, which is above z = 0.
+    // Calculated from the 3D convex hull, the result is cached for the last trafo with the XY offset ignored.
+    Polygon             convex_hull_2d(const Transform3d &trafo) const;
     // Get count of errors in the mesh
     int                 get_repaired_errors_count() const;
 
@@ -942,6 +964,21 @@ private:
     t_model_material_id             	m_material_id;
     // The convex hull of this model's mesh.
     std::shared_ptr<const TriangleMesh> m_convex_hull;
+    // Cache of convex_hull_2d(), which is mostly called for instances differing by their XY offset only
+    // (arrange, sequential print clearance). Not copied with the volume.
+    struct ConvexHull2DCache {
+        ConvexHull2DCache() = default;
+        ConvexHull2DCache(const ConvexHull2DCache &) {}
+        ConvexHull2DCache& operator=(const ConvexHull2DCache &) { return *this; }
+
+        std::mutex                          mutex;
+        // The 3D convex hull the 2D hull was calculated from, null if the cache is empty.
+        std::shared_ptr<const TriangleMesh> convex_hull;
+        // Transformation with zero XY offset and the 2D hull calculated with it.
+        Transform3d                         trafo;
+        Polygon                             hull;
+    };
+    mutable ConvexHull2DCache           m_convex_hull_2d_cache;
     Geometry::Transformation        	m_transformation;
 
     // flag to optimize the checking if the volume is splittable
@@ -13,12 +13,11 @@
 #include "format.hpp"
 
 #include <utility>
+#include <numeric>
 #include <unordered_set>
 
 #include <boost/log/trivial.hpp>
 #include <tbb/parallel_for.h>
-#include <mutex>
-#include <boost/thread/lock_guard.hpp>
 
 //#define MM_SEGMENTATION_DEBUG_GRAPH
 //#define MM_SEGMENTATION_DEBUG_REGIONS
@@ -70,7 +69,7 @@ struct PaintedLine
 
 struct PaintedLineVisitor
 {
-    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, std::mutex &painted_lines_mutex, size_t reserve) : grid(grid), painted_lines(painted_lines), painted_lines_mutex(painted_lines_mutex)
+    PaintedLineVisitor(const EdgeGrid::Grid &grid, std::vector<PaintedLine> &painted_lines, size_t reserve) : grid(grid), painted_lines(painted_lines)
     {
         painted_lines_set.reserve(reserve);
     }
@@ -112,10 +111,7 @@ struct PaintedLineVisitor
                             line_to_test_projected.reverse();
 
                         painted_lines_set.insert(*it_contour_and_segment);
-                        {
-                            boost::lock_guard<std::mutex> lock(painted_lines_mutex);
-                            painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
-                        }
+                        painted_lines.push_back({it_contour_and_segment->first, it_contour_and_segment->second, line_to_test_projected, this->color});
                     }
                 }
             }
@@ -126,7 +122,6 @@ struct PaintedLineVisitor
 
     const EdgeGrid::Grid                                                                 &grid;
     std::vector<PaintedLine>                                                             &painted_lines;
-    std::mutex                                                                           &painted_lines_mutex;
     Line                                                                                  line_to_test;
     std::unordered_set<std::pair<size_t, size_t>, boost::hash<std::pair<size_t, size_t>>> painted_lines_set;
     int                                                                                   color             = -1;
@@ -1210,6 +1205,198 @@ static void export_colorized_polygons_to_svg(const std::string &path, const std:
 }
 #endif // MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS
 
+// Painted facet of a model volume in the coordinates of the PrintObject, with its vertices sorted by z.
+struct PaintedFacet
+{
+    std::array<Vec3f, 3> vertices;
+    int                  color;
+    // Range of layers [first_layer_idx, end_layer_idx) the facet spans.
+    uint32_t             first_layer_idx;
+    uint32_t             end_layer_idx;
+};
+
+static std::vector<PaintedFacet> collect_painted_facets(const PrintObject &print_object, const size_t num_extruders, const std::function<void()> &throw_on_cancel_callback)
+{
+    const SpanOfConstPtrs<Layer>           layers = print_object.layers();
+    std::vector<std::vector<PaintedFacet>> painted_facets_by_extruder(num_extruders + 1);
+    for (const ModelVolume *mv : print_object.model_object()->volumes) {
+        if (!mv->is_model_part())
+            continue;
+
+        const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
+        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &tr, &layers, &painted_facets_by_extruder, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+            for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
+                throw_on_cancel_callback();
+                const indexed_triangle_set custom_facets = mv->mm_segmentation_facets.get_facets(*mv, TriangleStateType(extruder_idx));
+                if (custom_facets.indices.empty())
+                    continue;
+
+                std::vector<PaintedFacet> &painted_facets = painted_facets_by_extruder[extruder_idx];
+                const size_t               first_facet    = painted_facets.size();
+                painted_facets.resize(first_facet + custom_facets.indices.size());
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &layers, &painted_facets, first_facet, extruder_idx](const tbb::blocked_range<size_t> &range) {
+                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
+                        PaintedFacet &facet = painted_facets[first_facet + facet_idx];
+                        for (int p_idx = 0; p_idx < 3; ++p_idx)
+                            facet.vertices[p_idx] = tr * custom_facets.vertices[custom_facets.indices[facet_idx](p_idx)];
+                        facet.color = int(extruder_idx);
+
+                        // Sort the vertices by z-axis for simplification of projected_facet on slices
+                        std::sort(facet.vertices.begin(), facet.vertices.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
+
+                        // Find lowest slice not below the triangle and the first slice above the triangle.
+                        auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(facet.vertices.front().z() - EPSILON),
+                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
+                        auto end_layer   = std::upper_bound(layers.begin(), layers.end(), float(facet.vertices.back().z() + EPSILON),
+                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
+                        facet.first_layer_idx = uint32_t(first_layer - layers.begin());
+                        facet.end_layer_idx   = uint32_t(end_layer - layers.begin());
+                    }
+                }); // end of parallel_for
+
+                // Drop the facets between two slices.
+                painted_facets.erase(std::remove_if(painted_facets.begin() + first_facet, painted_facets.end(),
+                                                    [](const PaintedFacet &facet) { return facet.first_layer_idx >= facet.end_layer_idx; }),
+                                     painted_facets.end());
+            }
+        }); // end of parallel_for
+    }
+
+    size_t num_painted_facets = 0;
+    for (const std::vector<PaintedFacet> &painted_facets_extruder : painted_facets_by_extruder)
+        num_painted_facets += painted_facets_extruder.size();
+    std::vector<PaintedFacet> painted_facets;
+    painted_facets.reserve(num_painted_facets);
+    for (std::vector<PaintedFacet> &painted_facets_extruder : painted_facets_by_extruder)
+        Slic3r::append(painted_facets, std::move(painted_facets_extruder));
+    return painted_facets;
+}
+
+// Projects the painted facets onto the slices of the layers they intersect.
+// The layers are split into blocks of consecutive layers, each block is swept bottom-up by a single thread, maintaining the set
+// of facets crossing the current layer. Thus every layer is filled by a single thread and no locking is needed.
+static std::vector<std::vector<PaintedLine>> project_painted_facets(const PrintObject                  &print_object,
+                                                                    const std::vector<PaintedFacet>    &painted_facets,
+                                                                    const std::vector<EdgeGrid::Grid>  &edge_grids,
+                                                                    const std::vector<ExPolygons>      &input_expolygons,
+                                                                    const std::function<void()>        &throw_on_cancel_callback)
+{
+    const SpanOfConstPtrs<Layer>          layers     = print_object.layers();
+    const size_t                          num_layers = layers.size();
+    std::vector<std::vector<PaintedLine>> painted_lines(num_layers);
+    if (painted_facets.empty())
+        return painted_lines;
+
+    // A facet spanning several blocks is assigned to all of them, thus the blocks should not be too short.
+    const size_t layers_per_block = std::clamp<size_t>(num_layers / 64, 1, 16);
+    const size_t num_blocks       = (num_layers + layers_per_block - 1) / layers_per_block;
+    auto         first_block_idx  = [layers_per_block](const PaintedFacet &facet) { return size_t(facet.first_layer_idx) / layers_per_block; };
+    auto         last_block_idx   = [layers_per_block](const PaintedFacet &facet) { return size_t(facet.end_layer_idx - 1) / layers_per_block; };
+
+    // Indices of painted facets of each block of layers.
+    std::vector<size_t> block_offsets(num_blocks + 1, 0);
+    for (const PaintedFacet &facet : painted_facets)
+        for (size_t block_idx = first_block_idx(facet); block_idx <= last_block_idx(facet); ++block_idx)
+            ++block_offsets[block_idx + 1];
+    std::partial_sum(block_offsets.begin(), block_offsets.end(), block_offsets.begin());
+
+    assert(painted_facets.size() < size_t(std::numeric_limits<uint32_t>::max()));
+    std::vector<uint32_t> block_facets(block_offsets.back());
+    {
+        std::vector<size_t> block_ends(block_offsets.begin(), block_offsets.end() - 1);
+        for (const PaintedFacet &facet : painted_facets)
+            for (size_t block_idx = first_block_idx(facet); block_idx <= last_block_idx(facet); ++block_idx)
+                block_facets[block_ends[block_idx]++] = uint32_t(&facet - painted_facets.data());
+    }
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_blocks), [&print_object, &layers, &num_layers, &painted_facets, &edge_grids, &input_expolygons, &painted_lines,
+                                                                  &layers_per_block, &block_offsets, &block_facets, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        // Facets crossing the current layer.
+        std::vector<uint32_t> active_facets;
+        for (size_t block_idx = range.begin(); block_idx < range.end(); ++block_idx) {
+            const size_t block_begin  = block_idx * layers_per_block;
+            const size_t block_end    = std::min(block_begin + layers_per_block, num_layers);
+            const auto   facets_begin = block_facets.begin() + block_offsets[block_idx];
+            const auto   facets_end   = block_facets.begin() + block_offsets[block_idx + 1];
+            // Sort the facets of the block by the first layer they span. Facets coming from the blocks below are sorted first.
+            std::sort(facets_begin, facets_end, [&painted_facets](const uint32_t lhs, const uint32_t rhs) {
+                return painted_facets[lhs].first_layer_idx < painted_facets[rhs].first_layer_idx ||
+                       (painted_facets[lhs].first_layer_idx == painted_facets[rhs].first_layer_idx && lhs < rhs);
+            });
+
+            active_facets.clear();
+            auto it_next_facet = facets_begin;
+            for (size_t layer_idx = block_begin; layer_idx < block_end; ++layer_idx) {
+                throw_on_cancel_callback();
+                // Retire the facets below this layer and activate the facets starting at this layer.
+                active_facets.erase(std::remove_if(active_facets.begin(), active_facets.end(),
+                                                   [&painted_facets, layer_idx](const uint32_t facet_idx) { return painted_facets[facet_idx].end_layer_idx <= layer_idx; }),
+                                    active_facets.end());
+                for (; it_next_facet != facets_end && painted_facets[*it_next_facet].first_layer_idx <= layer_idx; ++it_next_facet)
+                    active_facets.emplace_back(*it_next_facet);
+
+                if (active_facets.empty() || input_expolygons[layer_idx].empty())
+                    continue;
+
+                const float           slice_z   = float(layers[layer_idx]->slice_z);
+                const EdgeGrid::Grid &edge_grid = edge_grids[layer_idx];
+                PaintedLineVisitor    visitor(edge_grid, painted_lines[layer_idx], 16);
+                for (const uint32_t facet_idx : active_facets) {
+                    const PaintedFacet         &painted_facet = painted_facets[facet_idx];
+                    const std::array<Vec3f, 3> &facet         = painted_facet.vertices;
+                    if (facet[0].z() > slice_z || slice_z > facet[2].z())
+                        continue;
+
+                    // https://kandepet.com/3d-printing-slicing-3d-objects/
+                    float t            = (slice_z - facet[0].z()) / (facet[2].z() - facet[0].z());
+                    Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
+                    Vec3f line_end_f;
+
+                    if (facet[1].z() > slice_z) {
+                        // [P0, P2] and [P0, P1]
+                        float t1   = (slice_z - facet[0].z()) / (facet[1].z() - facet[0].z());
+                        line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
+                    } else {
+                        // [P0, P2] and [P1, P2]
+                        float t2   = (slice_z - facet[1].z()) / (facet[2].z() - facet[1].z());
+                        line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
+                    }
+
+                    Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
+                                      Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
+                    line_to_test.translate(-print_object.center_offset());
+
+                    // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
+                    // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
+                    // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
+                    // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
+                    if (const BoundingBox &edge_grid_bbox = edge_grid.bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
+                        // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
+                        if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
+                            !line_to_test.clip_with_bbox(edge_grid_bbox))
+                            continue;
+                    }
+
+                    visitor.reset();
+                    visitor.line_to_test = line_to_test;
+                    visitor.color        = painted_facet.color;
+                    edge_grid.visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
+                }
+            }
+        }
+    }); // end of parallel_for
+
+    return painted_lines;
+}
+
+static bool are_colored_polygons_equal(const std::vector<ColoredLines> &lhs, const std::vector<ColoredLines> &rhs)
+{
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(), [](const ColoredLines &lhs_lines, const ColoredLines &rhs_lines) {
+        return std::equal(lhs_lines.begin(), lhs_lines.end(), rhs_lines.begin(), rhs_lines.end(),
+                          [](const ColoredLine &lhs_line, const ColoredLine &rhs_line) { return lhs_line.line == rhs_line.line && lhs_line.color == rhs_line.color; });
+    });
+}
+
 // Check if all ColoredLine representing a single layer uses the same color.
 static bool has_layer_only_one_color(const std::vector<ColoredLines> &colored_polygons)
 {
@@ -1224,14 +1411,13 @@ static bool has_layer_only_one_color(const std::vector<ColoredLines> &colored_po
     return true;
 }
 
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback)
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback,
+                                                                             bool reuse_identical_layers)
 {
     const size_t                          num_extruders = print_object.print()->config().nozzle_diameter.size();
     const size_t                          num_layers    = print_object.layers().size();
     std::vector<std::vector<ExPolygons>>  segmented_regions(num_layers);
     segmented_regions.assign(num_layers, std::vector<ExPolygons>(num_extruders + 1));
-    std::vector<std::vector<PaintedLine>> painted_lines(num_layers);
-    std::array<std::mutex, 64>            painted_lines_mutex;
     std::vector<EdgeGrid::Grid>           edge_grids(num_layers);
     const SpanOfConstPtrs<Layer>          layers = print_object.layers();
     std::vector<ExPolygons>               input_expolygons(num_layers);
@@ -1294,92 +1480,19 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
     }
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - projection of painted triangles - begin";
-    for (const ModelVolume *mv : print_object.model_object()->volumes) {
-        tbb::parallel_for(tbb::blocked_range<size_t>(1, num_extruders + 1), [&mv, &print_object, &layers, &edge_grids, &painted_lines, &painted_lines_mutex, &input_expolygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
-            for (size_t extruder_idx = range.begin(); extruder_idx < range.end(); ++extruder_idx) {
-                throw_on_cancel_callback();
-                const indexed_triangle_set custom_facets = mv->mm_segmentation_facets.get_facets(*mv, TriangleStateType(extruder_idx));
-                if (!mv->is_model_part() || custom_facets.indices.empty())
-                    continue;
-
-                const Transform3f tr = print_object.trafo().cast<float>() * mv->get_matrix().cast<float>();
-                tbb::parallel_for(tbb::blocked_range<size_t>(0, custom_facets.indices.size()), [&tr, &custom_facets, &print_object, &layers, &edge_grids, &input_expolygons, &painted_lines, &painted_lines_mutex, &extruder_idx](const tbb::blocked_range<size_t> &range) {
-                    for (size_t facet_idx = range.begin(); facet_idx < range.end(); ++facet_idx) {
-                        float min_z = std::numeric_limits<float>::max();
-                        float max_z = std::numeric_limits<float>::lowest();
-
-                        std::array<Vec3f, 3> facet;
-                        for (int p_idx = 0; p_idx < 3; ++p_idx) {
-                            facet[p_idx] = tr * custom_facets.vertices[custom_facets.indices[facet_idx](p_idx)];
-                            max_z        = std::max(max_z, facet[p_idx].z());
-                            min_z        = std::min(min_z, facet[p_idx].z());
-                        }
-
-                        // Sort the vertices by z-axis for simplification of projected_facet on slices
-                        std::sort(facet.begin(), facet.end(), [](const Vec3f &p1, const Vec3f &p2) { return p1.z() < p2.z(); });
-
-                        // Find lowest slice not below the triangle.
-                        auto first_layer = std::upper_bound(layers.begin(), layers.end(), float(min_z - EPSILON),
-                                                            [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        auto last_layer  = std::upper_bound(layers.begin(), layers.end(), float(max_z + EPSILON),
-                                                           [](float z, const Layer *l1) { return z < l1->slice_z; });
-                        --last_layer;
-
-                        for (auto layer_it = first_layer; layer_it != (last_layer + 1); ++layer_it) {
-                            const Layer *layer     = *layer_it;
-                            size_t       layer_idx = layer_it - layers.begin();
-                            if (input_expolygons[layer_idx].empty() || facet[0].z() > layer->slice_z || layer->slice_z > facet[2].z())
-                                continue;
-
-                            // https://kandepet.com/3d-printing-slicing-3d-objects/
-                            float t            = (float(layer->slice_z) - facet[0].z()) / (facet[2].z() - facet[0].z());
-                            Vec3f line_start_f = facet[0] + t * (facet[2] - facet[0]);
-                            Vec3f line_end_f;
-
-                            if (facet[1].z() > layer->slice_z) {
-                                // [P0, P2] and [P0, P1]
-                                float t1   = (float(layer->slice_z) - facet[0].z()) / (facet[1].z() - facet[0].z());
-                                line_end_f = facet[0] + t1 * (facet[1] - facet[0]);
-                            } else {
-                                // [P0, P2] and [P1, P2]
-                                float t2   = (float(layer->slice_z) - facet[1].z()) / (facet[2].z() - facet[1].z());
-                                line_end_f = facet[1] + t2 * (facet[2] - facet[1]);
-                            }
-
-                            Line line_to_test(Point(scale_(line_start_f.x()), scale_(line_start_f.y())),
-                                              Point(scale_(line_end_f.x()), scale_(line_end_f.y())));
-                            line_to_test.translate(-print_object.center_offset());
-
-                            // BoundingBoxes for EdgeGrids are computed from printable regions. It is possible that the painted line (line_to_test) could
-                            // be outside EdgeGrid's BoundingBox, for example, when the negative volume is used on the painted area (GH #7618).
-                            // To ensure that the painted line is always inside EdgeGrid's BoundingBox, it is clipped by EdgeGrid's BoundingBox in cases
-                            // when any of the endpoints of the line are outside the EdgeGrid's BoundingBox.
-                            if (const BoundingBox &edge_grid_bbox = edge_grids[layer_idx].bbox(); !edge_grid_bbox.contains(line_to_test.a) || !edge_grid_bbox.contains(line_to_test.b)) {
-                                // If the painted line (line_to_test) is entirely outside EdgeGrid's BoundingBox, skip this painted line.
-                                if (!edge_grid_bbox.overlap(BoundingBox(Points{line_to_test.a, line_to_test.b})) ||
-                                    !line_to_test.clip_with_bbox(edge_grid_bbox))
-                                    continue;
-                            }
-
-                            size_t mutex_idx = layer_idx & 0x3F;
-                            assert(mutex_idx < painted_lines_mutex.size());
-
-                            PaintedLineVisitor visitor(edge_grids[layer_idx], painted_lines[layer_idx], painted_lines_mutex[mutex_idx], 16);
-                            visitor.line_to_test = line_to_test;
-                            visitor.color        = int(extruder_idx);
-                            edge_grids[layer_idx].visit_cells_intersecting_line(line_to_test.a, line_to_test.b, visitor);
-                        }
-                    }
-                }); // end of parallel_for
-            }
-        }); // end of parallel_for
+    std::vector<std::vector<PaintedLine>> painted_lines;
+    {
+        const std::vector<PaintedFacet> painted_facets = collect_painted_facets(print_object, num_extruders, throw_on_cancel_callback);
+        BOOST_LOG_TRIVIAL(debug) << "MM segmentation - painted triangles count: " << painted_facets.size();
+        painted_lines = project_painted_facets(print_object, painted_facets, edge_grids, input_expolygons, throw_on_cancel_callback);
     }
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - projection of painted triangles - end";
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - painted layers count: "
                              << std::count_if(painted_lines.begin(), painted_lines.end(), [](const std::vector<PaintedLine> &pl) { return !pl.empty(); });
 
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - begin";
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+    std::vector<std::vector<ColoredLines>> colored_polygons(num_layers);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&edge_grids, &input_expolygons, &painted_lines, &colored_polygons, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
         for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
             throw_on_cancel_callback();
             if (!painted_lines[layer_idx].empty()) {
@@ -1393,13 +1506,35 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                 export_painted_lines_to_svg(debug_out_path("mm-painted-lines-post-processed-%d-%d.svg", layer_idx, iRun), post_processed_painted_lines, input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_PAINTED_LINES
 
-                std::vector<ColoredLines> color_poly = colorize_contours(edge_grids[layer_idx].contours(), post_processed_painted_lines);
+                colored_polygons[layer_idx] = colorize_contours(edge_grids[layer_idx].contours(), post_processed_painted_lines);
 
 #ifdef MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS
-                export_colorized_polygons_to_svg(debug_out_path("mm-colorized_polygons-%d-%d.svg", layer_idx, iRun), color_poly, input_expolygons[layer_idx]);
+                export_colorized_polygons_to_svg(debug_out_path("mm-colorized_polygons-%d-%d.svg", layer_idx, iRun), colored_polygons[layer_idx], input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_COLORIZED_POLYGONS
+            }
+        }
+    }); // end of parallel_for
+
+    // The segmentation of a layer depends just on its colored polygons. Layers with the same colored polygons as the layer below,
+    // which is common for vertical walls, reuse the segmentation of the lowest of such layers instead of constructing the same Voronoi diagram again.
+    std::vector<size_t> segmentation_source_layer(num_layers);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&colored_polygons, &segmentation_source_layer, reuse_identical_layers](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx)
+            segmentation_source_layer[layer_idx] = reuse_identical_layers && layer_idx > 0 && !colored_polygons[layer_idx].empty() &&
+                                                   are_colored_polygons_equal(colored_polygons[layer_idx], colored_polygons[layer_idx - 1]) ? layer_idx - 1 : layer_idx;
+    }); // end of parallel_for
+    size_t num_reused_layers = 0;
+    for (size_t layer_idx = 1; layer_idx < num_layers; ++layer_idx)
+        if (segmentation_source_layer[layer_idx] != layer_idx) {
+            segmentation_source_layer[layer_idx] = segmentation_source_layer[segmentation_source_layer[layer_idx]];
+            ++num_reused_layers;
+        }
+    BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers with reused segmentation count: " << num_reused_layers;
 
-                assert(!color_poly.empty());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&input_expolygons, &colored_polygons, &segmentation_source_layer, &segmented_regions, &num_extruders, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            if (const std::vector<ColoredLines> &color_poly = colored_polygons[layer_idx]; !color_poly.empty() && segmentation_source_layer[layer_idx] == layer_idx) {
                 assert(!color_poly.front().empty());
                 if (has_layer_only_one_color(color_poly)) {
                     // If the whole layer is painted using the same color, it is not needed to construct a Voronoi diagram for the segmentation of this layer.
@@ -1407,11 +1542,20 @@ std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(con
                 } else {
                     segmented_regions[layer_idx] = extract_colored_segments(color_poly, num_extruders, layer_idx);
                 }
+            }
+        }
+    }); // end of parallel_for
+    colored_polygons.clear();
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_layers), [&input_expolygons, &segmentation_source_layer, &segmented_regions, &throw_on_cancel_callback](const tbb::blocked_range<size_t> &range) {
+        for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++layer_idx) {
+            throw_on_cancel_callback();
+            if (size_t source_layer_idx = segmentation_source_layer[layer_idx]; source_layer_idx != layer_idx)
+                segmented_regions[layer_idx] = segmented_regions[source_layer_idx];
 
 #ifdef MM_SEGMENTATION_DEBUG_REGIONS
-                export_regions_to_svg(debug_out_path("mm-regions-sides-%d-%d.svg", layer_idx, iRun), segmented_regions[layer_idx], input_expolygons[layer_idx]);
+            export_regions_to_svg(debug_out_path("mm-regions-sides-%d-%d.svg", layer_idx, iRun), segmented_regions[layer_idx], input_expolygons[layer_idx]);
 #endif // MM_SEGMENTATION_DEBUG_REGIONS
-            }
         }
     }); // end of parallel_for
     BOOST_LOG_TRIVIAL(debug) << "MM segmentation - layers segmentation in parallel - end";
@@ -24,8 +24,10 @@ struct ColoredLine
 
 using ColoredLines = std::vector<ColoredLine>;
 
-// Returns MMU segmentation based on painting in MMU segmentation gizmo
-std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback);
+// Returns MMU segmentation based on painting in MMU segmentation gizmo.
+// If reuse_identical_layers is set, the segmentation of a layer with the same colored contours as the layer below is copied from that layer.
+std::vector<std::vector<ExPolygons>> multi_material_segmentation_by_painting(const PrintObject &print_object, const std::function<void()> &throw_on_cancel_callback,
+                                                                             bool reuse_identical_layers = true);
 
 } // namespace Slic3r
 
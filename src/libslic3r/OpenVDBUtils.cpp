@@ -20,6 +20,8 @@
 #include <openvdb/tools/LevelSetRebuild.h>
 #include <openvdb/tools/FastSweeping.h>
 
+#include "libslic3r/Execution/ExecutionTBB.hpp"
+
 namespace Slic3r {
 
 struct VoxelGrid
@@ -165,16 +167,25 @@ indexed_triangle_set grid_to_mesh(const VoxelGrid &vgrid,
     openvdb::tools::volumeToMesh(grid, points, triangles, quads, isovalue,
                                  adaptivity, relaxDisorientedTriangles);
 
+    // volumeToMesh() already extracts the surface of the leaf nodes in parallel,
+    // convert its output in parallel as well, it is in the order of millions
+    // of vertices for fine grids.
     indexed_triangle_set ret;
-    ret.vertices.reserve(points.size());
-    ret.indices.reserve(triangles.size() + quads.size() * 2);
-
-    for (auto &v : points) ret.vertices.emplace_back(to_vec3f(v) /*/ scale*/);
-    for (auto &v : triangles) ret.indices.emplace_back(to_vec3i(v));
-    for (auto &quad : quads) {
-        ret.indices.emplace_back(quad(2), quad(1), quad(0));
-        ret.indices.emplace_back(quad(3), quad(2), quad(0));
-    }
+    ret.vertices.resize(points.size());
+    ret.indices.resize(triangles.size() + quads.size() * 2);
+
+    constexpr size_t Granularity = 4096;
+    execution::for_each(ex_tbb, size_t(0), points.size(), [&](size_t i) {
+        ret.vertices[i] = to_vec3f(points[i]);
+    }, Granularity);
+    execution::for_each(ex_tbb, size_t(0), triangles.size(), [&](size_t i) {
+        ret.indices[i] = to_vec3i(triangles[i]);
+    }, Granularity);
+    execution::for_each(ex_tbb, size_t(0), quads.size(), [&](size_t i) {
+        const openvdb::Vec4I &quad = quads[i];
+        ret.indices[triangles.size() + 2 * i]     = Vec3i(quad(2), quad(1), quad(0));
+        ret.indices[triangles.size() + 2 * i + 1] = Vec3i(quad(3), quad(2), quad(0));
+    }, Granularity);
 
     return ret;
 }
@@ -800,6 +800,9 @@ namespace client
         // If false, the macro_processor will evaluate a full macro.
         // If true, the macro processor will evaluate just a boolean condition using the full expressive power of the macro processor.
         bool                     just_boolean_expression = false;
+        // If a compiled template is being processed, then only a part of the source is being parsed at a time.
+        // The error position is reported relative to the whole source.
+        const std::string       *source                 = nullptr;
         std::string              error_message;
 
         // Table to translate symbol tag to a human readable error message.
@@ -833,6 +836,8 @@ namespace client
         }
         // Inside a block, which is conditionally suppressed?
         bool skipping() const { return m_depth_suppressed > 0; }
+        // Parse the whole input as if it was inside a suppressed block, thus only checking its syntax.
+        void check_syntax_only() { ++ m_depth_suppressed; }
 
         const ConfigOption* 	optptr(const t_config_option_key &opt_key) const override
         {
@@ -1573,8 +1578,10 @@ namespace client
         static void process_error_message(const MyContext *context, const boost::spirit::info &info, const Iterator &it_begin, const Iterator &it_end, const Iterator &it_error)
         {
             std::string &msg = const_cast<MyContext*>(context)->error_message;
-            std::string  first(it_begin, it_error);
-            std::string  last(it_error, it_end);
+            const Iterator begin = context->source ? context->source->cbegin() : it_begin;
+            const Iterator end   = context->source ? context->source->cend()   : it_end;
+            std::string  first(begin, it_error);
+            std::string  last(it_error, end);
             auto         first_pos  = first.rfind('\n');
             auto         last_pos   = last.find('\n');
             int          line_nr    = 1;
@@ -1589,7 +1596,7 @@ namespace client
             }
             auto error_line = std::string(first, first_pos) + std::string(last, 0, last_pos);
             // Position of the it_error from the start of its line.
-            auto error_pos  = (it_error - it_begin) - first_pos;
+            auto error_pos  = (it_error - begin) - first_pos;
             msg += "Parsing error at line " + std::to_string(line_nr);
             if (! info.tag.empty() && info.tag.front() == '*') {
                 // The gat contains an explanatory string.
@@ -2338,10 +2345,10 @@ namespace client
 
 static const client::macro_processor g_macro_processor_instance;
 
-static std::string process_macro(const std::string &templ, client::MyContext &context)
+static std::string process_macro(client::Iterator begin, client::Iterator end, client::MyContext &context)
 {
     std::string output;
-    phrase_parse(templ.begin(), templ.end(), g_macro_processor_instance(&context), client::skipper{}, output);
+    phrase_parse(begin, end, g_macro_processor_instance(&context), client::skipper{}, output);
 	if (! context.error_message.empty()) {
         if (context.error_message.back() != '\n' && context.error_message.back() != '\r')
             context.error_message += '\n';
@@ -2350,7 +2357,360 @@ static std::string process_macro(const std::string &templ, client::MyContext &co
     return output;
 }
 
+static std::string process_macro(const std::string &templ, client::MyContext &context)
+{
+    return process_macro(templ.begin(), templ.end(), context);
+}
+
+class PlaceholderParser::Template
+{
+public:
+    struct Segment;
+
+    // Single branch of an {if}{elsif}{else}{endif} block.
+    struct Branch {
+        // Source range of the condition, empty for the {else} branch.
+        size_t                  condition_begin { 0 };
+        size_t                  condition_end   { 0 };
+        std::vector<Segment>    body;
+    };
+
+    struct Segment {
+        enum class Type {
+            // Free-form text, copied to the output.
+            Text,
+            // A {} code block or a [] legacy variable expansion, or a sequence of them, parsed by the macro processor.
+            Code,
+            // {if}{elsif}{else}{endif} block with text blocks in its branches.
+            Conditional,
+        };
+        Type                    type;
+        size_t                  begin;
+        size_t                  end;
+        std::vector<Branch>     branches;
+    };
+
+    std::string                 source;
+    std::vector<Segment>        segments;
+};
+
+namespace client {
+    // Lexical analysis of a template, just detailed enough to split it into segments the same way the macro_processor
+    // grammar would parse it. Whenever the structure is not understood, the template is not split.
+    class TemplateCompiler
+    {
+    public:
+        using Segment = PlaceholderParser::Template::Segment;
+        using Branch  = PlaceholderParser::Template::Branch;
+
+        explicit TemplateCompiler(const std::string &source) : m_source(source) {}
+
+        // Split a text block [begin, end) into segments. Returns false if the text block could not be split.
+        bool text_block(size_t begin, size_t end, std::vector<Segment> &out) const
+        {
+            for (size_t i = begin; i < end;) {
+                if (m_source[i] == '[') {
+                    // Legacy variable expansion [variable] or [variable_[index]].
+                    int    depth = 0;
+                    size_t j     = i;
+                    for (; j < end; ++ j)
+                        if (m_source[j] == '[')
+                            ++ depth;
+                        else if (m_source[j] == ']') {
+                            if (-- depth == 0)
+                                break;
+                        } else if (m_source[j] == '{' || m_source[j] == '}' || m_source[j] == '"')
+                            return false;
+                    if (j == end)
+                        return false;
+                    append_code(i, j + 1, out);
+                    i = j + 1;
+                } else if (m_source[i] == '{') {
+                    Block block;
+                    if (! this->block(i, end, block))
+                        return false;
+                    if (block.open_ifs == 0 && block.outer_keywords == 0) {
+                        append_code(i, block.end, out);
+                        i = block.end;
+                    } else if (block.header == Header::If) {
+                        Segment segment;
+                        if (! this->conditional(i, block, end, segment))
+                            return false;
+                        i = segment.end;
+                        out.emplace_back(std::move(segment));
+                    } else
+                        // Unpaired {elsif}, {else}, {endif} or an {if} with a code block inside.
+                        return false;
+                } else {
+                    size_t j = std::min(m_source.find_first_of("[{", i), end);
+                    out.push_back({ Segment::Type::Text, i, j, {} });
+                    i = j;
+                }
+            }
+            return true;
+        }
+
+    private:
+        enum class Header {
+            None,
+            If,
+            Elsif,
+            Else,
+            Endif,
+        };
+
+        // Summary of a {} code block.
+        struct Block {
+            // One past the closing brace.
+            size_t  end             { 0 };
+            // Number of "if" keywords not closed by "endif" inside this block.
+            int     open_ifs        { 0 };
+            // Number of "elsif", "else" and "endif" keywords belonging to an "if" before this block.
+            int     outer_keywords  { 0 };
+            // Number of "endif" keywords closing an "if" before this block.
+            int     outer_endifs    { 0 };
+            // Set if the block contains just the header of a branch: {if condition}, {elsif condition}, {else} or {endif}.
+            Header  header          { Header::None };
+            // Start of the condition following the "if" or "elsif" header.
+            size_t  condition_begin { 0 };
+        };
+
+        static bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+        static bool is_alpha(char c) { return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_'; }
+        static bool is_alnum(char c) { return is_alpha(c) || (c >= '0' && c <= '9'); }
+
+        // Skip a string literal or a regular expression starting at i with the delimiter, returns one past its end.
+        size_t skip_quoted(size_t i, size_t end) const
+        {
+            const char delimiter = m_source[i];
+            for (++ i; i < end && m_source[i] != delimiter; ++ i)
+                if (m_source[i] == '\\')
+                    ++ i;
+            return i < end ? i + 1 : std::string::npos;
+        }
+
+        // Analyze a code block starting with '{' at begin.
+        bool block(size_t begin, size_t end, Block &out) const
+        {
+            assert(m_source[begin] == '{');
+            int  num_tokens     = 0;
+            int  num_keywords   = 0;
+            bool separator      = false;
+            bool regex_expected = false;
+            for (size_t i = begin + 1; i < end;) {
+                const char c = m_source[i];
+                if (c == '}') {
+                    out.end = i + 1;
+                    if (num_keywords == 1 && ! separator) {
+                        if (out.header == Header::If || out.header == Header::Elsif) {
+                            if (num_tokens == 1)
+                                // Missing condition.
+                                out.header = Header::None;
+                        } else if (num_tokens > 1)
+                            out.header = Header::None;
+                    } else
+                        out.header = Header::None;
+                    return true;
+                }
+                if (c == '{')
+                    return false;
+                if (is_space(c)) {
+                    ++ i;
+                    continue;
+                }
+                if (c == '"' || (c == '/' && regex_expected)) {
+                    if (i = skip_quoted(i, end); i == std::string::npos)
+                        return false;
+                } else if (is_alpha(c)) {
+                    size_t j = i;
+                    while (j < end && is_alnum(m_source[j]))
+                        ++ j;
+                    const std::string_view word(m_source.data() + i, j - i);
+                    Header keyword = Header::None;
+                    if (word == "if") {
+                        keyword = Header::If;
+                        ++ out.open_ifs;
+                    } else if (word == "elsif" || word == "else") {
+                        keyword = word == "else" ? Header::Else : Header::Elsif;
+                        if (out.open_ifs == 0)
+                            ++ out.outer_keywords;
+                    } else if (word == "endif") {
+                        keyword = Header::Endif;
+                        if (out.open_ifs > 0)
+                            -- out.open_ifs;
+                        else {
+                            ++ out.outer_keywords;
+                            ++ out.outer_endifs;
+                        }
+                    } else if (word == "then")
+                        // "then" starts a code block of an "if", thus this is not a header.
+                        separator = true;
+                    if (keyword != Header::None)
+                        ++ num_keywords;
+                    if (num_tokens == 0) {
+                        out.header          = keyword;
+                        out.condition_begin = j;
+                    }
+                    i = j;
+                } else if (c >= '0' && c <= '9') {
+                    while (i < end && (is_alnum(m_source[i]) || m_source[i] == '.'))
+                        ++ i;
+                } else if ((c == '=' || c == '!') && i + 1 < end && m_source[i + 1] == '~') {
+                    i += 2;
+                    ++ num_tokens;
+                    regex_expected = true;
+                    continue;
+                } else {
+                    if (c == ';')
+                        separator = true;
+                    ++ i;
+                }
+                ++ num_tokens;
+                regex_expected = false;
+            }
+            // Unterminated block.
+            return false;
+        }
+
+        // Split an {if}{elsif}{else}{endif} block starting with the header "first".
+        bool conditional(size_t begin, const Block &first, size_t end, Segment &out) const
+        {
+            out.type  = Segment::Type::Conditional;
+            out.begin = begin;
+            Branch branch { first.condition_begin, first.end - 1, {} };
+            size_t body_begin = first.end;
+            bool   has_else   = false;
+            int    depth      = 1;
+            for (size_t i = first.end;;) {
+                i = m_source.find('{', i);
+                if (i >= end)
+                    return false;
+                Block block;
+                if (! this->block(i, end, block))
+                    return false;
+                if (depth == 1 && block.outer_keywords > 0) {
+                    // Header of the next branch or the end of this conditional block.
+                    if (block.header != Header::Elsif && block.header != Header::Else && block.header != Header::Endif)
+                        return false;
+                    if (! this->text_block(body_begin, i, branch.body))
+                        return false;
+                    out.branches.emplace_back(std::move(branch));
+                    if (block.header == Header::Endif) {
+                        out.end = block.end;
+                        return true;
+                    }
+                    if (has_else)
+                        return false;
+                    branch = {};
+                    if (block.header == Header::Elsif) {
+                        branch.condition_begin = block.condition_begin;
+                        branch.condition_end   = block.end - 1;
+                    } else
+                        has_else = true;
+                    body_begin = block.end;
+                } else if (depth += block.open_ifs - block.outer_endifs; depth <= 0)
+                    return false;
+                i = block.end;
+            }
+        }
+
+        // Neighbor code blocks are parsed together.
+        static void append_code(size_t begin, size_t end, std::vector<Segment> &out)
+        {
+            if (! out.empty() && out.back().type == Segment::Type::Code && out.back().end == begin)
+                out.back().end = end;
+            else
+                out.push_back({ Segment::Type::Code, begin, end, {} });
+        }
+
+        const std::string &m_source;
+    };
+
+    static void process_segments(const PlaceholderParser::Template &templ, const std::vector<PlaceholderParser::Template::Segment> &segments, MyContext &context, std::string &output)
+    {
+        using Segment = PlaceholderParser::Template::Segment;
+        for (const Segment &segment : segments)
+            switch (segment.type) {
+            case Segment::Type::Text:
+                output.append(templ.source, segment.begin, segment.end - segment.begin);
+                break;
+            case Segment::Type::Code:
+                output += process_macro(templ.source.begin() + segment.begin, templ.source.begin() + segment.end, context);
+                break;
+            case Segment::Type::Conditional:
+            {
+                // Like the macro_processor, evaluate the conditions of all the {elsif} branches even if a branch
+                // has already been taken, so that the same errors are reported.
+                bool taken = false;
+                for (const PlaceholderParser::Template::Branch &branch : segment.branches) {
+                    bool condition = true;
+                    if (branch.condition_begin != branch.condition_end) {
+                        context.just_boolean_expression = true;
+                        condition = process_macro(templ.source.begin() + branch.condition_begin, templ.source.begin() + branch.condition_end, context) == "true";
+                        context.just_boolean_expression = false;
+                    }
+                    if (condition && ! taken) {
+                        process_segments(templ, branch.body, context, output);
+                        taken = true;
+                    }
+                }
+                break;
+            }
+            }
+    }
+}
+
+std::shared_ptr<const PlaceholderParser::Template> PlaceholderParser::compile(const std::string &templ, bool split)
+{
+    auto out = std::make_shared<Template>();
+    out->source = templ;
+    if (templ.empty())
+        return out;
+    if (! split) {
+        out->segments = { { Template::Segment::Type::Code, 0, out->source.size(), {} } };
+        return out;
+    }
+
+    // Check the syntax of the whole template first, including the branches, which will not be parsed by process().
+    // If there is an error, let process() parse the whole template to report it the same way as the uncompiled template.
+    bool valid = false;
+    try {
+        client::MyContext context;
+        DynamicConfig     empty_config;
+        context.config = &empty_config;
+        context.check_syntax_only();
+        process_macro(out->source, context);
+        valid = true;
+    } catch (const std::exception &) {
+    }
+
+    if (! valid || ! client::TemplateCompiler(out->source).text_block(0, out->source.size(), out->segments))
+        out->segments = { { Template::Segment::Type::Code, 0, out->source.size(), {} } };
+
+    return out;
+}
+
+std::shared_ptr<const PlaceholderParser::Template> PlaceholderParser::compiled(const std::string &templ) const
+{
+    {
+        std::lock_guard<std::mutex> lock(m_template_cache.mutex);
+        if (auto it = m_template_cache.templates.find(templ); it != m_template_cache.templates.end())
+            return it->second;
+    }
+    std::shared_ptr<const Template> out = compile(templ);
+    std::lock_guard<std::mutex> lock(m_template_cache.mutex);
+    // Don't let the cache grow indefinitely if templates are generated on the fly.
+    if (m_template_cache.templates.size() >= 256)
+        m_template_cache.templates.clear();
+    return m_template_cache.templates.emplace(out->source, out).first->second;
+}
+
 std::string PlaceholderParser::process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context_data) const
+{
+    return this->process(*this->compiled(templ), current_extruder_id, config_override, config_outputs, context_data);
+}
+
+std::string PlaceholderParser::process(const Template &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context_data) const
 {
     client::MyContext context;
     context.external_config 	= this->external_config();
@@ -2359,7 +2719,10 @@ std::string PlaceholderParser::process(const std::string &templ, unsigned int cu
     context.config_outputs      = config_outputs;
     context.current_extruder_id = current_extruder_id;
     context.context_data        = context_data;
-    return process_macro(templ, context);
+    context.source              = &templ.source;
+    std::string output;
+    client::process_segments(templ, templ.segments, context, output);
+    return output;
 }
 
 // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
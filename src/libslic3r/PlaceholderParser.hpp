@@ -8,9 +8,12 @@
 
 #include "libslic3r.h"
 #include <map>
+#include <memory>
+#include <mutex>
 #include <random>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 #include "PrintConfig.hpp"
 
@@ -31,6 +34,10 @@ public:
         std::unique_ptr<DynamicConfig>  global_config;
     };
 
+    // Template split into literal text, code blocks and {if}{elsif}{else}{endif} blocks by compile().
+    // Processing a compiled template does not parse the literal text and the branches not taken.
+    class Template;
+
     PlaceholderParser(const DynamicConfig *external_config = nullptr);
     
     void clear_config() { m_config.clear(); }
@@ -62,11 +69,17 @@ public:
 	const DynamicConfig*	external_config() const  			{ return m_external_config; }
 
     // Fill in the template using a macro processing language.
+    // The template is compiled on its first use and cached.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
     std::string process(const std::string &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context) const;
+    std::string process(const Template &templ, unsigned int current_extruder_id, const DynamicConfig *config_override, DynamicConfig *config_outputs, ContextData *context) const;
     std::string process(const std::string &templ, unsigned int current_extruder_id = 0, const DynamicConfig *config_override = nullptr, ContextData *context = nullptr) const
         { return this->process(templ, current_extruder_id, config_override, nullptr /* config_outputs */, context); }
 
+    // Split the template for repeated processing. Never throws, a template with syntax errors is processed as a whole
+    // to report the error. If split is false, the template is processed as a whole, parsing all of it on every call.
+    static std::shared_ptr<const Template> compile(const std::string &templ, bool split = true);
+
     // Evaluate a boolean expression using the full expressive power of the PlaceholderParser boolean expression syntax.
     // Throws Slic3r::PlaceholderParserError on syntax or runtime error.
     static bool evaluate_boolean_expression(const std::string &templ, const DynamicConfig &config, const DynamicConfig *config_override = nullptr);
@@ -77,9 +90,23 @@ public:
     void update_timestamp() { update_timestamp(m_config); }
 
 private:
+    std::shared_ptr<const Template> compiled(const std::string &templ) const;
+
 	// config has a higher priority than external_config when looking up a symbol.
     DynamicConfig 			 m_config;
     const DynamicConfig 	*m_external_config;
+
+    // Templates compiled by process(), keyed by a view of their own source.
+    // The cache is not copied together with the PlaceholderParser.
+    struct TemplateCache {
+        TemplateCache() = default;
+        TemplateCache(const TemplateCache &) {}
+        TemplateCache& operator=(const TemplateCache &) { return *this; }
+
+        std::mutex                                                             mutex;
+        std::unordered_map<std::string_view, std::shared_ptr<const Template>> templates;
+    };
+    mutable TemplateCache    m_template_cache;
 };
 
 }
@@ -469,7 +469,7 @@ static std::vector<std::string> s_Preset_print_options {
     "support_material_contact_distance", "support_material_bottom_contact_distance",
     "support_material_buildplate_only", 
     "support_tree_angle", "support_tree_angle_slow", "support_tree_branch_diameter", "support_tree_branch_diameter_angle", "support_tree_branch_diameter_double_wall", 
-    "support_tree_top_rate", "support_tree_branch_distance", "support_tree_tip_diameter",
+    "support_tree_top_rate", "support_tree_branch_distance", "support_tree_tip_diameter", "support_tree_fast_avoidance",
     "dont_support_bridges", "thick_bridges", "notes", "complete_objects", "extruder_clearance_radius",
     "extruder_clearance_height", "gcode_comments", "gcode_label_objects", "output_filename_format", "post_process", "gcode_substitutions", "perimeter_extruder",
     "infill_extruder", "solid_infill_extruder", "support_material_extruder", "support_material_interface_extruder",
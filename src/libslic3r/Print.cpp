@@ -1549,33 +1549,63 @@ void Print::_make_wipe_tower()
     // Lets go through the wipe tower layers and determine pairs of extruder changes for each
     // to pass to wipe_tower (so that it can use it for planning the layout of the tower)
     {
+        struct ToolChange {
+            unsigned int old_extruder_id;
+            unsigned int new_extruder_id;
+            // total volume to wipe after this toolchange
+            float        volume_to_wipe;
+        };
+        struct WipeTowerLayer {
+            LayerTools             *layer_tools;
+            // Extruder active when starting the layer.
+            unsigned int            extruder_id;
+            std::vector<ToolChange> tool_changes;
+        };
+        // The sequence of tool changes only depends on the tool ordering.
+        std::vector<WipeTowerLayer> wipe_tower_layers;
         unsigned int current_extruder_id = m_wipe_tower_data.tool_ordering.all_extruders().back();
         for (auto &layer_tools : m_wipe_tower_data.tool_ordering.layer_tools()) { // for all layers
             if (!layer_tools.has_wipe_tower) continue;
             bool first_layer = &layer_tools == &m_wipe_tower_data.tool_ordering.front();
-            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, current_extruder_id, current_extruder_id, false);
+            WipeTowerLayer &wipe_tower_layer = wipe_tower_layers.emplace_back(WipeTowerLayer{ &layer_tools, current_extruder_id, {} });
             for (const auto extruder_id : layer_tools.extruders) {
                 if ((first_layer && extruder_id == m_wipe_tower_data.tool_ordering.all_extruders().back()) || extruder_id != current_extruder_id) {
-                    float volume_to_wipe = wipe_volumes[current_extruder_id][extruder_id];             // total volume to wipe after this toolchange
-                    // Not all of that can be used for infill purging:
-                    volume_to_wipe -= (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // try to assign some infills/objects for the wiping:
-                    volume_to_wipe = layer_tools.wiping_extrusions_nonconst().mark_wiping_extrusions(*this, layer_tools, current_extruder_id, extruder_id, volume_to_wipe);
-
-                    // add back the minimal amount toforce on the wipe tower:
-                    volume_to_wipe += (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(extruder_id);
-
-                    // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
-                    wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height,
-                                               current_extruder_id, extruder_id, volume_to_wipe);
+                    wipe_tower_layer.tool_changes.push_back({ current_extruder_id, extruder_id, wipe_volumes[current_extruder_id][extruder_id] });
                     current_extruder_id = extruder_id;
                 }
             }
-            layer_tools.wiping_extrusions_nonconst().ensure_perimeters_infills_order(*this, layer_tools);
             if (&layer_tools == &m_wipe_tower_data.tool_ordering.back() || (&layer_tools + 1)->wipe_tower_partitions == 0)
                 break;
         }
+
+        // Assigning infills / objects for wiping iterates over all extrusions of a layer, while it only modifies
+        // the WipingExtrusions of that layer. Process the layers in parallel.
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, wipe_tower_layers.size()), [this, &wipe_tower_layers](const tbb::blocked_range<size_t> &range) {
+            for (size_t layer_idx = range.begin(); layer_idx < range.end(); ++ layer_idx) {
+                WipeTowerLayer   &wipe_tower_layer = wipe_tower_layers[layer_idx];
+                LayerTools       &layer_tools      = *wipe_tower_layer.layer_tools;
+                WipingExtrusions &wiping           = layer_tools.wiping_extrusions_nonconst();
+                for (ToolChange &tool_change : wipe_tower_layer.tool_changes) {
+                    // Not all of that can be used for infill purging:
+                    float volume_to_wipe = tool_change.volume_to_wipe - (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(tool_change.new_extruder_id);
+                    // try to assign some infills/objects for the wiping:
+                    volume_to_wipe = wiping.mark_wiping_extrusions(*this, layer_tools, tool_change.old_extruder_id, tool_change.new_extruder_id, volume_to_wipe);
+                    // add back the minimal amount toforce on the wipe tower:
+                    tool_change.volume_to_wipe = volume_to_wipe + (float)m_config.filament_minimal_purge_on_wipe_tower.get_at(tool_change.new_extruder_id);
+                }
+                wiping.ensure_perimeters_infills_order(*this, layer_tools);
+            }
+        });
+        this->throw_if_canceled();
+
+        for (const WipeTowerLayer &wipe_tower_layer : wipe_tower_layers) {
+            const LayerTools &layer_tools = *wipe_tower_layer.layer_tools;
+            wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height, wipe_tower_layer.extruder_id, wipe_tower_layer.extruder_id, false);
+            for (const ToolChange &tool_change : wipe_tower_layer.tool_changes)
+                // request a toolchange at the wipe tower with at least volume_to_wipe purging amount
+                wipe_tower.plan_toolchange((float)layer_tools.print_z, (float)layer_tools.wipe_tower_layer_height,
+                                           tool_change.old_extruder_id, tool_change.new_extruder_id, tool_change.volume_to_wipe);
+        }
     }
 
     // Generate the wipe tower layers.
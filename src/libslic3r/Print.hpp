@@ -239,6 +239,9 @@ public:
     std::vector<ObjectID>                       cached_volume_ids;
 
     std::optional<GeneratedSupportPoints> generated_support_points;
+    // State of the last search of the support spots. Kept when generated_support_points are invalidated,
+    // so that the next search resumes from the lowest layer that changed.
+    std::shared_ptr<SupportSpotsGenerator::SearchCache> support_spots_search_cache;
 
     void ref_cnt_inc() { ++ m_ref_cnt; }
     void ref_cnt_dec() { if (-- m_ref_cnt == 0) delete this; }
@@ -2354,7 +2354,9 @@ void PrintConfigDef::init_fff_params()
     def->tooltip = L("If you want to process the output G-code through custom scripts, "
                    "just list their absolute paths here. Separate multiple scripts with a semicolon. "
                    "Scripts will be passed the absolute path to the G-code file as the first argument, "
-                   "and they can access the Slic3r config settings by reading environment variables.");
+                   "and they can access the Slic3r config settings by reading environment variables. "
+                   "A line starting with \"plugin:\" followed by the path to a shared library implementing "
+                   "the post-processing plugin interface loads the library, which processes the G-code while it is being generated.");
     def->gui_flags = "serialized";
     def->multiline = true;
     def->full_width = true;
@@ -3288,6 +3290,15 @@ void PrintConfigDef::init_fff_params()
     def->mode = comAdvanced;
     def->set_default_value(new ConfigOptionPercent(15));
 
+    def = this->add("support_tree_fast_avoidance", coBool);
+    def->label = L("Fast avoidance");
+    def->category = L("Support material");
+    // TRN PrintSettings: "Organic supports" > "Fast avoidance"
+    def->tooltip = L("Calculate the areas the branches avoid on a distance field sampled on a 0.1 mm grid instead of offsetting polygons "
+                     "for each branch radius. This is much faster for large objects, but the avoided areas are up to one grid cell coarser.");
+    def->mode = comExpert;
+    def->set_default_value(new ConfigOptionBool(false));
+
     def = this->add("temperature", coInts);
     def->label = L("Other layers");
     def->tooltip = L("Nozzle temperature for layers after the first one. Set this to zero to disable "
@@ -486,7 +486,8 @@ void PrintObject::generate_support_spots()
                                                  float(this->print()->m_config.perimeter_acceleration.getFloat()),
                                                  this->config().raft_layers.getInt(), this->config().brim_type.value,
                                                  float(this->config().brim_width.getFloat())};
-            auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params);
+            auto [supp_points, partial_objects] = SupportSpotsGenerator::full_search(this, cancel_func, params,
+                                                                                        this->m_shared_regions->support_spots_search_cache);
             Transform3d po_transform            = this->trafo_centered();
             if (this->layer_count() > 0) {
                 po_transform = Geometry::translation_transform(Vec3d{0, 0, this->layers().front()->bottom_z()}) * po_transform;
@@ -702,11 +703,13 @@ bool PrintObject::invalidate_state_by_config_options(
     bool invalidated = false;
     for (const t_config_option_key &opt_key : opt_keys) {
         if (   opt_key == "brim_width"
-            || opt_key == "brim_separation"
             || opt_key == "brim_type") {
             steps.emplace_back(posSupportSpotsSearch);
             // Brim is printed below supports, support invalidates brim and skirt.
             steps.emplace_back(posSupportMaterial);
+        } else if (opt_key == "brim_separation") {
+            // The search of support spots does not account for the brim separation.
+            steps.emplace_back(posSupportMaterial);
         } else if (
                opt_key == "perimeters"
             || opt_key == "extra_perimeters"
@@ -790,6 +793,7 @@ bool PrintObject::invalidate_state_by_config_options(
             || opt_key == "support_tree_branch_diameter"
             || opt_key == "support_tree_branch_diameter_angle"
             || opt_key == "support_tree_branch_diameter_double_wall"
+            || opt_key == "support_tree_fast_avoidance"
             || opt_key == "support_tree_top_rate"
             || opt_key == "support_tree_branch_distance"
             || opt_key == "support_tree_tip_diameter"
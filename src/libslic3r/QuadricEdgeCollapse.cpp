@@ -8,6 +8,10 @@
 #include "MutablePriorityQueue.hpp"
 #include <tbb/parallel_for.h>
 
+#include <atomic>
+#include <numeric>
+#include <unordered_map>
+
 using namespace Slic3r;
 
 #ifndef NDEBUG
@@ -137,7 +141,13 @@ namespace QuadricEdgeCollapse {
     void change_neighbors(EdgeInfos &e_infos, VertexInfos &v_infos, uint32_t ti0, uint32_t ti1,
                           uint32_t vi0, uint32_t vi1, uint32_t vi_top0,
                           const Triangle &t1, CopyEdgeInfos& infos, EdgeInfos &e_infos1);
-    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its);
+    // When vertex_map is not null, it is filled in with the new index of each vertex, UINT32_MAX for the removed ones.
+    void compact(const VertexInfos &v_infos, const TriangleInfos &t_infos, const EdgeInfos &e_infos, indexed_triangle_set &its,
+                 std::vector<uint32_t> *vertex_map = nullptr);
+    // Simplification of a single mesh (or a part of a mesh). Edges touching the locked vertices are not collapsed,
+    // thus the locked vertices are neither moved nor removed. Returns the error of the last collapsed edge.
+    float collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, const std::vector<bool> *locked_vertices,
+                   std::vector<uint32_t> *vertex_map, ThrowOnCancel &throw_on_cancel, StatusFn &status_fn);
 
 #ifdef EXPENSIVE_DEBUG_CHECKS
     void store_surround(const char *obj_filename, size_t triangle_index, int depth, const indexed_triangle_set &its,
@@ -175,6 +185,194 @@ void Slic3r::its_quadric_edge_collapse(
     if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
     if (status_fn == nullptr) status_fn = [](int) {};
 
+    float last_collapsed_error = collapse(its, triangle_count, maximal_error, nullptr, nullptr, throw_on_cancel, status_fn);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+void Slic3r::its_quadric_edge_collapse_partitioned(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count,
+    float *                   max_error,
+    std::function<void(void)> throw_on_cancel,
+    std::function<void(int)>  status_fn,
+    size_t                    cluster_triangle_count)
+{
+    // check input
+    if (triangle_count >= its.indices.size()) return;
+    if (cluster_triangle_count == 0 || its.indices.size() < 2 * cluster_triangle_count) {
+        // Not worth partitioning.
+        its_quadric_edge_collapse(its, triangle_count, max_error, throw_on_cancel, status_fn);
+        return;
+    }
+    float maximal_error = (max_error == nullptr)? std::numeric_limits<float>::max() : *max_error;
+    if (maximal_error <= 0.f) return;
+    if (throw_on_cancel == nullptr) throw_on_cancel = []() {};
+    if (status_fn == nullptr) status_fn = [](int) {};
+
+    // Split the triangles into spatially coherent clusters: Recursively split the triangles at the median of their centroids
+    // along the longest axis of the bounding box of the centroids.
+    std::vector<Vec3f> centroids(its.indices.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &centroids](const tbb::blocked_range<size_t> &range) {
+        for (size_t ti = range.begin(); ti < range.end(); ++ ti) {
+            const Triangle &t = its.indices[ti];
+            centroids[ti] = (its.vertices[t[0]] + its.vertices[t[1]] + its.vertices[t[2]]) / 3.f;
+        }
+    });
+    std::vector<uint32_t> triangles(its.indices.size());
+    std::iota(triangles.begin(), triangles.end(), 0);
+    // Ranges of triangles forming the clusters.
+    std::vector<std::pair<size_t, size_t>> clusters;
+    std::vector<std::pair<size_t, size_t>> to_split{ { 0, triangles.size() } };
+    while (! to_split.empty()) {
+        auto [begin, end] = to_split.back();
+        to_split.pop_back();
+        if (end - begin <= cluster_triangle_count) {
+            clusters.emplace_back(begin, end);
+            continue;
+        }
+        BoundingBoxf3 bbox;
+        for (size_t i = begin; i < end; ++ i)
+            bbox.merge(centroids[triangles[i]].cast<double>());
+        int axis;
+        bbox.size().maxCoeff(&axis);
+        const size_t middle = (begin + end) / 2;
+        std::nth_element(triangles.begin() + begin, triangles.begin() + middle, triangles.begin() + end,
+            [&centroids, axis](uint32_t ti1, uint32_t ti2) { return centroids[ti1][axis] < centroids[ti2][axis]; });
+        to_split.emplace_back(begin, middle);
+        to_split.emplace_back(middle, end);
+    }
+    centroids = {};
+    throw_on_cancel();
+
+    // Vertices shared by triangles of multiple clusters are locked while the clusters are being simplified.
+    static constexpr const uint32_t no_cluster     = std::numeric_limits<uint32_t>::max();
+    static constexpr const uint32_t shared_cluster = no_cluster - 1;
+    std::vector<uint32_t> vertex_cluster(its.vertices.size(), no_cluster);
+    for (uint32_t cluster_id = 0; cluster_id < clusters.size(); ++ cluster_id)
+        for (size_t i = clusters[cluster_id].first; i < clusters[cluster_id].second; ++ i)
+            for (int j = 0; j < 3; ++ j) {
+                uint32_t &c = vertex_cluster[its.indices[triangles[i]][j]];
+                if (c == no_cluster)
+                    c = cluster_id;
+                else if (c != cluster_id)
+                    c = shared_cluster;
+            }
+
+    // Simplify the clusters in parallel, each one proportionally to its size.
+    struct ClusterResult {
+        indexed_triangle_set  its;
+        // Indices of the shared vertices of the cluster in the input mesh, indexed by the cluster vertex index.
+        std::vector<uint32_t> shared_vertices;
+        float                 last_collapsed_error { 0.f };
+    };
+    std::vector<ClusterResult> results(clusters.size());
+    // Index of a vertex owned by a single cluster in the mesh of its cluster.
+    std::vector<uint32_t> local_vertex(its.vertices.size(), no_cluster);
+    // Clusters simplification takes this share of the progress, the rest is taken by the final simplification.
+    static constexpr const int status_clusters_size = 70;
+    std::atomic<size_t> clusters_done { 0 };
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, clusters.size(), 1), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t cluster_id = range.begin(); cluster_id < range.end(); ++ cluster_id) {
+            const auto [begin, end] = clusters[cluster_id];
+            ClusterResult &result = results[cluster_id];
+            indexed_triangle_set &cluster_its = result.its;
+            cluster_its.indices.reserve(end - begin);
+            std::vector<bool>     locked;
+            std::vector<uint32_t> shared;
+            std::unordered_map<uint32_t, uint32_t> shared_local;
+            for (size_t i = begin; i < end; ++ i) {
+                Triangle t = its.indices[triangles[i]];
+                for (int j = 0; j < 3; ++ j) {
+                    int &vi = t[j];
+                    if (vertex_cluster[vi] == shared_cluster) {
+                        auto [it, inserted] = shared_local.insert({ uint32_t(vi), uint32_t(cluster_its.vertices.size()) });
+                        if (inserted) {
+                            cluster_its.vertices.emplace_back(its.vertices[vi]);
+                            locked.emplace_back(true);
+                            shared.emplace_back(vi);
+                        }
+                        vi = int(it->second);
+                    } else {
+                        // Only this cluster accesses its own vertices.
+                        uint32_t &local = local_vertex[vi];
+                        if (local == no_cluster) {
+                            local = uint32_t(cluster_its.vertices.size());
+                            cluster_its.vertices.emplace_back(its.vertices[vi]);
+                            locked.emplace_back(false);
+                            shared.emplace_back(no_cluster);
+                        }
+                        vi = int(local);
+                    }
+                }
+                cluster_its.indices.emplace_back(t);
+            }
+
+            // The triangles touching the locked vertices are not collapsed now, keep them on top of the proportional count,
+            // otherwise the inner part of the cluster would be over-simplified.
+            uint32_t locked_triangles = 0;
+            for (const Triangle &t : cluster_its.indices)
+                if (locked[t[0]] || locked[t[1]] || locked[t[2]])
+                    ++ locked_triangles;
+            const uint32_t cluster_triangle_count = uint32_t(uint64_t(triangle_count) * (end - begin) / its.indices.size()) + locked_triangles;
+            std::vector<uint32_t> vertex_map;
+            StatusFn no_status = [](int) {};
+            result.last_collapsed_error = collapse(cluster_its, cluster_triangle_count, maximal_error, &locked, &vertex_map, throw_on_cancel, no_status);
+            result.shared_vertices.assign(cluster_its.vertices.size(), no_cluster);
+            for (size_t vi = 0; vi < vertex_map.size(); ++ vi)
+                if (shared[vi] != no_cluster) {
+                    // Locked vertices are never removed.
+                    assert(vertex_map[vi] != std::numeric_limits<uint32_t>::max());
+                    result.shared_vertices[vertex_map[vi]] = shared[vi];
+                }
+            status_fn(int(++ clusters_done * status_clusters_size / clusters.size()));
+        }
+    });
+    triangles = {};
+    local_vertex = {};
+
+    // Merge the simplified clusters, the shared vertices are merged back.
+    indexed_triangle_set merged;
+    std::vector<uint32_t> merged_shared(its.vertices.size(), no_cluster);
+    float last_collapsed_error = 0.f;
+    for (ClusterResult &result : results) {
+        std::vector<uint32_t> merged_vertex(result.its.vertices.size());
+        for (size_t vi = 0; vi < result.its.vertices.size(); ++ vi) {
+            const uint32_t shared = result.shared_vertices[vi];
+            uint32_t *merged_vi = shared == no_cluster ? nullptr : &merged_shared[shared];
+            if (merged_vi != nullptr && *merged_vi != no_cluster)
+                merged_vertex[vi] = *merged_vi;
+            else {
+                merged_vertex[vi] = uint32_t(merged.vertices.size());
+                merged.vertices.emplace_back(result.its.vertices[vi]);
+                if (merged_vi != nullptr)
+                    *merged_vi = merged_vertex[vi];
+            }
+        }
+        for (const Triangle &t : result.its.indices)
+            merged.indices.emplace_back(merged_vertex[t[0]], merged_vertex[t[1]], merged_vertex[t[2]]);
+        last_collapsed_error = std::max(last_collapsed_error, result.last_collapsed_error);
+        result = {};
+    }
+    throw_on_cancel();
+
+    // Simplify the whole mesh, mostly along the cluster boundaries, which were locked so far.
+    if (triangle_count < merged.indices.size()) {
+        StatusFn boundary_status_fn = [&status_fn](int percent) {
+            status_fn(status_clusters_size + percent * (100 - status_clusters_size) / 100);
+        };
+        float last_error = collapse(merged, triangle_count, maximal_error, nullptr, nullptr, throw_on_cancel, boundary_status_fn);
+        last_collapsed_error = std::max(last_collapsed_error, last_error);
+    }
+    its = std::move(merged);
+    if (max_error != nullptr) *max_error = last_collapsed_error;
+}
+
+float QuadricEdgeCollapse::collapse(indexed_triangle_set &its, uint32_t triangle_count, float maximal_error, 
+    const std::vector<bool> *locked_vertices, std::vector<uint32_t> *vertex_map, ThrowOnCancel &throw_on_cancel, StatusFn &status_fn)
+{
+    assert(locked_vertices == nullptr || locked_vertices->size() == its.vertices.size());
+    auto is_locked = [locked_vertices](uint32_t vi) { return locked_vertices != nullptr && (*locked_vertices)[vi]; };
+
     StatusFn init_status_fn = [&](int percent) {
         float n_percent = percent * status_init_size / 100.f;
         status_fn(static_cast<int>(std::round(n_percent)));
@@ -260,6 +458,7 @@ void Slic3r::its_quadric_edge_collapse(
             reorder_edges(e_infos, v_info1, ti0, ti1);
         }
         if (!ti1_opt.has_value() || // edge has only one triangle
+            is_locked(vi0) || is_locked(vi1) ||
             degenerate(vi0, ti0, ti1, v_info1, e_infos, its.indices) ||
             degenerate(vi1, ti0, ti1, v_info0, e_infos, its.indices) ||
             create_no_volume(vi0, vi1, ti0, ti1, v_info0, v_info1, e_infos, its.indices) ||
@@ -346,8 +545,8 @@ void Slic3r::its_quadric_edge_collapse(
     }
 
     // compact triangle
-    compact(v_infos, t_infos, e_infos, its);
-    if (max_error != nullptr) *max_error = last_collapsed_error;
+    compact(v_infos, t_infos, e_infos, its, vertex_map);
+    return last_collapsed_error;
 }
 
 Vec3d QuadricEdgeCollapse::create_normal(const Triangle &triangle,
@@ -840,12 +1039,17 @@ void QuadricEdgeCollapse::change_neighbors(EdgeInfos &     e_infos,
 void QuadricEdgeCollapse::compact(const VertexInfos &   v_infos,
                                   const TriangleInfos & t_infos,
                                   const EdgeInfos &     e_infos,
-                                  indexed_triangle_set &its)
+                                  indexed_triangle_set &its,
+                                  std::vector<uint32_t> *vertex_map)
 {
+    if (vertex_map != nullptr)
+        vertex_map->assign(v_infos.size(), std::numeric_limits<uint32_t>::max());
     uint32_t vi_new = 0;
     for (uint32_t vi = 0; vi < v_infos.size(); ++vi) {
         const VertexInfo &v_info = v_infos[vi];
         if (v_info.is_deleted()) continue; // deleted
+        if (vertex_map != nullptr)
+            (*vertex_map)[vi] = vi_new;
         uint32_t e_info_end = v_info.start + v_info.count;
         for (uint32_t ei = v_info.start; ei < e_info_end; ++ei) { 
             const EdgeInfo &e_info = e_infos[ei];
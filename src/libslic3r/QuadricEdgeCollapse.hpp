@@ -34,6 +34,24 @@ void its_quadric_edge_collapse(
     std::function<void(void)> throw_on_cancel = nullptr,
     std::function<void(int)>  statusfn        = nullptr);
 
+/// <summary>
+/// Simplify a large mesh by Quadric metric in parallel.
+/// The triangles are split into spatial clusters of about cluster_triangle_count triangles,
+/// which are simplified independently with the vertices shared by multiple clusters locked.
+/// Then the merged mesh is simplified as a whole, mostly along the cluster boundaries.
+/// The result is close to, but not the same as the one of its_quadric_edge_collapse(),
+/// which is called directly for meshes smaller than two clusters.
+/// </summary>
+/// <param name="cluster_triangle_count">Number of triangles of a cluster.</param>
+/// Other parameters are the same as of its_quadric_edge_collapse().
+void its_quadric_edge_collapse_partitioned(
+    indexed_triangle_set &    its,
+    uint32_t                  triangle_count         = 0,
+    float *                   max_error              = nullptr,
+    std::function<void(void)> throw_on_cancel        = nullptr,
+    std::function<void(int)>  statusfn               = nullptr,
+    size_t                    cluster_triangle_count = 200000);
+
 } // namespace Slic3r
 #endif // slic3r_quadric_edge_collapse_hpp_
 
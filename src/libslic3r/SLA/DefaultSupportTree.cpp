@@ -18,6 +18,122 @@ using Slic3r::opt::Optimizer;
 using Slic3r::opt::AlgNLoptSubplex;
 using Slic3r::opt::AlgNLoptGenetic;
 
+PillarIndex::PillarIndex(double cell_size)
+    : m_cell_size(std::max(cell_size, 1.))
+    , m_buckets(new std::atomic<const Node *>[BucketCount])
+    , m_minx(std::numeric_limits<int>::max())
+    , m_miny(std::numeric_limits<int>::max())
+    , m_maxx(std::numeric_limits<int>::min())
+    , m_maxy(std::numeric_limits<int>::min())
+{
+    for (size_t i = 0; i < BucketCount; ++i)
+        m_buckets[i].store(nullptr, std::memory_order_relaxed);
+}
+
+void PillarIndex::insert(const Vec3d &p, unsigned id)
+{
+    Vec2i c = cell_of(p);
+
+    auto update_min = [](std::atomic<int> &a, int v) {
+        int cur = a.load();
+        while (v < cur && !a.compare_exchange_weak(cur, v));
+    };
+
+    auto update_max = [](std::atomic<int> &a, int v) {
+        int cur = a.load();
+        while (v > cur && !a.compare_exchange_weak(cur, v));
+    };
+
+    update_min(m_minx, c.x()); update_max(m_maxx, c.x());
+    update_min(m_miny, c.y()); update_max(m_maxy, c.y());
+
+    Node *n = &*m_nodes.push_back(Node{{p, id}, nullptr});
+
+    size_t h = (size_t(c.x()) * 73856093u) ^ (size_t(c.y()) * 19349663u);
+    std::atomic<const Node *> &head = m_buckets[h & (BucketCount - 1)];
+
+    const Node *first = head.load(std::memory_order_relaxed);
+    do {
+        n->next = first;
+    } while (!head.compare_exchange_weak(first, n, std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+std::optional<PointIndexEl> PillarIndex::nearest(
+    const Vec3d &p, const std::function<bool(const PointIndexEl &)> &filter) const
+{
+    std::optional<PointIndexEl> ret;
+
+    int minx = m_minx.load(), maxx = m_maxx.load();
+    int miny = m_miny.load(), maxy = m_maxy.load();
+    if (minx > maxx || miny > maxy)
+        return ret;
+
+    Vec2i  c      = cell_of(p);
+    double best_d = std::numeric_limits<double>::infinity();
+
+    auto visit = [&](const PointIndexEl &el) {
+        double d = distance(el.first, p);
+        if (d < best_d && (!filter || filter(el))) {
+            best_d = d;
+            ret    = el;
+        }
+    };
+
+    auto visit_cell = [&](int x, int y) {
+        if (x >= minx && x <= maxx && y >= miny && y <= maxy)
+            foreach_in_cell(Vec2i{x, y}, visit);
+    };
+
+    // Walk the rings of cells around the query point. The elements of ring
+    // r + 1 are at least r cell sizes away, so the search can stop as soon
+    // as the best candidate is closer than that.
+    for (int r = 0;; ++r) {
+        if (r == 0) {
+            visit_cell(c.x(), c.y());
+        } else {
+            for (int x = c.x() - r; x <= c.x() + r; ++x) {
+                visit_cell(x, c.y() - r);
+                visit_cell(x, c.y() + r);
+            }
+            for (int y = c.y() - r + 1; y <= c.y() + r - 1; ++y) {
+                visit_cell(c.x() - r, y);
+                visit_cell(c.x() + r, y);
+            }
+        }
+
+        bool covers_all = c.x() - r <= minx && c.x() + r >= maxx &&
+                          c.y() - r <= miny && c.y() + r >= maxy;
+
+        if (covers_all || best_d <= r * m_cell_size)
+            break;
+    }
+
+    return ret;
+}
+
+std::vector<PointIndexEl> PillarIndex::query(const Vec3d &p, double radius) const
+{
+    std::vector<PointIndexEl> ret;
+
+    Vec2i from = cell_of(p - Vec3d{radius, radius, 0.});
+    Vec2i to   = cell_of(p + Vec3d{radius, radius, 0.});
+
+    from.x() = std::max(from.x(), m_minx.load());
+    from.y() = std::max(from.y(), m_miny.load());
+    to.x()   = std::min(to.x(), m_maxx.load());
+    to.y()   = std::min(to.y(), m_maxy.load());
+
+    for (int x = from.x(); x <= to.x(); ++x)
+        for (int y = from.y(); y <= to.y(); ++y)
+            foreach_in_cell(Vec2i{x, y}, [&](const PointIndexEl &el) {
+                if (distance(el.first, p) < radius)
+                    ret.emplace_back(el);
+            });
+
+    return ret;
+}
+
 DefaultSupportTree::DefaultSupportTree(SupportTreeBuilder &   builder,
                                      const SupportableMesh &sm)
     : m_sm(sm)
@@ -25,6 +141,7 @@ DefaultSupportTree::DefaultSupportTree(SupportTreeBuilder &   builder,
     , m_builder(builder)
     , m_points(sm.pts.size(), 3)
     , m_thr(builder.ctl().cancelfn)
+    , m_pillar_index(sm.cfg.max_pillar_link_distance_mm)
 {
     // Prepare the support points in Eigen/IGL format as well, we will use
     // it mostly in this form.
@@ -326,20 +443,19 @@ bool DefaultSupportTree::connect_to_nearpillar(const Head &head,
        // Cannot insert the bridge. (further search might not worth the hassle)
     if(t < distance(bridgestart, bridgeend)) return false;
 
-    std::lock_guard lk(m_bridge_mutex);
-
-    if (m_builder.bridgecount(nearpillar()) < m_sm.cfg.max_bridges_on_pillar) {
-        // A partial pillar is needed under the starting head.
-        if(zdiff > 0) {
-            m_builder.add_pillar(head.id, headjp.z() - bridgestart.z());
-            m_builder.add_junction(bridgestart, r);
-            m_builder.add_bridge(bridgestart, bridgeend, r);
-        } else {
-            m_builder.add_bridge(head.id, bridgeend);
-        }
+    // Reserve a slot on the pillar first, the counting is atomic so
+    // concurrent heads will never exceed the limit.
+    if (!m_builder.increment_bridges(nearpillar(), m_sm.cfg.max_bridges_on_pillar))
+        return false;
 
-        m_builder.increment_bridges(nearpillar());
-    } else return false;
+    // A partial pillar is needed under the starting head.
+    if(zdiff > 0) {
+        m_builder.add_pillar(head.id, headjp.z() - bridgestart.z());
+        m_builder.add_junction(bridgestart, r);
+        m_builder.add_bridge(bridgestart, bridgeend, r);
+    } else {
+        m_builder.add_bridge(head.id, bridgeend);
+    }
 
     return true;
 }
@@ -358,8 +474,8 @@ bool DefaultSupportTree::create_ground_pillar(const Junction &hjp,
                                                       head_id);
 
     if (pillar_id >= 0) // Save the pillar endpoint in the spatial index
-        m_pillar_index.guarded_insert(m_builder.pillar(pillar_id).endpt,
-                                      unsigned(pillar_id));
+        m_pillar_index.insert(m_builder.pillar(pillar_id).endpt,
+                              unsigned(pillar_id));
 
     return ret;
 }
@@ -609,9 +725,9 @@ void DefaultSupportTree::routing_to_ground()
 
         auto cidx = cl_centroids[ci++];
 
-        auto q = m_pillar_index.query(m_builder.head(cidx).junction_point(), 1);
-        if (!q.empty()) {
-            long centerpillarID = q.front().second;
+        auto q = m_pillar_index.nearest(m_builder.head(cidx).junction_point());
+        if (q) {
+            long centerpillarID = q->second;
             for (auto c : cl) {
                 m_thr();
                 if (c == cidx) continue;
@@ -640,8 +756,8 @@ bool DefaultSupportTree::connect_to_ground(Head &head)
 
     if (pillar_id >= 0) {
         // Save the pillar endpoint in the spatial index
-        m_pillar_index.guarded_insert(m_builder.pillar(pillar_id).endpt,
-                                      unsigned(pillar_id));
+        m_pillar_index.insert(m_builder.pillar(pillar_id).endpt,
+                              unsigned(pillar_id));
 
         head.pillar_id = pillar_id;
     }
@@ -697,40 +813,42 @@ bool DefaultSupportTree::connect_to_model_body(Head &head)
     m_builder.add_anchor(head.r_back_mm, head.r_pin_mm, w,
                          m_sm.cfg.head_penetration_mm, taildir, hitp);
 
-    m_pillar_index.guarded_insert(pill.endpoint(), pill.id);
+    m_pillar_index.insert(pill.endpoint(), unsigned(pill.id));
 
     return true;
 }
 
 bool DefaultSupportTree::search_pillar_and_connect(const Head &source)
 {
-    // Hope that a local copy takes less time than the whole search loop.
-    // We also need to remove elements progressively from the copied index.
-    PointIndex spindex = m_pillar_index.guarded_clone();
+    // The pillars which turned out to be unsuitable are skipped in the
+    // following searches instead of being removed from a copy of the index.
+    std::vector<unsigned> rejected;
+    auto not_rejected = [&rejected](const PointIndexEl &e) {
+        return std::find(rejected.begin(), rejected.end(), e.second) == rejected.end();
+    };
 
     long nearest_id = SupportTreeNode::ID_UNSET;
 
     Vec3d querypt = source.junction_point();
 
-    while(nearest_id < 0 && !spindex.empty()) { m_thr();
+    while(nearest_id < 0) { m_thr();
         // loop until a suitable head is not found
         // if there is a pillar closer than the cluster center
         // (this may happen as the clustering is not perfect)
         // than we will bridge to this closer pillar
 
         Vec3d qp(querypt.x(), querypt.y(), ground_level(m_sm));
-        auto qres = spindex.nearest(qp, 1);
-        if(qres.empty()) break;
+        auto ne = m_pillar_index.nearest(qp, not_rejected);
+        if(!ne) break;
 
-        auto ne = qres.front();
-        nearest_id = ne.second;
+        nearest_id = ne->second;
 
         if(nearest_id >= 0) {
             if (size_t(nearest_id) < m_builder.pillarcount()) {
                 if(!connect_to_nearpillar(source, nearest_id) ||
                     m_builder.pillar(nearest_id).r_start < source.r_back_mm) {
                     nearest_id = SupportTreeNode::ID_UNSET;    // continue searching
-                    spindex.remove(ne);       // without the current pillar
+                    rejected.emplace_back(ne->second);      // without the current pillar
                 }
             }
         }
@@ -809,9 +927,7 @@ void DefaultSupportTree::interconnect_pillars()
 
         double max_d = d * pillar.r_start / m_sm.cfg.head_back_radius_mm;
         // Query all remaining points within reach
-        auto qres = m_pillar_index.query([qp, max_d](const PointIndexEl& e){
-            return distance(e.first, qp) < max_d;
-        });
+        auto qres = m_pillar_index.query(qp, max_d);
 
         // sort the result by distance (have to check if this is needed)
         std::sort(qres.begin(), qres.end(),
@@ -888,7 +1004,7 @@ void DefaultSupportTree::interconnect_pillars()
             needpillars = 1;
         }
 
-        needpillars = std::max(pillar().links, needpillars) - pillar().links;
+        needpillars = std::max(unsigned(pillar().links), needpillars) - pillar().links;
         if (needpillars == 0) continue;
 
         // Search for new pillar locations:
@@ -10,53 +10,81 @@
 #include <libslic3r/SLA/SpatIndex.hpp>
 #include <libslic3r/Execution/ExecutionTBB.hpp>
 
+#include <atomic>
+#include <optional>
+
+#include <tbb/concurrent_vector.h>
+
 namespace Slic3r { namespace sla {
 
 inline constexpr const auto &suptree_ex_policy = ex_tbb;
 
+// Spatial index of the pillar endpoints which can be searched and extended
+// from multiple threads without locking. The points are hashed into a grid of
+// columns in the XY plane and every grid cell is a lock-free singly linked
+// list of its elements. The list nodes live in an arena and are never
+// removed, thus readers can walk the lists while new nodes are pushed.
 class PillarIndex {
-    PointIndex m_index;
-    using Mutex = execution::BlockingMutex<decltype(suptree_ex_policy)>;
-    mutable Mutex m_mutex;
+    struct Node {
+        PointIndexEl el;
+        const Node  *next = nullptr;
+    };
 
-public:
+    // Number of hash buckets for the grid cells, must be a power of two
+    static constexpr size_t BucketCount = 4096;
 
-    template<class...Args> inline void guarded_insert(Args&&...args)
-    {
-        std::lock_guard<Mutex> lck(m_mutex);
-        m_index.insert(std::forward<Args>(args)...);
-    }
+    double m_cell_size;
 
-    template<class...Args>
-    inline std::vector<PointIndexEl> guarded_query(Args&&...args) const
-    {
-        std::lock_guard<Mutex> lck(m_mutex);
-        return m_index.query(std::forward<Args>(args)...);
-    }
+    tbb::concurrent_vector<Node> m_nodes;
+    std::unique_ptr<std::atomic<const Node *>[]> m_buckets;
+
+    // Range of the occupied cells, the searches never leave this area.
+    std::atomic<int> m_minx, m_miny, m_maxx, m_maxy;
 
-    template<class...Args> inline void insert(Args&&...args)
+    Vec2i cell_of(const Vec3d &p) const
     {
-        m_index.insert(std::forward<Args>(args)...);
+        return {int(std::floor(p.x() / m_cell_size)),
+                int(std::floor(p.y() / m_cell_size))};
     }
 
-    template<class...Args>
-    inline std::vector<PointIndexEl> query(Args&&...args) const
+    const Node *bucket(const Vec2i &c) const
     {
-        return m_index.query(std::forward<Args>(args)...);
+        size_t h = (size_t(c.x()) * 73856093u) ^ (size_t(c.y()) * 19349663u);
+        return m_buckets[h & (BucketCount - 1)].load(std::memory_order_acquire);
     }
 
-    template<class Fn> inline void foreach(Fn fn) { m_index.foreach(fn); }
-    template<class Fn> inline void guarded_foreach(Fn fn)
+    template<class Fn> void foreach_in_cell(const Vec2i &c, Fn &&fn) const
     {
-        std::lock_guard<Mutex> lck(m_mutex);
-        m_index.foreach(fn);
+        // Different cells may share a bucket, skip the foreign elements.
+        for (const Node *n = bucket(c); n; n = n->next)
+            if (cell_of(n->el.first) == c)
+                fn(n->el);
     }
 
-    PointIndex guarded_clone()
+public:
+    // The cell size should be in the order of the typical search distance.
+    explicit PillarIndex(double cell_size = 10.);
+
+    void insert(const Vec3d &p, unsigned id);
+
+    // Nearest element to p for which the filter returns true.
+    std::optional<PointIndexEl> nearest(
+        const Vec3d &p,
+        const std::function<bool(const PointIndexEl &)> &filter = {}) const;
+
+    // All the elements closer than radius to p.
+    std::vector<PointIndexEl> query(const Vec3d &p, double radius) const;
+
+    // Visit the elements in insertion order. Must not be called
+    // concurrently with insert().
+    template<class Fn> void foreach(Fn &&fn) const
     {
-        std::lock_guard<Mutex> lck(m_mutex);
-        return m_index;
+        for (const Node &n : m_nodes)
+            fn(n.el);
     }
+
+    size_t size() const { return m_nodes.size(); }
+    bool empty() const { return m_nodes.empty(); }
 };
 
 class DefaultSupportTree {
@@ -90,9 +118,6 @@ class DefaultSupportTree {
     // A spatial index to easily find strong pillars to connect to.
     PillarIndex m_pillar_index;
 
-    // When bridging heads to pillars... TODO: find a cleaner solution
-    execution::BlockingMutex<ExecutionTBB> m_bridge_mutex;
-
     inline AABBMesh::hit_result ray_mesh_intersect(const Vec3d& s,
                                                       const Vec3d& dir)
     {
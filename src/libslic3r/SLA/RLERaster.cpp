@@ -0,0 +1,283 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "RLERaster.hpp"
+
+#include <algorithm>
+
+#include <agg/agg_renderer_scanline.h>
+
+#include <miniz.h>
+
+namespace Slic3r { namespace sla {
+
+namespace {
+
+// Same blending as agg::pixfmt_gray8 does for a white opaque foreground
+inline uint8_t blend(uint8_t px, uint8_t cover)
+{
+    if (cover == agg::cover_mask)
+        return 255;
+
+    return agg::gray8::lerp(px, 255, agg::gray8::mult_cover(255, cover));
+}
+
+// Append a run to a row, joining it with the previous one if possible.
+// Black runs are not stored.
+inline void push_run(RasterGrayscaleRLE::Row &row, uint32_t x, uint32_t len, uint8_t value)
+{
+    if (len == 0 || value == 0)
+        return;
+
+    if (!row.empty() && row.back().value == value &&
+        row.back().x + row.back().len == x)
+        row.back().len += len;
+    else
+        row.push_back({x, len, value});
+}
+
+} // namespace
+
+class RLEScanlineRenderer {
+    RasterGrayscaleRLE &m_rst;
+
+public:
+    explicit RLEScanlineRenderer(RasterGrayscaleRLE &rst) : m_rst{rst} {}
+
+    void prepare() {}
+
+    template<class Scanline> void render(const Scanline &sl)
+    {
+        m_rst.render_scanline(sl);
+    }
+};
+
+agg::path_storage RasterGrayscaleRLE::to_path(const Polygon &poly) const
+{
+    agg::path_storage path;
+
+    auto px = [this](const Point &p) { return p.x() * m_pxdim_scaled.w_mm; };
+    auto py = [this](const Point &p) { return p.y() * m_pxdim_scaled.h_mm; };
+    auto vertex = [this, &px, &py](const Point &p) {
+        return m_trafo.flipXY ? Vec2d{py(p), px(p)} : Vec2d{px(p), py(p)};
+    };
+
+    const Points &pts = poly.points;
+    Vec2d v = vertex(pts.front());
+    path.move_to(v.x(), v.y());
+    for (size_t i = 1; i < pts.size(); ++i) {
+        v = vertex(pts[i]);
+        path.line_to(v.x(), v.y());
+    }
+    v = vertex(pts.front());
+    path.line_to(v.x(), v.y());
+
+    path.translate_all_paths(m_trafo.center_x * m_pxdim_scaled.w_mm,
+                             m_trafo.center_y * m_pxdim_scaled.h_mm);
+
+    if (m_trafo.mirror_x) path.flip_x(0, double(m_resolution.width_px));
+    if (m_trafo.mirror_y) path.flip_y(0, double(m_resolution.height_px));
+
+    return path;
+}
+
+template<class Scanline>
+void RasterGrayscaleRLE::render_scanline(const Scanline &sl)
+{
+    int y = sl.y();
+    if (y < 0 || y >= int(m_resolution.height_px))
+        return;
+
+    const int xmax = int(m_resolution.width_px);
+
+    // Collect the coverage of this scanline as runs clipped to the raster,
+    // the value of a run is the coverage here, not the pixel value.
+    m_spans.clear();
+    unsigned num_spans = sl.num_spans();
+    auto     span      = sl.begin();
+    for (;;) {
+        int x = span->x;
+        if (span->len > 0) {
+            const auto *covers = span->covers;
+            for (int i = 0; i < span->len; ++i)
+                if (x + i >= 0 && x + i < xmax)
+                    push_run(m_spans, uint32_t(x + i), 1, covers[i]);
+        } else {
+            int from = std::max(x, 0), to = std::min(x - span->len, xmax);
+            if (from < to)
+                push_run(m_spans, uint32_t(from), uint32_t(to - from), *(span->covers));
+        }
+
+        if (--num_spans == 0) break;
+        ++span;
+    }
+
+    merge_spans(m_rows[size_t(y)]);
+}
+
+// Blend the coverage runs in m_spans into the row. Both are sorted and
+// non-overlapping, so this is a linear merge.
+void RasterGrayscaleRLE::merge_spans(Row &row)
+{
+    if (m_spans.empty())
+        return;
+
+    m_merged.clear();
+    m_merged.reserve(row.size() + m_spans.size());
+
+    size_t i = 0, j = 0;
+    Run    a = i < row.size() ? row[i] : Run{};
+    Run    b = m_spans[j];
+
+    auto next_a = [&] { a = ++i < row.size() ? row[i] : Run{}; };
+    auto next_b = [&] { b = ++j < m_spans.size() ? m_spans[j] : Run{}; };
+
+    while (a.len > 0 || b.len > 0) {
+        if (b.len == 0 || (a.len > 0 && a.x + a.len <= b.x)) {
+            push_run(m_merged, a.x, a.len, a.value);
+            next_a();
+        } else if (a.len == 0 || b.x + b.len <= a.x) {
+            push_run(m_merged, b.x, b.len, blend(0, b.value));
+            next_b();
+        } else if (a.x < b.x) {
+            uint32_t l = b.x - a.x;
+            push_run(m_merged, a.x, l, a.value);
+            a.x += l; a.len -= l;
+        } else if (b.x < a.x) {
+            uint32_t l = a.x - b.x;
+            push_run(m_merged, b.x, l, blend(0, b.value));
+            b.x += l; b.len -= l;
+        } else {
+            uint32_t l = std::min(a.len, b.len);
+            push_run(m_merged, a.x, l, blend(a.value, b.value));
+            a.x += l; a.len -= l;
+            b.x += l; b.len -= l;
+            if (a.len == 0) next_a();
+            if (b.len == 0) next_b();
+        }
+    }
+
+    row.swap(m_merged);
+}
+
+void RasterGrayscaleRLE::draw(const ExPolygon &poly)
+{
+    if (poly.contour.empty())
+        return;
+
+    m_rasterizer.reset();
+
+    m_rasterizer.add_path(to_path(poly.contour));
+    for (const Polygon &h : poly.holes)
+        if (!h.empty())
+            m_rasterizer.add_path(to_path(h));
+
+    RLEScanlineRenderer renderer{*this};
+    agg::render_scanlines(m_rasterizer, m_scanlines, renderer);
+}
+
+uint8_t RasterGrayscaleRLE::read_pixel(size_t col, size_t row) const
+{
+    const Row &r  = m_rows[row];
+    auto       it = std::upper_bound(r.begin(), r.end(), col,
+                                     [](size_t c, const Run &run) { return c < run.x; });
+
+    if (it == r.begin())
+        return 0;
+
+    --it;
+    return col < size_t(it->x) + it->len ? it->value : 0;
+}
+
+void RasterGrayscaleRLE::read_row(size_t row, uint8_t *dst) const
+{
+    std::fill(dst, dst + m_resolution.width_px, 0);
+    for (const Run &run : m_rows[row])
+        std::fill(dst + run.x, dst + run.x + run.len, run.value);
+}
+
+void RasterGrayscaleRLE::clear()
+{
+    for (Row &r : m_rows)
+        r = {};
+}
+
+EncodedRaster RasterGrayscaleRLE::encode(RasterEncoder encoder) const
+{
+    if (encoder.target<PNGRasterEncoder>())
+        return encode_png(*this);
+
+    std::vector<uint8_t> buf(m_resolution.pixels());
+    for (size_t r = 0; r < m_resolution.height_px; ++r)
+        read_row(r, buf.data() + r * m_resolution.width_px);
+
+    return encoder(buf.data(), m_resolution.width_px, m_resolution.height_px, 1);
+}
+
+// Produces the same byte stream as tdefl_write_image_to_png_file_in_memory()
+// which is used by PNGRasterEncoder, only the rows are expanded one by one.
+EncodedRaster encode_png(const RasterGrayscaleRLE &rst)
+{
+    static const uint8_t PNG_SIGNATURE_AND_IHDR_LEN[] = {
+        0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d};
+    static const size_t HEADER_SIZE = 41;
+
+    const size_t w = rst.resolution().width_px;
+    const size_t h = rst.resolution().height_px;
+
+    std::vector<uint8_t> buf(HEADER_SIZE, 0);
+
+    auto putter = [](const void *data, int len, void *user) -> mz_bool {
+        auto &out = *static_cast<std::vector<uint8_t> *>(user);
+        auto  ptr = static_cast<const uint8_t *>(data);
+        out.insert(out.end(), ptr, ptr + len);
+        return MZ_TRUE;
+    };
+
+    std::unique_ptr<tdefl_compressor, void (*)(tdefl_compressor *)>
+        comp{tdefl_compressor_alloc(), tdefl_compressor_free};
+
+    if (!comp)
+        return EncodedRaster({}, "png");
+
+    tdefl_init(comp.get(), putter, &buf,
+               TDEFL_DEFAULT_MAX_PROBES | TDEFL_WRITE_ZLIB_HEADER);
+
+    std::vector<uint8_t> line(w + 1, 0); // filter type byte + pixels
+    for (size_t r = 0; r < h; ++r) {
+        rst.read_row(r, line.data() + 1);
+        tdefl_compress_buffer(comp.get(), line.data(), line.size(), TDEFL_NO_FLUSH);
+    }
+
+    if (tdefl_compress_buffer(comp.get(), nullptr, 0, TDEFL_FINISH) != TDEFL_STATUS_DONE)
+        return EncodedRaster({}, "png");
+
+    auto put_u32 = [](uint8_t *dst, uint32_t v) {
+        for (int i = 0; i < 4; ++i, v <<= 8)
+            dst[i] = uint8_t(v >> 24);
+    };
+
+    uint32_t idat_len = uint32_t(buf.size() - HEADER_SIZE);
+
+    uint8_t *hdr = buf.data();
+    std::copy(std::begin(PNG_SIGNATURE_AND_IHDR_LEN), std::end(PNG_SIGNATURE_AND_IHDR_LEN), hdr);
+    std::copy_n("IHDR", 4, hdr + 12);
+    put_u32(hdr + 16, uint32_t(w));
+    put_u32(hdr + 20, uint32_t(h));
+    hdr[24] = 8; // bit depth, colour type 0 (greyscale) and the rest is zero
+    put_u32(hdr + 29, uint32_t(mz_crc32(MZ_CRC32_INIT, hdr + 12, 17)));
+    put_u32(hdr + 33, idat_len);
+    std::copy_n("IDAT", 4, hdr + 37);
+
+    size_t idat_crc_pos = buf.size();
+    static const uint8_t FOOTER[] = {0, 0, 0, 0, 0, 0, 0, 0, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82};
+    buf.insert(buf.end(), std::begin(FOOTER), std::end(FOOTER));
+
+    put_u32(buf.data() + idat_crc_pos,
+            uint32_t(mz_crc32(MZ_CRC32_INIT, buf.data() + HEADER_SIZE - 4, idat_len + 4)));
+
+    return EncodedRaster(std::move(buf), "png");
+}
+
+}} // namespace Slic3r::sla
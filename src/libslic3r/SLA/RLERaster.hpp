@@ -0,0 +1,120 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef SLA_RLERASTER_HPP
+#define SLA_RLERASTER_HPP
+
+#include <libslic3r/SLA/RasterBase.hpp>
+#include "libslic3r/ExPolygon.hpp"
+
+#include <agg/agg_basics.h>
+#include <agg/agg_color_gray.h>
+#include <agg/agg_gamma_functions.h>
+#include <agg/agg_rasterizer_scanline_aa.h>
+#include <agg/agg_scanline_p.h>
+#include <agg/agg_path_storage.h>
+
+namespace Slic3r { namespace sla {
+
+/*
+ * Anti-aliased monochrome canvas storing each row as a sorted list of
+ * non-black runs instead of a full framebuffer. Layers of resin printers are
+ * mostly empty, so both the memory and the time needed for encoding scale
+ * with the number of polygon edges and not with the display resolution.
+ *
+ * The polygons are scan converted by the same AGG rasterizer that
+ * RasterGrayscaleAA uses and the coverage values are blended identically,
+ * thus the two rasters produce the very same pixels.
+ */
+class RasterGrayscaleRLE : public RasterBase {
+public:
+    // Horizontal run of pixels of the same (non-zero) value.
+    struct Run {
+        uint32_t x   = 0;
+        uint32_t len = 0;
+        uint8_t  value = 0;
+    };
+
+    using Row = std::vector<Run>;
+
+private:
+    Resolution m_resolution;
+    PixelDim   m_pxdim_scaled; // used for scaled coordinate polygons
+    Trafo      m_trafo;
+
+    std::vector<Row> m_rows;
+
+    agg::rasterizer_scanline_aa<> m_rasterizer;
+    agg::scanline_p8              m_scanlines;
+
+    // Scratch buffers reused for merging the spans of a scanline into a row
+    Row m_spans, m_merged;
+
+    agg::path_storage to_path(const Polygon &poly) const;
+
+    // Interface required by agg::render_scanlines()
+    friend class RLEScanlineRenderer;
+    template<class Scanline> void render_scanline(const Scanline &sl);
+    void merge_spans(Row &row);
+
+public:
+    template<class GammaFn>
+    RasterGrayscaleRLE(const Resolution &res,
+                       const PixelDim   &pd,
+                       const Trafo      &trafo,
+                       GammaFn         &&gammafn)
+        : m_resolution(res)
+        , m_pxdim_scaled(SCALING_FACTOR, SCALING_FACTOR)
+        , m_trafo(trafo)
+        , m_rows(res.height_px)
+    {
+        assert(pd.w_mm != 0 && pd.h_mm != 0);
+        if (pd.w_mm != 0 && pd.h_mm != 0) {
+            m_pxdim_scaled.w_mm /= pd.w_mm;
+            m_pxdim_scaled.h_mm /= pd.h_mm;
+        }
+
+        m_rasterizer.gamma(gammafn);
+    }
+
+    Trafo      trafo() const override { return m_trafo; }
+    Resolution resolution() const { return m_resolution; }
+    PixelDim   pixel_dimensions() const
+    {
+        return {SCALING_FACTOR / m_pxdim_scaled.w_mm,
+                SCALING_FACTOR / m_pxdim_scaled.h_mm};
+    }
+
+    void draw(const ExPolygon &poly) override;
+
+    // PNG images are encoded directly from the runs, one expanded row at a
+    // time. Other encoders get the full framebuffer.
+    EncodedRaster encode(RasterEncoder encoder) const override;
+
+    const Row &row(size_t r) const { return m_rows[r]; }
+
+    uint8_t read_pixel(size_t col, size_t row) const;
+
+    // Expand a single row into a buffer of at least resolution().width_px
+    void read_row(size_t row, uint8_t *dst) const;
+
+    void clear();
+};
+
+class RasterGrayscaleRLEGammaPower : public RasterGrayscaleRLE {
+public:
+    RasterGrayscaleRLEGammaPower(const Resolution        &res,
+                                 const PixelDim          &pd,
+                                 const RasterBase::Trafo &trafo,
+                                 double                   gamma = 1.)
+        : RasterGrayscaleRLE(res, pd, trafo, agg::gamma_power(gamma))
+    {}
+};
+
+// Encode a run-length encoded raster into PNG without materializing it.
+EncodedRaster encode_png(const RasterGrayscaleRLE &rst);
+
+}} // namespace Slic3r::sla
+
+#endif // SLA_RLERASTER_HPP
@@ -10,6 +10,7 @@
 
 #include <libslic3r/SLA/RasterBase.hpp>
 #include <libslic3r/SLA/AGGRaster.hpp>
+#include <libslic3r/SLA/RLERaster.hpp>
 
 // minz image write:
 #include <miniz.h>
@@ -85,6 +86,22 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     return rst;
 }
 
+std::unique_ptr<RasterBase> create_raster_grayscale_rle(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma,
+    const RasterBase::Trafo &tr)
+{
+    std::unique_ptr<RasterBase> rst;
+
+    if (gamma > 0)
+        rst = std::make_unique<RasterGrayscaleRLEGammaPower>(res, pxdim, tr, gamma);
+    else
+        rst = std::make_unique<RasterGrayscaleRLE>(res, pxdim, tr, agg::gamma_threshold(.5));
+
+    return rst;
+}
+
 } // namespace sla
 } // namespace Slic3r
 
@@ -118,6 +118,14 @@ std::unique_ptr<RasterBase> create_raster_grayscale_aa(
     double                   gamma = 1.0,
     const RasterBase::Trafo &tr    = {});
 
+// Same as above but the raster is stored run-length encoded, which is much
+// cheaper for mostly empty layers of large displays.
+std::unique_ptr<RasterBase> create_raster_grayscale_rle(
+    const Resolution        &res,
+    const PixelDim          &pxdim,
+    double                   gamma = 1.0,
+    const RasterBase::Trafo &tr    = {});
+
 }} // namespace Slic3r::sla
 
 #endif // SLARASTERBASE_HPP
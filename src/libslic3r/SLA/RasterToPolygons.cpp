@@ -5,6 +5,7 @@
 #include "RasterToPolygons.hpp"
 
 #include "AGGRaster.hpp"
+#include "RLERaster.hpp"
 #include "libslic3r/MarchingSquares.hpp"
 #include "MTUtils.hpp"
 #include "ClipperUtils.hpp"
@@ -26,6 +27,18 @@ template<> struct _RasterTraits<Slic3r::sla::RasterGrayscaleAA> {
     static size_t cols(const Rst &rst) { return rst.resolution().width_px; }
 };
 
+template<> struct _RasterTraits<Slic3r::sla::RasterGrayscaleRLE> {
+    using Rst = Slic3r::sla::RasterGrayscaleRLE;
+
+    using ValueType = uint8_t;
+
+    // Binary search within the runs of the row
+    static uint8_t get(const Rst &rst, size_t row, size_t col) { return rst.read_pixel(col, row); }
+
+    static size_t rows(const Rst &rst) { return rst.resolution().height_px; }
+    static size_t cols(const Rst &rst) { return rst.resolution().width_px; }
+};
+
 } // namespace Slic3r::marchsq
 
 namespace Slic3r { namespace sla {
@@ -37,8 +50,9 @@ template<class Fn> void foreach_vertex(ExPolygon &poly, Fn &&fn)
         for (auto &p : h.points) fn(p);
 }
 
-ExPolygons raster_to_polygons(const RasterGrayscaleAA &rst, Vec2i windowsize)
-{    
+template<class Raster>
+ExPolygons raster_to_polygons_impl(const Raster &rst, Vec2i windowsize)
+{
     size_t rows = rst.resolution().height_px, cols = rst.resolution().width_px;
     
     if (rows < 2 || cols < 2) return {};
@@ -92,4 +106,14 @@ ExPolygons raster_to_polygons(const RasterGrayscaleAA &rst, Vec2i windowsize)
     return unioned;
 }
 
+ExPolygons raster_to_polygons(const RasterGrayscaleAA &rst, Vec2i windowsize)
+{
+    return raster_to_polygons_impl(rst, windowsize);
+}
+
+ExPolygons raster_to_polygons(const RasterGrayscaleRLE &rst, Vec2i windowsize)
+{
+    return raster_to_polygons_impl(rst, windowsize);
+}
+
 }} // namespace Slic3r
@@ -11,8 +11,10 @@ namespace Slic3r {
 namespace sla {
 
 class RasterGrayscaleAA;
+class RasterGrayscaleRLE;
 
 ExPolygons raster_to_polygons(const RasterGrayscaleAA &rst, Vec2i windowsize = {2, 2});
+ExPolygons raster_to_polygons(const RasterGrayscaleRLE &rst, Vec2i windowsize = {2, 2});
 
 }} // namespace Slic3r::sla
 
@@ -31,7 +31,7 @@ SupportTreeBuilder::SupportTreeBuilder(SupportTreeBuilder &&o)
     , m_bridges{std::move(o.m_bridges)}
     , m_crossbridges{std::move(o.m_crossbridges)}
     , m_meshcache{std::move(o.m_meshcache)}
-    , m_meshcache_valid{o.m_meshcache_valid}
+    , m_meshcache_valid{o.m_meshcache_valid.load()}
     , m_model_height{o.m_model_height}
 {}
 
@@ -42,7 +42,7 @@ SupportTreeBuilder::SupportTreeBuilder(const SupportTreeBuilder &o)
     , m_bridges{o.m_bridges}
     , m_crossbridges{o.m_crossbridges}
     , m_meshcache{o.m_meshcache}
-    , m_meshcache_valid{o.m_meshcache_valid}
+    , m_meshcache_valid{o.m_meshcache_valid.load()}
     , m_model_height{o.m_model_height}
 {}
 
@@ -54,7 +54,7 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(SupportTreeBuilder &&o)
     m_bridges = std::move(o.m_bridges);
     m_crossbridges = std::move(o.m_crossbridges);
     m_meshcache = std::move(o.m_meshcache);
-    m_meshcache_valid = o.m_meshcache_valid;
+    m_meshcache_valid = o.m_meshcache_valid.load();
     m_model_height = o.m_model_height;
     return *this;
 }
@@ -67,21 +67,17 @@ SupportTreeBuilder &SupportTreeBuilder::operator=(const SupportTreeBuilder &o)
     m_bridges = o.m_bridges;
     m_crossbridges = o.m_crossbridges;
     m_meshcache = o.m_meshcache;
-    m_meshcache_valid = o.m_meshcache_valid;
+    m_meshcache_valid = o.m_meshcache_valid.load();
     m_model_height = o.m_model_height;
     return *this;
 }
 
 void SupportTreeBuilder::add_pillar_base(long pid, double baseheight, double radius)
 {
-    std::lock_guard<Mutex> lk(m_mutex);
     assert(pid >= 0 && size_t(pid) < m_pillars.size());
     Pillar& pll = m_pillars[size_t(pid)];
-    m_pedestals.emplace_back(pll.endpt, std::min(baseheight, pll.height),
-                             std::max(radius, pll.r_start), pll.r_start);
-
-    m_pedestals.back().id = m_pedestals.size() - 1;
-    m_meshcache_valid = false;
+    _add(m_pedestals, pll.endpt, std::min(baseheight, pll.height),
+         std::max(radius, pll.r_start), pll.r_start);
 }
 
 const indexed_triangle_set &SupportTreeBuilder::merged_mesh(size_t steps) const
@@ -155,6 +151,7 @@ const indexed_triangle_set &SupportTreeBuilder::merge_and_cleanup()
     auto &ret = merged_mesh(); 
     
     // Doing clear() does not garantee to release the memory.
+    auto clear_and_shrink = [](auto &arena) { arena.clear(); arena.shrink_to_fit(); };
     clear_and_shrink(m_heads);
     clear_and_shrink(m_head_indices);
     clear_and_shrink(m_pillars);
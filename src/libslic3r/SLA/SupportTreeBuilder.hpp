@@ -11,6 +11,10 @@
 #include <libslic3r/SLA/Pad.hpp>
 #include <libslic3r/MTUtils.hpp>
 
+#include <atomic>
+
+#include <tbb/concurrent_vector.h>
+
 namespace Slic3r {
 namespace sla {
 
@@ -64,6 +68,38 @@ T distance(const Vec<I, T>& pp1, const Vec<I, T>& pp2) {
 
 const Vec3d DOWN = {0.0, 0.0, -1.0};
 
+// A counter which can be incremented from multiple threads while the
+// element holding it remains copyable.
+class AtomicCounter {
+    std::atomic<unsigned> m_val{0};
+
+public:
+    AtomicCounter() = default;
+    AtomicCounter(const AtomicCounter &o) : m_val{o.m_val.load()} {}
+    AtomicCounter &operator=(const AtomicCounter &o)
+    {
+        m_val.store(o.m_val.load());
+        return *this;
+    }
+
+    operator unsigned() const { return m_val.load(); }
+
+    unsigned operator++() { return ++m_val; }
+    unsigned operator++(int) { return m_val++; }
+
+    // Increment only if the current value is below max. Returns true if
+    // the increment took place.
+    bool increment_below(unsigned max)
+    {
+        unsigned v = m_val.load();
+        while (v < max)
+            if (m_val.compare_exchange_weak(v, v + 1))
+                return true;
+
+        return false;
+    }
+};
+
 struct SupportTreeNode
 {
     static const constexpr long ID_UNSET = -1;
@@ -141,10 +177,10 @@ struct Pillar: public SupportTreeNode {
     long start_junction_id = ID_UNSET;
     
     // How many bridges are connected to this pillar
-    unsigned bridges = 0;
+    AtomicCounter bridges;
     
     // How many pillars are cascaded with this one
-    unsigned links = 0;
+    AtomicCounter links;
 
     Pillar(const Vec3d &endp, double h, double start_radius, double end_radius)
         : height{h}
@@ -219,34 +255,36 @@ struct DiffBridge: public Bridge {
 // basically indices into the arrays of the appropriate type (heads, pillars,
 // etc...). One can later query e.g. a pillar for a specific head...
 class SupportTreeBuilder {
+    // The elements are stored in concurrent vectors so that the support
+    // tree algorithms can add them from multiple threads without locking.
+    // References to the stored elements remain valid while the containers
+    // grow.
+    template<class T> using Arena = tbb::concurrent_vector<T>;
+
     // For heads it is beneficial to use the same IDs as for the support points.
-    std::vector<Head>       m_heads;
-    std::vector<size_t>     m_head_indices;
-    std::vector<Pillar>     m_pillars;
-    std::vector<Junction>   m_junctions;
-    std::vector<Bridge>     m_bridges;
-    std::vector<Bridge>     m_crossbridges;
-    std::vector<DiffBridge> m_diffbridges;
-    std::vector<Pedestal>   m_pedestals;
-    std::vector<Anchor>     m_anchors;
+    Arena<Head>       m_heads;
+    Arena<size_t>     m_head_indices;
+    Arena<Pillar>     m_pillars;
+    Arena<Junction>   m_junctions;
+    Arena<Bridge>     m_bridges;
+    Arena<Bridge>     m_crossbridges;
+    Arena<DiffBridge> m_diffbridges;
+    Arena<Pedestal>   m_pedestals;
+    Arena<Anchor>     m_anchors;
 
     JobController m_ctl;
     
-    using Mutex = tbb::spin_mutex;
-    
     mutable indexed_triangle_set m_meshcache;
-    mutable Mutex m_mutex;
-    mutable bool m_meshcache_valid = false;
+    mutable std::atomic<bool> m_meshcache_valid{false};
     mutable double m_model_height = 0; // the full height of the model
     
-    template<class BridgeT, class...Args>
-    const BridgeT& _add_bridge(std::vector<BridgeT> &br, Args&&... args)
+    template<class T, class...Args>
+    T& _add(Arena<T> &arena, Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        br.emplace_back(std::forward<Args>(args)...);
-        br.back().id = long(br.size() - 1);
+        auto it = arena.emplace_back(std::forward<Args>(args)...);
+        it->id = long(it - arena.begin());
         m_meshcache_valid = false;
-        return br.back();
+        return *it;
     }
     
 public:
@@ -261,36 +299,28 @@ public:
 
     template<class...Args> Head& add_head(unsigned id, Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_heads.emplace_back(std::forward<Args>(args)...);
-        m_heads.back().id = id;
+        auto it = m_heads.emplace_back(std::forward<Args>(args)...);
+        it->id = id;
         
-        if (id >= m_head_indices.size()) m_head_indices.resize(id + 1);
-        m_head_indices[id] = m_heads.size() - 1;
+        m_head_indices.grow_to_at_least(id + 1);
+        m_head_indices[id] = size_t(it - m_heads.begin());
         
         m_meshcache_valid = false;
-        return m_heads.back();
+        return *it;
     }
     
     long add_pillar(long headid, double length)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        if (m_pillars.capacity() < m_heads.size())
-            m_pillars.reserve(m_heads.size() * 10);
-        
         assert(headid >= 0 && size_t(headid) < m_head_indices.size());
         Head &head = m_heads[m_head_indices[size_t(headid)]];
         
         Vec3d hjp = head.junction_point() - Vec3d{0, 0, length};
-        m_pillars.emplace_back(hjp, length, head.r_back_mm);
+        Pillar &pillar = _add(m_pillars, hjp, length, head.r_back_mm);
 
-        Pillar& pillar = m_pillars.back();
-        pillar.id = long(m_pillars.size() - 1);
         head.pillar_id = pillar.id;
         pillar.start_junction_id = head.id;
         pillar.starts_from_head = true;
         
-        m_meshcache_valid = false;
         return pillar.id;
     }
     
@@ -298,25 +328,30 @@ public:
 
     template<class...Args> const Anchor& add_anchor(Args&&...args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_anchors.emplace_back(std::forward<Args>(args)...);
-        m_anchors.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
-        return m_anchors.back();
+        return _add(m_anchors, std::forward<Args>(args)...);
     }
     
     void increment_bridges(const Pillar& pillar)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         
         if(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size())
             m_pillars[size_t(pillar.id)].bridges++;
     }
     
+    // Count a new bridge on the pillar only if it has less than max bridges.
+    // The check and the increment is a single atomic step, so concurrent
+    // callers can not exceed the limit.
+    bool increment_bridges(const Pillar& pillar, unsigned max)
+    {
+        assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
+        
+        return pillar.id >= 0 && size_t(pillar.id) < m_pillars.size() &&
+               m_pillars[size_t(pillar.id)].bridges.increment_below(max);
+    }
+    
     void increment_links(const Pillar& pillar)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         
         if(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size()) 
@@ -324,66 +359,50 @@ public:
     }
     
     unsigned bridgecount(const Pillar &pillar) const {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(pillar.id >= 0 && size_t(pillar.id) < m_pillars.size());
         return pillar.bridges;
     }
     
     template<class...Args> long add_pillar(Args&&...args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        if (m_pillars.capacity() < m_heads.size())
-            m_pillars.reserve(m_heads.size() * 10);
-        
-        m_pillars.emplace_back(std::forward<Args>(args)...);
-        Pillar& pillar = m_pillars.back();
-        pillar.id = long(m_pillars.size() - 1);
+        Pillar &pillar = _add(m_pillars, std::forward<Args>(args)...);
         pillar.starts_from_head = false;
-        m_meshcache_valid = false;
         return pillar.id;
     }
     
     template<class...Args> const Junction& add_junction(Args&&... args)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
-        m_junctions.emplace_back(std::forward<Args>(args)...);
-        m_junctions.back().id = long(m_junctions.size() - 1);
-        m_meshcache_valid = false;
-        return m_junctions.back();
+        return _add(m_junctions, std::forward<Args>(args)...);
     }
     
     const Bridge& add_bridge(const Vec3d &s, const Vec3d &e, double r)
     {
-        return _add_bridge(m_bridges, s, e, r);
+        return _add(m_bridges, s, e, r);
     }
     
     const Bridge& add_bridge(long headid, const Vec3d &endp)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(headid >= 0 && size_t(headid) < m_head_indices.size());
         
         Head &h = m_heads[m_head_indices[size_t(headid)]];
-        m_bridges.emplace_back(h.junction_point(), endp, h.r_back_mm);
-        m_bridges.back().id = long(m_bridges.size() - 1);
+        const Bridge &br = _add(m_bridges, h.junction_point(), endp, h.r_back_mm);
         
-        h.bridge_id = m_bridges.back().id;
-        m_meshcache_valid = false;
-        return m_bridges.back();
+        h.bridge_id = br.id;
+        return br;
     }
     
     template<class...Args> const Bridge& add_crossbridge(Args&&... args)
     {
-        return _add_bridge(m_crossbridges, std::forward<Args>(args)...);
+        return _add(m_crossbridges, std::forward<Args>(args)...);
     }
 
     template<class...Args> const DiffBridge& add_diffbridge(Args&&... args)
     {
-        return _add_bridge(m_diffbridges, std::forward<Args>(args)...);
+        return _add(m_diffbridges, std::forward<Args>(args)...);
     }
     
     Head &head(unsigned id)
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id < m_head_indices.size());
         
         m_meshcache_valid = false;
@@ -391,18 +410,16 @@ public:
     }
     
     inline size_t pillarcount() const {
-        std::lock_guard<Mutex> lk(m_mutex);
         return m_pillars.size();
     }
     
-    inline const std::vector<Pillar> &pillars() const { return m_pillars; }
-    inline const std::vector<Head>   &heads() const { return m_heads; }
-    inline const std::vector<Bridge> &bridges() const { return m_bridges; }
-    inline const std::vector<Bridge> &crossbridges() const { return m_crossbridges; }
+    inline const Arena<Pillar> &pillars() const { return m_pillars; }
+    inline const Arena<Head>   &heads() const { return m_heads; }
+    inline const Arena<Bridge> &bridges() const { return m_bridges; }
+    inline const Arena<Bridge> &crossbridges() const { return m_crossbridges; }
     
     template<class T> inline IntegerOnly<T, const Pillar&> pillar(T id) const
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id >= 0 && size_t(id) < m_pillars.size() &&
                size_t(id) < std::numeric_limits<size_t>::max());
         
@@ -411,7 +428,6 @@ public:
     
     template<class T> inline IntegerOnly<T, Pillar&> pillar(T id) 
     {
-        std::lock_guard<Mutex> lk(m_mutex);
         assert(id >= 0 && size_t(id) < m_pillars.size() &&
                size_t(id) < std::numeric_limits<size_t>::max());
         
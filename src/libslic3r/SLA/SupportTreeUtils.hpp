@@ -107,6 +107,38 @@ template<class It> Hit min_hit(It from, It to)
     return *mit;
 }
 
+// Maximum number of rays the AABBMesh traverses together.
+constexpr size_t RAY_PACKET_SIZE = 8;
+
+// Cast a batch of n rays on the mesh. The rays are split into packets of at
+// most RAY_PACKET_SIZE rays, but into at least as many packets as the
+// execution policy runs in parallel. Thus a beam of a few rays is cast ray by
+// ray in parallel, it is cast as a single packet only by a sequential policy.
+template<class Ex>
+void cast_rays(Ex              policy,
+               const AABBMesh &mesh,
+               const Vec3d    *src,
+               const Vec3d    *dir,
+               size_t          n,
+               Hit            *out)
+{
+    size_t concurrency = std::max(execution::max_concurrency(policy), size_t(1));
+    size_t packet_size = std::clamp((n + concurrency - 1) / concurrency, size_t(1), RAY_PACKET_SIZE);
+    size_t packets     = (n + packet_size - 1) / packet_size;
+
+    execution::for_each(
+        policy, size_t(0), packets,
+        [&mesh, src, dir, n, out, packet_size](size_t p) {
+            size_t from = p * packet_size;
+            size_t cnt  = std::min(packet_size, n - from);
+            if (cnt == 1)
+                out[from] = mesh.query_ray_hit(src[from], dir[from]);
+            else
+                mesh.query_ray_hit(src + from, dir + from, cnt, out + from);
+        },
+        std::min(concurrency, packets));
+}
+
 inline StopCriteria get_criteria(const SupportTreeConfig &cfg)
 {
     return StopCriteria{}
@@ -166,29 +198,40 @@ Hit beam_mesh_hit(Ex policy,
     // Hit results
     std::array<Hit, RayCount> hits;
 
-    execution::for_each(
-        policy, size_t(0), hits.size(),
-        [&mesh, r_src, r_dst, src, dst, &ring, dir, sd, &hits](size_t i) {
-            Hit &hit = hits[i];
-
-            // Point on the circle on the pin sphere
-            Vec3d p_src = ring.get(i, src, r_src + sd);
-            Vec3d p_dst = ring.get(i, dst, r_dst + sd);
-            Vec3d raydir = (p_dst - p_src).normalized();
-
-            auto hr = mesh.query_ray_hit(p_src + r_src * raydir, raydir);
-
-            if (hr.is_inside()) {
-                if (hr.distance() > 2 * r_src + sd)
-                    hit = Hit(0.0);
-                else {
-                    // re-cast the ray from the outside of the object
-                    auto q = p_src + (hr.distance() + EPSILON) * raydir;
-                    hit = mesh.query_ray_hit(q, raydir);
-                }
-            } else
-                hit = hr;
-        }, std::min(execution::max_concurrency(policy), RayCount));
+    std::array<Vec3d, RayCount> p_srcs, raydirs, sources;
+    for (size_t i = 0; i < RayCount; ++i) {
+        // Point on the circle on the pin sphere
+        p_srcs[i]  = ring.get(i, src, r_src + sd);
+        Vec3d p_dst = ring.get(i, dst, r_dst + sd);
+        raydirs[i] = (p_dst - p_srcs[i]).normalized();
+        sources[i] = p_srcs[i] + r_src * raydirs[i];
+    }
+
+    cast_rays(policy, mesh, sources.data(), raydirs.data(), RayCount, hits.data());
+
+    // Rays starting inside the object are either invalidated or re-cast
+    // from the outside of the object.
+    std::array<size_t, RayCount> recast_idx;
+    size_t recast_cnt = 0;
+    for (size_t i = 0; i < RayCount; ++i) {
+        const Hit &hr = hits[i];
+        if (hr.is_inside()) {
+            if (hr.distance() > 2 * r_src + sd)
+                hits[i] = Hit(0.0);
+            else {
+                sources[recast_cnt]      = p_srcs[i] + (hr.distance() + EPSILON) * raydirs[i];
+                raydirs[recast_cnt]      = raydirs[i];
+                recast_idx[recast_cnt++] = i;
+            }
+        }
+    }
+
+    if (recast_cnt > 0) {
+        std::array<Hit, RayCount> recast_hits;
+        cast_rays(policy, mesh, sources.data(), raydirs.data(), recast_cnt, recast_hits.data());
+        for (size_t k = 0; k < recast_cnt; ++k)
+            hits[recast_idx[k]] = recast_hits[k];
+    }
 
     return min_hit(hits.begin(), hits.end());
 }
@@ -233,48 +276,58 @@ Hit pinhead_mesh_hit(Ex              ex,
     // of the pinhead robe (side) surface. The result will be the smallest
     // hit distance.
 
-    execution::for_each(
-        ex, size_t(0), hits.size(), [&m, &rings, sd, &hits](size_t i) {
-            // Point on the circle on the pin sphere
-            Vec3d ps = rings.pinring(i);
-            // This is the point on the circle on the back sphere
-            Vec3d p = rings.backring(i);
-
-            auto &hit = hits[i];
-
-               // Point ps is not on mesh but can be inside or
-               // outside as well. This would cause many problems
-               // with ray-casting. To detect the position we will
-               // use the ray-casting result (which has an is_inside
-               // predicate).
-
-            Vec3d n = (p - ps).normalized();
-            auto  q = m.query_ray_hit(ps + sd * n, n);
-
-            if (q.is_inside()) { // the hit is inside the model
-                if (q.distance() > rings.rpin) {
-                    // If we are inside the model and the hit
-                    // distance is bigger than our pin circle
-                    // diameter, it probably indicates that the
-                    // support point was already inside the
-                    // model, or there is really no space
-                    // around the point. We will assign a zero
-                    // hit distance to these cases which will
-                    // enforce the function return value to be
-                    // an invalid ray with zero hit distance.
-                    // (see min_element at the end)
-                    hit = HitResult(0.0);
-                } else {
-                    // re-cast the ray from the outside of the
-                    // object. The starting point has an offset
-                    // of 2*safety_distance because the
-                    // original ray has also had an offset
-                    auto q2 = m.query_ray_hit(ps + (q.distance() + 2 * sd) * n, n);
-                    hit     = q2;
-                }
-            } else
-                hit = q;
-        }, std::min(execution::max_concurrency(ex), SAMPLES));
+    std::array<Vec3d, SAMPLES> pss, dirs, sources;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        // Point on the circle on the pin sphere
+        pss[i] = rings.pinring(i);
+        // This is the point on the circle on the back sphere
+        Vec3d p = rings.backring(i);
+
+        dirs[i]    = (p - pss[i]).normalized();
+        sources[i] = pss[i] + sd * dirs[i];
+    }
+
+    // Point ps is not on mesh but can be inside or outside as well. This
+    // would cause many problems with ray-casting. To detect the position we
+    // will use the ray-casting result (which has an is_inside predicate).
+    cast_rays(ex, m, sources.data(), dirs.data(), SAMPLES, hits.data());
+
+    std::array<size_t, SAMPLES> recast_idx;
+    size_t recast_cnt = 0;
+    for (size_t i = 0; i < SAMPLES; ++i) {
+        const HitResult &q = hits[i];
+
+        if (q.is_inside()) { // the hit is inside the model
+            if (q.distance() > rings.rpin) {
+                // If we are inside the model and the hit
+                // distance is bigger than our pin circle
+                // diameter, it probably indicates that the
+                // support point was already inside the
+                // model, or there is really no space
+                // around the point. We will assign a zero
+                // hit distance to these cases which will
+                // enforce the function return value to be
+                // an invalid ray with zero hit distance.
+                // (see min_element at the end)
+                hits[i] = HitResult(0.0);
+            } else {
+                // re-cast the ray from the outside of the
+                // object. The starting point has an offset
+                // of 2*safety_distance because the
+                // original ray has also had an offset
+                sources[recast_cnt]      = pss[i] + (q.distance() + 2 * sd) * dirs[i];
+                dirs[recast_cnt]         = dirs[i];
+                recast_idx[recast_cnt++] = i;
+            }
+        }
+    }
+
+    if (recast_cnt > 0) {
+        std::array<HitResult, SAMPLES> recast_hits;
+        cast_rays(ex, m, sources.data(), dirs.data(), recast_cnt, recast_hits.data());
+        for (size_t k = 0; k < recast_cnt; ++k)
+            hits[recast_idx[k]] = recast_hits[k];
+    }
 
     return min_hit(hits.begin(), hits.end());
 }
@@ -694,9 +694,12 @@ std::string SLAPrint::validate(std::vector<std::string>*) const
 
 void SLAPrint::export_print(const std::string &fname, const ThumbnailsList &thumbnails, const std::string &projectname)
 {
-    if (m_archiver)
+    if (m_archiver) {
+        // A streaming archive rasterizes m_printer_input while exporting, which is only valid while the rasterization step is done.
+        if (m_archiver->is_streaming() && ! this->Inherited::is_step_done(slapsRasterize))
+            throw ExportError(_u8L("The print was changed since it was sliced, it has to be sliced again before exporting."));
         m_archiver->export_print(fname, *this, thumbnails, projectname);
-    else {
+    } else {
         throw ExportError(format(_u8L("Unknown archive format: %s"), m_printer_config.sla_archive_format.value));
     }
 }
@@ -713,6 +716,15 @@ bool SLAPrint::invalidate_step(SLAPrintStep step)
     return invalidated;
 }
 
+void SLAPrint::set_streaming_rasterization(std::optional<bool> streaming)
+{
+    std::scoped_lock<std::mutex> lock(this->state_mutex());
+    if (streaming != m_streaming_rasterization) {
+        m_streaming_rasterization = streaming;
+        this->invalidate_step(slapsRasterize);
+    }
+}
+
 void SLAPrint::process()
 {
     if (m_objects.empty())
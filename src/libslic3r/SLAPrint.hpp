@@ -7,7 +7,9 @@
 #define slic3r_SLAPrint_hpp_
 
 #include <cstdint>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <set>
 
 #include "PrintBase.hpp"
@@ -274,6 +276,9 @@ public:
         return m_slice_index;
     }
 
+    // Voxelized object the interior is generated from, null if the object is not hollowed.
+    const VoxelGrid* hollowing_grid() const { return m_hollowing_grid; }
+
     // Search slice index for the closest slice to given print_level.
     // max_epsilon gives the allowable deviation of the returned slice record's
     // level.
@@ -394,6 +399,16 @@ private:
     };
     
     std::unique_ptr<HollowingData> m_hollowing_data;
+
+    // Signed distance grids of the assembled object by their voxel scale.
+    // generate_interior() takes its resolution from the grid, thus a grid is
+    // only reused for the very same voxel scale. The grids are kept until the
+    // object is assembled again, so that changing the closing distance or
+    // returning to a wall thickness or quality used before only offsets and
+    // remeshes a grid.
+    std::map<double, VoxelGridPtr> m_hollowing_grids;
+    // The grid of m_hollowing_grids the current interior was generated from.
+    const VoxelGrid               *m_hollowing_grid = nullptr;
 };
 
 using PrintObjects = std::vector<SLAPrintObject*>;
@@ -547,6 +562,10 @@ public:
     // TODO: use this structure for the preview in the future.
     const std::vector<PrintLayer>& print_layers() const { return m_printer_input; }
 
+    // Rasterize the layers while the archive is being exported rather than after slicing. Unless forced,
+    // this is decided by the estimated memory taken by the encoded layers. Invalidates the rasterization.
+    void set_streaming_rasterization(std::optional<bool> streaming);
+
     void export_print(const std::string &fname, const std::string &projectname = "")
     {
         ThumbnailsList thumbnails; //empty thumbnail list
@@ -577,6 +596,8 @@ private:
     
     // The archive object which collects the raster images after slicing
     std::unique_ptr<SLAArchiveWriter>     m_archiver;
+    // Streaming rasterization forced on or off, see set_streaming_rasterization().
+    std::optional<bool>             m_streaming_rasterization;
     
     // Estimated print time, material consumed.
     SLAPrintStatistics              m_print_statistics;
@@ -86,6 +86,23 @@ std::string PRINT_STEP_LABELS(size_t idx)
     assert(false); return "Out of bounds!";
 }
 
+// Rough estimate of how much smaller an encoded layer image is compared to
+// the raw 8bit greyscale framebuffer.
+constexpr size_t RASTER_COMPRESSION_RATIO_ESTIMATE = 16;
+
+// If the encoded layers are expected to take more memory than this, they are
+// not kept in memory after slicing but rasterized on the fly while exporting.
+constexpr size_t RASTER_MEMORY_BUDGET = size_t(1) << 30;
+
+bool use_streaming_rasterization(const SLAPrinterConfig &cfg, size_t layer_num)
+{
+    size_t pixels = size_t(std::max(cfg.display_pixels_x.getInt(), 0)) *
+                    size_t(std::max(cfg.display_pixels_y.getInt(), 0));
+
+    return layer_num * (pixels / RASTER_COMPRESSION_RATIO_ESTIMATE) >
+           RASTER_MEMORY_BUDGET;
+}
+
 }
 
 SLAPrint::Steps::Steps(SLAPrint *print)
@@ -157,8 +174,7 @@ indexed_triangle_set SLAPrint::Steps::generate_preview_vdb(
     });
 
     auto r = range(po.m_mesh_to_slice);
-    auto grid = csg::voxelize_csgmesh(r, voxparams);
-    auto m = grid ? grid_to_mesh(*grid, 0., 0.01) : indexed_triangle_set{};
+    auto m = csg::perform_csgmesh_booleans(r, csg::BooleanBackend::Voxel, voxparams, 0.01);
     float loss_less_max_error = float(1e-6);
     its_quadric_edge_collapse(m, 0U, &loss_less_max_error);
 
@@ -180,15 +196,9 @@ void SLAPrint::Steps::generate_preview(SLAPrintObject &po, SLAPrintObjectStep st
         m = csgmesh_merge_positive_parts(r);
         handled = true;
     } else if (csg::check_csgmesh_booleans(r) == r.end()) {
-        MeshBoolean::cgal::CGALMeshPtr cgalmeshptr;
-        try {
-            cgalmeshptr = csg::perform_csgmesh_booleans(r);
-        } catch (...) {
-            // leaves cgalmeshptr as nullptr
-        }
+        m = csg::perform_csgmesh_booleans(r, csg::BooleanBackend::CGAL);
 
-        if (cgalmeshptr) {
-            m = MeshBoolean::cgal::cgal_to_indexed_triangle_set(*cgalmeshptr);
+        if (!m.empty()) {
             handled = true;
         } else {
             BOOST_LOG_TRIVIAL(warning) << "CSG mesh is not egligible for proper CGAL booleans!";
@@ -321,6 +331,8 @@ void SLAPrint::Steps::mesh_assembly(SLAPrintObject &po)
     po.m_mesh_to_slice.clear();
     po.m_supportdata.reset();
     po.m_hollowing_data.reset();
+    po.m_hollowing_grids.clear();
+    po.m_hollowing_grid = nullptr;
 
     csg::model_to_csgmesh(*po.model_object(), po.trafo(),
                           csg_inserter{po.m_mesh_to_slice, slaposAssembly},
@@ -338,6 +350,8 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
 
     if (! po.m_config.hollowing_enable.getBool()) {
         BOOST_LOG_TRIVIAL(info) << "Skipping hollowing step!";
+        po.m_hollowing_grids.clear();
+        po.m_hollowing_grid = nullptr;
         return;
     }
 
@@ -351,8 +365,27 @@ void SLAPrint::Steps::hollow_model(SLAPrintObject &po)
     ctl.stopcondition = [this]() { return canceled(); };
     ctl.cancelfn = [this]() { throw_if_canceled(); };
 
-    sla::InteriorPtr interior =
-        generate_interior(po.mesh_to_slice(), hlwcfg, ctl);
+    // Only the assembled object is left in m_mesh_to_slice, its grids are
+    // reused until the object is assembled again. The voxel scale depends on
+    // the quality and on walls thinner than 3.5 mm.
+    double voxel_scale = sla::get_voxel_scale(po.mesh_to_slice(), hlwcfg);
+    auto   it_grid     = po.m_hollowing_grids.find(voxel_scale);
+    if (it_grid == po.m_hollowing_grids.end()) {
+        VoxelGridPtr grid = sla::generate_interior_grid(po.mesh_to_slice(), voxel_scale, ctl);
+        // Don't cache a grid interrupted by cancellation.
+        throw_if_canceled();
+        // Don't keep more than a few grids of a big object in memory.
+        if (po.m_hollowing_grids.size() >= 4)
+            po.m_hollowing_grids.clear();
+        it_grid = po.m_hollowing_grids.emplace(voxel_scale, std::move(grid)).first;
+    } else
+        BOOST_LOG_TRIVIAL(debug) << "Hollowing: reusing the voxelized object";
+    po.m_hollowing_grid = it_grid->second.get();
+
+    throw_if_canceled();
+
+    sla::InteriorPtr interior = po.m_hollowing_grid ?
+        generate_interior(*po.m_hollowing_grid, hlwcfg, ctl) : sla::InteriorPtr{};
 
     if (!interior || sla::get_mesh(*interior).empty())
         BOOST_LOG_TRIVIAL(warning) << "Hollowed interior is empty!";
@@ -1312,6 +1345,35 @@ void SLAPrint::Steps::rasterize()
     // pst: previous state
     double pst = current_status();
 
+    if (m_print->m_streaming_rasterization.value_or(
+            use_streaming_rasterization(m_print->m_printer_config,
+                                        m_print->m_printer_input.size()))) {
+        // High resolution printer and a tall print: the layers are drawn
+        // only when the archive is written, one bounded window at a time.
+        // The archive keeps referencing the printer input, which is only
+        // valid while this step is done. SLAPrint::export_print() refuses
+        // to export otherwise. The export reports its own progress.
+        SLAPrint *print = m_print;
+        const size_t layer_count = m_print->m_printer_input.size();
+        m_print->m_archiver->draw_layers_deferred(
+            layer_count,
+            [print](sla::RasterBase &raster, size_t idx) {
+                for (const ExPolygon &poly : print->m_printer_input[idx].transformed_slices())
+                    raster.draw(poly);
+            },
+            [print]() { print->throw_if_canceled(); },
+            [print, layer_count, last_percent = -1](size_t layers_done) mutable {
+                int percent = int(100 * layers_done / layer_count);
+                if (percent != last_percent) {
+                    last_percent = percent;
+                    print->set_status(percent, PRINT_STEP_LABELS(slapsRasterize));
+                }
+            });
+
+        report_status(pst + slot * sd, PRINT_STEP_LABELS(slapsRasterize));
+        return;
+    }
+
     double increment = (slot * sd) / m_print->m_printer_input.size();
     double dstatus = current_status();
 
@@ -2,6 +2,7 @@
 ///|/
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
+#include <algorithm>
 #include <numeric>
 
 #include "SlicesToTriangleMesh.hpp"
@@ -10,43 +11,92 @@
 #include "libslic3r/ClipperUtils.hpp"
 #include "libslic3r/Tesselate.hpp"
 
-#include <tbb/parallel_for.h>
-#include <tbb/parallel_reduce.h>
-
 #include <boost/log/trivial.hpp>
 
 namespace Slic3r {
 
-// Same as walls() but with identical higher and lower polygons.
-indexed_triangle_set inline straight_walls(const Polygon &plate,
-                                     double         lo_z,
-                                     double         hi_z)
-{
-    return wall_strip(plate, lo_z, hi_z);
-}
+namespace {
 
-indexed_triangle_set inline straight_walls(const ExPolygon &plate,
-                                     double           lo_z,
-                                     double           hi_z)
+// Vertices of the mesh in the plane between two layers and the triangles of the horizontal surfaces in that plane.
+// The walls of the layers below and above the plane share the vertices with the horizontal surfaces,
+// so the assembled mesh does not need to have its vertices merged.
+struct SlicesPlane
 {
-    indexed_triangle_set ret = straight_walls(plate.contour, lo_z, hi_z);
-    for (auto &h : plate.holes)
-        its_merge(ret, straight_walls(h, lo_z, hi_z));
-
-    return ret;
+    std::vector<Vec3f>                       vertices;
+    // Indices of the vertices of the points of the slice below and of the slice above the plane,
+    // in the order of for_each_polygon().
+    std::vector<int>                         below;
+    std::vector<int>                         above;
+    std::vector<stl_triangle_vertex_indices> triangles;
+};
+
+template<class Fn> void for_each_polygon(const ExPolygons &slice, Fn &&fn)
+{
+    for (const ExPolygon &poly : slice) {
+        fn(poly.contour);
+        for (const Polygon &h : poly.holes)
+            fn(h);
+    }
 }
 
-indexed_triangle_set inline straight_walls(const ExPolygons &slice,
-                                     double            lo_z,
-                                     double            hi_z)
+SlicesPlane slices_plane(const ExPolygons *below, const ExPolygons *above, float z)
 {
-    indexed_triangle_set ret;
-    for (const ExPolygon &poly : slice)
-        its_merge(ret, straight_walls(poly, lo_z, hi_z));
-
-    return ret;
+    std::vector<Vec3d> triangles;
+    if (below && above) {
+        // Small 0 area artefacts can be created by diff_ex, and the
+        // tesselation also can create 0 area triangles. These will be removed
+        // by its_remove_degenerate_faces.
+        ExPolygons free_top = diff_ex(*below, *above);
+        ExPolygons overhang = diff_ex(*above, *below);
+        triangles = triangulate_expolygons_3d(free_top, z, NORMALS_UP);
+        append(triangles, triangulate_expolygons_3d(overhang, z, NORMALS_DOWN));
+    } else if (below)
+        triangles = triangulate_expolygons_3d(*below, z, NORMALS_UP);
+    else if (above)
+        triangles = triangulate_expolygons_3d(*above, z, NORMALS_DOWN);
+
+    // The expression unscaled(p).cast<float>().eval() ensures identical conversion
+    // of the scaled coordinates to that used by the tesselation, see wall_strip().
+    std::vector<Vec3f> points;
+    auto append_points = [&points, z](const Polygon &poly) {
+        for (const Point &p : poly.points)
+            points.emplace_back(to_3d(unscaled(p).cast<float>().eval(), z));
+    };
+    if (below)
+        for_each_polygon(*below, append_points);
+    const size_t num_below = points.size();
+    if (above)
+        for_each_polygon(*above, append_points);
+    const size_t num_walls = points.size();
+    for (const Vec3d &p : triangles)
+        points.emplace_back(p.cast<float>());
+
+    // Merge the identical points the same way its_merge_vertices() does.
+    std::vector<int> sorted(points.size());
+    std::iota(sorted.begin(), sorted.end(), 0);
+    std::sort(sorted.begin(), sorted.end(), [&points](int il, int ir) {
+        const Vec3f &l = points[il];
+        const Vec3f &r = points[ir];
+        return l.x() < r.x() || (l.x() == r.x() && (l.y() < r.y() || (l.y() == r.y() && il < ir)));
+    });
+    SlicesPlane      out;
+    std::vector<int> map_points(points.size());
+    for (size_t i = 0; i < sorted.size(); ++ i) {
+        if (i == 0 || points[sorted[i]] != points[sorted[i - 1]])
+            out.vertices.emplace_back(points[sorted[i]]);
+        map_points[sorted[i]] = int(out.vertices.size()) - 1;
+    }
+    out.below.assign(map_points.begin(), map_points.begin() + num_below);
+    out.above.assign(map_points.begin() + num_below, map_points.begin() + num_walls);
+    out.triangles.reserve(triangles.size() / 3);
+    for (size_t i = num_walls; i < points.size(); i += 3)
+        out.triangles.emplace_back(map_points[i], map_points[i + 1], map_points[i + 2]);
+
+    return out;
 }
 
+} // namespace
+
 indexed_triangle_set slices_to_mesh(
     const std::vector<ExPolygons> &slices,
     double                         zmin,
@@ -54,43 +104,60 @@ indexed_triangle_set slices_to_mesh(
 {
     assert(slices.size() == grid.size());
 
-    using Layers = std::vector<indexed_triangle_set>;
-    Layers layers(slices.size());
-    size_t len = slices.size() - 1;
-
-    auto threads_cnt = execution::max_concurrency(ex_tbb);
-    execution::for_each(ex_tbb, size_t(0), len, [&slices, &layers, &grid](size_t i) {
-        const ExPolygons &upper = slices[i + 1];
-        const ExPolygons &lower = slices[i];
-
-        // Small 0 area artefacts can be created by diff_ex, and the
-        // tesselation also can create 0 area triangles. These will be removed
-        // by its_remove_degenerate_faces.
-        ExPolygons free_top = diff_ex(lower, upper);
-        ExPolygons overhang = diff_ex(upper, lower);
-        its_merge(layers[i], triangulate_expolygons_3d(free_top, grid[i], NORMALS_UP));
-        its_merge(layers[i], triangulate_expolygons_3d(overhang, grid[i], NORMALS_DOWN));
-        its_merge(layers[i], straight_walls(upper, grid[i], grid[i + 1]));
-        }, threads_cnt);
-
-    auto merge_fn = []( const indexed_triangle_set &a, const indexed_triangle_set &b ) {
-        indexed_triangle_set res{a}; its_merge(res, b); return res;
-    };
-
-    auto ret = execution::reduce(ex_tbb, layers.begin(), layers.end(),
-                                 indexed_triangle_set{}, merge_fn,
-                                 threads_cnt);
-
-    its_merge(ret, triangulate_expolygons_3d(slices.front(), zmin, NORMALS_DOWN));
-    its_merge(ret, straight_walls(slices.front(), zmin, grid.front()));
-    its_merge(ret, triangulate_expolygons_3d(slices.back(), grid.back(), NORMALS_UP));
+    indexed_triangle_set ret;
+    if (slices.empty())
+        return ret;
+
+    // Plane i is at the bottom of layer i, the last plane at the top of the last layer.
+    std::vector<SlicesPlane> planes(slices.size() + 1);
+    execution::for_each(ex_tbb, size_t(0), planes.size(), [&slices, &planes, &grid, zmin](size_t i) {
+        planes[i] = slices_plane(i > 0 ? &slices[i - 1] : nullptr, i < slices.size() ? &slices[i] : nullptr,
+                                 i > 0 ? grid[i - 1] : float(zmin));
+    });
+
+    // The triangles of the planes are followed by the walls of the layers, two triangles per point of a slice.
+    std::vector<size_t> vertex_offsets(planes.size() + 1, 0);
+    std::vector<size_t> face_offsets(planes.size() + slices.size() + 1, 0);
+    for (size_t i = 0; i < planes.size(); ++ i) {
+        vertex_offsets[i + 1] = vertex_offsets[i] + planes[i].vertices.size();
+        face_offsets[i + 1]   = face_offsets[i] + planes[i].triangles.size();
+    }
+    for (size_t i = 0; i < slices.size(); ++ i)
+        face_offsets[planes.size() + i + 1] = face_offsets[planes.size() + i] + 2 * planes[i].above.size();
+    ret.vertices.resize(vertex_offsets.back());
+    ret.indices.resize(face_offsets.back());
+
+    execution::for_each(ex_tbb, size_t(0), planes.size(), [&planes, &vertex_offsets, &face_offsets, &ret](size_t i) {
+        const SlicesPlane &plane  = planes[i];
+        const int          offset = int(vertex_offsets[i]);
+        std::copy(plane.vertices.begin(), plane.vertices.end(), ret.vertices.begin() + vertex_offsets[i]);
+        auto it = ret.indices.begin() + face_offsets[i];
+        for (const stl_triangle_vertex_indices &t : plane.triangles)
+            *it ++ = t + stl_triangle_vertex_indices(offset, offset, offset);
+    });
+
+    execution::for_each(ex_tbb, size_t(0), slices.size(), [&slices, &planes, &vertex_offsets, &face_offsets, &ret](size_t i) {
+        // Walls of the layer between its bottom and top planes, the same triangles as wall_strip() produces.
+        const std::vector<int> &lo        = planes[i].above;
+        const std::vector<int> &hi        = planes[i + 1].below;
+        const int               lo_offset = int(vertex_offsets[i]);
+        const int               hi_offset = int(vertex_offsets[i + 1]);
+        auto                    it        = ret.indices.begin() + face_offsets[planes.size() + i];
+        size_t                  first     = 0;
+        for_each_polygon(slices[i], [&](const Polygon &poly) {
+            for (size_t j = 0; j < poly.size(); ++ j) {
+                const size_t a = first + (j == 0 ? poly.size() : j) - 1;
+                const size_t b = first + j;
+                *it ++ = { lo_offset + lo[a], lo_offset + lo[b], hi_offset + hi[a] };
+                *it ++ = { lo_offset + lo[b], hi_offset + hi[b], hi_offset + hi[a] };
+            }
+            first += poly.size();
+        });
+    });
 
     // FIXME: these repairs do not fix the mesh entirely. There will be cracks
     // in the output. It is very hard to do the meshing in a way that does not
     // leave errors.
-    int num_mergedv = its_merge_vertices(ret);
-    BOOST_LOG_TRIVIAL(debug) << "Merged vertices count: " << num_mergedv;
-
     int remcnt = its_remove_degenerate_faces(ret);
     BOOST_LOG_TRIVIAL(debug) << "Removed degenerate faces count: " << remcnt;
 
@@ -12,6 +12,7 @@
 
 #include "TreeModelVolumes.hpp"
 #include "TreeSupportCommon.hpp"
+#include "TreeSupportDistanceField.hpp"
 
 #include "../BuildVolume.hpp"
 #include "../ClipperUtils.hpp"
@@ -23,11 +24,14 @@
 #include "../Utils.hpp"
 #include "../format.hpp"
 
+#include <array>
+#include <chrono>
 #include <string_view>
 
 #include <boost/log/trivial.hpp>
 
 #include <tbb/parallel_for.h>
+#include <tbb/task_arena.h>
 #include <tbb/task_group.h>
 
 namespace Slic3r::FFFTreeSupport
@@ -39,6 +43,10 @@ using namespace std::literals;
 // had to use a define beacuse the macro processing inside macro BOOST_LOG_TRIVIAL()
 #define error_level_not_in_cache error
 
+// The holefree collision of a radius is the collision of m_increase_until_radius shrunk by slightly less than the difference
+// of the radii, keeping it on the safe side of the rounding of the offset (scaled units).
+static constexpr const coord_t HolefreeCollisionShrinkMargin = 5;
+
 //FIXME Machine border is currently ignored.
 static Polygons calculateMachineBorderCollision(Polygon machine_border)
 {
@@ -243,7 +251,12 @@ void TreeModelVolumes::precalculate(const PrintObject& print_object, const coord
     // Calculate the relevant avoidances in parallel as far as possible
     {
         tbb::task_group task_group;
-        task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateAvoidance(relevant_avoidance_radiis, true, m_support_rests_on_model, throw_on_cancel); });
+        if (m_avoidance_backend == AvoidanceBackend::DistanceField) {
+            task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateAvoidanceDistanceField(relevant_avoidance_radiis, throw_on_cancel); });
+            if (m_support_rests_on_model)
+                task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateAvoidance(relevant_avoidance_radiis, false, true, throw_on_cancel); });
+        } else
+            task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateAvoidance(relevant_avoidance_radiis, true, m_support_rests_on_model, throw_on_cancel); });
         task_group.run([this, relevant_avoidance_radiis, throw_on_cancel]{ calculateWallRestrictions(relevant_avoidance_radiis, throw_on_cancel); });
         task_group.wait();
     }
@@ -599,7 +612,7 @@ void TreeModelVolumes::calculateCollisionHolefree(const std::vector<RadiusLayerP
                     // this union is important as otherwise holes(in form of lines that will increase to holes in a later step) can get unioned onto the area.
                     data.emplace_back(RadiusLayerPair(radius, layer_idx), polygons_simplify(
                         offset(union_ex(this->getCollision(m_increase_until_radius, layer_idx, false)),
-                            5 - increase_radius_ceil, ClipperLib::jtRound, m_min_resolution),
+                            HolefreeCollisionShrinkMargin - increase_radius_ceil, ClipperLib::jtRound, m_min_resolution),
                         m_min_resolution, polygons_strictly_simple));
                     throw_on_cancel();
                 }
@@ -708,6 +721,134 @@ void TreeModelVolumes::calculateAvoidance(const std::vector<RadiusLayerPair> &ke
 }
 
 
+void TreeModelVolumes::calculateAvoidanceDistanceField(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel)
+{
+    if (keys.empty())
+        return;
+
+    LayerIndex max_layer  = 0;
+    coord_t    max_radius = 0;
+    coord_t    min_radius = std::numeric_limits<coord_t>::max();
+    for (const RadiusLayerPair &key : keys) {
+        max_layer  = std::max(max_layer, key.second);
+        max_radius = std::max(max_radius, key.first);
+        min_radius = std::min(min_radius, key.first);
+    }
+    if (max_layer < 1)
+        return;
+
+    // Avoidances of radii below holefree_radius avoid holes, see calculateCollisionHolefree().
+    const coord_t holefree_radius           = m_increase_until_radius + m_current_min_xy_dist_delta;
+    const coord_t holefree_collision_radius = this->ceilRadius(m_increase_until_radius, false);
+    const bool    calculate_holefree        = min_radius < holefree_radius;
+
+    BoundingBox bbox;
+    for (LayerIndex layer_idx = 0; layer_idx <= max_layer; ++ layer_idx)
+        bbox.merge(get_extents(getCollision(0, layer_idx, true)));
+    if (! bbox.defined) {
+        // Nothing to avoid.
+        calculateAvoidance(keys, true, false, throw_on_cancel);
+        return;
+    }
+    // The fields have to extend beyond the largest threshold, so that the contours are closed.
+    DistanceField collision(bbox.inflated(std::max(max_radius, holefree_collision_radius)), SUPPORT_TREE_DISTANCE_FIELD_RESOLUTION, SUPPORT_TREE_DISTANCE_FIELD_MAX_CELLS);
+    const coord_t resolution = collision.resolution();
+    // A cell is included into the avoidance if its center is closer than a radius to the center of a collision cell.
+    // Inflate by one cell to compensate for the collision being sampled at the cell centers only.
+    const float   threshold_offset = float(resolution);
+    const coord_t simplify_resolution = std::max(m_min_resolution, resolution);
+
+    // Collision field of the Slow and FastSafe avoidances: holefree collision below holefree_radius, regular collision above.
+    DistanceField collision_holefree;
+    DistanceField holefree_inside;
+    // Clearance fields of the avoidances propagated from the layer below, indexed by AvoidanceType.
+    std::array<DistanceField, size_t(AvoidanceType::Count)> clearance;
+
+    // Limit the move step as calculateAvoidance() does, so that a branch does not tunnel through a thin wall.
+    auto move_steps = [move_step = std::max(scaled<float>(0.05), 1.9f * std::max(min_radius, m_current_min_xy_dist))](coord_t max_move) {
+        return std::max(1, round_up_divide<int>(max_move, move_step));
+    };
+    const int steps_fast = move_steps(m_max_move);
+    const int steps_slow = move_steps(m_max_move_slow);
+
+    struct ContourTask {
+        AvoidanceType   type;
+        coord_t         radius;
+    };
+    std::vector<ContourTask> tasks;
+    std::vector<Polygons>    results;
+
+    for (LayerIndex layer_idx = 0; layer_idx <= max_layer; ++ layer_idx) {
+        collision.distance_to(getCollision(0, layer_idx, true));
+        if (layer_idx == 0) {
+            // Avoidance at the first layer is the collision.
+            for (DistanceField &field : clearance)
+                field = collision;
+            continue;
+        }
+
+        const DistanceField *collision_slow = &collision;
+        if (calculate_holefree) {
+            // The holefree collision of a radius is the collision of holefree_collision_radius shrunk by (holefree_collision_radius - radius),
+            // thus a cell is inside the holefree collision of all radii above (holefree_collision_radius - distance from the outside).
+            holefree_inside = collision;
+            holefree_inside.distance_inside(collision, float(holefree_collision_radius));
+            collision_holefree = collision;
+            std::vector<float>       &dst     = collision_holefree.values();
+            const std::vector<float> &inside  = holefree_inside.values();
+            const std::vector<float> &regular = collision.values();
+            for (size_t i = 0; i < dst.size(); ++ i)
+                if (float holefree = float(holefree_collision_radius - HolefreeCollisionShrinkMargin) - inside[i]; inside[i] > 0 && holefree < float(holefree_radius))
+                    dst[i] = holefree;
+                else
+                    dst[i] = std::max(regular[i], float(holefree_radius));
+            collision_slow = &collision_holefree;
+        }
+
+        // Propagate the clearance from the layer below.
+        auto propagate = [](DistanceField &field, const DistanceField &collision, coord_t max_move, int steps) {
+            for (int i = 0; i < steps; ++ i) {
+                field.dilate(max_move / steps);
+                field.min(collision);
+            }
+        };
+        propagate(clearance[size_t(AvoidanceType::Fast)], collision, m_max_move, steps_fast);
+        propagate(clearance[size_t(AvoidanceType::Slow)], *collision_slow, m_max_move_slow, steps_slow);
+        if (calculate_holefree)
+            propagate(clearance[size_t(AvoidanceType::FastSafe)], collision_holefree, m_max_move, steps_fast);
+        throw_on_cancel();
+
+        // Extract avoidances of all radii requested at this layer in parallel.
+        tasks.clear();
+        for (const RadiusLayerPair &key : keys)
+            if (layer_idx <= key.second) {
+                tasks.push_back({ AvoidanceType::Fast, key.first });
+                tasks.push_back({ AvoidanceType::Slow, key.first });
+                if (key.first < holefree_radius)
+                    tasks.push_back({ AvoidanceType::FastSafe, key.first });
+            }
+        results.assign(tasks.size(), Polygons{});
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, tasks.size(), 1),
+            [&tasks, &results, &clearance, threshold_offset, simplify_resolution](const tbb::blocked_range<size_t> &range) {
+            for (size_t task_idx = range.begin(); task_idx < range.end(); ++ task_idx) {
+                const ContourTask &task = tasks[task_idx];
+                results[task_idx] = polygons_simplify(
+                    clearance[size_t(task.type)].contour(float(task.radius) + threshold_offset),
+                    simplify_resolution, polygons_strictly_simple);
+            }
+        });
+        for (AvoidanceType type : { AvoidanceType::Fast, AvoidanceType::Slow, AvoidanceType::FastSafe }) {
+            std::vector<std::pair<RadiusLayerPair, Polygons>> data;
+            for (size_t task_idx = 0; task_idx < tasks.size(); ++ task_idx)
+                if (tasks[task_idx].type == type)
+                    data.emplace_back(RadiusLayerPair{ tasks[task_idx].radius, layer_idx }, std::move(results[task_idx]));
+            if (! data.empty())
+                avoidance_cache(type, false).insert(std::move(data));
+        }
+        throw_on_cancel();
+    }
+}
+
 void TreeModelVolumes::calculatePlaceables(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel)
 {
     tbb::parallel_for(tbb::blocked_range<size_t>(0, keys.size()),
@@ -853,12 +994,166 @@ coord_t TreeModelVolumes::ceilRadius(const coord_t radius) const
     return out;
 }
 
+TreeModelVolumes::RadiusLayerPolygonCache::Counters& TreeModelVolumes::RadiusLayerPolygonCache::counters() const
+{
+    // current_thread_index() returns -1 outside of a TBB arena, such as the main thread.
+    return m_counters[size_t(tbb::this_task_arena::current_thread_index() + 1) % NUM_COUNTERS];
+}
+
 void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layers)
 {
-    if (num_layers > m_data.size()) {
-        if (num_layers > m_data.capacity())
-            reserve_power_of_2(m_data, num_layers);
-        m_data.resize(num_layers, {});
+    if (num_layers > m_num_layers.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> guard(m_allocate_mutex);
+        if (num_layers > m_data.size())
+            m_data.grow_to_at_least(num_layers);
+        // Publish the layers once they are constructed.
+        if (num_layers > m_num_layers.load(std::memory_order_relaxed))
+            m_num_layers.store(num_layers, std::memory_order_release);
+    }
+}
+
+std::unique_lock<std::mutex> TreeModelVolumes::RadiusLayerPolygonCache::lock_layer(LayerIndex layer_idx)
+{
+    std::unique_lock<std::mutex> lock(m_stripe_mutexes[size_t(layer_idx) % NUM_STRIPES], std::try_to_lock);
+    if (! lock.owns_lock()) {
+        auto t_start = std::chrono::steady_clock::now();
+        lock.lock();
+        Counters &c = this->counters();
+        c.contentions.fetch_add(1, std::memory_order_relaxed);
+        c.contention_ns.fetch_add(uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - t_start).count()), std::memory_order_relaxed);
+    }
+    return lock;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert_locked(LayerIndex layer_idx, coord_t radius, Polygons &&polygons)
+{
+    LayerData &layer = m_data[layer_idx];
+    const size_t num_entries = layer.num_entries.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < num_entries; ++ i)
+        if (layer.entries[i].radius == radius)
+            // Keep the first value inserted, references to it may have been handed out already.
+            return;
+    if (layer.entries.size() == num_entries)
+        layer.entries.push_back({ radius, std::move(polygons) });
+    else
+        // Entry left over from clear_all_but_radius0().
+        layer.entries[num_entries] = { radius, std::move(polygons) };
+    layer.num_entries.store(num_entries + 1, std::memory_order_release);
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in)
+{
+    LayerIndex max_layer_idx = -1;
+    for (const auto &d : in)
+        max_layer_idx = std::max(max_layer_idx, d.first.second);
+    allocate_layers(size_t(max_layer_idx + 1));
+    for (auto &d : in) {
+        auto lock = this->lock_layer(d.first.second);
+        this->insert_locked(d.first.second, d.first.first, std::move(d.second));
+    }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius)
+{
+    coord_t max_layer_idx = -1;
+    for (const auto &d : in)
+        max_layer_idx = std::max(max_layer_idx, d.first);
+    allocate_layers(size_t(max_layer_idx + 1));
+    for (auto &d : in) {
+        auto lock = this->lock_layer(d.first);
+        this->insert_locked(d.first, radius, std::move(d.second));
+    }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius)
+{
+    allocate_layers(first_layer_idx + in.size());
+    for (auto &d : in) {
+        auto lock = this->lock_layer(first_layer_idx);
+        this->insert_locked(first_layer_idx ++, radius, std::move(d));
+    }
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::insert(LayerPolygonCache &&in, coord_t radius)
+{
+    LayerIndex i = in.begin();
+    allocate_layers(i + LayerIndex(in.size()));
+    for (auto &d : in.polygons_mutable()) {
+        auto lock = this->lock_layer(i);
+        this->insert_locked(i ++, radius, std::move(d));
+    }
+}
+
+const TreeModelVolumes::RadiusLayerPolygonCache::Entry* TreeModelVolumes::RadiusLayerPolygonCache::find(LayerIndex layer_idx, coord_t radius) const
+{
+    if (layer_idx >= 0 && size_t(layer_idx) < m_num_layers.load(std::memory_order_acquire)) {
+        const LayerData &layer = m_data[layer_idx];
+        const size_t num_entries = layer.num_entries.load(std::memory_order_acquire);
+        for (size_t i = 0; i < num_entries; ++ i)
+            if (const Entry &entry = layer.entries[i]; entry.radius == radius)
+                return &entry;
+    }
+    return nullptr;
+}
+
+std::optional<std::reference_wrapper<const Polygons>> TreeModelVolumes::RadiusLayerPolygonCache::getArea(const TreeModelVolumes::RadiusLayerPair &key) const
+{
+    const Entry *entry = this->find(key.second, key.first);
+    Counters &c = this->counters();
+    if (entry == nullptr) {
+        c.misses.fetch_add(1, std::memory_order_relaxed);
+        return std::nullopt;
+    }
+    c.hits.fetch_add(1, std::memory_order_relaxed);
+    return std::optional<std::reference_wrapper<const Polygons>>{ entry->polygons };
+}
+
+std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const
+{
+    const Entry *best = nullptr;
+    if (key.second >= 0 && size_t(key.second) < m_num_layers.load(std::memory_order_acquire)) {
+        const LayerData &layer = m_data[key.second];
+        const size_t num_entries = layer.num_entries.load(std::memory_order_acquire);
+        for (size_t i = 0; i < num_entries; ++ i)
+            if (const Entry &entry = layer.entries[i]; entry.radius <= key.first && (best == nullptr || entry.radius > best->radius))
+                best = &entry;
+    }
+    Counters &c = this->counters();
+    if (best == nullptr) {
+        c.misses.fetch_add(1, std::memory_order_relaxed);
+        return {};
+    }
+    c.hits.fetch_add(1, std::memory_order_relaxed);
+    return std::make_pair(best->radius, std::reference_wrapper<const Polygons>(best->polygons));
+}
+
+LayerIndex TreeModelVolumes::RadiusLayerPolygonCache::getMaxCalculatedLayer(coord_t radius) const
+{
+    auto layer_idx = LayerIndex(m_num_layers.load(std::memory_order_acquire)) - 1;
+    for (; layer_idx > 0; -- layer_idx)
+        if (this->find(layer_idx, radius) != nullptr)
+            break;
+    // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
+    return layer_idx == 0 ? -1 : layer_idx;
+}
+
+void TreeModelVolumes::RadiusLayerPolygonCache::clear_all_but_radius0()
+{
+    for (size_t layer_idx = 0; layer_idx < m_num_layers.load(std::memory_order_relaxed); ++ layer_idx) {
+        LayerData   &layer       = m_data[layer_idx];
+        const size_t num_entries = layer.num_entries.load(std::memory_order_relaxed);
+        if (num_entries > 1) {
+            // Keep the smallest radius only.
+            size_t imin = 0;
+            for (size_t i = 1; i < num_entries; ++ i)
+                if (layer.entries[i].radius < layer.entries[imin].radius)
+                    imin = i;
+            if (imin != 0)
+                std::swap(layer.entries[0], layer.entries[imin]);
+            for (size_t i = 1; i < num_entries; ++ i)
+                layer.entries[i].polygons = Polygons{};
+            layer.num_entries.store(1, std::memory_order_release);
+        }
     }
 }
 
@@ -866,13 +1161,46 @@ void TreeModelVolumes::RadiusLayerPolygonCache::allocate_layers(size_t num_layer
 std::vector<std::pair<TreeModelVolumes::RadiusLayerPair, std::reference_wrapper<const Polygons>>> TreeModelVolumes::RadiusLayerPolygonCache::sorted() const
 {
     std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> out;
-    for (auto &layer : m_data) {
-        auto layer_idx = LayerIndex(&layer - m_data.data());
-        for (auto &radius_polygons : layer)
-            out.emplace_back(std::make_pair(radius_polygons.first, layer_idx), radius_polygons.second);
+    for (size_t layer_idx = 0; layer_idx < m_num_layers.load(std::memory_order_acquire); ++ layer_idx) {
+        const LayerData &layer = m_data[layer_idx];
+        const size_t num_entries = layer.num_entries.load(std::memory_order_acquire);
+        for (size_t i = 0; i < num_entries; ++ i)
+            out.emplace_back(std::make_pair(layer.entries[i].radius, LayerIndex(layer_idx)), layer.entries[i].polygons);
+    }
+    std::sort(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second && l.first.first < r.first.first); });
+    return out;
+}
+
+TreeModelVolumes::RadiusLayerPolygonCache::Statistics TreeModelVolumes::RadiusLayerPolygonCache::statistics() const
+{
+    Statistics out;
+    for (const Counters &c : m_counters) {
+        out.hits            += c.hits.load(std::memory_order_relaxed);
+        out.misses          += c.misses.load(std::memory_order_relaxed);
+        out.contentions     += c.contentions.load(std::memory_order_relaxed);
+        out.contention_time += 1e-9 * double(c.contention_ns.load(std::memory_order_relaxed));
     }
-    assert(std::is_sorted(out.begin(), out.end(), [](auto &l, auto &r){ return l.first.second < r.first.second || (l.first.second == r.first.second) && l.first.first < r.first.first; }));
     return out;
 }
 
+void TreeModelVolumes::log_cache_statistics() const
+{
+    auto log = [](const RadiusLayerPolygonCache &cache, std::string_view name) {
+        RadiusLayerPolygonCache::Statistics stats = cache.statistics();
+        BOOST_LOG_TRIVIAL(debug) << "Tree support cache " << name << ": hits " << stats.hits << ", misses " << stats.misses <<
+            ", insertions waiting " << stats.contentions << ", waiting time " << stats.contention_time << "s";
+    };
+    log(m_collision_cache,                      "collision"sv);
+    log(m_collision_cache_holefree,             "collision_holefree"sv);
+    log(m_avoidance_cache,                      "avoidance"sv);
+    log(m_avoidance_cache_slow,                 "avoidance_slow"sv);
+    log(m_avoidance_cache_to_model,             "avoidance_to_model"sv);
+    log(m_avoidance_cache_to_model_slow,        "avoidance_to_model_slow"sv);
+    log(m_placeable_areas_cache,                "placeable_areas"sv);
+    log(m_avoidance_cache_holefree,             "avoidance_holefree"sv);
+    log(m_avoidance_cache_holefree_to_model,    "avoidance_holefree_to_model"sv);
+    log(m_wall_restrictions_cache,              "wall_restrictions"sv);
+    log(m_wall_restrictions_cache_min,          "wall_restrictions_min"sv);
+}
+
 } // namespace Slic3r::FFFTreeSupport
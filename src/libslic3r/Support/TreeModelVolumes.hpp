@@ -13,11 +13,15 @@
 #ifndef slic3r_TreeModelVolumes_hpp
 #define slic3r_TreeModelVolumes_hpp
 
+#include <array>
+#include <atomic>
 #include <mutex>
 #include <unordered_map>
 
 #include <boost/functional/hash.hpp>
 
+#include <tbb/concurrent_vector.h>
+
 #include "TreeSupportCommon.hpp"
 
 #include "../Point.hpp"
@@ -37,6 +41,10 @@ static constexpr const double  SUPPORT_TREE_EXPONENTIAL_FACTOR = 1.5;
 static constexpr const coord_t SUPPORT_TREE_EXPONENTIAL_THRESHOLD = scaled<coord_t>(1. * SUPPORT_TREE_EXPONENTIAL_FACTOR);
 static constexpr const coord_t SUPPORT_TREE_COLLISION_RESOLUTION = scaled<coord_t>(0.5);
 static constexpr const bool    SUPPORT_TREE_AVOID_SUPPORT_BLOCKER = true;
+// Cell size of the distance fields used by TreeModelVolumes::AvoidanceBackend::DistanceField.
+static constexpr const coord_t SUPPORT_TREE_DISTANCE_FIELD_RESOLUTION = scaled<coord_t>(0.1);
+// The cell size is increased for large objects to limit memory consumption of the distance fields.
+static constexpr const size_t  SUPPORT_TREE_DISTANCE_FIELD_MAX_CELLS = 4000000;
 
 class TreeModelVolumes
 {
@@ -73,6 +81,8 @@ public:
         m_wall_restrictions_cache.clear();
         m_wall_restrictions_cache_min.clear();
     }
+    // Log lookup hits, misses and insertion contention of the caches at debug level.
+    void log_cache_statistics() const;
 
     enum class AvoidanceType : int8_t
     {
@@ -82,6 +92,18 @@ public:
         Count
     };
 
+    enum class AvoidanceBackend : int8_t
+    {
+        // Avoidances are propagated from layer to layer by polygon offsets and unions, separately for each radius.
+        Polygons,
+        // Avoidances to build plate of all radii are thresholded from a single distance field per layer and avoidance type,
+        // see calculateAvoidanceDistanceField(). Avoidances to model are always calculated with polygons.
+        DistanceField,
+    };
+
+    // Select how precalculate() calculates the avoidances. Lazily calculated avoidances always use polygons.
+    void set_avoidance_backend(AvoidanceBackend backend) { m_avoidance_backend = backend; }
+
     /*!
      * \brief Precalculate avoidances and collisions up to max_layer.
      *
@@ -199,78 +221,56 @@ private:
      * \brief Convenience typedef for the keys to the caches
      */
     using RadiusLayerPair             = std::pair<coord_t, LayerIndex>;
+    // Cache of polygons indexed by layer and radius, shared by the threads calculating and consuming the tree support volumes.
+    // Lookups are lock free, they are orders of magnitude more frequent than insertions when growing the tree branches.
+    // Insertions are serialized per layer by striped mutexes.
     class RadiusLayerPolygonCache {
-        // Map from radius to Polygons. Cache of one layer collision regions.
-        using LayerData = std::map<coord_t, Polygons>;
-        // Vector of layers, at each layer map of radius to Polygons.
-        // Reference to Polygons returned shall be stable to insertion.
-        using Layers = std::vector<LayerData>;
+        struct Entry {
+            coord_t     radius;
+            Polygons    polygons;
+        };
+        // Entries of a single layer in order of insertion. Entries never move once inserted, thus a reference
+        // to Polygons returned shall be stable to insertion. Only the first num_entries entries are visible to readers.
+        struct LayerData {
+            tbb::concurrent_vector<Entry>   entries;
+            std::atomic<size_t>             num_entries { 0 };
+        };
+        using Layers = tbb::concurrent_vector<LayerData>;
     public:
+        struct Statistics {
+            // Number of lookups finding / not finding the requested radius.
+            uint64_t    hits { 0 };
+            uint64_t    misses { 0 };
+            // Number of insertions waiting for another thread inserting into the same stripe of layers.
+            uint64_t    contentions { 0 };
+            // Total time spent waiting in seconds.
+            double      contention_time { 0 };
+        };
+
         RadiusLayerPolygonCache() = default;
-        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) : m_data(std::move(rhs.m_data)) {}
-        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) { m_data = std::move(rhs.m_data); return *this; }
+        RadiusLayerPolygonCache(RadiusLayerPolygonCache &&rhs) { *this = std::move(rhs); }
+        RadiusLayerPolygonCache& operator=(RadiusLayerPolygonCache &&rhs) {
+            m_data = std::move(rhs.m_data);
+            m_num_layers.store(rhs.m_num_layers.exchange(0, std::memory_order_relaxed), std::memory_order_release);
+            return *this;
+        }
 
         RadiusLayerPolygonCache(const RadiusLayerPolygonCache&) = delete;
         RadiusLayerPolygonCache& operator=(const RadiusLayerPolygonCache&) = delete;
 
-        void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            for (auto &d : in)
-                this->get_allocate_layer_data(d.first.second).emplace(d.first.first, std::move(d.second));
-        }
+        void insert(std::vector<std::pair<RadiusLayerPair, Polygons>> &&in);
         // by layer
-        void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            for (auto &d : in)
-                this->get_allocate_layer_data(d.first).emplace(radius, std::move(d.second));
-        }
-        void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            allocate_layers(first_layer_idx + in.size());
-            for (auto &d : in)
-                m_data[first_layer_idx ++].emplace(radius, std::move(d));
-        }
-        void insert(LayerPolygonCache &&in, coord_t radius) {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            LayerIndex i = in.begin();
-            allocate_layers(i + LayerIndex(in.size()));
-            for (auto &d : in.polygons_mutable())
-                m_data[i ++].emplace(radius, std::move(d));
-        }
+        void insert(std::vector<std::pair<coord_t, Polygons>> &&in, coord_t radius);
+        void insert(std::vector<Polygons> &&in, coord_t first_layer_idx, coord_t radius);
+        void insert(LayerPolygonCache &&in, coord_t radius);
         /*!
          * \brief Checks a cache for a given RadiusLayerPair and returns it if it is found
          * \param key RadiusLayerPair of the requested areas. The radius will be calculated up to the provided layer.
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
-        std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-
-            if (key.second >= LayerIndex(m_data.size()))
-                return std::nullopt;
-
-            const LayerData &layer = m_data[key.second];
-            auto it = layer.find(key.first);
-            if (it == layer.end())
-                return std::nullopt;
-
-            return std::optional<std::reference_wrapper<const Polygons>>{it->second};
-        }
+        std::optional<std::reference_wrapper<const Polygons>> getArea(const TreeModelVolumes::RadiusLayerPair &key) const;
         // Get a collision area at a given layer for a radius that is a lower or equial to the key radius.
-        std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            if (key.second >= LayerIndex(m_data.size()))
-                return {};
-            const auto &layer = m_data[key.second];
-            if (layer.empty())
-                return {};
-            auto it = layer.lower_bound(key.first);
-            if (it == layer.end() || it->first != key.first) {
-                if (it == layer.begin())
-                    return {};
-                -- it;
-            }
-            return std::make_pair(it->first, std::reference_wrapper<const Polygons>(it->second));
-        }
+        std::optional<std::pair<coord_t, std::reference_wrapper<const Polygons>>> get_lower_bound_area(const TreeModelVolumes::RadiusLayerPair &key) const;
         /*!
          * \brief Get the highest already calculated layer in the cache.
          * \param radius The radius for which the highest already calculated layer has to be found.
@@ -278,41 +278,49 @@ private:
          *
          * \return A wrapped optional reference of the requested area (if it was found, an empty optional if nothing was found)
          */
-        LayerIndex getMaxCalculatedLayer(coord_t radius) const {
-            std::lock_guard<std::mutex> guard(m_mutex);
-            auto layer_idx = LayerIndex(m_data.size()) - 1;
-            for (; layer_idx > 0; -- layer_idx)
-                if (const auto &layer = m_data[layer_idx]; layer.find(radius) != layer.end())
-                    break;
-            // The placeable on model areas do not exist on layer 0, as there can not be model below it. As such it may be possible that layer 1 is available, but layer 0 does not exist.
-            return layer_idx == 0 ? -1 : layer_idx;
-        }
+        LayerIndex getMaxCalculatedLayer(coord_t radius) const;
 
         // For debugging purposes, sorted by layer index, then by radius.
         [[nodiscard]] std::vector<std::pair<RadiusLayerPair, std::reference_wrapper<const Polygons>>> sorted() const;
 
-        void clear() { m_data.clear(); }
-        void clear_all_but_radius0() { 
-            for (LayerData &l : m_data) {
-                auto begin = l.begin();
-                auto end = l.end();
-                if (begin != end && ++ begin != end)
-                    l.erase(begin, end);
-            }
-        }
+        // Accumulated counters of lookups and insertions since construction.
+        [[nodiscard]] Statistics statistics() const;
+
+        // Not thread safe.
+        void clear() { m_data.clear(); m_num_layers.store(0, std::memory_order_release); }
+        void clear_all_but_radius0();
 
     private:
-        LayerData&          get_allocate_layer_data(LayerIndex layer_idx) {
-            allocate_layers(layer_idx + 1);
-            return m_data[layer_idx];
-        }
+        // Lock-free lookup of radius at a layer, nullptr if not found.
+        const Entry*        find(LayerIndex layer_idx, coord_t radius) const;
+        // Insert into a layer unless the radius is already there, the layer stripe has to be locked.
+        void                insert_locked(LayerIndex layer_idx, coord_t radius, Polygons &&polygons);
+        // Lock the stripe of layers containing layer_idx, count and time the waiting if another thread holds it.
+        std::unique_lock<std::mutex> lock_layer(LayerIndex layer_idx);
         void                allocate_layers(size_t num_layers);
 
+        // Counters are spread over cache lines indexed by the worker thread, so that counting does not cause
+        // false sharing between the threads.
+        struct alignas(64) Counters {
+            std::atomic<uint64_t>   hits { 0 };
+            std::atomic<uint64_t>   misses { 0 };
+            std::atomic<uint64_t>   contentions { 0 };
+            std::atomic<uint64_t>   contention_ns { 0 };
+        };
+        static constexpr const size_t NUM_COUNTERS = 64;
+        static constexpr const size_t NUM_STRIPES  = 64;
+        Counters&           counters() const;
+
         Layers              m_data;
-        mutable std::mutex  m_mutex;
+        // Number of layers of m_data visible to readers. Growing m_data is serialized by m_allocate_mutex.
+        std::atomic<size_t> m_num_layers { 0 };
+        std::mutex          m_allocate_mutex;
+        std::array<std::mutex, NUM_STRIPES>     m_stripe_mutexes;
+        mutable std::array<Counters, NUM_COUNTERS> m_counters;
     };
 
 
+
     /*!
      * \brief Provides the areas that have to be avoided by the tree's branches to prevent collision with the model on this layer. Holes are removed.
      *
@@ -387,6 +395,18 @@ private:
         calculateAvoidance(std::vector<RadiusLayerPair>{ RadiusLayerPair(key) }, to_build_plate, to_model, []{});
     }
 
+    /*!
+     * \brief Creates the avoidances to build plate of all types for all requested radii from distance fields.
+     *
+     * Instead of propagating the avoidance of each radius separately, a single clearance field is propagated per avoidance type:
+     * the distance to the collision of radius zero is limited by the clearance at the layer below, dilated by the maximum move distance.
+     * The avoidance of a radius is then the region where the clearance does not exceed the radius.
+     * The propagation is sequential in z, but cheap. Extracting the avoidances of all radii at a layer runs in parallel.
+     * Result is saved in the cache.
+     * \param keys RadiusLayerPairs of all requested areas. Every radius will be calculated up to the provided layer.
+     */
+    void calculateAvoidanceDistanceField(const std::vector<RadiusLayerPair> &keys, std::function<void()> throw_on_cancel);
+
     /*!
      * \brief Creates the areas where a branch of a given radius can be place on the model.
      * Result is saved in the cache.
@@ -436,6 +456,7 @@ private:
     coord_t m_min_resolution;
 
     bool m_precalculated = false;
+    AvoidanceBackend m_avoidance_backend = AvoidanceBackend::Polygons;
     /*!
      * \brief The index to access the outline corresponding with the currently processing mesh
      */
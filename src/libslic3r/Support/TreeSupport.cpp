@@ -3449,6 +3449,9 @@ static void generate_support_areas(Print &print, const BuildVolume &build_volume
             m_progress_multiplier, m_progress_offset, 
 #endif // SLIC3R_TREESUPPORTS_PROGRESS
             /* additional_excluded_areas */{} };
+        if (print_object.config().support_material_style == smsOrganic && print_object.config().support_tree_fast_avoidance)
+            // Organic supports smooth the branches against the collisions afterwards, thus a slightly coarser avoidance is acceptable.
+            volumes.set_avoidance_backend(TreeModelVolumes::AvoidanceBackend::DistanceField);
 
         //FIXME generating overhangs just for the furst mesh of the group.
         assert(processing.second.size() == 1);
@@ -3562,6 +3565,7 @@ static void generate_support_areas(Print &print, const BuildVolume &build_volume
                 "Influence area creation: " << dur_path << "ms "
                 "Placement of Points in InfluenceAreas: " << dur_place << "ms "
                 "Drawing result as support " << dur_draw << " ms";
+            volumes.log_cache_statistics();
     //        if (config.branch_radius==2121)
     //            BOOST_LOG_TRIVIAL(error) << "Why ask questions when you already know the answer twice.\n (This is not a real bug, please dont report it.)";
             
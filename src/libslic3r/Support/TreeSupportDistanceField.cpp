@@ -0,0 +1,337 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#include "TreeSupportDistanceField.hpp"
+
+#include "../ClipperUtils.hpp"
+#include "../MarchingSquares.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include <tbb/parallel_for.h>
+
+namespace Slic3r::FFFTreeSupport
+{
+
+// Binary raster of the cells of a DistanceField with a value lower or equal to a threshold,
+// limited to a window of the grid, to be traced by the marching squares.
+struct DistanceFieldThreshold
+{
+    const DistanceField *field;
+    float                threshold;
+    size_t               row0;
+    size_t               col0;
+    size_t               rows;
+    size_t               cols;
+};
+
+} // namespace Slic3r::FFFTreeSupport
+
+namespace marchsq {
+
+template<> struct _RasterTraits<Slic3r::FFFTreeSupport::DistanceFieldThreshold> {
+    using Rst       = Slic3r::FFFTreeSupport::DistanceFieldThreshold;
+    using ValueType = uint8_t;
+
+    static uint8_t get(const Rst &rst, size_t row, size_t col) { return (*rst.field)(rst.row0 + row, rst.col0 + col) <= rst.threshold; }
+
+    static size_t rows(const Rst &rst) { return rst.rows; }
+    static size_t cols(const Rst &rst) { return rst.cols; }
+};
+
+} // namespace marchsq
+
+namespace Slic3r::FFFTreeSupport
+{
+
+static constexpr const float DISTANCE_FIELD_INFINITY = 1e20f;
+
+DistanceField::DistanceField(const BoundingBox &bbox, coord_t resolution, size_t max_cells)
+{
+    assert(bbox.defined);
+    assert(resolution > 0);
+    const Vec2d size = (bbox.max - bbox.min).cast<double>();
+    // Two border cells on each side.
+    auto num_cells = [&size](double resolution) {
+        return (std::floor(size.x() / resolution) + 5.) * (std::floor(size.y() / resolution) + 5.);
+    };
+    double res = resolution;
+    if (double cells = num_cells(res); cells > double(max_cells))
+        res *= std::sqrt(cells / double(max_cells));
+    while (num_cells(res) > double(max_cells))
+        res *= 1.05;
+    m_resolution = coord_t(std::ceil(res));
+    m_rows       = size_t(size.y() / m_resolution) + 5;
+    m_cols       = size_t(size.x() / m_resolution) + 5;
+    m_origin     = bbox.min - Point(2 * m_resolution, 2 * m_resolution);
+    m_values.assign(m_rows * m_cols, 0.f);
+}
+
+// Squared Euclidean distance transform of a sampled function along a line.
+// P. Felzenszwalb, D. Huttenlocher: Distance Transforms of Sampled Functions, 2012.
+// Samples of f equal to DISTANCE_FIELD_INFINITY are not sites. v, z are work buffers of n and n + 1 elements.
+static void distance_transform_1d(const float *f, size_t n, float *d, int *v, double *z)
+{
+    // Lower envelope of the parabolas rooted at the sites.
+    int k = -1;
+    for (int q = 0; q < int(n); ++ q) {
+        if (f[q] >= DISTANCE_FIELD_INFINITY)
+            continue;
+        if (k == -1) {
+            k    = 0;
+            v[0] = q;
+            z[0] = - std::numeric_limits<double>::max();
+            z[1] = std::numeric_limits<double>::max();
+            continue;
+        }
+        double s;
+        for (;;) {
+            // Intersection of the parabola rooted at q with the parabola rooted at v[k].
+            s = ((double(f[q]) + double(q) * double(q)) - (double(f[v[k]]) + double(v[k]) * double(v[k]))) / double(2 * (q - v[k]));
+            if (s > z[k])
+                break;
+            // z[0] is -inf, thus k never drops below zero.
+            -- k;
+        }
+        ++ k;
+        v[k]     = q;
+        z[k]     = s;
+        z[k + 1] = std::numeric_limits<double>::max();
+    }
+    if (k == -1) {
+        // No site at all.
+        std::fill(d, d + n, DISTANCE_FIELD_INFINITY);
+        return;
+    }
+    k = 0;
+    for (int q = 0; q < int(n); ++ q) {
+        while (z[k + 1] < double(q))
+            ++ k;
+        d[q] = std::min(DISTANCE_FIELD_INFINITY, float(q - v[k]) * float(q - v[k]) + f[v[k]]);
+    }
+}
+
+void DistanceField::distance_transform(const std::vector<uint8_t> &mask)
+{
+    assert(mask.size() == m_values.size());
+    // Vertical pass, squared distances in cells.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_cols, 16), [this, &mask](const tbb::blocked_range<size_t> &range) {
+        std::vector<float>  f(m_rows), d(m_rows);
+        std::vector<double> z(m_rows + 1);
+        std::vector<int>    v(m_rows);
+        for (size_t col = range.begin(); col < range.end(); ++ col) {
+            for (size_t row = 0; row < m_rows; ++ row)
+                f[row] = mask[row * m_cols + col] ? 0.f : DISTANCE_FIELD_INFINITY;
+            distance_transform_1d(f.data(), m_rows, d.data(), v.data(), z.data());
+            for (size_t row = 0; row < m_rows; ++ row)
+                m_values[row * m_cols + col] = d[row];
+        }
+    });
+    // Horizontal pass, converted to distances in scaled coordinates.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rows, 16), [this](const tbb::blocked_range<size_t> &range) {
+        std::vector<float>  d(m_cols);
+        std::vector<double> z(m_cols + 1);
+        std::vector<int>    v(m_cols);
+        for (size_t row = range.begin(); row < range.end(); ++ row) {
+            float *values = m_values.data() + row * m_cols;
+            distance_transform_1d(values, m_cols, d.data(), v.data(), z.data());
+            for (size_t col = 0; col < m_cols; ++ col)
+                values[col] = d[col] >= DISTANCE_FIELD_INFINITY ? DISTANCE_FIELD_INFINITY : std::sqrt(d[col]) * float(m_resolution);
+        }
+    });
+}
+
+void DistanceField::distance_to(const Polygons &polygons)
+{
+    // Scan convert the polygons: collect intersections of the polygon edges with the horizontal lines through the cell centers.
+    // A cell center lying exactly on a horizontal line is counted just once by treating the edges as half open intervals in Y.
+    std::vector<std::vector<double>> intersections(m_rows);
+    for (const Polygon &polygon : polygons)
+        for (size_t i = 0; i < polygon.size(); ++ i) {
+            const Point &a = polygon.points[i];
+            const Point &b = polygon.points[i + 1 == polygon.size() ? 0 : i + 1];
+            if (a.y() == b.y())
+                continue;
+            const Point &lo = a.y() < b.y() ? a : b;
+            const Point &hi = a.y() < b.y() ? b : a;
+            const auto row_begin = std::max<int64_t>(0,              int64_t(std::ceil(double(lo.y() - m_origin.y()) / m_resolution)));
+            const auto row_end   = std::min<int64_t>(int64_t(m_rows), int64_t(std::ceil(double(hi.y() - m_origin.y()) / m_resolution)));
+            const double dxdy = double(hi.x() - lo.x()) / double(hi.y() - lo.y());
+            for (int64_t row = row_begin; row < row_end; ++ row)
+                intersections[row].emplace_back(double(lo.x()) + dxdy * (double(m_origin.y() + row * m_resolution) - double(lo.y())));
+        }
+
+    std::vector<uint8_t> mask(m_values.size(), 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rows, 16), [this, &intersections, &mask](const tbb::blocked_range<size_t> &range) {
+        for (size_t row = range.begin(); row < range.end(); ++ row) {
+            std::vector<double> &xs = intersections[row];
+            assert(xs.size() % 2 == 0);
+            std::sort(xs.begin(), xs.end());
+            for (size_t i = 0; i + 1 < xs.size(); i += 2) {
+                const auto col_begin = std::max<int64_t>(0,              int64_t(std::ceil((xs[i]     - m_origin.x()) / m_resolution)));
+                const auto col_end   = std::min<int64_t>(int64_t(m_cols), int64_t(std::ceil((xs[i + 1] - m_origin.x()) / m_resolution)));
+                if (col_begin < col_end)
+                    std::fill(mask.begin() + row * m_cols + col_begin, mask.begin() + row * m_cols + col_end, 1);
+            }
+        }
+    });
+
+    this->distance_transform(mask);
+}
+
+void DistanceField::distance_inside(const DistanceField &field, float threshold)
+{
+    assert(field.rows() == m_rows && field.cols() == m_cols);
+    std::vector<uint8_t> mask(m_values.size());
+    for (size_t i = 0; i < mask.size(); ++ i)
+        mask[i] = field.m_values[i] > threshold;
+    this->distance_transform(mask);
+}
+
+// Running maximum over windows of 2 * k + 1 cells along the lines of the grid advancing by (drow, dcol),
+// with drow == 0 && dcol == 1 for the rows, or drow == 1 for the columns and diagonals.
+// M. van Herk: A fast algorithm for local minimum and maximum filters on rectangular and octagonal kernels, 1992:
+// The lines are split into blocks of 2 * k + 1 cells, the maximum over a window is the maximum of the suffix maximum
+// of the block containing the first cell of the window and the prefix maximum of the block containing the last cell.
+// The windows are clipped at the ends of the lines. The cost does not depend on k.
+void DistanceField::dilate_lines(size_t k, int drow, int dcol)
+{
+    assert((drow == 0 && dcol == 1) || (drow == 1 && dcol >= -1 && dcol <= 1));
+    const size_t w = 2 * k + 1;
+    if (drow == 0) {
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rows, 16), [this, k, w](const tbb::blocked_range<size_t> &range) {
+            std::vector<float> prefix(m_cols), suffix(m_cols);
+            for (size_t row = range.begin(); row < range.end(); ++ row) {
+                float *values = m_values.data() + row * m_cols;
+                for (size_t col = 0; col < m_cols; ++ col)
+                    prefix[col] = col % w == 0 ? values[col] : std::max(prefix[col - 1], values[col]);
+                for (size_t col = m_cols; col > 0; -- col)
+                    suffix[col - 1] = col == m_cols || col % w == 0 ? values[col - 1] : std::max(suffix[col], values[col - 1]);
+                for (size_t col = 0; col < m_cols; ++ col)
+                    values[col] = std::max(suffix[col < k ? 0 : col - k], prefix[std::min(col + k, m_cols - 1)]);
+            }
+        });
+        return;
+    }
+
+    // The lines advance by one row, thus the blocks are aligned to the rows and the blocks of rows are independent.
+    std::vector<float> prefix(m_values.size()), suffix(m_values.size());
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, (m_rows + w - 1) / w), [this, &prefix, &suffix, w, dcol](const tbb::blocked_range<size_t> &range) {
+        for (size_t block = range.begin(); block < range.end(); ++ block) {
+            const size_t row_begin = block * w;
+            const size_t row_end   = std::min(row_begin + w, m_rows);
+            for (size_t row = row_begin; row < row_end; ++ row)
+                for (size_t col = 0; col < m_cols; ++ col) {
+                    const int64_t prev_col = int64_t(col) - dcol;
+                    const size_t  idx      = row * m_cols + col;
+                    prefix[idx] = row == row_begin || prev_col < 0 || prev_col >= int64_t(m_cols) ? m_values[idx] :
+                        std::max(prefix[idx - m_cols - dcol], m_values[idx]);
+                }
+            for (size_t row = row_end; row > row_begin; -- row)
+                for (size_t col = 0; col < m_cols; ++ col) {
+                    const int64_t next_col = int64_t(col) + dcol;
+                    const size_t  idx      = (row - 1) * m_cols + col;
+                    suffix[idx] = row == row_end || next_col < 0 || next_col >= int64_t(m_cols) ? m_values[idx] :
+                        std::max(suffix[idx + m_cols + dcol], m_values[idx]);
+                }
+        }
+    });
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_rows, 16), [this, &prefix, &suffix, k, dcol](const tbb::blocked_range<size_t> &range) {
+        for (size_t row = range.begin(); row < range.end(); ++ row)
+            for (size_t col = 0; col < m_cols; ++ col) {
+                // Number of steps to the first and to the last cell of the window, clipped by the ends of the line.
+                size_t back = std::min(k, row);
+                size_t fwd  = std::min(k, m_rows - 1 - row);
+                if (dcol > 0) {
+                    back = std::min(back, col);
+                    fwd  = std::min(fwd, m_cols - 1 - col);
+                } else if (dcol < 0) {
+                    back = std::min(back, m_cols - 1 - col);
+                    fwd  = std::min(fwd, col);
+                }
+                m_values[row * m_cols + col] = std::max(
+                    suffix[(row - back) * m_cols + col - int64_t(back) * dcol],
+                    prefix[(row + fwd)  * m_cols + col + int64_t(fwd)  * dcol]);
+            }
+    });
+}
+
+void DistanceField::dilate(coord_t radius)
+{
+    // An octagon is the Minkowski sum of segments in the directions 0, 45, 90 and 135 degrees, thus the dilation
+    // is separable into running maxima along the rows, columns and diagonals. Choose the half lengths of the axis
+    // and diagonal segments in whole cells, so that the octagon fits into the circle and its inscribed radius is maximal.
+    const double r = double(radius) / double(m_resolution);
+    size_t k_axis = 0;
+    size_t k_diag = 0;
+    double best   = 0;
+    for (size_t a = 0; double(a) <= r; ++ a)
+        for (size_t b = 0; double(a + 2 * b) <= r; ++ b) {
+            // Vertices of the octagon are at (a + 2b, a) and its symmetries.
+            if (double(a + 2 * b) * double(a + 2 * b) + double(a * a) > r * r)
+                break;
+            // Inscribed radius: minimum of the extents in the axis and diagonal directions.
+            if (double inscribed = std::min(double(a + 2 * b), std::sqrt(2.) * double(a + b)); inscribed > best) {
+                best   = inscribed;
+                k_axis = a;
+                k_diag = b;
+            }
+        }
+    if (k_axis > 0) {
+        this->dilate_lines(k_axis, 0, 1);
+        this->dilate_lines(k_axis, 1, 0);
+    }
+    if (k_diag > 0) {
+        this->dilate_lines(k_diag, 1, 1);
+        this->dilate_lines(k_diag, 1, -1);
+    }
+}
+
+void DistanceField::min(const DistanceField &other)
+{
+    assert(other.rows() == m_rows && other.cols() == m_cols);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, m_values.size(), 4096), [this, &other](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            m_values[i] = std::min(m_values[i], other.m_values[i]);
+    });
+}
+
+Polygons DistanceField::contour(float threshold) const
+{
+    // Trace just the window of the grid containing cells below the threshold.
+    size_t row_min = m_rows, row_max = 0, col_min = m_cols, col_max = 0;
+    for (size_t row = 0; row < m_rows; ++ row) {
+        const float *values = m_values.data() + row * m_cols;
+        size_t col_first = 0;
+        while (col_first < m_cols && values[col_first] > threshold)
+            ++ col_first;
+        if (col_first == m_cols)
+            continue;
+        size_t col_last = m_cols - 1;
+        while (values[col_last] > threshold)
+            -- col_last;
+        row_min = std::min(row_min, row);
+        row_max = row;
+        col_min = std::min(col_min, col_first);
+        col_max = std::max(col_max, col_last);
+    }
+    if (row_min > row_max)
+        return {};
+
+    const DistanceFieldThreshold raster{ this, threshold, row_min, col_min, row_max + 1 - row_min, col_max + 1 - col_min };
+    std::vector<marchsq::Ring> rings = marchsq::execute(raster, uint8_t(1), { 2, 2 });
+    Polygons polygons;
+    polygons.reserve(rings.size());
+    for (const marchsq::Ring &ring : rings) {
+        Polygon &polygon = polygons.emplace_back();
+        polygon.points.reserve(ring.size());
+        for (const marchsq::Coord &crd : ring)
+            polygon.points.emplace_back(this->cell_center(row_min + crd.r, col_min + crd.c));
+    }
+    return union_(polygons, ClipperLib::pftEvenOdd);
+}
+
+} // namespace Slic3r::FFFTreeSupport
@@ -0,0 +1,76 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef slic3r_TreeSupportDistanceField_hpp
+#define slic3r_TreeSupportDistanceField_hpp
+
+#include <vector>
+
+#include "../BoundingBox.hpp"
+#include "../Polygon.hpp"
+
+namespace Slic3r
+{
+
+namespace FFFTreeSupport
+{
+
+// Scalar field sampled at the centers of a regular grid of square cells.
+// Used by TreeModelVolumes to derive the avoidances of all radii at a layer by thresholding a single field,
+// see TreeModelVolumes::calculateAvoidanceDistanceField().
+// All operations run in parallel over the rows or columns of the grid.
+class DistanceField
+{
+public:
+    DistanceField() = default;
+    // Grid covering bbox with a border of two cells. The cell size is increased over resolution
+    // if the grid would have more than max_cells cells. All values are initialized to zero.
+    DistanceField(const BoundingBox &bbox, coord_t resolution, size_t max_cells);
+
+    size_t  rows()       const { return m_rows; }
+    size_t  cols()       const { return m_cols; }
+    coord_t resolution() const { return m_resolution; }
+    bool    empty()      const { return m_values.empty(); }
+
+    float   operator()(size_t row, size_t col) const { return m_values[row * m_cols + col]; }
+    float&  operator()(size_t row, size_t col) { return m_values[row * m_cols + col]; }
+    std::vector<float>&       values()       { return m_values; }
+    const std::vector<float>& values() const { return m_values; }
+
+    // Center of a cell.
+    Point   cell_center(size_t row, size_t col) const
+        { return m_origin + Point(coord_t(col) * m_resolution, coord_t(row) * m_resolution); }
+
+    // Euclidean distance of each cell center to the nearest cell center inside polygons, zero inside.
+    // Polygons are expected not to overlap, they are filled with the even-odd rule.
+    void    distance_to(const Polygons &polygons);
+    // For the cells where field <= threshold, Euclidean distance of the cell center to the nearest cell center
+    // with field > threshold. Zero for the other cells. The field has to share the grid with this one.
+    void    distance_inside(const DistanceField &field, float threshold);
+    // Grayscale dilation by a flat octagon approximating a circle of the given radius from inside:
+    // each value is replaced by the maximum over the octagon centered at the cell.
+    // The octagon is made of whole cells and it never reaches further than radius.
+    void    dilate(coord_t radius);
+    // Each value is replaced by the minimum of itself and the value of the other field at the same cell.
+    void    min(const DistanceField &other);
+    // Polygons enclosing the centers of the cells with a value lower or equal to threshold.
+    Polygons contour(float threshold) const;
+
+private:
+    // Fill m_values with distances to the cells marked in the mask.
+    void    distance_transform(const std::vector<uint8_t> &mask);
+    // Running maximum over 2 * k + 1 cells along the lines advancing by (drow, dcol).
+    void    dilate_lines(size_t k, int drow, int dcol);
+
+    Point               m_origin { Point::Zero() };
+    coord_t             m_resolution { 0 };
+    size_t              m_rows { 0 };
+    size_t              m_cols { 0 };
+    std::vector<float>  m_values;
+};
+
+} // namespace FFFTreeSupport
+} // namespace Slic3r
+
+#endif // slic3r_TreeSupportDistanceField_hpp
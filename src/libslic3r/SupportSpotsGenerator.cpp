@@ -25,6 +25,7 @@
 #include "tbb/blocked_range2d.h"
 #include "tbb/parallel_reduce.h"
 #include <algorithm>
+#include <boost/functional/hash.hpp>
 #include <boost/log/trivial.hpp>
 #include <cmath>
 #include <cstddef>
@@ -249,17 +250,21 @@ SliceConnection estimate_slice_connection(size_t slice_idx, const Layer *layer)
 };
 
 using PrecomputedSliceConnections = std::vector<std::vector<SliceConnection>>;
-PrecomputedSliceConnections precompute_slices_connections(const PrintObject *po)
+// Connections of the slices of layers starting with first_layer_idx, the connections of the layers below are left empty.
+PrecomputedSliceConnections precompute_slices_connections(const PrintObject *po, size_t first_layer_idx)
 {
     PrecomputedSliceConnections result{};
     for (size_t lidx = 0; lidx < po->layer_count(); lidx++) {
         result.emplace_back(std::vector<SliceConnection>{});
+        if (lidx < first_layer_idx) {
+            continue;
+        }
         for (size_t slice_idx = 0; slice_idx < po->get_layer(lidx)->lslices_ex.size(); slice_idx++) {
             result[lidx].push_back(SliceConnection{});
         }
     }
 
-    tbb::parallel_for(tbb::blocked_range<size_t>(0, po->layers().size()), [po, &result](tbb::blocked_range<size_t> r) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(first_layer_idx, po->layers().size()), [po, &result](tbb::blocked_range<size_t> r) {
         for (size_t lidx = r.begin(); lidx < r.end(); lidx++) {
             const Layer *l = po->get_layer(lidx);
             tbb::parallel_for(tbb::blocked_range<size_t>(0, l->lslices_ex.size()), [lidx, l, &result](tbb::blocked_range<size_t> r2) {
@@ -325,6 +330,12 @@ float estimate_curled_up_height(
     return curled_up_height;
 }
 
+// Pure bridges are checked against the slices of the layer below only, the other extrusions against the external perimeters of the layer below.
+bool is_pure_bridge(const ExtrusionEntity *entity)
+{
+    return entity->role().is_bridge() && !entity->role().is_perimeter();
+}
+
 std::vector<ExtrusionLine> check_extrusion_entity_stability(const ExtrusionEntity                      *entity,
                                                             const LayerRegion                          *layer_region,
                                                             const LD                                   &prev_layer_lines,
@@ -332,7 +343,7 @@ std::vector<ExtrusionLine> check_extrusion_entity_stability(const ExtrusionEntit
                                                             const Params                               &params)
 {
     assert(!entity->is_collection());
-    if (entity->role().is_bridge() && !entity->role().is_perimeter()) {
+    if (is_pure_bridge(entity)) {
         // pure bridges are handled separately, beacuse we need to align the forward and backward direction support points
         if (entity->length() < scale_(params.min_distance_to_allow_local_supports)) {
             return {};
@@ -769,6 +780,84 @@ bool has_brim(const Layer* layer, const Params& params){
         && params.brim_width > 0.0;
 }
 
+void hash_points(size_t &seed, const Points &points)
+{
+    boost::hash_combine(seed, points.size());
+    for (const Point &pt : points) {
+        boost::hash_combine(seed, pt.x());
+        boost::hash_combine(seed, pt.y());
+    }
+}
+
+void hash_extrusions(size_t &seed, const ExtrusionEntity *entity)
+{
+    auto hash_path = [&seed](const ExtrusionPath &path) {
+        boost::hash_combine(seed, int(extrusion_role_to_gcode_extrusion_role(path.role())));
+        boost::hash_combine(seed, path.width());
+        boost::hash_combine(seed, path.height());
+        hash_points(seed, path.polyline.points);
+    };
+    if (entity->is_collection()) {
+        for (const ExtrusionEntity *e : static_cast<const ExtrusionEntityCollection *>(entity)->entities) {
+            hash_extrusions(seed, e);
+        }
+    } else if (const auto *path = dynamic_cast<const ExtrusionPath *>(entity); path != nullptr) {
+        hash_path(*path);
+    } else if (const auto *loop = dynamic_cast<const ExtrusionLoop *>(entity); loop != nullptr) {
+        for (const ExtrusionPath &path : loop->paths) {
+            hash_path(path);
+        }
+    } else if (const auto *multi_path = dynamic_cast<const ExtrusionMultiPath *>(entity); multi_path != nullptr) {
+        for (const ExtrusionPath &path : multi_path->paths) {
+            hash_path(path);
+        }
+    }
+}
+
+// Hash of the layer data read by check_stability(): the slices, their links to the slices below, their extrusions
+// and the flows of the regions extruding them. The search of a layer depends only on the fingerprints of the layer
+// and of the layers below.
+size_t layer_fingerprint(const Layer *layer)
+{
+    size_t seed = 0;
+    // Only the regions of the islands are hashed. A layer range modifier adds regions to all the layers of the object,
+    // which must not change the fingerprints of the layers outside of the range.
+    auto hash_region = [layer, &seed](uint32_t region_id) {
+        boost::hash_combine(seed, region_id);
+        const LayerRegion *region = layer->get_region(region_id);
+        for (FlowRole role : {frExternalPerimeter, frPerimeter, frInfill, frSolidInfill, frTopSolidInfill}) {
+            boost::hash_combine(seed, region->flow(role).width());
+        }
+    };
+    boost::hash_combine(seed, layer->id());
+    boost::hash_combine(seed, layer->print_z);
+    boost::hash_combine(seed, layer->height);
+    boost::hash_combine(seed, layer->lslices.size());
+    for (const ExPolygon &expoly : layer->lslices) {
+        hash_points(seed, expoly.contour.points);
+        boost::hash_combine(seed, expoly.holes.size());
+        for (const Polygon &hole : expoly.holes) {
+            hash_points(seed, hole.points);
+        }
+    }
+    for (const LayerSlice &slice : layer->lslices_ex) {
+        boost::hash_combine(seed, slice.overlaps_below.size());
+        for (const LayerSlice::Link &link : slice.overlaps_below) {
+            boost::hash_combine(seed, link.slice_idx);
+        }
+        for (const LayerIsland &island : slice.islands) {
+            hash_region(island.perimeters.region());
+            for (const LayerExtrusionRange &fill_range : island.fills) {
+                hash_region(fill_range.region());
+            }
+        }
+        for (const ExtrusionEntityCollection *collection : gather_extrusions(slice, layer)) {
+            hash_extrusions(seed, collection);
+        }
+    }
+    return seed;
+}
+
 
 Polygons get_brim(const ExPolygon& slice_polygon, const BrimType brim_type, const float brim_width) {
     // TODO: The algorithm here should take into account that multiple slices may
@@ -930,7 +1019,7 @@ std::vector<EnitityToCheck> gather_entities_to_check(const Layer* layer) {
 
 LocalSupports compute_local_supports(
     const std::vector<EnitityToCheck>& entities_to_check,
-    const std::optional<Linesf>& previous_layer_boundary,
+    const AABBTreeLines::LinesDistancer<Linef>& prev_layer_boundary_distancer,
     const LD& prev_layer_ext_perim_lines,
     size_t slices_count,
     const Params& params
@@ -938,39 +1027,36 @@ LocalSupports compute_local_supports(
     std::vector<tbb::concurrent_vector<ExtrusionLine>> unstable_lines_per_slice(slices_count);
     std::vector<tbb::concurrent_vector<ExtrusionLine>> ext_perim_lines_per_slice(slices_count);
 
-    AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary_distancer =
-        (previous_layer_boundary ? AABBTreeLines::LinesDistancer<Linef>{*previous_layer_boundary} : AABBTreeLines::LinesDistancer<Linef>{});
-
+    std::vector<std::vector<ExtrusionLine>> lines_per_entity(entities_to_check.size());
+    auto check_entity = [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &lines_per_entity,
+                         &params](size_t entity_idx) {
+        const auto &e_to_check       = entities_to_check[entity_idx];
+        lines_per_entity[entity_idx] = check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
+                                                                        prev_layer_boundary_distancer, params);
+    };
     if constexpr (debug_files) {
-        for (const auto &e_to_check : entities_to_check) {
-            for (const auto &line : check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
-                                                                     prev_layer_boundary_distancer, params)) {
-                if (line.support_point_generated.has_value()) {
-                    unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                }
-                if (line.is_external_perimeter()) {
-                    ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                }
-            }
+        for (size_t entity_idx = 0; entity_idx < entities_to_check.size(); ++entity_idx) {
+            check_entity(entity_idx);
         }
     } else {
-        tbb::parallel_for(tbb::blocked_range<size_t>(0, entities_to_check.size()),
-                          [&entities_to_check, &prev_layer_ext_perim_lines, &prev_layer_boundary_distancer, &unstable_lines_per_slice,
-                           &ext_perim_lines_per_slice, &params](tbb::blocked_range<size_t> r) {
-                              for (size_t entity_idx = r.begin(); entity_idx < r.end(); ++entity_idx) {
-                                  const auto &e_to_check = entities_to_check[entity_idx];
-                                  for (const auto &line :
-                                       check_extrusion_entity_stability(e_to_check.e, e_to_check.region, prev_layer_ext_perim_lines,
-                                                                        prev_layer_boundary_distancer, params)) {
-                                      if (line.support_point_generated.has_value()) {
-                                          unstable_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                      if (line.is_external_perimeter()) {
-                                          ext_perim_lines_per_slice[e_to_check.slice_idx].push_back(line);
-                                      }
-                                  }
-                              }
-                          });
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, entities_to_check.size()), [&check_entity](tbb::blocked_range<size_t> r) {
+            for (size_t entity_idx = r.begin(); entity_idx < r.end(); ++entity_idx) {
+                check_entity(entity_idx);
+            }
+        });
+    }
+    // Collect the lines in the order of the entities. The support points are filtered by the order of the lines,
+    // thus the search gives the same result regardless of the scheduling of the parallel checks.
+    for (size_t entity_idx = 0; entity_idx < entities_to_check.size(); ++entity_idx) {
+        const size_t slice_idx = entities_to_check[entity_idx].slice_idx;
+        for (const ExtrusionLine &line : lines_per_entity[entity_idx]) {
+            if (line.support_point_generated.has_value()) {
+                unstable_lines_per_slice[slice_idx].push_back(line);
+            }
+            if (line.is_external_perimeter()) {
+                ext_perim_lines_per_slice[slice_idx].push_back(line);
+            }
+        }
     }
     return {unstable_lines_per_slice, ext_perim_lines_per_slice};
 }
@@ -1114,33 +1200,155 @@ void reckon_global_supports(const tbb::concurrent_vector<ExtrusionLine> &externa
     }
 }
 
-std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject                 *po,
-                                                          const PrecomputedSliceConnections &precomputed_slices_connections,
-                                                          const PrintTryCancel              &cancel_func,
-                                                          const Params                      &params)
+// Number of layers between the states of the search saved into SearchCache.
+static constexpr const size_t SearchCheckpointInterval = 16;
+
+// State of check_stability() before processing a layer.
+struct SearchCheckpoint
+{
+    ActiveObjectParts          active_object_parts;
+    SliceMappings              slice_mappings;
+    // External perimeters of the layer below. The lines do not reference their extrusion entities,
+    // which do not survive regeneration of the layer.
+    std::vector<ExtrusionLine> prev_layer_ext_perim_lines;
+    size_t                     support_points_count;
+    size_t                     partial_objects_count;
+};
+
+struct SearchCache
+{
+    std::optional<Params>         params;
+    // Size of the object defining the grid of SupportGridFilter.
+    Vec3crd                       object_size{Vec3crd::Zero()};
+    // Fingerprints of the layers seen by the last search, see layer_fingerprint().
+    std::vector<size_t>           layer_fingerprints;
+    // checkpoints[i] is the state before layer i * SearchCheckpointInterval.
+    std::vector<SearchCheckpoint> checkpoints;
+    // Support points and partial objects found below the last checkpoint.
+    SupportPoints                 support_points;
+    PartialObjects                partial_objects;
+    // Layer, from which the last search started.
+    size_t                        first_searched_layer_idx{0};
+};
+
+size_t first_searched_layer(const SearchCache &cache) { return cache.first_searched_layer_idx; }
+
+bool same_params(const Params &lhs, const Params &rhs)
+{
+    // The other parameters are constant.
+    return lhs.max_acceleration == rhs.max_acceleration && lhs.raft_layers_count == rhs.raft_layers_count &&
+           lhs.filament_type == rhs.filament_type && lhs.brim_type == rhs.brim_type && lhs.brim_width == rhs.brim_width;
+}
+
+std::tuple<SupportPoints, PartialObjects> check_stability(const PrintObject    *po,
+                                                          const PrintTryCancel &cancel_func,
+                                                          const Params         &params,
+                                                          SearchCache          &cache)
 {
-    SupportPoints     supp_points{};
+    const size_t        layer_count = po->layer_count();
+    std::vector<size_t> layer_fingerprints(layer_count);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, layer_count), [po, &layer_fingerprints](tbb::blocked_range<size_t> r) {
+        for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+            layer_fingerprints[layer_idx] = layer_fingerprint(po->get_layer(layer_idx));
+        }
+    });
+
+    if (!cache.params.has_value() || !same_params(*cache.params, params) || cache.object_size != po->size()) {
+        // Results of all the layers depend on the parameters and on the grid of SupportGridFilter.
+        cache.params.reset();
+        cache.params.emplace(params);
+        cache.object_size = po->size();
+        cache.checkpoints.clear();
+    }
+    if (cache.checkpoints.empty()) {
+        cache.checkpoints.push_back({ActiveObjectParts{}, SliceMappings{}, {}, 0, 0});
+    }
+    // Resume from the last checkpoint not above the lowest changed layer.
+    const size_t first_changed_layer_idx = std::mismatch(layer_fingerprints.begin(), layer_fingerprints.end(),
+                                                         cache.layer_fingerprints.begin(), cache.layer_fingerprints.end())
+                                               .first -
+                                           layer_fingerprints.begin();
+    cache.layer_fingerprints = std::move(layer_fingerprints);
+    cache.checkpoints.erase(cache.checkpoints.begin() +
+                                std::min(first_changed_layer_idx / SearchCheckpointInterval + 1, cache.checkpoints.size()),
+                            cache.checkpoints.end());
+    const SearchCheckpoint &checkpoint      = cache.checkpoints.back();
+    const size_t            first_layer_idx = (cache.checkpoints.size() - 1) * SearchCheckpointInterval;
+    cache.support_points.erase(cache.support_points.begin() + checkpoint.support_points_count, cache.support_points.end());
+    cache.partial_objects.erase(cache.partial_objects.begin() + checkpoint.partial_objects_count, cache.partial_objects.end());
+    cache.first_searched_layer_idx = first_layer_idx;
+    BOOST_LOG_TRIVIAL(debug) << "Searching support spots from layer " << first_layer_idx << " of " << layer_count;
+
+    SupportPoints     supp_points{cache.support_points};
     SupportGridFilter supports_presence_grid(po, params.min_distance_between_support_points);
-    ActiveObjectParts active_object_parts{};
-    PartialObjects    partial_objects{};
-    LD                prev_layer_ext_perim_lines;
+    // Each support point takes its cell of the grid, see reckon_new_support_point().
+    for (const SupportPoint &support_point : supp_points) {
+        supports_presence_grid.take_position(support_point.position);
+    }
+    ActiveObjectParts active_object_parts{checkpoint.active_object_parts};
+    PartialObjects    partial_objects{cache.partial_objects};
+    LD                prev_layer_ext_perim_lines{checkpoint.prev_layer_ext_perim_lines};
+
+    SliceMappings slice_mappings{checkpoint.slice_mappings};
 
-    SliceMappings slice_mappings;
+    const PrecomputedSliceConnections precomputed_slices_connections = precompute_slices_connections(po, first_layer_idx);
 
+    // The pure bridges do not depend on the curling of the layer below, they are checked for all the layers in parallel.
+    // The other extrusions are checked against the external perimeters of the layer below, whose curling depends
+    // on the layers below them, thus they are checked layer by layer.
+    struct LayerToCheck
+    {
+        std::vector<EnitityToCheck>          entities_to_check;
+        AABBTreeLines::LinesDistancer<Linef> prev_layer_boundary;
+        LocalSupports                        bridges_local_supports;
+    };
+    std::vector<LayerToCheck> layers_to_check(layer_count - first_layer_idx);
+    tbb::parallel_for(tbb::blocked_range<size_t>(first_layer_idx, layer_count),
+                      [po, first_layer_idx, &layers_to_check, &params](tbb::blocked_range<size_t> r) {
+                          for (size_t layer_idx = r.begin(); layer_idx < r.end(); ++layer_idx) {
+                              const Layer  *layer          = po->get_layer(layer_idx);
+                              LayerToCheck &layer_to_check = layers_to_check[layer_idx - first_layer_idx];
+                              if (layer->lower_layer != nullptr) {
+                                  layer_to_check.prev_layer_boundary = AABBTreeLines::LinesDistancer<Linef>{
+                                      to_unscaled_linesf(layer->lower_layer->lslices)};
+                              }
+                              std::vector<EnitityToCheck> bridges_to_check;
+                              for (const EnitityToCheck &e_to_check : gather_entities_to_check(layer)) {
+                                  (is_pure_bridge(e_to_check.e) ? bridges_to_check : layer_to_check.entities_to_check).push_back(e_to_check);
+                              }
+                              layer_to_check.bridges_local_supports = compute_local_supports(bridges_to_check,
+                                                                                             layer_to_check.prev_layer_boundary, LD{},
+                                                                                             layer->lslices_ex.size(), params);
+                          }
+                      });
 
-    for (size_t layer_idx = 0; layer_idx < po->layer_count(); ++layer_idx) {
+    for (size_t layer_idx = first_layer_idx; layer_idx < layer_count; ++layer_idx) {
         cancel_func();
+        if (layer_idx % SearchCheckpointInterval == 0 && layer_idx / SearchCheckpointInterval == cache.checkpoints.size()) {
+            cache.support_points.insert(cache.support_points.end(), supp_points.begin() + cache.support_points.size(), supp_points.end());
+            cache.partial_objects.insert(cache.partial_objects.end(), partial_objects.begin() + cache.partial_objects.size(),
+                                         partial_objects.end());
+            std::vector<ExtrusionLine> ext_perim_lines = prev_layer_ext_perim_lines.get_lines();
+            for (ExtrusionLine &line : ext_perim_lines) {
+                line.origin_entity = nullptr;
+            }
+            cache.checkpoints.push_back(
+                {active_object_parts, slice_mappings, std::move(ext_perim_lines), supp_points.size(), partial_objects.size()});
+        }
         const Layer *layer                 = po->get_layer(layer_idx);
         float        bottom_z              = layer->bottom_z();
 
         slice_mappings = update_active_object_parts(layer, params, precomputed_slices_connections[layer_idx], slice_mappings, active_object_parts, partial_objects);
 
-        std::optional<Linesf> prev_layer_boundary = layer->lower_layer != nullptr ?
-                                                        std::optional{to_unscaled_linesf(layer->lower_layer->lslices)} :
-                                                        std::nullopt;
-
-        LocalSupports local_supports{
-            compute_local_supports(gather_entities_to_check(layer), prev_layer_boundary, prev_layer_ext_perim_lines, layer->lslices_ex.size(), params)};
+        LayerToCheck &layer_to_check = layers_to_check[layer_idx - first_layer_idx];
+        LocalSupports local_supports{compute_local_supports(layer_to_check.entities_to_check, layer_to_check.prev_layer_boundary,
+                                                            prev_layer_ext_perim_lines, layer->lslices_ex.size(), params)};
+        for (size_t slice_idx = 0; slice_idx < layer->lslices_ex.size(); ++slice_idx) {
+            const tbb::concurrent_vector<ExtrusionLine> &bridge_lines = layer_to_check.bridges_local_supports.unstable_lines_per_slice[slice_idx];
+            local_supports.unstable_lines_per_slice[slice_idx].grow_by(bridge_lines.begin(), bridge_lines.end());
+        }
+        // Release the data of the layer early, the search may span many layers.
+        layer_to_check = LayerToCheck{};
 
         std::vector<ExtrusionLine> current_layer_ext_perims_lines{};
         current_layer_ext_perims_lines.reserve(prev_layer_ext_perim_lines.get_lines().size());
@@ -1221,8 +1429,17 @@ void debug_export(const SupportPoints& support_points,const PartialObjects& obje
 
 std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params)
 {
-    auto precomputed_slices_connections = precompute_slices_connections(po);
-    auto results = check_stability(po, precomputed_slices_connections, cancel_func, params);
+    std::shared_ptr<SearchCache> cache;
+    return full_search(po, cancel_func, params, cache);
+}
+
+std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params,
+                                                      std::shared_ptr<SearchCache> &cache)
+{
+    if (!cache) {
+        cache = std::make_shared<SearchCache>();
+    }
+    auto results = check_stability(po, cancel_func, params, *cache);
 #ifdef DEBUG_FILES
     auto [supp_points, objects] = results;
     debug_export(supp_points, objects, "issues");
@@ -11,6 +11,7 @@
 #include "PrintConfig.hpp"
 #include <boost/log/trivial.hpp>
 #include <cstddef>
+#include <memory>
 #include <vector>
 
 namespace Slic3r {
@@ -253,8 +254,17 @@ public:
 
 using PartialObjects = std::vector<PartialObject>;
 
+// State of the search kept between the searches of the same object, see full_search().
+struct SearchCache;
+
 // Both support points and partial objects are sorted from the lowest z to the highest
 std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params);
+// Search reusing the state of the previous search stored in cache (allocated if null) and updating it.
+// The search resumes from the lowest layer, whose slices or extrusions differ from the ones seen by the previous search.
+std::tuple<SupportPoints, PartialObjects> full_search(const PrintObject *po, const PrintTryCancel& cancel_func, const Params &params,
+                                                      std::shared_ptr<SearchCache> &cache);
+// Index of the layer, from which the last search using the cache started.
+size_t first_searched_layer(const SearchCache &cache);
 
 void estimate_supports_malformations(std::vector<SupportLayer *> &layers, float supports_flow_width, const Params &params);
 void estimate_malformations(std::vector<Layer *> &layers, const Params &params);
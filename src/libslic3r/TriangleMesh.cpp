@@ -29,8 +29,10 @@
 #include <libqhullcpp/QhullFacetList.h>
 #include <libqhullcpp/QhullVertexSet.h>
 
+#include <array>
 #include <cmath>
 #include <deque>
+#include <numeric>
 #include <queue>
 #include <vector>
 #include <utility>
@@ -42,6 +44,8 @@
 #include <boost/predef/other/endian.h>
 
 #include <tbb/concurrent_vector.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_sort.h>
 
 #include <Eigen/Core>
 #include <Eigen/Dense>
@@ -64,7 +68,7 @@ static void fill_initial_stats(const indexed_triangle_set &its, TriangleMeshStat
     out.volume              = its_volume(its);
     update_bounding_box(its, out);
 
-    const std::vector<Vec3i> face_neighbors = its_face_neighbors(its);
+    const std::vector<Vec3i> face_neighbors = its_face_neighbors_par(its);
     out.number_of_parts = its_number_of_patches(its, face_neighbors);
     out.open_edges      = its_num_open_edges(face_neighbors);
 }
@@ -90,108 +94,289 @@ TriangleMesh::TriangleMesh(indexed_triangle_set &&its, const RepairedMeshErrors&
     fill_initial_stats(this->its, m_stats);
 }
 
-// #define SLIC3R_TRACE_REPAIR
+// Neighbors of faces across their edges, -1 if the edge is open. Contrary to its_face_neighbors(), faces are connected even if they are
+// oriented inconsistently, such edges are marked in backwards. If more than two faces share an edge, they are paired by increasing face index.
+static void its_face_neighbors_unoriented_par(const indexed_triangle_set &its, std::vector<Vec3i> &neighbors, std::vector<std::array<bool, 3>> &backwards)
+{
+    struct EdgeRef {
+        // Indices of the edge end points, the lower one in the upper 32 bits.
+        uint64_t key;
+        // face_idx * 3 + edge_idx
+        uint32_t face_edge;
+        bool operator<(const EdgeRef &rhs) const { return this->key < rhs.key || (this->key == rhs.key && this->face_edge < rhs.face_edge); }
+    };
+    std::vector<EdgeRef> edges(its.indices.size() * 3);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &edges](const tbb::blocked_range<size_t> &range) {
+        for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+            for (int edge_idx = 0; edge_idx < 3; ++ edge_idx) {
+                const Vec2i edge = its_triangle_edge(its.indices[face_idx], edge_idx);
+                edges[face_idx * 3 + edge_idx] = { (uint64_t(std::min(edge(0), edge(1))) << 32) | uint64_t(std::max(edge(0), edge(1))), uint32_t(face_idx * 3 + edge_idx) };
+            }
+    });
+    tbb::parallel_sort(edges.begin(), edges.end());
+
+    neighbors.assign(its.indices.size(), Vec3i(-1, -1, -1));
+    backwards.assign(its.indices.size(), { false, false, false });
+    // A group of equal edges is processed by the range containing its first edge. Each group writes to its own face edges only.
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, edges.size()), [&its, &edges, &neighbors, &backwards](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i) {
+            if (i > 0 && edges[i - 1].key == edges[i].key)
+                continue;
+            for (size_t j = i; j + 1 < edges.size() && edges[j + 1].key == edges[i].key; j += 2) {
+                const int face_a = int(edges[j].face_edge / 3);
+                const int edge_a = int(edges[j].face_edge % 3);
+                const int face_b = int(edges[j + 1].face_edge / 3);
+                const int edge_b = int(edges[j + 1].face_edge % 3);
+                const stl_triangle_vertex_indices &a = its.indices[face_a];
+                const stl_triangle_vertex_indices &b = its.indices[face_b];
+                neighbors[face_a](edge_a) = face_b;
+                neighbors[face_b](edge_b) = face_a;
+                // Both faces traverse the shared edge in the same direction.
+                backwards[face_a][edge_a] = backwards[face_b][edge_b] = (a(edge_a) < a(next_idx_modulo(edge_a, 3))) == (b(edge_b) < b(next_idx_modulo(edge_b, 3)));
+            }
+        }
+    });
+}
 
-static void trianglemesh_repair_on_import(stl_file &stl)
+// Connect open edges, which end points fall into the same cells of a grid spaced by tolerance, by merging their end points.
+// Same matching as admesh stl_check_facets_nearby(). Returns the number of edges fixed, counted twice for each pair as admesh does.
+static int its_connect_nearby_open_edges(indexed_triangle_set &its, const std::vector<Vec3i> &neighbors, const Vec3f &min, float tolerance)
 {
-    // admesh fails when repairing empty meshes
-    if (stl.stats.number_of_facets == 0)
-        return;
+    struct OpenEdge {
+        // Grid cells of the end points, the lexicographically lower one first.
+        std::array<int32_t, 6> key;
+        // Vertices of the end points in the order of key.
+        int                    vertices[2];
+        int                    face_idx;
+        bool operator<(const OpenEdge &rhs) const { return this->key < rhs.key || (this->key == rhs.key && this->face_idx < rhs.face_idx); }
+    };
+    std::vector<OpenEdge> open_edges;
+    for (int face_idx = 0; face_idx < int(its.indices.size()); ++ face_idx)
+        for (int edge_idx = 0; edge_idx < 3; ++ edge_idx)
+            if (neighbors[face_idx](edge_idx) < 0) {
+                Vec2i edge = its_triangle_edge(its.indices[face_idx], edge_idx);
+                Vec3i32 cell1 = ((its.vertices[edge(0)] - min) / tolerance).cast<int32_t>();
+                Vec3i32 cell2 = ((its.vertices[edge(1)] - min) / tolerance).cast<int32_t>();
+                if (cell1 == cell2)
+                    // Both end points fall into the same cell.
+                    continue;
+                if (std::lexicographical_compare(cell2.data(), cell2.data() + 3, cell1.data(), cell1.data() + 3)) {
+                    std::swap(cell1, cell2);
+                    std::swap(edge(0), edge(1));
+                }
+                open_edges.push_back({ { cell1.x(), cell1.y(), cell1.z(), cell2.x(), cell2.y(), cell2.z() }, { edge(0), edge(1) }, face_idx });
+            }
+    tbb::parallel_sort(open_edges.begin(), open_edges.end());
+
+    // Union-find of the merged vertices, the vertex with the lowest index represents its set.
+    std::vector<int> parent(its.vertices.size());
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](int v) {
+        while (parent[v] != v)
+            v = parent[v] = parent[parent[v]];
+        return v;
+    };
+    auto merge = [&parent, &find](int u, int v) {
+        u = find(u);
+        v = find(v);
+        if (u != v)
+            parent[std::max(u, v)] = std::min(u, v);
+    };
+    int edges_fixed = 0;
+    for (size_t i = 0; i + 1 < open_edges.size();) {
+        const OpenEdge &a = open_edges[i];
+        const OpenEdge &b = open_edges[i + 1];
+        if (a.key == b.key && a.face_idx != b.face_idx) {
+            merge(a.vertices[0], b.vertices[0]);
+            merge(a.vertices[1], b.vertices[1]);
+            edges_fixed += 2;
+            i += 2;
+        } else
+            ++ i;
+    }
 
-    BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() started";
-
-    // checking exact
-#ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_check_faces_exact";
-#endif /* SLIC3R_TRACE_REPAIR */
-    assert(stl_validate(&stl));
-    stl_check_facets_exact(&stl);
-    assert(stl_validate(&stl));
-    stl.stats.facets_w_1_bad_edge = (stl.stats.connected_facets_2_edge - stl.stats.connected_facets_3_edge);
-    stl.stats.facets_w_2_bad_edge = (stl.stats.connected_facets_1_edge - stl.stats.connected_facets_2_edge);
-    stl.stats.facets_w_3_bad_edge = (stl.stats.number_of_facets - stl.stats.connected_facets_1_edge);
-    
-    // checking nearby
-    //int last_edges_fixed = 0;
-    float tolerance = (float)stl.stats.shortest_edge;
-    float increment = (float)stl.stats.bounding_diameter / 10000.0f;
-    int iterations = 2;
-    if (stl.stats.connected_facets_3_edge < int(stl.stats.number_of_facets)) {
-        // Not a manifold, some triangles have unconnected edges.
-        for (int i = 0; i < iterations; ++ i) {
-            if (stl.stats.connected_facets_3_edge < int(stl.stats.number_of_facets)) {
-                // Still not a manifold, some triangles have unconnected edges.
-                //printf("Checking nearby. Tolerance= %f Iteration=%d of %d...", tolerance, i + 1, iterations);
-#ifdef SLIC3R_TRACE_REPAIR
-                BOOST_LOG_TRIVIAL(trace) << "\tstl_check_faces_nearby";
-#endif /* SLIC3R_TRACE_REPAIR */
-                stl_check_facets_nearby(&stl, tolerance);
-                //printf("  Fixed %d edges.\n", stl.stats.edges_fixed - last_edges_fixed);
-                //last_edges_fixed = stl.stats.edges_fixed;
-                tolerance += increment;
-            } else {
-                break;
+    if (edges_fixed > 0) {
+        // Point each vertex to the representative of its set, parents have lower indices than their children.
+        for (int v = 0; v < int(parent.size()); ++ v)
+            parent[v] = parent[parent[v]];
+        tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &parent](const tbb::blocked_range<size_t> &range) {
+            for (size_t face_idx = range.begin(); face_idx < range.end(); ++ face_idx)
+                for (int i = 0; i < 3; ++ i)
+                    its.indices[face_idx](i) = parent[its.indices[face_idx](i)];
+        });
+    }
+    return edges_fixed;
+}
+
+// Is the normal stored in the file pointing against the normal of the face? Same test as admesh check_normal_vector().
+static bool stl_normal_reversed(const stl_vertex &v0, const stl_vertex &v1, const stl_vertex &v2, const stl_normal &stored)
+{
+    static constexpr const float eps = 0.001f;
+    auto equal = [](const stl_normal &a, const stl_normal &b) { return (a - b).cwiseAbs().maxCoeff() < eps; };
+    stl_normal normal = (v1 - v0).cross(v2 - v0);
+    stl_normalize_vector(normal);
+    stl_normal stored_normalized = stored;
+    stl_normalize_vector(stored_normalized);
+    return ! equal(normal, stored) && ! equal(normal, stored_normalized) && equal(normal, - stored_normalized);
+}
+
+indexed_triangle_set its_repair_on_import(const std::vector<stl_facet> &facets, RepairedMeshErrors &errors)
+{
+    BOOST_LOG_TRIVIAL(debug) << "its_repair_on_import() started";
+
+    errors.clear();
+    indexed_triangle_set its;
+    // Normals stored in the file, used to orient the connected components. Kept in sync with its.indices.
+    std::vector<stl_normal> normals;
+
+    // 1) Remove faces with two equal vertices.
+    its.indices.reserve(facets.size());
+    its.vertices.reserve(facets.size() * 3);
+    normals.reserve(facets.size());
+    for (const stl_facet &facet : facets)
+        if (facet.vertex[0] == facet.vertex[1] || facet.vertex[1] == facet.vertex[2] || facet.vertex[0] == facet.vertex[2]) {
+            ++ errors.degenerate_facets;
+        } else {
+            const int idx = int(its.vertices.size());
+            its.indices.emplace_back(idx, idx + 1, idx + 2);
+            its.vertices.insert(its.vertices.end(), facet.vertex, facet.vertex + 3);
+            normals.emplace_back(facet.normal);
+        }
+    errors.facets_removed = errors.degenerate_facets;
+    if (its.indices.empty())
+        return {};
+
+    // 2) Weld equal vertices.
+    its_merge_vertices(its, false);
+
+    // Remove the faces marked in mask together with their normals, return the number of faces removed.
+    auto remove_faces = [&its, &normals](const std::vector<char> &mask) {
+        size_t k = 0;
+        for (size_t i = 0; i < its.indices.size(); ++ i)
+            if (! mask[i]) {
+                its.indices[k] = its.indices[i];
+                normals[k ++]  = normals[i];
+            }
+        const int removed = int(its.indices.size() - k);
+        its.indices.resize(k);
+        normals.resize(k);
+        return removed;
+    };
+
+    std::vector<Vec3i>               neighbors;
+    std::vector<std::array<bool, 3>> backwards;
+    its_face_neighbors_unoriented_par(its, neighbors, backwards);
+    auto has_open_edge = [&neighbors]() { return std::any_of(neighbors.begin(), neighbors.end(), [](const Vec3i &n) { return n.minCoeff() < 0; }); };
+
+    if (has_open_edge()) {
+        // 3) Connect open edges to nearby open edges, with a tolerance growing from the shortest edge.
+        const BoundingBoxf3 bbox          = Slic3r::bounding_box(its);
+        float               shortest_edge = std::numeric_limits<float>::max();
+        for (const stl_triangle_vertex_indices &face : its.indices)
+            for (int i = 0; i < 3; ++ i)
+                shortest_edge = std::min(shortest_edge, (its.vertices[face(i)] - its.vertices[face(next_idx_modulo(i, 3))]).cwiseAbs().maxCoeff());
+        float       tolerance = shortest_edge;
+        const float increment = float(bbox.size().norm()) / 10000.f;
+        for (int iteration = 0; iteration < 2 && has_open_edge(); ++ iteration, tolerance += increment)
+            if (int edges_fixed = its_connect_nearby_open_edges(its, neighbors, bbox.min.cast<float>(), tolerance); edges_fixed > 0) {
+                errors.edges_fixed += edges_fixed;
+                // 4) Merging the end points of the edges may have collapsed some faces.
+                std::vector<char> degenerate(its.indices.size());
+                tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &degenerate](const tbb::blocked_range<size_t> &range) {
+                    for (size_t i = range.begin(); i < range.end(); ++ i) {
+                        const stl_triangle_vertex_indices &face = its.indices[i];
+                        degenerate[i] = face(0) == face(1) || face(1) == face(2) || face(0) == face(2);
+                    }
+                });
+                errors.facets_removed += remove_faces(degenerate);
+                its_face_neighbors_unoriented_par(its, neighbors, backwards);
             }
+
+        // 5) Remove faces not connected to any other face, they are likely wrong.
+        std::vector<char> unconnected(its.indices.size());
+        for (size_t i = 0; i < its.indices.size(); ++ i)
+            unconnected[i] = neighbors[i].maxCoeff() < 0;
+        if (int removed = remove_faces(unconnected); removed > 0) {
+            errors.facets_removed += removed;
+            its_face_neighbors_unoriented_par(its, neighbors, backwards);
         }
     }
-    assert(stl_validate(&stl));
-    
-    // remove_unconnected
-    if (stl.stats.connected_facets_3_edge < (int)stl.stats.number_of_facets) {
-#ifdef SLIC3R_TRACE_REPAIR
-        BOOST_LOG_TRIVIAL(trace) << "\tstl_remove_unconnected_facets";
-#endif /* SLIC3R_TRACE_REPAIR */
-        stl_remove_unconnected_facets(&stl);
-        assert(stl_validate(&stl));
+
+    // 6) Orient the faces of each connected component consistently with its face of the lowest index,
+    // which is reversed if the normal stored in the file points the other way.
+    // Collect the faces of the components in breadth first order, so that each face but the first has a neighbor preceding it.
+    std::vector<int>    component_faces;
+    std::vector<size_t> component_start;
+    {
+        component_faces.reserve(its.indices.size());
+        std::vector<char> visited(its.indices.size(), false);
+        for (int seed = 0; seed < int(its.indices.size()); ++ seed)
+            if (! visited[seed]) {
+                component_start.emplace_back(component_faces.size());
+                visited[seed] = true;
+                component_faces.emplace_back(seed);
+                for (size_t i = component_start.back(); i < component_faces.size(); ++ i)
+                    for (int neighbor : neighbors[component_faces[i]])
+                        if (neighbor >= 0 && ! visited[neighbor]) {
+                            visited[neighbor] = true;
+                            component_faces.emplace_back(neighbor);
+                        }
+            }
+        component_start.emplace_back(component_faces.size());
     }
-    
-    // fill_holes
-#if 0
-    // Don't fill holes, the current algorithm does more harm than good on complex holes.
-    // Rather let the slicing algorithm close gaps in 2D slices.
-    if (stl.stats.connected_facets_3_edge < stl.stats.number_of_facets) {
-#ifdef SLIC3R_TRACE_REPAIR
-        BOOST_LOG_TRIVIAL(trace) << "\tstl_fill_holes";
-#endif /* SLIC3R_TRACE_REPAIR */
-        stl_fill_holes(&stl);
-        stl_clear_error(&stl);
+    const size_t        num_components = component_start.size() - 1;
+    std::vector<char>   flip(its.indices.size(), false);
+    std::vector<char>   oriented(its.indices.size(), false);
+    std::vector<int>    component_backwards_edges(num_components, 0);
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, num_components), [&](const tbb::blocked_range<size_t> &range) {
+        for (size_t component_idx = range.begin(); component_idx < range.end(); ++ component_idx) {
+            auto begin = component_faces.begin() + component_start[component_idx];
+            auto end   = component_faces.begin() + component_start[component_idx + 1];
+            const stl_triangle_vertex_indices &seed = its.indices[*begin];
+            flip[*begin]     = stl_normal_reversed(its.vertices[seed(0)], its.vertices[seed(1)], its.vertices[seed(2)], normals[*begin]);
+            oriented[*begin] = true;
+            for (auto it = begin + 1; it != end; ++ it) {
+                for (int i = 0; i < 3; ++ i)
+                    if (int neighbor = neighbors[*it](i); neighbor >= 0 && oriented[neighbor]) {
+                        flip[*it] = flip[neighbor] != backwards[*it][i];
+                        break;
+                    }
+                oriented[*it] = true;
+            }
+            // A non-orientable component (Moebius strip) is left as it was loaded, its inconsistent edges are reported as backwards edges.
+            auto count_backwards_edges = [&]() {
+                int cnt = 0;
+                for (auto it = begin; it != end; ++ it)
+                    for (int i = 0; i < 3; ++ i)
+                        if (int neighbor = neighbors[*it](i); neighbor >= 0 && (flip[*it] != flip[neighbor]) != backwards[*it][i])
+                            ++ cnt;
+                return cnt;
+            };
+            if (count_backwards_edges() > 0) {
+                for (auto it = begin; it != end; ++ it)
+                    flip[*it] = false;
+                component_backwards_edges[component_idx] = count_backwards_edges();
+            }
+        }
+    });
+    errors.backwards_edges = std::accumulate(component_backwards_edges.begin(), component_backwards_edges.end(), 0);
+    errors.facets_reversed = int(std::count(flip.begin(), flip.end(), true));
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, its.indices.size()), [&its, &flip](const tbb::blocked_range<size_t> &range) {
+        for (size_t i = range.begin(); i < range.end(); ++ i)
+            if (flip[i])
+                std::swap(its.indices[i](1), its.indices[i](2));
+    });
+
+    // 7) Reverse all the faces if the volume is negative.
+    if (its_volume(its) < 0.f) {
+        its_flip_triangles(its);
+        errors.facets_reversed += int(its.indices.size());
     }
-#endif
-
-    // normal_directions
-#ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_fix_normal_directions";
-#endif /* SLIC3R_TRACE_REPAIR */
-    stl_fix_normal_directions(&stl);
-    assert(stl_validate(&stl));
-
-    // normal_values
-#ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_fix_normal_values";
-#endif /* SLIC3R_TRACE_REPAIR */
-    stl_fix_normal_values(&stl);
-    assert(stl_validate(&stl));
-    
-    // always calculate the volume and reverse all normals if volume is negative
-#ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_calculate_volume";
-#endif /* SLIC3R_TRACE_REPAIR */
-    // If the volume is negative, all the facets are flipped and added to stats.facets_reversed.
-    stl_calculate_volume(&stl);
-    assert(stl_validate(&stl));
-    
-    // neighbors
-#ifdef SLIC3R_TRACE_REPAIR
-    BOOST_LOG_TRIVIAL(trace) << "\tstl_verify_neighbors";
-#endif /* SLIC3R_TRACE_REPAIR */
-    stl_verify_neighbors(&stl);
-    assert(stl_validate(&stl));
 
-    //FIXME The admesh repair function may break the face connectivity, rather refresh it here as the slicing code relies on it.
-    if (auto nr_degenerated = stl.stats.degenerate_facets; stl.stats.number_of_facets > 0 && nr_degenerated > 0)
-        stl_check_facets_exact(&stl);
+    its_compactify_vertices(its);
 
-    BOOST_LOG_TRIVIAL(debug) << "TriangleMesh::repair() finished";
+    BOOST_LOG_TRIVIAL(debug) << "its_repair_on_import() finished";
+    return its;
 }
 
 bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
@@ -199,8 +384,13 @@ bool TriangleMesh::ReadSTLFile(const char* input_file, bool repair)
     stl_file stl;
     if (! stl_open(&stl, input_file))
         return false;
-    if (repair)
-        trianglemesh_repair_on_import(stl);
+    m_face_patches.reset();
+    if (repair) {
+        m_stats.clear();
+        this->its = its_repair_on_import(stl.facet_start, m_stats.repaired_errors);
+        fill_initial_stats(this->its, m_stats);
+        return true;
+    }
 
     m_stats.number_of_facets        = stl.stats.number_of_facets;
     m_stats.min                     = stl.stats.min;
@@ -392,7 +582,24 @@ void TriangleMesh::rotate(double angle, Point* center)
  */
 bool TriangleMesh::is_splittable() const
 {
-    return its_is_splittable(this->its);
+    return this->face_patches()->num_patches > 1;
+}
+
+std::shared_ptr<const FacePatches> TriangleMesh::face_patches() const
+{
+    std::shared_ptr<const FacePatches> patches = std::atomic_load(&m_face_patches);
+    if (! patches || patches->face_patch.size() != this->its.indices.size()) {
+        // Concurrent queries may calculate the patches multiple times, all of them with the same result.
+        patches = std::make_shared<const FacePatches>(its_face_patches(this->its));
+        std::atomic_store(&m_face_patches, patches);
+    }
+    return patches;
+}
+
+size_t TriangleMesh::release_optional()
+{
+    std::shared_ptr<const FacePatches> patches = std::atomic_exchange(&m_face_patches, std::shared_ptr<const FacePatches>());
+    return patches && patches.use_count() == 1 ? patches->memsize() : 0;
 }
 
 bool TriangleMesh::has_zero_volume() const
@@ -405,7 +612,7 @@ bool TriangleMesh::has_zero_volume() const
 
 std::vector<TriangleMesh> TriangleMesh::split() const
 {
-    std::vector<indexed_triangle_set> itss = its_split(this->its);
+    std::vector<indexed_triangle_set> itss = its_split(this->its, *this->face_patches());
     std::vector<TriangleMesh> out;
     out.reserve(itss.size());
     for (indexed_triangle_set &m : itss) {
@@ -423,6 +630,7 @@ void TriangleMesh::merge(const TriangleMesh &mesh)
 {
     its_merge(this->its, mesh.its);
     m_stats = m_stats.merge(mesh.m_stats);
+    m_face_patches.reset();
 }
 
 // Calculate projection of the mesh into the XY plane, in scaled coordinates.
@@ -530,6 +738,8 @@ std::vector<ExPolygons> TriangleMesh::slice(const std::vector<double> &z) const
 size_t TriangleMesh::memsize() const
 {
     size_t memsize = 8 + this->its.memsize() + sizeof(m_stats);
+    if (std::shared_ptr<const FacePatches> patches = std::atomic_load(&m_face_patches); patches)
+        memsize += patches->memsize();
     return memsize;
 }
 
@@ -693,7 +903,7 @@ int its_merge_vertices(indexed_triangle_set &its, bool shrink_to_fit)
     auto sorted = reserve_vector<int>(its.vertices.size());
     for (int i = 0; i < int(its.vertices.size()); ++ i)
         sorted.emplace_back(i);
-    std::sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
+    tbb::parallel_sort(sorted.begin(), sorted.end(), [&its](int il, int ir) {
         const Vec3f &l = its.vertices[il];
         const Vec3f &r = its.vertices[ir];
         // Sort lexicographically by coordinates AND vertex index.
@@ -1578,6 +1788,23 @@ std::vector<indexed_triangle_set> its_split(const indexed_triangle_set &its)
     return its_split<>(its);
 }
 
+std::vector<indexed_triangle_set> its_split(const indexed_triangle_set &its, const FacePatches &patches)
+{
+    auto ret = reserve_vector<indexed_triangle_set>(patches.num_patches);
+    its_split(its, patches, std::back_inserter(ret));
+    return ret;
+}
+
+FacePatches its_face_patches(const indexed_triangle_set &its)
+{
+    return its_face_patches(ex_tbb, create_face_neighbors_index(ex_tbb, its), its.indices.size());
+}
+
+FacePatches its_face_patches(const indexed_triangle_set &its, const std::vector<Vec3i> &face_neighbors)
+{
+    return its_face_patches(ex_tbb, face_neighbors, its.indices.size());
+}
+
 // Number of disconnected patches (faces are connected if they share an edge, shared edge defined with 2 shared vertex indices).
 size_t its_number_of_patches(const indexed_triangle_set &its)
 {
@@ -1588,7 +1815,7 @@ size_t its_number_of_patches(const indexed_triangle_set &its, const std::vector<
     return its_number_of_patches<>(ItsNeighborsWrapper{ its, face_neighbors });
 }
 
-// Same as its_number_of_patches(its) > 1, but faster.
+// Same as its_number_of_patches(its) > 1.
 bool its_is_splittable(const indexed_triangle_set &its)
 {
     return its_is_splittable<>(its);
@@ -15,6 +15,7 @@
 #include "libslic3r.h"
 #include <admesh/stl.h>
 #include <functional>
+#include <memory>
 #include <vector>
 #include "BoundingBox.hpp"
 #include "Line.hpp"
@@ -95,6 +96,15 @@ struct TriangleMeshStats {
     bool repaired() const { return repaired_errors.repaired(); }
 };
 
+// Connected patches of faces, faces are connected if they share an edge. See its_face_patches().
+struct FacePatches {
+    // Index of the patch of each face. Patches are numbered in the order of their first face.
+    std::vector<int> face_patch;
+    size_t           num_patches { 0 };
+
+    size_t memsize() const { return sizeof(*this) + this->face_patch.capacity() * sizeof(int); }
+};
+
 class TriangleMesh
 {
 public:
@@ -103,7 +113,7 @@ public:
     TriangleMesh(std::vector<Vec3f> &&vertices, const std::vector<Vec3i> &&faces);
     explicit TriangleMesh(const indexed_triangle_set &M);
     explicit TriangleMesh(indexed_triangle_set &&M, const RepairedMeshErrors& repaired_errors = RepairedMeshErrors());
-    void clear() { this->its.clear(); m_stats.clear(); }
+    void clear() { this->its.clear(); m_stats.clear(); m_face_patches.reset(); }
     bool ReadSTLFile(const char* input_file, bool repair = true);
     bool write_ascii(const char* output_file);
     bool write_binary(const char* output_file);
@@ -150,14 +160,18 @@ public:
     bool   empty() const { return this->facets_count() == 0; }
     bool   repaired() const;
     bool   is_splittable() const;
+    size_t number_of_patches() const { return this->face_patches()->num_patches; }
+    // Connected patches of faces, calculated on the first query and cached. The cache is shared by copies of this mesh
+    // and it survives transformations, as they do not change the topology. Modifying the faces of this->its directly
+    // requires calling release_optional() to drop the cache.
+    std::shared_ptr<const FacePatches> face_patches() const;
     bool   has_zero_volume() const;
     // Estimate of the memory occupied by this structure, important for keeping an eye on the Undo / Redo stack allocation.
     size_t memsize() const;
 
-    // Used by the Undo / Redo stack, legacy interface. As of now there is nothing cached at TriangleMesh,
-    // but we may decide to cache some data in the future (for example normals), thus we keep the interface in place.
+    // Used by the Undo / Redo stack. The face patches are the only data cached at TriangleMesh.
     // Release optional data from the mesh if the object is on the Undo / Redo stack only. Returns the amount of memory released.
-    size_t release_optional() { return 0; }
+    size_t release_optional();
     // Restore optional data possibly released by release_optional().
     void   restore_optional() {}
 
@@ -166,7 +180,9 @@ public:
     indexed_triangle_set its;
 
 private:
-    TriangleMeshStats m_stats;
+    TriangleMeshStats                          m_stats;
+    // Accessed with std::atomic_load() / std::atomic_store(), as the meshes of a Model are queried from multiple threads.
+    mutable std::shared_ptr<const FacePatches> m_face_patches;
 };
 
 // Index of face indices incident with a vertex index.
@@ -223,17 +239,26 @@ int its_remove_degenerate_faces(indexed_triangle_set &its, bool shrink_to_fit =
 // Remove vertices, which none of the faces references. Return number of freed vertices.
 int its_compactify_vertices(indexed_triangle_set &its, bool shrink_to_fit = true);
 
+// Repair a triangle soup loaded from STL and convert it to an indexed triangle set: Weld equal vertices, connect open edges
+// to nearby open edges, remove degenerate and unconnected faces, orient the faces of each connected component consistently
+// and make the volume positive. Replaces the admesh repair, the repairs done are reported in errors with the admesh meaning.
+indexed_triangle_set its_repair_on_import(const std::vector<stl_facet> &facets, RepairedMeshErrors &errors);
+
 // store part of index triangle set
 bool its_store_triangle_to_obj(const indexed_triangle_set &its, const char *obj_filename, size_t triangle_index);
 bool its_store_triangles_to_obj(const indexed_triangle_set &its, const char *obj_filename, const std::vector<size_t>& triangles);
 
 std::vector<indexed_triangle_set> its_split(const indexed_triangle_set &its);
+std::vector<indexed_triangle_set> its_split(const indexed_triangle_set &its, const FacePatches &patches);
 std::vector<indexed_triangle_set> its_split(const indexed_triangle_set &its, std::vector<Vec3i> &face_neighbors);
 
 // Number of disconnected patches (faces are connected if they share an edge, shared edge defined with 2 shared vertex indices).
 size_t its_number_of_patches(const indexed_triangle_set &its);
 size_t its_number_of_patches(const indexed_triangle_set &its, const std::vector<Vec3i> &face_neighbors);
-// Same as its_number_of_patches(its) > 1, but faster.
+// Label the connected patches of faces using a parallel union-find over the face neighbors.
+FacePatches its_face_patches(const indexed_triangle_set &its);
+FacePatches its_face_patches(const indexed_triangle_set &its, const std::vector<Vec3i> &face_neighbors);
+// Same as its_number_of_patches(its) > 1.
 bool its_is_splittable(const indexed_triangle_set &its);
 bool its_is_splittable(const indexed_triangle_set &its, const std::vector<Vec3i> &face_neighbors);
 
@@ -390,6 +415,7 @@ namespace cereal {
     template<class Archive> void load(Archive &archive, Slic3r::TriangleMesh &mesh) {
         archive.loadBinary(reinterpret_cast<char*>(const_cast<Slic3r::TriangleMeshStats*>(&mesh.stats())), sizeof(Slic3r::TriangleMeshStats));
         archive(mesh.its.indices, mesh.its.vertices);
+        mesh.release_optional();
     }
     template<class Archive> void save(Archive &archive, const Slic3r::TriangleMesh &mesh) {
         archive.saveBinary(reinterpret_cast<const char*>(&mesh.stats()), sizeof(Slic3r::TriangleMeshStats));
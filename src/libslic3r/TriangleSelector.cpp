@@ -1697,6 +1697,18 @@ void TriangleSelector::deserialize(const TriangleSplittingData &data, bool needs
     }
 }
 
+void TriangleSelector::copy_state(const TriangleSelector &other)
+{
+    assert(m_mesh.its.indices.size() == other.m_mesh.its.indices.size() && m_mesh.its.vertices.size() == other.m_mesh.its.vertices.size());
+    m_vertices            = other.m_vertices;
+    m_triangles           = other.m_triangles;
+    m_invalid_triangles   = other.m_invalid_triangles;
+    m_free_triangles_head = other.m_free_triangles_head;
+    m_free_vertices_head  = other.m_free_vertices_head;
+    m_orig_size_vertices  = other.m_orig_size_vertices;
+    m_orig_size_indices   = other.m_orig_size_indices;
+}
+
 void TriangleSelector::TriangleSplittingData::update_used_states(const size_t bitstream_start_idx) {
     assert(bitstream_start_idx < this->bitstream.size());
     assert(!this->bitstream.empty() && this->bitstream.size() != bitstream_start_idx);
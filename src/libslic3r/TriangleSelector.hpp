@@ -318,6 +318,10 @@ public:
     // Load serialized data. Assumes that correct mesh is loaded.
     void deserialize(const TriangleSplittingData &data, bool needs_reset = true);
 
+    // Copy the splitting and the states of the triangles from a selector created over the same mesh.
+    // Cheaper than deserializing the data serialized from the other selector.
+    void copy_state(const TriangleSelector &other);
+
     // Extract all used facet states from the given TriangleSplittingData.
     static std::vector<TriangleStateType> extract_used_facet_states(const TriangleSplittingData &data);
 
@@ -3,6 +3,10 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include <exception>
+#include <algorithm>
+#include <vector>
+
+#include <tbb/parallel_for.h>
 
 #include "Exception.hpp"
 #include "Zipper.hpp"
@@ -18,10 +22,39 @@
 
 namespace Slic3r {
 
+namespace {
+
+mz_uint to_mz_level(Zipper::e_compression compression)
+{
+    switch (compression) {
+    case Zipper::NO_COMPRESSION: return MZ_NO_COMPRESSION;
+    case Zipper::FAST_COMPRESSION: return MZ_BEST_SPEED;
+    case Zipper::TIGHT_COMPRESSION: return MZ_BEST_COMPRESSION;
+    }
+
+    return MZ_NO_COMPRESSION;
+}
+
+} // namespace
+
 class Zipper::Impl: public MZ_Archive {
 public:
     std::string m_zipname;
 
+    // Entries are not compressed one by one when added, but collected and
+    // deflated in parallel once there is enough of them. Entries larger
+    // than a chunk are deflated as independent chunks, see deflate_raw().
+    static constexpr size_t MaxPendingBytes = size_t(64) << 20;
+    static constexpr size_t ChunkSize = MZ_StagedParallelWriter::ChunkSize;
+
+    struct PendingEntry {
+        std::string name;
+        std::string data;
+    };
+
+    std::vector<PendingEntry> m_pending;
+    size_t                    m_pending_bytes = 0;
+
     std::string formatted_errorstr() const
     {
         return _u8L("Error with ZIP archive") + " " + m_zipname + ": " +
@@ -37,8 +70,97 @@ public:
     {
         return arch.m_zip_mode != MZ_ZIP_MODE_WRITING_HAS_BEEN_FINALIZED;
     }
+
+    void add(std::string &&name, std::string &&data, mz_uint level)
+    {
+        m_pending_bytes += data.size();
+        m_pending.push_back({std::move(name), std::move(data)});
+
+        if (m_pending_bytes >= MaxPendingBytes)
+            flush(level);
+    }
+
+    void flush(mz_uint level);
 };
 
+void Zipper::Impl::flush(mz_uint level)
+{
+    // Entries which miniz stores without compression
+    auto is_stored = [level](const PendingEntry &e) { return level == 0 || e.data.size() <= 3; };
+
+    struct Task { size_t entry; size_t chunk; };
+    static constexpr size_t CRCTask = size_t(-1);
+
+    std::vector<std::vector<std::string>> deflated(m_pending.size());
+    std::vector<mz_uint32>                crcs(m_pending.size(), MZ_CRC32_INIT);
+    std::vector<Task>                     tasks;
+
+    for (size_t i = 0; i < m_pending.size(); ++i) {
+        if (is_stored(m_pending[i]))
+            continue;
+
+        size_t chunks = (m_pending[i].data.size() + ChunkSize - 1) / ChunkSize;
+        deflated[i].resize(chunks);
+        for (size_t c = 0; c < chunks; ++c)
+            tasks.push_back({i, c});
+
+        // The CRC of a single chunk entry is computed along with deflating
+        if (chunks > 1)
+            tasks.push_back({i, CRCTask});
+    }
+
+    mz_uint flags = deflate_flags(int(level));
+    std::vector<char> ok(tasks.size(), true);
+    tbb::parallel_for(size_t(0), tasks.size(), [&](size_t t) {
+        const Task        &task = tasks[t];
+        const std::string &data = m_pending[task.entry].data;
+        size_t             nchunks = deflated[task.entry].size();
+
+        if (task.chunk == CRCTask || nchunks == 1)
+            crcs[task.entry] = mz_crc32(MZ_CRC32_INIT, reinterpret_cast<const unsigned char *>(data.data()), data.size());
+
+        if (task.chunk != CRCTask) {
+            size_t from = task.chunk * ChunkSize;
+            size_t n    = std::min(ChunkSize, data.size() - from);
+            ok[t] = deflate_raw(data.data() + from, n, flags, task.chunk + 1 == nchunks, deflated[task.entry][task.chunk]);
+        }
+    });
+
+    if (!std::all_of(ok.begin(), ok.end(), [](char v) { return v; })) {
+        arch.m_last_error = MZ_ZIP_COMPRESSION_FAILED;
+        m_pending.clear();
+        m_pending_bytes = 0;
+        blow_up();
+    }
+
+    std::string compressed;
+    for (size_t i = 0; i < m_pending.size(); ++i) {
+        const PendingEntry &e = m_pending[i];
+        bool res = false;
+
+        if (is_stored(e)) {
+            res = mz_zip_writer_add_mem(&arch, e.name.c_str(), e.data.data(), e.data.size(), level);
+        } else {
+            compressed.clear();
+            for (const std::string &chunk : deflated[i])
+                compressed += chunk;
+
+            res = mz_zip_writer_add_mem_ex(&arch, e.name.c_str(), compressed.data(), compressed.size(),
+                                           nullptr, 0, level | MZ_ZIP_FLAG_COMPRESSED_DATA,
+                                           e.data.size(), crcs[i]);
+        }
+
+        if (!res) {
+            m_pending.clear();
+            m_pending_bytes = 0;
+            blow_up();
+        }
+    }
+
+    m_pending.clear();
+    m_pending_bytes = 0;
+}
+
 Zipper::Zipper(const std::string &zipfname, e_compression compression)
 {
     m_impl.reset(new Impl());
@@ -57,7 +179,7 @@ Zipper::~Zipper()
 {
     if(m_impl->is_alive()) {
         // Flush the current entry if not finished yet.
-        try { finish_entry(); } catch(...) {
+        try { finish_entry(); m_impl->flush(to_mz_level(m_compression)); } catch(...) {
             BOOST_LOG_TRIVIAL(error) << m_impl->formatted_errorstr();
         }
 
@@ -97,15 +219,9 @@ void Zipper::add_entry(const std::string &name, const void *data, size_t l)
     if(!m_impl->is_alive()) return;
 
     finish_entry();
-    mz_uint cmpr = MZ_NO_COMPRESSION;
-    switch (m_compression) {
-    case NO_COMPRESSION: cmpr = MZ_NO_COMPRESSION; break;
-    case FAST_COMPRESSION: cmpr = MZ_BEST_SPEED; break;
-    case TIGHT_COMPRESSION: cmpr = MZ_BEST_COMPRESSION; break;
-    }
 
-    if(!mz_zip_writer_add_mem(&m_impl->arch, name.c_str(), data, l, cmpr))
-        m_impl->blow_up();
+    m_impl->add(std::string(name), std::string(static_cast<const char *>(data), l),
+                to_mz_level(m_compression));
 
     m_entry.clear();
     m_data.clear();
@@ -115,20 +231,8 @@ void Zipper::finish_entry()
 {
     if(!m_impl->is_alive()) return;
 
-    if(!m_data.empty() && !m_entry.empty()) {
-        mz_uint compression = MZ_NO_COMPRESSION;
-
-        switch (m_compression) {
-        case NO_COMPRESSION: compression = MZ_NO_COMPRESSION; break;
-        case FAST_COMPRESSION: compression = MZ_BEST_SPEED; break;
-        case TIGHT_COMPRESSION: compression = MZ_BEST_COMPRESSION; break;
-        }
-
-        if(!mz_zip_writer_add_mem(&m_impl->arch, m_entry.c_str(),
-                                  m_data.c_str(),
-                                  m_data.size(),
-                                  compression)) m_impl->blow_up();
-    }
+    if(!m_data.empty() && !m_entry.empty())
+        m_impl->add(std::move(m_entry), std::move(m_data), to_mz_level(m_compression));
 
     m_data.clear();
     m_entry.clear();
@@ -138,8 +242,12 @@ void Zipper::finalize()
 {
     finish_entry();
 
-    if(m_impl->is_alive()) if(!mz_zip_writer_finalize_archive(&m_impl->arch))
-        m_impl->blow_up();
+    if(m_impl->is_alive()) {
+        m_impl->flush(to_mz_level(m_compression));
+
+        if(!mz_zip_writer_finalize_archive(&m_impl->arch))
+            m_impl->blow_up();
+    }
 }
 
 const std::string &Zipper::get_filename() const
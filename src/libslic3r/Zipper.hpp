@@ -11,7 +11,9 @@
 
 namespace Slic3r {
 
-// Class for creating zip archives.
+// Class for creating zip archives. The entries are compressed in parallel
+// batches, thus the errors may be reported by a later call than the one
+// adding the broken entry, at the latest by finalize().
 class Zipper {
 public:
     // Three compression levels supported
@@ -3,9 +3,14 @@
 ///|/ PrusaSlicer is released under the terms of the AGPLv3 or higher
 ///|/
 #include <exception>
+#include <algorithm>
+#include <memory>
+#include <thread>
 
 #include "miniz_extension.hpp"
 
+#include <tbb/parallel_for.h>
+
 #if defined(_MSC_VER) || defined(__MINGW64__)
 #include "boost/nowide/cstdio.hpp"
 #endif
@@ -156,4 +161,79 @@ std::string MZ_Archive::get_errorstr(mz_zip_error mz_err)
     return "unknown error";
 }
 
+bool deflate_raw(const void *data, size_t n, mz_uint comp_flags, bool final, std::string &out)
+{
+    std::unique_ptr<tdefl_compressor, void (*)(tdefl_compressor *)>
+        comp{tdefl_compressor_alloc(), tdefl_compressor_free};
+
+    if (!comp)
+        return false;
+
+    auto putter = [](const void *buf, int len, void *user) -> mz_bool {
+        static_cast<std::string *>(user)->append(static_cast<const char *>(buf), size_t(len));
+        return MZ_TRUE;
+    };
+
+    out.clear();
+    if (tdefl_init(comp.get(), putter, &out, int(comp_flags)) != TDEFL_STATUS_OKAY)
+        return false;
+
+    tdefl_status status = tdefl_compress_buffer(comp.get(), data, n, final ? TDEFL_FINISH : TDEFL_SYNC_FLUSH);
+
+    return status == (final ? TDEFL_STATUS_DONE : TDEFL_STATUS_OKAY);
+}
+
+mz_uint deflate_flags(int level)
+{
+    return tdefl_create_comp_flags_from_zip_params(level < 0 ? MZ_DEFAULT_LEVEL : level, -15, MZ_DEFAULT_STRATEGY);
+}
+
+MZ_StagedParallelWriter::MZ_StagedParallelWriter(mz_zip_writer_staged_context &context,
+                                                 size_t max_chunks_in_flight)
+    : m_context(context)
+    , m_max_chunks(max_chunks_in_flight > 0 ?
+                       max_chunks_in_flight :
+                       2 * std::max(1u, std::thread::hardware_concurrency()))
+{}
+
+bool MZ_StagedParallelWriter::add(const char *data, size_t n)
+{
+    while (n > 0) {
+        if (m_chunks.empty() || m_chunks.back().size() >= ChunkSize) {
+            if (m_chunks.size() >= m_max_chunks && !flush())
+                return false;
+
+            m_chunks.emplace_back();
+            m_chunks.back().reserve(ChunkSize);
+        }
+
+        std::string &chunk = m_chunks.back();
+        size_t       l     = std::min(n, ChunkSize - chunk.size());
+        chunk.append(data, l);
+        data += l;
+        n -= l;
+    }
+
+    return true;
+}
+
+bool MZ_StagedParallelWriter::flush()
+{
+    std::vector<std::string> compressed(m_chunks.size());
+    std::vector<char>        ok(m_chunks.size(), false);
+
+    tbb::parallel_for(size_t(0), m_chunks.size(), [this, &compressed, &ok](size_t i) {
+        ok[i] = deflate_raw(m_chunks[i].data(), m_chunks[i].size(), m_context.comp_flags, false, compressed[i]);
+    });
+
+    bool ret = std::all_of(ok.begin(), ok.end(), [](char v) { return v; });
+    for (size_t i = 0; ret && i < m_chunks.size(); ++i)
+        ret = mz_zip_writer_add_staged_precompressed(&m_context, m_chunks[i].data(), m_chunks[i].size(),
+                                                     compressed[i].data(), compressed[i].size());
+
+    m_chunks.clear();
+
+    return ret;
+}
+
 } // namespace Slic3r
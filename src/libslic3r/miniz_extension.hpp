@@ -6,6 +6,7 @@
 #define MINIZ_EXTENSION_HPP
 
 #include <string>
+#include <vector>
 #include <miniz.h>
 
 namespace Slic3r {
@@ -34,6 +35,40 @@ public:
     }
 };
 
+// Raw deflate of a buffer with tdefl flags comp_flags, the same as
+// mz_zip_writer_add_mem() produces. If final is false, the output ends with
+// a non-final block aligned to a byte boundary, so that parts of a file
+// deflated independently (and concurrently) may simply be concatenated.
+bool deflate_raw(const void *data, size_t n, mz_uint comp_flags, bool final, std::string &out);
+
+// tdefl flags matching a zip compression level (MZ_BEST_SPEED etc.)
+mz_uint deflate_flags(int level);
+
+// Writes data into a staged ZIP file entry (see mz_zip_writer_add_staged_open()).
+// The data are cut into chunks, which are deflated in parallel and appended
+// to the entry in order. The entry is still to be closed by
+// mz_zip_writer_add_staged_finish() after flush().
+class MZ_StagedParallelWriter {
+public:
+    static constexpr size_t ChunkSize = 1 << 20;
+
+    // At most max_chunks_in_flight chunks are kept in memory,
+    // zero means twice the number of hardware threads.
+    explicit MZ_StagedParallelWriter(mz_zip_writer_staged_context &context,
+                                     size_t max_chunks_in_flight = 0);
+
+    bool add(const char *data, size_t n);
+    bool add(const std::string &data) { return add(data.data(), data.size()); }
+
+    // Compress and write all the data added so far.
+    bool flush();
+
+private:
+    mz_zip_writer_staged_context &m_context;
+    size_t                        m_max_chunks;
+    std::vector<std::string>      m_chunks;
+};
+
 } // namespace Slic3r
 
 #endif // MINIZ_EXTENSION_HPP
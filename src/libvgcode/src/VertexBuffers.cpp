@@ -0,0 +1,102 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ libvgcode is released under the terms of the AGPLv3 or higher
+///|/
+#include "VertexBuffers.hpp"
+
+#include "Utils.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#ifdef LIBVGCODE_USE_TBB
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif // LIBVGCODE_USE_TBB
+
+namespace libvgcode {
+
+static_assert(VERTICES_CHUNK_SIZE % (8 * sizeof(BitSet<>::blocks[0])) == 0, "Chunks must not share BitSet blocks");
+
+void parallel_for_chunks(std::size_t count, const std::function<void(std::size_t chunk_id, std::size_t begin, std::size_t end)>& fn)
+{
+    const std::size_t chunks_count = (count + VERTICES_CHUNK_SIZE - 1) / VERTICES_CHUNK_SIZE;
+    auto process_chunk = [count, &fn](std::size_t chunk_id) {
+        const std::size_t begin = chunk_id * VERTICES_CHUNK_SIZE;
+        fn(chunk_id, begin, std::min(count, begin + VERTICES_CHUNK_SIZE));
+    };
+#ifdef LIBVGCODE_USE_TBB
+    tbb::parallel_for(tbb::blocked_range<std::size_t>(0, chunks_count, 1), [&process_chunk](const tbb::blocked_range<std::size_t>& range) {
+        for (std::size_t chunk_id = range.begin(); chunk_id < range.end(); ++chunk_id) {
+            process_chunk(chunk_id);
+        }
+    });
+#else
+    for (std::size_t chunk_id = 0; chunk_id < chunks_count; ++chunk_id) {
+        process_chunk(chunk_id);
+    }
+#endif // LIBVGCODE_USE_TBB
+}
+
+void extract_valid_lines(const std::vector<PathVertex>& vertices, BitSet<>& valid_lines_bitset)
+{
+    valid_lines_bitset = BitSet<>(vertices.size());
+    parallel_for_chunks(vertices.size(), [&vertices, &valid_lines_bitset](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            // there is a valid path between point i and i+1 only if they are distinct points of a move of the same type
+            const PathVertex& v = vertices[i];
+            if (i + 1 < vertices.size() &&
+                vertices[i + 1].position != v.position &&
+                vertices[i + 1].type == v.type &&
+                v.type != EMoveType::Seam)
+                valid_lines_bitset.set(i);
+        }
+    });
+}
+
+void extract_positions(const std::vector<PathVertex>& vertices, Vec3* positions)
+{
+    parallel_for_chunks(vertices.size(), [&vertices, positions](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const PathVertex& v = vertices[i];
+            Vec3 position = v.position;
+            if (v.type == EMoveType::Extrude)
+                // push down extrusion vertices by half height to render them at the right z
+                position[2] -= 0.5f * v.height;
+            positions[i] = position;
+        }
+    });
+}
+
+void extract_heights_widths_angles(const std::vector<PathVertex>& vertices, const BitSet<>& valid_lines_bitset,
+    float travels_radius, float wipes_radius, Vec3* heights_widths_angles)
+{
+    static constexpr const Vec3 ZERO = { 0.0f, 0.0f, 0.0f };
+    parallel_for_chunks(vertices.size(), [&](std::size_t, std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const PathVertex& v = vertices[i];
+            const Vec3 prev_line = (i > 0 && valid_lines_bitset[i - 1]) ? v.position - vertices[i - 1].position : ZERO;
+            const Vec3 this_line = valid_lines_bitset[i] ? vertices[i + 1].position - v.position : ZERO;
+
+            float height = 0.0f;
+            float width = 0.0f;
+            if (v.is_travel()) {
+                height = travels_radius;
+                width  = travels_radius;
+            }
+            else if (v.is_wipe()) {
+                height = wipes_radius;
+                width  = wipes_radius;
+            }
+            else {
+                height = v.height;
+                width  = v.width;
+            }
+
+            heights_widths_angles[i] = { height, width,
+                std::atan2(prev_line[0] * this_line[1] - prev_line[1] * this_line[0], dot(prev_line, this_line)) };
+        }
+    });
+}
+
+} // namespace libvgcode
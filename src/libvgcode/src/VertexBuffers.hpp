@@ -0,0 +1,54 @@
+///|/ Copyright (c) Prusa Research 2024
+///|/
+///|/ libvgcode is released under the terms of the AGPLv3 or higher
+///|/
+#ifndef VGCODE_VERTEXBUFFERS_HPP
+#define VGCODE_VERTEXBUFFERS_HPP
+
+#include "../include/PathVertex.hpp"
+#include "Bitset.hpp"
+
+#include <functional>
+
+namespace libvgcode {
+
+//
+// Cpu side of the data sent to the gpu by ViewerImpl.
+// Nothing here uses OpenGL, so it can run (and be tested) without a context.
+//
+
+//
+// Number of vertices processed by a single task of parallel_for_chunks().
+// Multiple of the bits in a BitSet block, so that the tasks never write into the same block.
+//
+static constexpr const std::size_t VERTICES_CHUNK_SIZE = 64 * 256;
+
+//
+// Calls fn(chunk_id, begin, end) for the consecutive chunks of VERTICES_CHUNK_SIZE vertices in [0, count).
+// The chunks are processed in parallel when libvgcode is built with TBB.
+//
+extern void parallel_for_chunks(std::size_t count, const std::function<void(std::size_t chunk_id, std::size_t begin, std::size_t end)>& fn);
+
+//
+// Resets valid_lines_bitset to the size of vertices and sets the bits of the vertices
+// starting a segment which should be rendered.
+//
+extern void extract_valid_lines(const std::vector<PathVertex>& vertices, BitSet<>& valid_lines_bitset);
+
+//
+// Fills positions, which must have room for vertices.size() items, with the positions of the vertices
+// as sent to the gpu.
+//
+extern void extract_positions(const std::vector<PathVertex>& vertices, Vec3* positions);
+
+//
+// Fills heights_widths_angles, which must have room for vertices.size() items, with the height, width
+// and angle between the adjacent segments of the vertices, as sent to the gpu.
+// valid_lines_bitset is the one produced by extract_valid_lines().
+//
+extern void extract_heights_widths_angles(const std::vector<PathVertex>& vertices, const BitSet<>& valid_lines_bitset,
+    float travels_radius, float wipes_radius, Vec3* heights_widths_angles);
+
+} // namespace libvgcode
+
+#endif // VGCODE_VERTEXBUFFERS_HPP
@@ -8,6 +8,7 @@
 #include "ShadersES.hpp"
 #include "OpenGLUtils.hpp"
 #include "Utils.hpp"
+#include "VertexBuffers.hpp"
 
 #include <map>
 #include <assert.h>
@@ -895,70 +896,6 @@ void ViewerImpl::reset()
 #endif // ENABLE_OPENGL_ES
 }
 
-static void extract_pos_and_or_hwa(const std::vector<PathVertex>& vertices, float travels_radius, float wipes_radius, BitSet<>& valid_lines_bitset,
-    std::vector<Vec3>* positions = nullptr, std::vector<Vec3>* heights_widths_angles = nullptr, bool update_bitset = false) {
-    static constexpr const Vec3 ZERO = { 0.0f, 0.0f, 0.0f };
-    if (positions == nullptr && heights_widths_angles == nullptr)
-        return;
-    if (vertices.empty())
-        return;
-    if (travels_radius <= 0.0f || wipes_radius <= 0.0f)
-        return;
-
-    if (positions != nullptr)
-        positions->reserve(vertices.size());
-    if (heights_widths_angles != nullptr)
-        heights_widths_angles->reserve(vertices.size());
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        const PathVertex& v = vertices[i];
-        const EMoveType move_type = v.type;
-        const bool prev_line_valid = i > 0 && valid_lines_bitset[i - 1];
-        const Vec3 prev_line = prev_line_valid ? v.position - vertices[i - 1].position : ZERO;
-        const bool this_line_valid = i + 1 < vertices.size() &&
-                                     vertices[i + 1].position != v.position &&
-                                     vertices[i + 1].type == move_type &&
-                                     move_type != EMoveType::Seam;
-        const Vec3 this_line = this_line_valid ? vertices[i + 1].position - v.position : ZERO;
-
-        if (this_line_valid) {
-            // there is a valid path between point i and i+1.
-        }
-        else {
-            // the connection is invalid, there should be no line rendered, ever
-            if (update_bitset)
-                valid_lines_bitset.reset(i);
-        }
-        
-        if (positions != nullptr) {
-            Vec3 position = v.position;
-            if (move_type == EMoveType::Extrude)
-                // push down extrusion vertices by half height to render them at the right z
-                position[2] -= 0.5f * v.height;
-            positions->emplace_back(position);
-        }
-
-        if (heights_widths_angles != nullptr) {
-            float height = 0.0f;
-            float width = 0.0f;
-            if (v.is_travel()) {
-                height = travels_radius;
-                width  = travels_radius;
-            }
-            else if (v.is_wipe()) {
-                height = wipes_radius;
-                width  = wipes_radius;
-            }
-            else {
-                height = v.height;
-                width = v.width;
-            }
-
-            heights_widths_angles->push_back({ height, width,
-                std::atan2(prev_line[0] * this_line[1] - prev_line[1] * this_line[0], dot(prev_line, this_line)) });
-        }
-    }
-}
-
 void ViewerImpl::load(GCodeInputData&& gcode_data)
 {
     if (!m_initialized)
@@ -1025,45 +962,55 @@ void ViewerImpl::load(GCodeInputData&& gcode_data)
     m_options.erase(std::unique(m_options.begin(), m_options.end()), m_options.end());
     m_options.shrink_to_fit();
 
-    // reset segments visibility bitset
-    m_valid_lines_bitset = BitSet<>(m_vertices.size());
-    m_valid_lines_bitset.setAll();
+    // segments visibility bitset
+    extract_valid_lines(m_vertices, m_valid_lines_bitset);
 
     if (m_settings.time_mode != ETimeMode::Normal && m_total_time[static_cast<size_t>(m_settings.time_mode)] == 0.0f)
         m_settings.time_mode = ETimeMode::Normal;
 
-    // buffers to send to gpu
-    std::vector<Vec3> positions;
-    std::vector<Vec3> heights_widths_angles;
-    positions.reserve(m_vertices.size());
-    heights_widths_angles.reserve(m_vertices.size());
-    extract_pos_and_or_hwa(m_vertices, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, &positions, &heights_widths_angles, true);
-
-    if (!positions.empty()) {
+    if (m_travels_radius > 0.0f && m_wipes_radius > 0.0f) {
 #ifdef ENABLE_OPENGL_ES
+        // buffers to send to gpu
+        std::vector<Vec3> positions(m_vertices.size());
+        std::vector<Vec3> heights_widths_angles(m_vertices.size());
+        extract_positions(m_vertices, positions.data());
+        extract_heights_widths_angles(m_vertices, m_valid_lines_bitset, m_travels_radius, m_wipes_radius, heights_widths_angles.data());
+
         m_texture_data.init(positions.size());
         // create and fill position textures
         m_texture_data.set_positions(positions);
         // create and fill height, width and angle textures
         m_texture_data.set_heights_widths_angles(heights_widths_angles);
 #else
-        m_positions_tex_size = positions.size() * sizeof(Vec3);
-        m_height_width_angle_tex_size = heights_widths_angles.size() * sizeof(Vec3);
+        m_positions_tex_size = m_vertices.size() * sizeof(Vec3);
+        m_height_width_angle_tex_size = m_vertices.size() * sizeof(Vec3);
 
         int old_bound_texture = 0;
         glsafe(glGetIntegerv(GL_TEXTURE_BINDING_BUFFER, &old_bound_texture));
 
-        // create and fill positions buffer
+        // create and fill positions buffer, the data is written directly into the mapped buffer
         glsafe(glGenBuffers(1, &m_positions_buf_id));
         glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_positions_buf_id));
-        glsafe(glBufferData(GL_TEXTURE_BUFFER, positions.size() * sizeof(Vec3), positions.data(), GL_STATIC_DRAW));
+        glsafe(glBufferData(GL_TEXTURE_BUFFER, m_positions_tex_size, nullptr, GL_STATIC_DRAW));
+        Vec3* positions = static_cast<Vec3*>(glMapBuffer(GL_TEXTURE_BUFFER, GL_WRITE_ONLY));
+        glcheck();
+        if (positions != nullptr) {
+            extract_positions(m_vertices, positions);
+            glsafe(glUnmapBuffer(GL_TEXTURE_BUFFER));
+        }
         glsafe(glGenTextures(1, &m_positions_tex_id));
         glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_positions_tex_id));
 
-        // create and fill height, width and angles buffer
+        // create and fill height, width and angles buffer, the data is written directly into the mapped buffer
         glsafe(glGenBuffers(1, &m_heights_widths_angles_buf_id));
         glsafe(glBindBuffer(GL_TEXTURE_BUFFER, m_heights_widths_angles_buf_id));
-        glsafe(glBufferData(GL_TEXTURE_BUFFER, heights_widths_angles.size() * sizeof(Vec3), heights_widths_angles.data(), GL_DYNAMIC_DRAW));
+        glsafe(glBufferData(GL_TEXTURE_BUFFER, m_height_width_angle_tex_size, nullptr, GL_DYNAMIC_DRAW));
+        Vec3* heights_widths_angles = static_cast<Vec3*>(glMapBuffer(GL_TEXTURE_BUFFER, GL_WRITE_ONLY));
+        glcheck();
+        if (heights_widths_angles != nullptr) {
+            extract_heights_widths_angles(m_vertices, m_valid_lines_bitset, m_travels_radius, m_wipes_radius, heights_widths_angles);
+            glsafe(glUnmapBuffer(GL_TEXTURE_BUFFER));
+        }
         glsafe(glGenTextures(1, &m_heights_widths_angles_tex_id));
         glsafe(glBindTexture(GL_TEXTURE_BUFFER, m_heights_widths_angles_tex_id));
 
@@ -1122,34 +1069,53 @@ void ViewerImpl::update_enabled_entities()
             --range[0];
     }
 
-    for (size_t i = range[0]; i < range[1]; ++i) {
-        const PathVertex& v = m_vertices[i];
+    // the vertices are filtered in parallel by chunks, then the results of the chunks are concatenated in order
+    const size_t range_size = (range[1] > range[0]) ? static_cast<size_t>(range[1] - range[0]) : 0;
+    std::vector<std::pair<std::vector<uint32_t>, std::vector<uint32_t>>> chunks((range_size + VERTICES_CHUNK_SIZE - 1) / VERTICES_CHUNK_SIZE);
+    parallel_for_chunks(range_size, [this, &range, &chunks](size_t chunk_id, size_t begin, size_t end) {
+        auto& [chunk_segments, chunk_options] = chunks[chunk_id];
+        for (size_t i = range[0] + begin; i < range[0] + end; ++i) {
+            const PathVertex& v = m_vertices[i];
 
-        if (!m_valid_lines_bitset[i] && !v.is_option())
-            continue;
-        if (v.is_travel()) {
-            if (!m_settings.options_visibility[size_t(EOptionType::Travels)])
-                continue;
-        }
-        else if (v.is_wipe()) {
-            if (!m_settings.options_visibility[size_t(EOptionType::Wipes)])
+            if (!m_valid_lines_bitset[i] && !v.is_option())
                 continue;
-        }
-        else if (v.is_option()) {
-            if (!m_settings.options_visibility[size_t(move_type_to_option(v.type))])
-                continue;
-        }
-        else if (v.is_extrusion()) {
-            if (!m_settings.extrusion_roles_visibility[size_t(v.role)])
+            if (v.is_travel()) {
+                if (!m_settings.options_visibility[size_t(EOptionType::Travels)])
+                    continue;
+            }
+            else if (v.is_wipe()) {
+                if (!m_settings.options_visibility[size_t(EOptionType::Wipes)])
+                    continue;
+            }
+            else if (v.is_option()) {
+                if (!m_settings.options_visibility[size_t(move_type_to_option(v.type))])
+                    continue;
+            }
+            else if (v.is_extrusion()) {
+                if (!m_settings.extrusion_roles_visibility[size_t(v.role)])
+                    continue;
+            }
+            else
                 continue;
+
+            if (v.is_option())
+                chunk_options.push_back(static_cast<uint32_t>(i));
+            else
+                chunk_segments.push_back(static_cast<uint32_t>(i));
         }
-        else
-            continue;
+    });
 
-        if (v.is_option())
-            enabled_options.push_back(static_cast<uint32_t>(i));
-        else
-            enabled_segments.push_back(static_cast<uint32_t>(i));
+    size_t segments_count = 0;
+    size_t options_count = 0;
+    for (const auto& [chunk_segments, chunk_options] : chunks) {
+        segments_count += chunk_segments.size();
+        options_count += chunk_options.size();
+    }
+    enabled_segments.reserve(segments_count);
+    enabled_options.reserve(options_count);
+    for (const auto& [chunk_segments, chunk_options] : chunks) {
+        enabled_segments.insert(enabled_segments.end(), chunk_segments.begin(), chunk_segments.end());
+        enabled_options.insert(enabled_options.end(), chunk_options.begin(), chunk_options.end());
     }
 
 #ifdef ENABLE_OPENGL_ES
@@ -1207,10 +1173,14 @@ void ViewerImpl::update_colors_texture()
     // vertices as dark grey. Use either that or the normal color (from the cache).
     std::vector<float> colors(m_vertices_colors.size());
     assert(colors.size() == m_vertices.size() && m_vertices_colors.size() == m_vertices.size());
-    for (size_t i=0; i<m_vertices.size(); ++i)
-        colors[i] = (color_top_layer_only && m_vertices[i].layer_id < top_layer_id &&
-                    (!m_settings.spiral_vase_mode || i != m_view_range.get_enabled()[0])) ?
-                    encode_color(DUMMY_COLOR) : m_vertices_colors[i];
+    const float dummy_color = encode_color(DUMMY_COLOR);
+    parallel_for_chunks(m_vertices.size(), [&](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            colors[i] = (color_top_layer_only && m_vertices[i].layer_id < top_layer_id &&
+                        (!m_settings.spiral_vase_mode || i != m_view_range.get_enabled()[0])) ?
+                        dummy_color : m_vertices_colors[i];
+        }
+    });
 
     #ifdef ENABLE_OPENGL_ES
         if (!colors.empty())
@@ -1248,8 +1218,11 @@ void ViewerImpl::update_colors()
     // If some part of the preview should be rendered in dark grey, it is taken
     // care of in update_colors_texture. That is to avoid the need to recalculate
     // the "normal" color on every slider move.
-    for (size_t i = 0; i < m_vertices.size(); ++i)
-        m_vertices_colors[i] = encode_color(get_vertex_color(m_vertices[i]));
+    parallel_for_chunks(m_vertices.size(), [this](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            m_vertices_colors[i] = encode_color(get_vertex_color(m_vertices[i]));
+        }
+    });
     
     update_colors_texture();
     m_settings.update_colors = false;
@@ -1798,9 +1771,8 @@ void ViewerImpl::update_color_ranges()
 void ViewerImpl::update_heights_widths()
 {
 #ifdef ENABLE_OPENGL_ES
-    std::vector<Vec3> heights_widths_angles;
-    heights_widths_angles.reserve(m_vertices.size());
-    extract_pos_and_or_hwa(m_vertices, m_travels_radius, m_wipes_radius, m_valid_lines_bitset, nullptr, &heights_widths_angles);
+    std::vector<Vec3> heights_widths_angles(m_vertices.size());
+    extract_heights_widths_angles(m_vertices, m_valid_lines_bitset, m_travels_radius, m_wipes_radius, heights_widths_angles.data());
     m_texture_data.set_heights_widths_angles(heights_widths_angles);
 #else
     if (m_heights_widths_angles_buf_id == 0)
@@ -1811,17 +1783,19 @@ void ViewerImpl::update_heights_widths()
     Vec3* buffer = static_cast<Vec3*>(glMapBuffer(GL_TEXTURE_BUFFER, GL_WRITE_ONLY));
     glcheck();
 
-    for (size_t i = 0; i < m_vertices.size(); ++i) {
-        const PathVertex& v = m_vertices[i];
-        if (v.is_travel()) {
-            buffer[i][0] = m_travels_radius;
-            buffer[i][1] = m_travels_radius;
-        }
-        else if (v.is_wipe()) {
-            buffer[i][0] = m_wipes_radius;
-            buffer[i][1] = m_wipes_radius;
+    parallel_for_chunks(m_vertices.size(), [this, buffer](size_t, size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i) {
+            const PathVertex& v = m_vertices[i];
+            if (v.is_travel()) {
+                buffer[i][0] = m_travels_radius;
+                buffer[i][1] = m_travels_radius;
+            }
+            else if (v.is_wipe()) {
+                buffer[i][0] = m_wipes_radius;
+                buffer[i][1] = m_wipes_radius;
+            }
         }
-    }
+    });
 
     glsafe(glUnmapBuffer(GL_TEXTURE_BUFFER));
     glsafe(glBindBuffer(GL_TEXTURE_BUFFER, 0));
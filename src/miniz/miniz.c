@@ -6844,7 +6844,8 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     pContext->add_state.m_cur_archive_file_ofs = pContext->cur_archive_file_ofs;
     pContext->add_state.m_comp_size = 0;
 
-    if (tdefl_init(pContext->pCompressor, mz_zip_writer_add_put_buf_callback, &pContext->add_state, tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY)) != TDEFL_STATUS_OKAY)
+    pContext->comp_flags = tdefl_create_comp_flags_from_zip_params(level, -15, MZ_DEFAULT_STRATEGY);
+    if (tdefl_init(pContext->pCompressor, mz_zip_writer_add_put_buf_callback, &pContext->add_state, pContext->comp_flags) != TDEFL_STATUS_OKAY)
     {
         pZip->m_pFree(pZip->m_pAlloc_opaque, pContext->pCompressor);
         return mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
@@ -6883,6 +6884,54 @@ mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context *pContext, co
     return MZ_FALSE;
 }
 
+mz_bool mz_zip_writer_add_staged_precompressed(mz_zip_writer_staged_context *pContext, const char *pRead_buf, size_t n, const void *pComp_buf, size_t comp_n)
+{
+    mz_zip_archive *pZip = pContext->pZip;
+
+    if (!pContext->pCompressor)
+        return MZ_FALSE;
+
+    if (pContext->file_ofs + n > pContext->max_size)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_READ_FAILED);
+        goto fail;
+    }
+
+    /* Emit whatever the compressor holds, byte aligned and not final. */
+    if (pContext->file_ofs != pContext->comp_file_ofs &&
+        tdefl_compress_buffer(pContext->pCompressor, NULL, 0, TDEFL_SYNC_FLUSH) != TDEFL_STATUS_OKAY)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_COMPRESSION_FAILED);
+        goto fail;
+    }
+
+    if (pZip->m_pWrite(pZip->m_pIO_opaque, pContext->add_state.m_cur_archive_file_ofs, pComp_buf, comp_n) != comp_n)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_FILE_WRITE_FAILED);
+        goto fail;
+    }
+
+    pContext->add_state.m_cur_archive_file_ofs += comp_n;
+    pContext->add_state.m_comp_size += comp_n;
+    pContext->file_ofs += n;
+    pContext->uncomp_crc32 = (mz_uint32)mz_crc32(pContext->uncomp_crc32, (const mz_uint8 *)pRead_buf, n);
+
+    /* The following blocks must not reference the data compressed by the caller. */
+    pContext->comp_file_ofs = pContext->file_ofs;
+    if (tdefl_init(pContext->pCompressor, mz_zip_writer_add_put_buf_callback, &pContext->add_state, pContext->comp_flags) != TDEFL_STATUS_OKAY)
+    {
+        mz_zip_set_error(pZip, MZ_ZIP_INTERNAL_ERROR);
+        goto fail;
+    }
+
+    return MZ_TRUE;
+
+fail:
+    pZip->m_pFree(pZip->m_pAlloc_opaque, pContext->pCompressor);
+    pContext->pCompressor = NULL;
+    return MZ_FALSE;
+}
+
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context *pContext)
 {
     if (! mz_zip_writer_add_staged_data(pContext, NULL, 0) ||
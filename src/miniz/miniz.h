@@ -1334,7 +1334,10 @@ typedef struct mz_zip_writer_staged_context
      */
     mz_zip_writer_add_state  add_state;
     tdefl_compressor        *pCompressor;
+    mz_uint                  comp_flags;
     mz_uint64                file_ofs;
+    /* file_ofs at the last (re)initialization of pCompressor */
+    mz_uint64                comp_file_ofs;
 
     /*
      * The following data is passed to the "finish" stage, the referenced pointers must still be valid!
@@ -1353,6 +1356,10 @@ mz_bool mz_zip_writer_add_staged_open(mz_zip_archive* pZip, mz_zip_writer_staged
     const char* user_extra_data, mz_uint user_extra_data_len, const char* user_extra_data_central, mz_uint user_extra_data_central_len);
 mz_bool mz_zip_writer_add_staged_data(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n);
 mz_bool mz_zip_writer_add_staged_finish(mz_zip_writer_staged_context* pContext);
+/* Appends a chunk of raw deflate data compressed by the caller, pRead_buf / n being the uncompressed data.
+ * The compressed chunk must not be final and it must end on a byte boundary, for example by TDEFL_SYNC_FLUSH.
+ * Data previously passed to mz_zip_writer_add_staged_data() are flushed first. */
+mz_bool mz_zip_writer_add_staged_precompressed(mz_zip_writer_staged_context* pContext, const char* pRead_buf, size_t n, const void* pComp_buf, size_t comp_n);
 
 /* Adds a file to an archive by fully cloning the data from another archive. */
 /* This function fully clones the source file's compressed data (no recompression), along with its full filename, extra data (it may add or modify the zip64 local header extra data field), and the optional descriptor following the compressed data. */
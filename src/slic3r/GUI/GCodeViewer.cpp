@@ -525,6 +525,18 @@ void GCodeViewer::SequentialView::GCodeWindow::load_gcode(const GCodeProcessorRe
     m_filename = gcode_result.filename;
     m_is_binary_file = gcode_result.is_binary_file;
     m_lines_ends = gcode_result.lines_ends;
+    m_layer_index = BinaryGCodeLayerIndex();
+    if (m_is_binary_file) {
+        FilePtr file(boost::nowide::fopen(m_filename.c_str(), "rb"));
+        if (file.f != nullptr) {
+            try {
+                m_layer_index = BinaryGCodeLayerIndex::load(*file.f);
+            }
+            catch (const std::exception& ex) {
+                BOOST_LOG_TRIVIAL(error) << "GCodeWindow: Couldn't load the layer index of " << m_filename << ": " << ex.what();
+            }
+        }
+    }
 }
 
 void GCodeViewer::SequentialView::GCodeWindow::add_gcode_line_to_lines_cache(const std::string& src)
@@ -672,6 +684,35 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
         assert(m_lines_cache.size() == m_cache_range.size());
     };
 
+    // Decodes only the blocks of the layers containing the cached lines, returns false if the index cannot be used.
+    auto update_lines_binary_from_index = [this]() {
+        const size_t first_layer_id = m_layer_index.layer_id_at_line(*m_cache_range.min);
+        if (first_layer_id == m_layer_index.size())
+            // the cached lines start before the first layer
+            return false;
+        const size_t last_layer_id = m_layer_index.layer_id_at_line(*m_cache_range.max);
+
+        FilePtr file(boost::nowide::fopen(m_filename.c_str(), "rb"));
+        if (file.f == nullptr)
+            return false;
+
+        m_lines_cache.clear();
+        m_lines_cache.reserve(m_cache_range.size());
+        size_t line_id = m_layer_index[first_layer_id].first_line_id;
+        try {
+            m_layer_index.read_layers(*file.f, first_layer_id, last_layer_id, [this, &line_id](std::string_view line) {
+                if (line_id >= *m_cache_range.min && line_id <= *m_cache_range.max)
+                    add_gcode_line_to_lines_cache(std::string(line));
+                ++line_id;
+            });
+        }
+        catch (const std::exception&) {
+            m_lines_cache.clear();
+        }
+        // the lines of the index itself, at the end of the gcode, are not returned by read_layers()
+        return m_lines_cache.size() == m_cache_range.size();
+    };
+
     static const ImVec4 LINE_NUMBER_COLOR = ImGuiPureWrap::COL_ORANGE_LIGHT;
     static const ImVec4 SELECTION_RECT_COLOR = ImGuiPureWrap::COL_ORANGE_DARK;
     static const ImVec4 COMMAND_COLOR    = { 0.8f, 0.8f, 0.0f, 1.0f };
@@ -717,8 +758,10 @@ void GCodeViewer::SequentialView::GCodeWindow::render(float top, float bottom, s
     // update cache if needed
     if (m_cache_range.empty() || !m_cache_range.contains(visible_range)) {
         resize_range(m_cache_range, 4 * visible_range.size());
-        if (m_is_binary_file)
-            update_lines_binary();
+        if (m_is_binary_file) {
+            if (m_layer_index.empty() || !update_lines_binary_from_index())
+                update_lines_binary();
+        }
         else
             update_lines_ascii();
     }
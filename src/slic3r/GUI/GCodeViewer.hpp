@@ -10,6 +10,7 @@
 #include "3DScene.hpp"
 #include "libslic3r/ExtrusionRole.hpp"
 #include "libslic3r/GCode/GCodeProcessor.hpp"
+#include "libslic3r/GCode/BinaryGCodeLayerIndex.hpp"
 #include "GLModel.hpp"
 
 #include "LibVGCode/LibVGCodeWrapper.hpp"
@@ -188,6 +189,8 @@ public:
             bool m_is_binary_file{ false };
             // map for accessing data in file by line number
             std::vector<std::vector<size_t>> m_lines_ends;
+            // layers of a binary file, allowing to decode only the blocks containing the cached lines
+            BinaryGCodeLayerIndex m_layer_index;
             std::vector<Line> m_lines_cache;
             Range m_cache_range;
             size_t m_max_line_length{ 0 };
@@ -198,6 +201,7 @@ public:
                 m_lines_ends.clear();
                 m_lines_cache.clear();
                 m_filename.clear();
+                m_layer_index = BinaryGCodeLayerIndex();
             }
             void toggle_visibility() { m_visible = !m_visible; }
             void render(float top, float bottom, size_t curr_line_id);
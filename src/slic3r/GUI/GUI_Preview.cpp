@@ -840,7 +840,7 @@ void Preview::update_sliders_from_canvas(wxKeyEvent& event)
 
 void Preview::update_moves_slider(std::optional<int> visible_range_min, std::optional<int> visible_range_max)
 {
-    if (m_gcode_result->moves.empty())
+    if (m_gcode_result->compact_moves.empty())
         return;
 
     const libvgcode::Interval& range = m_canvas->get_gcode_view_enabled_range();
@@ -944,7 +944,7 @@ void Preview::load_print_as_fff(bool keep_z_range)
     }
 
     libvgcode::EViewType gcode_view_type = m_canvas->get_gcode_view_type();
-    const bool gcode_preview_data_valid = !m_gcode_result->moves.empty();
+    const bool gcode_preview_data_valid = !m_gcode_result->compact_moves.empty();
     const bool is_pregcode_preview = !gcode_preview_data_valid && wxGetApp().is_editor();
 
     const std::vector<std::string> tool_colors = wxGetApp().plater()->get_extruder_color_strings_from_plater_config(m_gcode_result);
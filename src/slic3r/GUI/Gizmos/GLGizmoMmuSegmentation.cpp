@@ -538,8 +538,8 @@ void GLGizmoMmuSegmentation::init_model_triangle_selectors()
 
         const size_t extruder_idx = ModelVolume::get_extruder_color_idx(*mv, extruders_count);
         m_triangle_selectors.emplace_back(std::make_unique<TriangleSelectorMmGui>(*mesh, m_modified_extruders_colors, m_original_extruders_colors[extruder_idx]));
-        // Reset of TriangleSelector is done inside TriangleSelectorMmGUI's constructor, so we don't need it to perform it again in deserialize().
-        m_triangle_selectors.back()->deserialize(mv->mm_segmentation_facets.get_data(), false);
+        // Reuses the painting resolved for the background processing if it has not changed since.
+        mv->mm_segmentation_facets.copy_to_selector(*mv, *m_triangle_selectors.back());
         m_triangle_selectors.back()->request_update_render_data();
     }
     m_original_volumes_extruder_idxs = get_extruder_id_for_volumes(*mo);
@@ -232,8 +232,8 @@ void GLGizmoSeam::update_from_model_object()
         const TriangleMesh* mesh = &mv->mesh();
 
         m_triangle_selectors.emplace_back(std::make_unique<TriangleSelectorGUI>(*mesh));
-        // Reset of TriangleSelector is done inside TriangleSelectorGUI's constructor, so we don't need it to perform it again in deserialize().
-        m_triangle_selectors.back()->deserialize(mv->seam_facets.get_data(), false);
+        // Reuses the painting resolved for the background processing if it has not changed since.
+        mv->seam_facets.copy_to_selector(*mv, *m_triangle_selectors.back());
         m_triangle_selectors.back()->request_update_render_data();
     }
 }
@@ -171,11 +171,13 @@ GCodeInputData convert(const Slic3r::GCodeProcessorResult& result, const std::ve
         ret.color_print_colors.emplace_back(convert(color));
     }
 
-    const std::vector<Slic3r::GCodeProcessorResult::MoveVertex>& moves = result.moves;
+    // the moves are decoded one by one, to avoid expanding all of them in memory at once
+    const Slic3r::GCodeProcessorResult::CompactMoves& moves = result.compact_moves;
     ret.vertices.reserve(2 * moves.size());
-    for (size_t i = 1; i < moves.size(); ++i) {
-        const Slic3r::GCodeProcessorResult::MoveVertex& curr = moves[i];
-        const Slic3r::GCodeProcessorResult::MoveVertex& prev = moves[i - 1];
+    Slic3r::GCodeProcessorResult::MoveVertex curr = moves.empty() ? Slic3r::GCodeProcessorResult::MoveVertex() : moves.front();
+    for (auto it = moves.begin() + 1; it < moves.end(); ++it) {
+        const Slic3r::GCodeProcessorResult::MoveVertex prev = curr;
+        curr = *it;
         const EMoveType curr_type = convert(curr.type);
         const EOptionType option_type = move_type_to_option(curr_type);
         if (option_type == EOptionType::COUNT || option_type == EOptionType::Travels || option_type == EOptionType::Wipes) {
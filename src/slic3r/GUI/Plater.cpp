@@ -5530,10 +5530,7 @@ void Plater::export_stl_obj(bool extended, bool selection_only)
         if (csg::is_all_positive(csgrange)) {
             mesh = TriangleMesh{csg::csgmesh_merge_positive_parts(csgrange)};
         } else if (csg::check_csgmesh_booleans(csgrange) == csgrange.end()) {
-            try {
-                auto cgalm = csg::perform_csgmesh_booleans(csgrange);
-                mesh = MeshBoolean::cgal::cgal_to_triangle_mesh(*cgalm);
-            } catch (...) {}
+            mesh = TriangleMesh{csg::perform_csgmesh_booleans(csgrange, csg::BooleanBackend::CGAL)};
         }
 
         if (mesh.empty()) {
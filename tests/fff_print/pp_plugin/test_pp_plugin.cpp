@@ -0,0 +1,76 @@
+// Minimal G-code post-processing plugin used by test_postprocess_plugin.cpp.
+// After each ";LAYER_CHANGE" line it inserts a comment with the plugin arguments and the layer height from the print configuration.
+// Arguments "fail_begin" and "fail" make it fail when starting and when processing the G-code.
+
+#include "libslic3r/GCode/PostProcessPlugin.hpp"
+
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+    #define PP_PLUGIN_EXPORT __declspec(dllexport)
+#else
+    #define PP_PLUGIN_EXPORT __attribute__((visibility("default")))
+#endif
+
+namespace {
+
+struct PluginData {
+    std::string args;
+    std::string layer_height;
+    std::string error;
+};
+
+} // anonymous namespace
+
+extern "C" {
+
+PP_PLUGIN_EXPORT int slic3r_pp_api_version()
+{
+    return SLIC3R_PP_PLUGIN_API_VERSION;
+}
+
+PP_PLUGIN_EXPORT void* slic3r_pp_begin(const char *args, const char *const *config_keys, const char *const *config_values, size_t config_size)
+{
+    if (std::strcmp(args, "fail_begin") == 0)
+        return nullptr;
+    auto *data = new PluginData;
+    data->args = args;
+    for (size_t i = 0; i < config_size; ++ i)
+        if (std::strcmp(config_keys[i], "layer_height") == 0)
+            data->layer_height = config_values[i];
+    return data;
+}
+
+PP_PLUGIN_EXPORT int slic3r_pp_process(void *vdata, const char *gcode, size_t size, slic3r_pp_emit_fn emit, void *emit_data)
+{
+    auto *data = static_cast<PluginData*>(vdata);
+    if (data->args == "fail") {
+        data->error = "failure requested by the arguments";
+        return 1;
+    }
+    static constexpr const char LayerChange[] = ";LAYER_CHANGE";
+    const std::string comment = "; test plugin " + data->args + ", layer_height = " + data->layer_height + "\n";
+    for (size_t begin = 0; begin < size;) {
+        const char *eol = static_cast<const char*>(std::memchr(gcode + begin, '\n', size - begin));
+        size_t      end = eol ? eol - gcode + 1 : size;
+        emit(emit_data, gcode + begin, end - begin);
+        if (end - begin >= sizeof(LayerChange) - 1 && std::strncmp(gcode + begin, LayerChange, sizeof(LayerChange) - 1) == 0)
+            emit(emit_data, comment.data(), comment.size());
+        begin = end;
+    }
+    return 0;
+}
+
+PP_PLUGIN_EXPORT const char* slic3r_pp_error(void *vdata)
+{
+    auto *data = static_cast<PluginData*>(vdata);
+    return data->error.empty() ? nullptr : data->error.c_str();
+}
+
+PP_PLUGIN_EXPORT void slic3r_pp_end(void *vdata)
+{
+    delete static_cast<PluginData*>(vdata);
+}
+
+} // extern "C"
@@ -7,8 +7,15 @@
 #include <memory>
 #include <regex>
 #include <fstream>
+#include <sstream>
+
+#include <boost/algorithm/string/predicate.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/nowide/cstdio.hpp>
+#include <boost/nowide/fstream.hpp>
 
 #include "libslic3r/GCode.hpp"
+#include "libslic3r/GCode/BinaryGCodeLayerIndex.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 #include "libslic3r/ModelArrange.hpp"
 #include "test_data.hpp"
@@ -329,3 +336,169 @@ TEST_CASE("M201 for acceleation reset", "[GCode]") {
     INFO("M204 is not generated for repetier firmware");
     CHECK(!has_m204);
 }
+
+TEST_CASE("Compact moves match the processed moves", "[GCode]") {
+    using MoveVertex = GCodeProcessorResult::MoveVertex;
+    std::vector<MoveVertex> moves;
+    for (unsigned int layer_id = 0; layer_id < 4; ++ layer_id)
+        for (unsigned int i = 0; i < 100; ++ i) {
+            MoveVertex &move = moves.emplace_back();
+            move.gcode_id        = unsigned(moves.size()) * (layer_id == 2 ? 1000 : 1);
+            move.type            = i % 50 == 0 ? EMoveType::Travel : EMoveType::Extrude;
+            move.extrusion_role  = i % 50 == 0 ? GCodeExtrusionRole::None : GCodeExtrusionRole::ExternalPerimeter;
+            move.extruder_id     = layer_id % 2;
+            move.cp_color_id     = layer_id;
+            // Travels jump across the bed to split the blocks.
+            move.position        = Vec3f(i % 50 == 0 ? 200.f : 10.f + 0.123f * i, 20.f + 0.017f * i, 0.2f * (layer_id + 1));
+            move.delta_extruder  = 0.01f * i;
+            move.feedrate        = i % 50 == 0 ? 150.f : 40.f;
+            move.actual_feedrate = 0.37f * i;
+            move.width           = 0.45f;
+            move.height          = 0.2f;
+            move.mm3_per_mm      = 0.08f;
+            move.fan_speed       = 100.f;
+            move.temperature     = 215.f;
+            move.time            = { 0.1f * i, 0.2f * i };
+            move.layer_id        = layer_id;
+            move.internal_only   = i == 50;
+        }
+
+    const GCodeProcessorResult::CompactMoves compact(moves);
+    REQUIRE(compact.size() == moves.size());
+    CHECK(compact.memory_used() < moves.size() * sizeof(MoveVertex) / 2);
+    CHECK(compact.palette_size() == 2);
+
+    auto check_move = [](const MoveVertex &decoded, const MoveVertex &move) {
+        CHECK(decoded.gcode_id == move.gcode_id);
+        CHECK(decoded.type == move.type);
+        CHECK(decoded.extrusion_role == move.extrusion_role);
+        CHECK(decoded.extruder_id == move.extruder_id);
+        CHECK(decoded.cp_color_id == move.cp_color_id);
+        CHECK((decoded.position - move.position).norm() < 0.001f);
+        CHECK(decoded.delta_extruder == move.delta_extruder);
+        CHECK(decoded.feedrate == move.feedrate);
+        CHECK(decoded.actual_feedrate == move.actual_feedrate);
+        CHECK(decoded.width == move.width);
+        CHECK(decoded.height == move.height);
+        CHECK(decoded.mm3_per_mm == move.mm3_per_mm);
+        CHECK(decoded.fan_speed == move.fan_speed);
+        CHECK(decoded.temperature == move.temperature);
+        CHECK(decoded.time == move.time);
+        CHECK(decoded.layer_id == move.layer_id);
+        CHECK(decoded.internal_only == move.internal_only);
+    };
+
+    SECTION("sequential access") {
+        size_t i = 0;
+        for (const MoveVertex &decoded : compact)
+            check_move(decoded, moves[i ++]);
+        CHECK(i == moves.size());
+    }
+    SECTION("random access") {
+        for (size_t i = 0; i < moves.size(); i += 7)
+            check_move(compact[moves.size() - 1 - i], moves[moves.size() - 1 - i]);
+        auto it = compact.begin() + 250;
+        check_move(*it, moves[250]);
+        check_move(it[-150], moves[100]);
+        CHECK(compact.end() - it == moves.size() - 250);
+    }
+}
+
+TEST_CASE("Binary G-code layer index reads the layers of the ASCII G-code", "[GCode]") {
+    DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "layer_height",       "0.2" },
+        { "first_layer_height", "0.2" },
+    });
+
+    auto export_gcode = [&config](bool binary, const std::string &path) {
+        config.set("binary_gcode", binary);
+        Print print;
+        Model model;
+        Test::init_print({ TestMesh::cube_20x20x20 }, print, model, config);
+        print.set_status_silent();
+        print.process();
+        print.export_gcode(path, nullptr, nullptr);
+    };
+    const std::string ascii_path  = boost::filesystem::unique_path().string();
+    const std::string binary_path = boost::filesystem::unique_path().string();
+    export_gcode(false, ascii_path);
+    export_gcode(true, binary_path);
+
+    // Layers of the ASCII G-code, each one starting with its ;LAYER_CHANGE line.
+    std::vector<std::string> ascii_layers;
+    {
+        boost::nowide::ifstream is(ascii_path);
+        for (std::string line; std::getline(is, line);) {
+            if (line == ";LAYER_CHANGE")
+                ascii_layers.emplace_back();
+            if (! ascii_layers.empty())
+                ascii_layers.back() += line + "\n";
+        }
+    }
+    REQUIRE(ascii_layers.size() == 100);
+
+    FilePtr file(boost::nowide::fopen(binary_path.c_str(), "rb"));
+    REQUIRE(file.f != nullptr);
+    const BinaryGCodeLayerIndex index = BinaryGCodeLayerIndex::load(*file.f);
+    REQUIRE(index.size() == ascii_layers.size());
+
+    auto read_layers = [&index, &file](size_t first_layer_id, size_t last_layer_id) {
+        std::string out;
+        index.read_layers(*file.f, first_layer_id, last_layer_id, [&out](std::string_view line) { out += line; });
+        return out;
+    };
+    auto count_lines = [](const std::string &gcode) { return size_t(std::count(gcode.begin(), gcode.end(), '\n')); };
+    auto count_moves = [](const std::string &gcode) {
+        size_t moves = 0;
+        std::istringstream is(gcode);
+        for (std::string line; std::getline(is, line);)
+            moves += std::regex_match(line, std::regex("G[0-3]( .*)?"));
+        return moves;
+    };
+
+    SECTION("layers match the ASCII G-code") {
+        // The last layer extends to the end of the G-code, which differs: the binary G-code stores the config in a metadata block.
+        for (size_t layer_id = 0; layer_id + 1 < index.size(); ++ layer_id) {
+            const std::string layer = read_layers(layer_id, layer_id);
+            CHECK(layer == ascii_layers[layer_id]);
+            CHECK(index[layer_id].moves_count == count_moves(layer));
+            CHECK(index[layer_id + 1].first_line_id == index[layer_id].first_line_id + count_lines(layer));
+            CHECK(index.layer_id_at(index[layer_id].z) == layer_id);
+        }
+        CHECK(boost::starts_with(read_layers(index.size() - 1, index.size() - 1), ";LAYER_CHANGE\n;Z:"));
+    }
+    SECTION("a range of layers is read at once") {
+        CHECK(read_layers(10, 12) == ascii_layers[10] + ascii_layers[11] + ascii_layers[12]);
+    }
+    SECTION("line ids match the lines of the G-code blocks") {
+        // Decode all the G-code blocks.
+        using namespace bgcode::core;
+        std::vector<std::string> lines;
+        rewind(file.f);
+        FileHeader file_header;
+        REQUIRE(read_header(*file.f, file_header, nullptr) == EResult::Success);
+        BlockHeader block_header;
+        while (read_next_block_header(*file.f, file_header, block_header, nullptr, 0) == EResult::Success) {
+            if (block_header.type == (uint16_t)EBlockType::GCode) {
+                bgcode::binarize::GCodeBlock block;
+                REQUIRE(block.read_data(*file.f, file_header, block_header) == EResult::Success);
+                std::istringstream is(block.raw_data);
+                for (std::string line; std::getline(is, line);)
+                    lines.emplace_back(line);
+            } else
+                REQUIRE(skip_block(*file.f, file_header, block_header) == EResult::Success);
+        }
+        for (size_t layer_id = 0; layer_id < index.size(); ++ layer_id) {
+            REQUIRE(index[layer_id].first_line_id > 0);
+            REQUIRE(index[layer_id].first_line_id <= lines.size());
+            CHECK(lines[index[layer_id].first_line_id - 1] == ";LAYER_CHANGE");
+            CHECK(index.layer_id_at_line(index[layer_id].first_line_id) == layer_id);
+        }
+        CHECK(index.layer_id_at_line(index[0].first_line_id - 1) == index.size());
+    }
+
+    file.close();
+    boost::nowide::remove(ascii_path.c_str());
+    boost::nowide::remove(binary_path.c_str());
+}
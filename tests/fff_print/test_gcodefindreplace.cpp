@@ -290,3 +290,66 @@ SCENARIO("Find/Replace with regexp", "[GCodeFindReplace]") {
         }
     }
 }
+
+SCENARIO("Find/Replace with multiple substitutions", "[GCodeFindReplace]") {
+    GIVEN("G-code") {
+        const std::string gcode =
+            "G1 Z0; home\n"
+            "G1 Z1; move up\n"
+            "G1 X0 Y1 Z1; perimeter\n"
+            "G1 X13 Y32 Z1; infill\n"
+            "G1 X13 Y32 Z1; wipe\n";
+        WHEN("Substitutions are applied in order, each one to the output of the previous one") {
+            GCodeFindReplace find_replace({
+                "move up",      "move Down", "",   "",
+                "down",         "further",   "iw", "",
+                "Z1; move",     "Z2; jump",  "",   "",
+                "(X1)?3 Y32",   "\\1 Y64",   "r",  "",
+                "jump further", "go up",     "",   "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; home\n"
+                "G1 Z2; go up\n"
+                "G1 X0 Y1 Z1; perimeter\n"
+                "G1 X1 Y64 Z1; infill\n"
+                "G1 X1 Y64 Z1; wipe\n");
+        }
+        WHEN("Substitutions not matching are skipped") {
+            GCodeFindReplace find_replace({
+                "retract", "unretract", "",   "",
+                "G10",     "G11",       "w",  "",
+                "^M10\\d", "",          "r",  "",
+                "E[0-9]+", "",          "ri", "" });
+            REQUIRE(find_replace.process_layer(gcode) == gcode);
+        }
+        WHEN("Regular expressions with back references and single line modifier are mixed") {
+            GCodeFindReplace find_replace({
+                "(Y)(\\d+) Z1; (i|w)",     "Y\\2\\2 Z1; \\3",       "r",  "",
+                "wipe\\n$",                "wipe\\nM107\\n",        "rs", "",
+                "^G1 (Z\\d)",              "G0 \\1",                "r",  "",
+                "; PERIMETER",             "; external perimeter",  "i",  "",
+                "(X\\d+) (Y\\d+) \\1",     "",                      "r",  "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G0 Z0; home\n"
+                "G0 Z1; move up\n"
+                "G1 X0 Y1 Z1; external perimeter\n"
+                "G1 X13 Y3232 Z1; infill\n"
+                "G1 X13 Y3232 Z1; wipe\n"
+                "M107\n");
+        }
+        WHEN("Substitutions match across the boundary of a text modified by a previous one") {
+            GCodeFindReplace find_replace({
+                "home",     "home position", "",  "",
+                "e p",      "E_P",           "",  "",
+                "Z0;",      "Z0;",           "",  "",
+                "Position", "pos",           "w", "",
+                "Y1",       "Y",             "",  "",
+                "Y",        "W",             "w", "" });
+            REQUIRE(find_replace.process_layer(gcode) ==
+                "G1 Z0; homE_pos\n"
+                "G1 Z1; move up\n"
+                "G1 X0 W Z1; perimeter\n"
+                "G1 X13 Y32 Z1; infill\n"
+                "G1 X13 Y32 Z1; wipe\n");
+        }
+    }
+}
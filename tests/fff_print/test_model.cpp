@@ -63,3 +63,90 @@ SCENARIO("Model construction", "[Model]") {
         }
     }
 }
+
+SCENARIO("Painted facets are resolved once per paint data", "[Model]") {
+    GIVEN("A sphere with its upper half painted by extruder 2") {
+        Model        model;
+        ModelObject *model_object = model.add_object();
+        ModelVolume *volume       = model_object->add_volume(make_sphere(10., 2. * PI / 32.));
+        TriangleSelector selector(volume->mesh());
+        const indexed_triangle_set &its = volume->mesh().its;
+        for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx)
+            if (its_face_normal(its, facet_idx).z() > 0.f)
+                selector.set_facet(facet_idx, TriangleStateType::Extruder2);
+        REQUIRE(volume->mm_segmentation_facets.set(selector));
+        const indexed_triangle_set expected = selector.get_facets(TriangleStateType::Extruder2);
+
+        WHEN("The painted facets are requested repeatedly and from a copy of the model") {
+            Model model_copy = model;
+            const ModelVolume &volume_copy = *model_copy.objects.front()->volumes.front();
+            THEN("They match the painting") {
+                for (const ModelVolume *mv : std::vector<const ModelVolume*>{ volume, &volume_copy }) {
+                    const indexed_triangle_set facets = mv->mm_segmentation_facets.get_facets(*mv, TriangleStateType::Extruder2);
+                    REQUIRE(facets.indices == expected.indices);
+                    REQUIRE(facets.vertices == expected.vertices);
+                    REQUIRE(mv->mm_segmentation_facets.get_facets(*mv, TriangleStateType::Extruder3).empty());
+                }
+            }
+            THEN("The copies share the facets resolved once") {
+                std::shared_ptr<const indexed_triangle_set> facets = volume->mm_segmentation_facets.get_facets_shared(*volume, TriangleStateType::Extruder2);
+                REQUIRE(volume->mm_segmentation_facets.get_facets_shared(*volume, TriangleStateType::Extruder2) == facets);
+                REQUIRE(volume_copy.mm_segmentation_facets.get_facets_shared(volume_copy, TriangleStateType::Extruder2) == facets);
+            }
+        }
+        WHEN("The painting changes after the facets were resolved") {
+            std::shared_ptr<const indexed_triangle_set> resolved = volume->mm_segmentation_facets.get_facets_shared(*volume, TriangleStateType::Extruder2);
+            selector.reset();
+            selector.set_facet(0, TriangleStateType::Extruder3);
+            REQUIRE(volume->mm_segmentation_facets.set(selector));
+            THEN("The new painting is resolved") {
+                REQUIRE(volume->mm_segmentation_facets.get_facets_shared(*volume, TriangleStateType::Extruder2) != resolved);
+                REQUIRE(volume->mm_segmentation_facets.get_facets(*volume, TriangleStateType::Extruder2).empty());
+                REQUIRE(volume->mm_segmentation_facets.get_facets(*volume, TriangleStateType::Extruder3).indices.size() == 1);
+            }
+        }
+        WHEN("The painting is loaded into a new selector") {
+            TriangleSelector loaded(volume->mesh());
+            volume->mm_segmentation_facets.copy_to_selector(*volume, loaded);
+            THEN("It serializes to the same data") {
+                REQUIRE(loaded.serialize() == volume->mm_segmentation_facets.get_data());
+            }
+        }
+    }
+}
+
+SCENARIO("Convex hull 2D of a volume is calculated from its convex hull", "[Model]") {
+    GIVEN("A sphere with an instance rotated around the X axis") {
+        Model        model;
+        ModelObject *model_object = model.add_object();
+        ModelVolume *volume       = model_object->add_volume(make_sphere(10., 2. * PI / 64.));
+        Transform3d  trafo        = Geometry::assemble_transform(Vec3d(0., 0., 5.), Vec3d(0.3, 0., 0.));
+
+        auto reference = [volume](const Transform3d &trafo) {
+            return its_convex_hull_2d_above(volume->mesh().its, trafo.cast<float>(), 0.0f);
+        };
+        // The reference transforms the vertices with the XY offset in float precision, thus the hulls differ in the order of a micron.
+        auto same_hull = [](const Polygon &hull, const Polygon &expected) {
+            const BoundingBox bbox = get_extents(hull), bbox_expected = get_extents(expected);
+            return std::abs(hull.area() - expected.area()) < 1e-4 * expected.area() &&
+                (bbox.min - bbox_expected.min).cast<double>().norm() < scaled<double>(0.001) &&
+                (bbox.max - bbox_expected.max).cast<double>().norm() < scaled<double>(0.001);
+        };
+
+        THEN("The hull of the sinking part matches the hull of the clipped mesh") {
+            REQUIRE(same_hull(volume->convex_hull_2d(trafo), reference(trafo)));
+        }
+        WHEN("The hull is requested for instances shifted in XY and lifted above the bed") {
+            trafo.translation().z() = 20.;
+            const Polygon first = volume->convex_hull_2d(trafo);
+            THEN("The cached hull is translated with the instances") {
+                REQUIRE(same_hull(first, reference(trafo)));
+                for (double offset : { 50., -120., 300. }) {
+                    Transform3d shifted = trafo;
+                    shifted.translation() += Vec3d(offset, 2. * offset, 0.);
+                    REQUIRE(same_hull(volume->convex_hull_2d(shifted), reference(shifted)));
+                }
+            }
+        }
+    }
+}
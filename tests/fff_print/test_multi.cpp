@@ -7,6 +7,8 @@
 #include "libslic3r/Geometry.hpp"
 #include "libslic3r/Geometry/ConvexHull.hpp"
 #include "libslic3r/Print.hpp"
+#include "libslic3r/MultiMaterialSegmentation.hpp"
+#include "libslic3r/TriangleSelector.hpp"
 #include "libslic3r/libslic3r.h"
 
 #include "test_data.hpp"
@@ -269,3 +271,131 @@ SCENARIO("Stacked cubes", "[Multi]")
         }
     }
 }
+
+TEST_CASE("Multi-material tool ordering and wipe tower benchmark", "[Multi][.Benchmarks]")
+{
+    // Five objects side by side, each printed with its own extruder, thus there are four tool changes on each layer.
+    static constexpr const int num_extruders = 5;
+    Model        model;
+    ModelObject *object = model.add_object();
+    object->name = "object.stl";
+    for (int i = 0; i < num_extruders; ++ i) {
+        ModelVolume *volume = object->add_volume(Test::mesh(Test::TestMesh::cube_20x20x20));
+        volume->translate(25. * i, 0., 0.);
+        DynamicPrintConfig volume_config;
+        volume_config.set_deserialize_strict({ { "extruder", i + 1 } });
+        volume->config.assign_config(volume_config);
+    }
+    object->add_instance();
+    object->ensure_on_bed();
+
+    auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
+        { "nozzle_diameter",                "0.4, 0.4, 0.4, 0.4, 0.4" },
+        { "layer_height",                   0.1 },
+        { "fill_density",                   "20%" },
+        { "wipe_tower",                     1 },
+        { "single_extruder_multi_material", 1 },
+        { "wipe_into_infill",               1 },
+    });
+    Print print;
+    print.apply(model, config);
+    print.validate();
+    print.process();
+
+    BENCHMARK("ToolOrdering") {
+        return ToolOrdering(print, (unsigned int)-1, true);
+    };
+
+    // Changing the wipe tower width invalidates the wipe tower and the skirt / brim steps only.
+    int wipe_tower_width = 60;
+    BENCHMARK_ADVANCED("Wipe tower")(Catch::Benchmark::Chronometer meter) {
+        meter.measure([&] {
+            config.set_deserialize_strict({ { "wipe_tower_width", ++ wipe_tower_width } });
+            print.apply(model, config);
+            print.process();
+            return print.wipe_tower_data().tool_changes.size();
+        });
+    };
+}
+
+// Model of a single object with its sides painted by four vertical stripes: unpainted, extruder 2, unpainted, extruder 3.
+static Model mm_painted_model(TriangleMesh &&mesh)
+{
+    Model        model;
+    ModelObject *object = model.add_object();
+    object->name = "object.stl";
+    ModelVolume *volume = object->add_volume(std::move(mesh));
+    TriangleSelector selector(volume->mesh());
+    const indexed_triangle_set &its = volume->mesh().its;
+    for (int facet_idx = 0; facet_idx < int(its.indices.size()); ++ facet_idx)
+        if (const Vec3f normal = its_face_normal(its, facet_idx); std::abs(normal.z()) < 0.5f) {
+            const int stripe = std::clamp(int(std::floor((std::atan2(normal.y(), normal.x()) + M_PI) / (0.5 * M_PI))), 0, 3);
+            if (stripe == 1)
+                selector.set_facet(facet_idx, TriangleStateType::Extruder2);
+            else if (stripe == 3)
+                selector.set_facet(facet_idx, TriangleStateType::Extruder3);
+        }
+    volume->mm_segmentation_facets.set(selector);
+    object->add_instance();
+    object->ensure_on_bed();
+    return model;
+}
+
+SCENARIO("Multi-material segmentation by painting", "[Multi]")
+{
+    GIVEN("Cylinder with its side painted by stripes of extruders 2 and 3") {
+        Model model = mm_painted_model(make_cylinder(10., 20., 2. * PI / 64.));
+        auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
+            { "nozzle_diameter",    "0.4, 0.4, 0.4" },
+            { "layer_height",       0.2 },
+            { "first_layer_height", 0.2 },
+        });
+        Print print;
+        print.apply(model, config);
+        print.validate();
+        print.process();
+        THEN("Each layer between the top and bottom shells is split into regions of both painted extruders") {
+            const PrintObject &print_object = *print.objects().front();
+            for (const Layer *layer : print_object.layers())
+                if (layer->slice_z > 5. && layer->slice_z < 15.) {
+                    std::set<int> extruders;
+                    for (const LayerRegion *layerm : layer->regions())
+                        if (! layerm->slices().empty())
+                            extruders.insert(layerm->region().config().perimeter_extruder.value);
+                    REQUIRE(extruders.count(2) == 1);
+                    REQUIRE(extruders.count(3) == 1);
+                }
+        }
+        THEN("Segmentation reusing the identical layers is the same as the one computed layer by layer") {
+            const PrintObject &print_object = *print.objects().front();
+            std::vector<std::vector<ExPolygons>> segmentation          = multi_material_segmentation_by_painting(print_object, []() {});
+            std::vector<std::vector<ExPolygons>> segmentation_no_reuse = multi_material_segmentation_by_painting(print_object, []() {}, false);
+            REQUIRE(segmentation.size() == segmentation_no_reuse.size());
+            for (size_t layer_idx = 0; layer_idx < segmentation.size(); ++ layer_idx) {
+                INFO("Layer " << layer_idx);
+                REQUIRE(segmentation[layer_idx] == segmentation_no_reuse[layer_idx]);
+            }
+        }
+    }
+}
+
+TEST_CASE("Multi-material segmentation by painting benchmark", "[Multi][.Benchmarks]")
+{
+    auto config = Slic3r::DynamicPrintConfig::full_print_config_with({
+        { "nozzle_diameter",    "0.4, 0.4, 0.4" },
+        { "layer_height",       0.1 },
+        { "first_layer_height", 0.1 },
+    });
+    // Finely tessellated sphere, whose every layer is different, and a cylinder with identical layers.
+    Model sphere   = mm_painted_model(make_sphere(20., 2. * PI / 512.));
+    Model cylinder = mm_painted_model(make_cylinder(20., 40., 2. * PI / 512.));
+    for (auto [name, model] : { std::make_pair("sphere", &sphere), std::make_pair("cylinder", &cylinder) }) {
+        Print print;
+        print.apply(*model, config);
+        print.validate();
+        print.process();
+        BENCHMARK(std::string("Segmentation of painted ") + name) {
+            return multi_material_segmentation_by_painting(*print.objects().front(), []() {});
+        };
+    }
+}
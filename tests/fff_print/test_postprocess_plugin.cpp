@@ -0,0 +1,70 @@
+#include <catch2/catch.hpp>
+
+#include "libslic3r/libslic3r.h"
+#include "libslic3r/Exception.hpp"
+#include "libslic3r/GCode/PostProcessPlugin.hpp"
+
+#include "test_data.hpp"
+
+using namespace Slic3r;
+
+TEST_CASE("Post-processing plugin lines are recognized by their prefix", "[PostProcessPlugin]") {
+    std::string path, args;
+
+    SECTION("plugin with arguments") {
+        REQUIRE(is_post_process_plugin("plugin:/usr/lib/pp.so --fast  1", &path, &args));
+        REQUIRE(path == "/usr/lib/pp.so");
+        REQUIRE(args == "--fast  1");
+    }
+    SECTION("quoted path with spaces") {
+        REQUIRE(is_post_process_plugin("  plugin: \"C:\\My Plugins\\pp.dll\" x", &path, &args));
+        REQUIRE(path == "C:\\My Plugins\\pp.dll");
+        REQUIRE(args == "x");
+    }
+    SECTION("plugin without arguments") {
+        REQUIRE(is_post_process_plugin("plugin:pp.dylib", &path, &args));
+        REQUIRE(path == "pp.dylib");
+        REQUIRE(args.empty());
+    }
+    SECTION("scripts referencing shared libraries are not plugins") {
+        REQUIRE(! is_post_process_plugin("python3 pp.py --lib foo.so"));
+        REQUIRE(! is_post_process_plugin("/usr/lib/pp.so"));
+        REQUIRE(! is_post_process_plugin("\"C:\\My Plugins\\pp.dll\" x"));
+    }
+}
+
+TEST_CASE("Post-processing plugin rewrites the G-code", "[PostProcessPlugin]") {
+    DynamicPrintConfig config = Slic3r::DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "layer_height",   "0.25" },
+        { "gcode_comments", "1" },
+    });
+
+    SECTION("G-code is rewritten") {
+        config.set_deserialize_strict("post_process", std::string(PostProcessPluginPrefix) + "\"" PP_TEST_PLUGIN_PATH "\" marker");
+        std::string gcode = Test::slice({ Test::TestMesh::cube_20x20x20 }, config);
+        const std::string comment = "; test plugin marker, layer_height = 0.25\n";
+        size_t num_comments = 0;
+        for (size_t pos = gcode.find(comment); pos != std::string::npos; pos = gcode.find(comment, pos + 1))
+            ++ num_comments;
+        REQUIRE(num_comments > 0);
+        // The comment follows each layer change.
+        size_t num_layer_changes = 0;
+        for (size_t pos = gcode.find("\n;LAYER_CHANGE\n"); pos != std::string::npos; pos = gcode.find("\n;LAYER_CHANGE\n", pos + 1))
+            ++ num_layer_changes;
+        REQUIRE(num_comments == num_layer_changes);
+        REQUIRE(Test::contains(gcode, "\n;LAYER_CHANGE\n" + comment));
+    }
+    SECTION("Failure to start is reported") {
+        config.set_deserialize_strict("post_process", std::string(PostProcessPluginPrefix) + "\"" PP_TEST_PLUGIN_PATH "\" fail_begin");
+        REQUIRE_THROWS_AS(Test::slice({ Test::TestMesh::cube_20x20x20 }, config), Slic3r::RuntimeError);
+    }
+    SECTION("Failure to process is reported with the plugin message") {
+        config.set_deserialize_strict("post_process", std::string(PostProcessPluginPrefix) + "\"" PP_TEST_PLUGIN_PATH "\" fail");
+        REQUIRE_THROWS_WITH(Test::slice({ Test::TestMesh::cube_20x20x20 }, config), Catch::Contains("failure requested by the arguments"));
+    }
+    SECTION("Missing library is reported") {
+        config.set_deserialize_strict("post_process", std::string(PostProcessPluginPrefix) + "\"" PP_TEST_PLUGIN_PATH ".missing\"");
+        REQUIRE_THROWS_AS(Test::slice({ Test::TestMesh::cube_20x20x20 }, config), Slic3r::RuntimeError);
+    }
+}
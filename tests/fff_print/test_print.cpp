@@ -3,6 +3,7 @@
 #include "libslic3r/libslic3r.h"
 #include "libslic3r/Print.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/GCode/ConflictChecker.hpp"
 
 #include "test_data.hpp"
 
@@ -185,3 +186,36 @@ SCENARIO("Ported from Perl", "[Print]") {
         }
     }
 }
+
+SCENARIO("ConflictChecker: intersections of lines of different instances", "[Print]") {
+    LineWithIDs lines;
+    auto add_line = [&lines](double ax, double ay, double bx, double by, int obj_id, int inst_id) {
+        lines.emplace_back(Line(Point::new_scale(ax, ay), Point::new_scale(bx, by)), obj_id, inst_id, ExtrusionRole::Perimeter);
+    };
+    GIVEN("Crossing lines of a single instance and a square of another object") {
+        add_line(0, 0, 10, 10, 0, 0);
+        add_line(0, 10, 10, 0, 0, 0);
+        add_line(20, 0, 30, 0, 1, 0);
+        add_line(30, 0, 30, 10, 1, 0);
+        add_line(30, 10, 20, 10, 1, 0);
+        add_line(20, 10, 20, 0, 1, 0);
+        THEN("No conflict is reported") {
+            REQUIRE(! ConflictChecker::find_inter_of_lines(lines).has_value());
+        }
+        WHEN("Another instance crosses the first object") {
+            add_line(5, -5, 5, 15, 1, 1);
+            THEN("The conflicting objects are reported") {
+                ConflictComputeOpt conflict = ConflictChecker::find_inter_of_lines(lines);
+                REQUIRE(conflict.has_value());
+                REQUIRE(std::min(conflict->_obj1, conflict->_obj2) == 0);
+                REQUIRE(std::max(conflict->_obj1, conflict->_obj2) == 1);
+            }
+        }
+        WHEN("Another object only touches the end point of the first object") {
+            add_line(10, 10, 20, 10, 2, 0);
+            THEN("No conflict is reported") {
+                REQUIRE(! ConflictChecker::find_inter_of_lines(lines).has_value());
+            }
+        }
+    }
+}
@@ -2,6 +2,7 @@
 
 #include "libslic3r/GCodeReader.hpp"
 #include "libslic3r/Layer.hpp"
+#include "libslic3r/Print.hpp"
 
 #include "test_data.hpp" // get access to init_print, etc
 
@@ -119,6 +120,76 @@ SCENARIO("SupportMaterial: support_layers_z and contact_distance", "[SupportMate
     }
 }
 
+SCENARIO("SupportMaterial: support spots search resumed from the previous search", "[SupportMaterial]")
+{
+    auto search_results = [](const Print &print) {
+        const PrintObjectRegions *regions = print.objects().front()->shared_regions();
+        REQUIRE(regions->generated_support_points.has_value());
+        return std::make_pair(regions->generated_support_points->support_points.size(), regions->generated_support_points->partial_objects.size());
+    };
+    GIVEN("An overhanging object") {
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({ { "fill_density", "20%" } });
+        Model model;
+        Print print;
+        Slic3r::Test::init_print({ TestMesh::overhang }, print, model, config);
+        print.process();
+        THEN("the state of the search is kept") {
+            REQUIRE(print.objects().front()->shared_regions()->support_spots_search_cache);
+        }
+        WHEN("the brim separation changes") {
+            config.set_deserialize_strict({ { "brim_separation", 1 } });
+            print.apply(model, config);
+            THEN("the support spots are not searched again") {
+                REQUIRE(print.objects().front()->is_step_done(posSupportSpotsSearch));
+            }
+        }
+        WHEN("the infill changes") {
+            config.set_deserialize_strict({ { "fill_density", "40%" } });
+            print.apply(model, config);
+            print.process();
+            THEN("the resumed search finds the same issues as a new search") {
+                Model model_new;
+                Print print_new;
+                Slic3r::Test::init_print({ TestMesh::overhang }, print_new, model_new, config);
+                print_new.process();
+                REQUIRE(search_results(print) == search_results(print_new));
+            }
+        }
+    }
+    GIVEN("A tall overhanging object") {
+        // The overhang stretched to about 84 layers of 0.3mm, its top above 18mm changed by the modifier below.
+        DynamicPrintConfig config = DynamicPrintConfig::full_print_config_with({ { "fill_density", "20%" } });
+        Model model;
+        Print print;
+        Slic3r::Test::init_print({ mesh(TestMesh::overhang, Vec3d::Zero(), Vec3d(1., 1., 4.)) }, print, model, config);
+        print.process();
+        WHEN("a layer range modifier changes the infill of the top of the object") {
+            ModelConfig &range_config = model.objects.front()->layer_config_ranges[t_layer_height_range(18., 30.)];
+            range_config.set("layer_height", config.opt_float("layer_height"));
+            range_config.set_deserialize_strict("fill_density", "40%");
+            print.apply(model, config);
+            print.process();
+            THEN("the search resumes above the first layer") {
+                REQUIRE(print.objects().front()->layer_count() > 64);
+                REQUIRE(SupportSpotsGenerator::first_searched_layer(*print.objects().front()->shared_regions()->support_spots_search_cache) > 0);
+            }
+            THEN("the resumed search finds the same support points as a new search") {
+                Print print_new;
+                print_new.apply(model, config);
+                print_new.set_status_silent();
+                print_new.process();
+                const SupportSpotsGenerator::SupportPoints &points     = print.objects().front()->shared_regions()->generated_support_points->support_points;
+                const SupportSpotsGenerator::SupportPoints &points_new = print_new.objects().front()->shared_regions()->generated_support_points->support_points;
+                REQUIRE(search_results(print) == search_results(print_new));
+                for (size_t i = 0; i < points.size(); ++ i) {
+                    REQUIRE(points[i].cause == points_new[i].cause);
+                    REQUIRE(points[i].position == points_new[i].position);
+                }
+            }
+        }
+    }
+}
+
 #if 0
 // Test 8.
 TEST_CASE("SupportMaterial: forced support is generated", "[SupportMaterial]")
@@ -280,6 +280,179 @@ SCENARIO( "TriangleMesh: Mesh merge functions") {
     }
 }
 
+SCENARIO( "TriangleMesh: Repair on import") {
+    GIVEN( "Facets of a 20mm cube with a flipped facet, a facet with a shifted vertex, a degenerate facet and a lone facet") {
+        const indexed_triangle_set cube = make_cube().its;
+        std::vector<stl_facet> facets;
+        for (const stl_triangle_vertex_indices &face : cube.indices) {
+            stl_facet facet;
+            for (int i = 0; i < 3; ++ i)
+                facet.vertex[i] = cube.vertices[face(i)];
+            facet.normal = (facet.vertex[1] - facet.vertex[0]).cross(facet.vertex[2] - facet.vertex[0]).normalized();
+            facets.emplace_back(facet);
+        }
+        std::swap(facets[5].vertex[1], facets[5].vertex[2]);
+        facets[3].vertex[0] += Vec3f(1e-4f, 1e-4f, 1e-4f);
+        stl_facet degenerate = facets.front();
+        degenerate.vertex[1] = degenerate.vertex[0];
+        facets.emplace_back(degenerate);
+        stl_facet lone;
+        lone.vertex[0] = Vec3f(100.f, 100.f, 100.f);
+        lone.vertex[1] = Vec3f(101.f, 100.f, 100.f);
+        lone.vertex[2] = Vec3f(100.f, 101.f, 100.f);
+        lone.normal    = Vec3f::UnitZ();
+        facets.emplace_back(lone);
+        WHEN( "The facets are repaired") {
+            RepairedMeshErrors errors;
+            indexed_triangle_set its = its_repair_on_import(facets, errors);
+            THEN( "The cube is restored") {
+                REQUIRE(its.indices.size() == 12);
+                REQUIRE(its.vertices.size() == 8);
+                REQUIRE(its_num_open_edges(its) == 0);
+                REQUIRE(its_volume(its) == Approx(8000.));
+            }
+            THEN( "The repairs are reported") {
+                REQUIRE(errors.degenerate_facets == 1);
+                REQUIRE(errors.facets_removed == 2);
+                REQUIRE(errors.facets_reversed == 1);
+                REQUIRE(errors.edges_fixed == 4);
+                REQUIRE(errors.backwards_edges == 0);
+            }
+        }
+        WHEN( "All the facets are flipped and their normals are zero") {
+            for (stl_facet &facet : facets) {
+                std::swap(facet.vertex[1], facet.vertex[2]);
+                facet.normal = stl_normal::Zero();
+            }
+            RepairedMeshErrors errors;
+            indexed_triangle_set its = its_repair_on_import(facets, errors);
+            THEN( "The cube is turned inside out to a positive volume") {
+                REQUIRE(its_volume(its) == Approx(8000.));
+                REQUIRE(errors.facets_reversed == 13);
+            }
+        }
+    }
+}
+
+// Repair the facets with admesh, the way TriangleMesh::ReadSTLFile() did before its_repair_on_import().
+static indexed_triangle_set repair_on_import_by_admesh(const std::vector<stl_facet> &facets, RepairedMeshErrors &errors)
+{
+    stl_file stl;
+    stl.stats.type             = inmemory;
+    stl.stats.number_of_facets = uint32_t(facets.size());
+    stl.stats.original_num_facets = int(facets.size());
+    stl_allocate(&stl);
+    bool first = true;
+    for (size_t i = 0; i < facets.size(); ++ i) {
+        stl.facet_start[i] = facets[i];
+        stl_facet_stats(&stl, facets[i], first);
+    }
+    stl.stats.size              = stl.stats.max - stl.stats.min;
+    stl.stats.bounding_diameter = stl.stats.size.norm();
+
+    stl_check_facets_exact(&stl);
+    float tolerance = stl.stats.shortest_edge;
+    float increment = stl.stats.bounding_diameter / 10000.0f;
+    for (int i = 0; i < 2 && stl.stats.connected_facets_3_edge < int(stl.stats.number_of_facets); ++ i, tolerance += increment)
+        stl_check_facets_nearby(&stl, tolerance);
+    if (stl.stats.connected_facets_3_edge < int(stl.stats.number_of_facets))
+        stl_remove_unconnected_facets(&stl);
+    stl_fix_normal_directions(&stl);
+    stl_fix_normal_values(&stl);
+    stl_calculate_volume(&stl);
+    stl_verify_neighbors(&stl);
+    if (stl.stats.number_of_facets > 0 && stl.stats.degenerate_facets > 0)
+        stl_check_facets_exact(&stl);
+
+    errors = { stl.stats.edges_fixed, stl.stats.degenerate_facets, stl.stats.facets_removed, stl.stats.facets_reversed, stl.stats.backwards_edges };
+    indexed_triangle_set its;
+    stl_generate_shared_vertices(&stl, its);
+    return its;
+}
+
+static std::vector<stl_facet> its_to_facets(const indexed_triangle_set &its)
+{
+    std::vector<stl_facet> facets;
+    for (const stl_triangle_vertex_indices &face : its.indices) {
+        stl_facet facet;
+        for (int i = 0; i < 3; ++ i)
+            facet.vertex[i] = its.vertices[face(i)];
+        facet.normal = (facet.vertex[1] - facet.vertex[0]).cross(facet.vertex[2] - facet.vertex[0]).normalized();
+        facets.emplace_back(facet);
+    }
+    return facets;
+}
+
+SCENARIO("TriangleMesh: Repair on import reports the same errors as admesh") {
+    // Each facet of an STL file stores its own copy of the vertices. Shift the copies a little, so that the facets
+    // are only connected by matching nearby edges.
+    const std::vector<stl_facet> sphere = its_to_facets(its_make_sphere(10., PI / 16.));
+    auto perturbed = [](std::vector<stl_facet> facets, int every_nth) {
+        for (size_t i = 0; i < facets.size(); i += every_nth)
+            for (int j = 0; j < 3; ++ j)
+                facets[i].vertex[j] += Vec3f(float((i + j) % 3), float((i + 2 * j) % 5), float((2 * i + j) % 7)) * 1e-4f;
+        return facets;
+    };
+    auto flipped = [](std::vector<stl_facet> facets, int every_nth, bool flip_normal) {
+        for (size_t i = 0; i < facets.size(); i += every_nth) {
+            std::swap(facets[i].vertex[1], facets[i].vertex[2]);
+            if (flip_normal)
+                facets[i].normal = - facets[i].normal;
+        }
+        return facets;
+    };
+    auto opened = [](std::vector<stl_facet> facets, int every_nth) {
+        for (size_t i = 0; i < facets.size(); i += every_nth)
+            facets.erase(facets.begin() + i);
+        return facets;
+    };
+    auto degenerated = [](std::vector<stl_facet> facets, int every_nth) {
+        for (size_t i = 0; i < facets.size(); i += every_nth)
+            facets[i].vertex[2] = facets[i].vertex[i % 2];
+        return facets;
+    };
+
+    std::vector<std::pair<std::string, std::vector<stl_facet>>> inputs {
+        { "a perturbed sphere", perturbed(sphere, 3) },
+        { "an open sphere", opened(sphere, 37) },
+        { "a sphere with flipped facets and normals", flipped(sphere, 7, true) },
+        { "a sphere with flipped facets", flipped(sphere, 7, false) },
+        { "an inside out sphere", flipped(sphere, 1, true) },
+        { "a sphere with degenerate facets", degenerated(sphere, 11) },
+        { "a perturbed, open sphere with flipped and degenerate facets", degenerated(flipped(opened(perturbed(sphere, 2), 41), 5, false), 13) },
+    };
+    // Two spheres, the second one bigger, perturbed and inside out, thus the total volume is negative.
+    std::vector<stl_facet> two_spheres = sphere;
+    for (stl_facet facet : flipped(perturbed(sphere, 2), 1, true)) {
+        for (stl_vertex &v : facet.vertex)
+            v = v * 1.5f + Vec3f(40.f, 0.f, 0.f);
+        two_spheres.emplace_back(facet);
+    }
+    inputs.emplace_back("two spheres", two_spheres);
+
+    for (const auto &[name, facets] : inputs) {
+        GIVEN("Facets of " + name) {
+            RepairedMeshErrors   errors_admesh;
+            indexed_triangle_set its_admesh = repair_on_import_by_admesh(facets, errors_admesh);
+            RepairedMeshErrors   errors;
+            indexed_triangle_set its        = its_repair_on_import(facets, errors);
+            THEN("The repaired meshes and the reported errors are the same") {
+                REQUIRE(errors.edges_fixed == errors_admesh.edges_fixed);
+                REQUIRE(errors.degenerate_facets == errors_admesh.degenerate_facets);
+                REQUIRE(errors.facets_removed == errors_admesh.facets_removed);
+                REQUIRE(errors.facets_reversed == errors_admesh.facets_reversed);
+                REQUIRE(errors.backwards_edges == errors_admesh.backwards_edges);
+                REQUIRE(its.indices.size() == its_admesh.indices.size());
+                // The welded vertices keep the coordinates of one of them, while admesh moves the first end points
+                // of the edges onto each other and leaves the second ones to stl_generate_shared_vertices().
+                // With the tolerance growing to close the holes of the removed degenerate facets, the resulting
+                // volume differs a little.
+                REQUIRE(its_volume(its) == Approx(its_volume(its_admesh)).epsilon(0.002));
+            }
+        }
+    }
+}
+
 SCENARIO( "TriangleMeshSlicer: Cut behavior.") {
     GIVEN( "A 20mm cube with one corner on the origin") {
 		auto cube = make_cube();
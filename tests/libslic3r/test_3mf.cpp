@@ -80,6 +80,37 @@ SCENARIO("Export+Import geometry to/from 3mf file cycle", "[3mf]") {
     }
 }
 
+SCENARIO("Export+Import of a large mesh to/from 3mf file cycle", "[3mf]") {
+    GIVEN("a mesh whose model file spans several compression chunks") {
+        Model src_model;
+        ModelObject *src_object = src_model.add_object("sphere", "", make_sphere(10., 2. * PI / 360.));
+        src_object->add_instance();
+
+        WHEN("model is saved+loaded to/from 3mf file") {
+            std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/sphere.3mf";
+            bool stored = store_3mf(test_file.c_str(), &src_model, nullptr, false);
+
+            Model dst_model;
+            DynamicPrintConfig dst_config;
+            bool loaded = false;
+            {
+                ConfigSubstitutionContext ctxt{ ForwardCompatibilitySubstitutionRule::Disable };
+                loaded = load_3mf(test_file.c_str(), dst_config, ctxt, &dst_model, false);
+            }
+            boost::filesystem::remove(test_file);
+
+            THEN("the mesh is read back intact") {
+                REQUIRE(stored);
+                REQUIRE(loaded);
+                const indexed_triangle_set &src_its = src_model.objects.front()->volumes.front()->mesh().its;
+                const indexed_triangle_set &dst_its = dst_model.objects.front()->volumes.front()->mesh().its;
+                REQUIRE(dst_its.vertices.size() == src_its.vertices.size());
+                REQUIRE(dst_its.indices.size() == src_its.indices.size());
+            }
+        }
+    }
+}
+
 SCENARIO("2D convex hull of sinking object", "[3mf]") {
     GIVEN("model") {
         // load a model
@@ -131,3 +162,17 @@ SCENARIO("2D convex hull of sinking object", "[3mf]") {
     }
 }
 
+
+TEST_CASE("Saving a large multi-object 3mf file", "[3mf][.Benchmarks]") {
+    Model model;
+    for (int i = 0; i < 16; ++ i) {
+        ModelObject *object = model.add_object(("sphere_" + std::to_string(i)).c_str(), "", make_sphere(10., 2. * PI / 360.));
+        object->add_instance()->set_offset(Vec3d(25. * (i % 4), 25. * (i / 4), 10.));
+    }
+
+    std::string test_file = std::string(TEST_DATA_DIR) + "/test_3mf/large_multi_object.3mf";
+    BENCHMARK("store_3mf") {
+        return store_3mf(test_file.c_str(), &model, nullptr, false);
+    };
+    boost::filesystem::remove(test_file);
+}
@@ -61,6 +61,62 @@ TEST_CASE("Building a tree over a box, ray caster and closest query", "[AABBIndi
     REQUIRE(closest_point.z() == Approx(1.));
 }
 
+template<size_t PacketSize>
+static void test_ray_packets_hit_as_single_rays(const indexed_triangle_set &its, const std::vector<Vec3d> &src, const std::vector<Vec3d> &dir)
+{
+    auto   tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+
+    std::vector<igl::Hit> hits(src.size());
+    size_t num_hits = AABBTreeIndirect::intersect_rays_first_hit<PacketSize>(its.vertices, its.indices, tree, src.data(), dir.data(), src.size(), hits.data());
+
+    size_t num_single_hits = 0;
+    for (size_t i = 0; i < src.size(); ++ i) {
+        igl::Hit hit;
+        bool     intersected = AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, src[i], dir[i], hit);
+        REQUIRE(intersected == (hits[i].id >= 0));
+        if (intersected) {
+            ++ num_single_hits;
+            REQUIRE(hits[i].id == hit.id);
+            REQUIRE(hits[i].t == hit.t);
+        }
+    }
+    REQUIRE(num_hits == num_single_hits);
+}
+
+TEST_CASE("Packets of rays hit the same as single rays", "[AABBIndirect]")
+{
+    TriangleMesh sphere = make_sphere(10., 2 * PI / 40);
+
+    // Rays aimed at the vertices and at the edge midpoints are on the boundaries of the ray-triangle tests.
+    // Beams of parallel rays are the coherent rays the packets are meant for.
+    std::vector<Vec3d> src, dir;
+    for (const stl_triangle_vertex_indices &face : sphere.its.indices)
+        for (int i = 0; i < 3; ++ i) {
+            Vec3d a = sphere.its.vertices[face(i)].cast<double>();
+            Vec3d b = sphere.its.vertices[face((i + 1) % 3)].cast<double>();
+            for (const Vec3d &target : std::array<Vec3d, 2>{ a, (a + b) / 2. }) {
+                src.emplace_back(Vec3d{ 0.1, 0.2, 30. });
+                dir.emplace_back((target - src.back()).normalized());
+            }
+        }
+    for (int b = 0; b < 100; ++ b) {
+        double phi = b * 2. * PI / 100;
+        Vec3d  p   = Vec3d{ std::cos(phi), std::sin(phi), (b % 5 - 2) * 0.3 } * 15.;
+        Vec3d  d   = (Vec3d{ 0., 0., b % 3 - 1. } - p).normalized();
+        // Some of the beams are shifted to miss the sphere partially.
+        double r   = b % 4 == 0 ? 12. : 0.5;
+        for (int k = 0; k < 7; ++ k) {
+            double a = k * 2. * PI / 7;
+            src.emplace_back(p + Vec3d{ -std::sin(phi), std::cos(phi), 0. } * r * std::cos(a) + Vec3d::UnitZ() * r * std::sin(a));
+            dir.emplace_back(d);
+        }
+    }
+
+    SECTION("packets of 4 rays") { test_ray_packets_hit_as_single_rays<4>(sphere.its, src, dir); }
+    SECTION("packets of 8 rays") { test_ray_packets_hit_as_single_rays<8>(sphere.its, src, dir); }
+    SECTION("default packets") { test_ray_packets_hit_as_single_rays<AABBTreeIndirect::ray_packet_size_default>(sphere.its, src, dir); }
+}
+
 TEST_CASE("Creating a several 2d lines, testing closest point query", "[AABBIndirect]")
 {
     std::vector<Linef> lines { };
@@ -102,6 +102,54 @@ TEST_CASE("Split two watertight meshes", "[its_split][its]") {
     debug_write_obj(res, "parts_watertight");
 }
 
+TEST_CASE("Face patches are numbered in the order of their first face", "[its_split][its]") {
+    using namespace Slic3r;
+
+    indexed_triangle_set its;
+    for (float x : { 0.f, 20.f, 40.f }) {
+        indexed_triangle_set cube = its_make_cube(10., 10., 10.);
+        its_transform(cube, identity3f().translate(Vec3f{x, 0.f, 0.f}));
+        its_merge(its, cube);
+    }
+    // Interleave the faces of the three cubes.
+    std::vector<stl_triangle_vertex_indices> interleaved;
+    for (size_t i = 0; i < 12; ++ i)
+        for (size_t cube = 0; cube < 3; ++ cube)
+            interleaved.emplace_back(its.indices[cube * 12 + i]);
+    its.indices = interleaved;
+
+    FacePatches patches = its_face_patches(its);
+    REQUIRE(patches.num_patches == 3);
+    for (size_t i = 0; i < its.indices.size(); ++ i)
+        REQUIRE(patches.face_patch[i] == int(i % 3));
+    REQUIRE(its_number_of_patches(its) == 3);
+
+    std::vector<indexed_triangle_set> res = its_split(its, patches);
+    REQUIRE(res.size() == 3);
+    for (const indexed_triangle_set &part : res) {
+        REQUIRE(part.indices.size() == 12);
+        REQUIRE(part.vertices.size() == 8);
+        REQUIRE(its_volume(part) == Approx(1000.));
+    }
+}
+
+TEST_CASE("Face patches are cached by TriangleMesh", "[its_split][its]") {
+    using namespace Slic3r;
+
+    TriangleMesh mesh(its_make_cube(10., 10., 10.));
+    REQUIRE(! mesh.is_splittable());
+    std::shared_ptr<const FacePatches> patches = mesh.face_patches();
+    mesh.translate(5.f, 0.f, 0.f);
+    REQUIRE(mesh.face_patches() == patches);
+
+    TriangleMesh mesh2(its_make_cube(10., 10., 10.));
+    mesh2.translate(20.f, 0.f, 0.f);
+    mesh.merge(mesh2);
+    REQUIRE(mesh.is_splittable());
+    REQUIRE(mesh.number_of_patches() == 2);
+    REQUIRE(mesh.split().size() == 2);
+}
+
 #include <libslic3r/QuadricEdgeCollapse.hpp>
 static float triangle_area(const Vec3f &v0, const Vec3f &v1, const Vec3f &v2)
 {
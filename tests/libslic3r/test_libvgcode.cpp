@@ -0,0 +1,84 @@
+#include <catch2/catch.hpp>
+
+#include "libvgcode/src/VertexBuffers.hpp"
+
+#include <cmath>
+
+using namespace libvgcode;
+
+// Layers of square extrusion loops joined by travels, long enough to span several chunks.
+static std::vector<PathVertex> make_vertices(size_t layers_count, size_t loops_per_layer)
+{
+    std::vector<PathVertex> vertices;
+    for (size_t layer_id = 0; layer_id < layers_count; ++layer_id) {
+        const float z = 0.2f * float(layer_id + 1);
+        for (size_t loop = 0; loop < loops_per_layer; ++loop) {
+            const float d = 1.0f + 0.01f * float(loop);
+            PathVertex v;
+            v.layer_id = uint32_t(layer_id);
+            v.height   = 0.2f;
+            v.width    = 0.45f;
+            v.role     = EGCodeExtrusionRole::ExternalPerimeter;
+            v.type     = EMoveType::Travel;
+            v.position = { -d, -d, z };
+            vertices.push_back(v);
+            v.type     = EMoveType::Extrude;
+            vertices.push_back(v);
+            for (const Vec3 &p : { Vec3{ d, -d, z }, Vec3{ d, d, z }, Vec3{ -d, d, z }, Vec3{ -d, -d, z } }) {
+                v.position = p;
+                vertices.push_back(v);
+            }
+            v.type = EMoveType::Seam;
+            vertices.push_back(v);
+        }
+    }
+    return vertices;
+}
+
+TEST_CASE("libvgcode gpu data is built without an OpenGL context", "[libvgcode]") {
+    const std::vector<PathVertex> vertices = make_vertices(20, 300);
+    REQUIRE(vertices.size() > 2 * VERTICES_CHUNK_SIZE);
+
+    BitSet<> valid_lines;
+    extract_valid_lines(vertices, valid_lines);
+
+    SECTION("valid lines join distinct points of moves of the same type") {
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const bool valid = i + 1 < vertices.size() && vertices[i + 1].position != vertices[i].position &&
+                vertices[i + 1].type == vertices[i].type && vertices[i].type != EMoveType::Seam;
+            REQUIRE(valid_lines[i] == valid);
+        }
+    }
+
+    SECTION("extrusions are pushed down by half of their height") {
+        std::vector<Vec3> positions(vertices.size());
+        extract_positions(vertices, positions.data());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const float dz = vertices[i].type == EMoveType::Extrude ? 0.5f * vertices[i].height : 0.0f;
+            REQUIRE(positions[i][0] == vertices[i].position[0]);
+            REQUIRE(positions[i][1] == vertices[i].position[1]);
+            REQUIRE(positions[i][2] == Approx(vertices[i].position[2] - dz));
+        }
+    }
+
+    SECTION("travels get the travels radius and loop corners turn by a right angle") {
+        std::vector<Vec3> heights_widths_angles(vertices.size());
+        extract_heights_widths_angles(vertices, valid_lines, 0.1f, 0.2f, heights_widths_angles.data());
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            const PathVertex &v = vertices[i];
+            if (v.type == EMoveType::Travel) {
+                REQUIRE(heights_widths_angles[i][0] == 0.1f);
+                REQUIRE(heights_widths_angles[i][1] == 0.1f);
+            } else {
+                REQUIRE(heights_widths_angles[i][0] == v.height);
+                REQUIRE(heights_widths_angles[i][1] == v.width);
+            }
+            // the 2nd, 3rd and 4th vertex of each extrusion loop are corners
+            const size_t loop_vertex = i % 7;
+            if (loop_vertex >= 2 && loop_vertex <= 4)
+                REQUIRE(std::abs(heights_widths_angles[i][2]) == Approx(0.5 * M_PI));
+            else
+                REQUIRE(heights_widths_angles[i][2] == 0.0f);
+        }
+    }
+}
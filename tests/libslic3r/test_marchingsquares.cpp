@@ -372,3 +372,24 @@ static void recreate_object_from_rasters(const std::string &objname, float lh) {
 TEST_CASE("Recreate object from rasters", "[SL1Import]") {
     recreate_object_from_rasters("frog_legs.obj", 0.05f);
 }
+
+TEST_CASE("Mesh from slices is closed and has no duplicate vertices", "[SL1Import]") {
+    const ExPolygon square{ Polygon::new_scale({ { 0., 0. }, { 20., 0. }, { 20., 20. }, { 0., 20. } }) };
+    const ExPolygon small{ Polygon::new_scale({ { 5., 5. }, { 15., 5. }, { 15., 15. }, { 5., 15. } }) };
+    Polygon         hole = small.contour;
+    hole.reverse();
+    const ExPolygon holed{ square.contour, hole };
+
+    // A box with a square cavity and a smaller box on top of it.
+    const std::vector<ExPolygons> slices = { { square }, { square }, { holed }, { holed }, { holed }, { square }, { small }, { small } };
+    const double lh = 0.1;
+    indexed_triangle_set its = slices_to_mesh(slices, 0., lh, lh);
+
+    REQUIRE(its_num_open_edges(its) == 0);
+    indexed_triangle_set merged = its;
+    REQUIRE(its_merge_vertices(merged) == 0);
+    double volume = 0.;
+    for (const ExPolygons &slice : slices)
+        volume += area(slice) * SCALING_FACTOR * SCALING_FACTOR * lh;
+    REQUIRE(its_volume(its) == Approx(volume));
+}
@@ -304,3 +304,72 @@ SCENARIO("Placeholder parser variables", "[PlaceholderParser]") {
     }
     SECTION("if else completely empty") { REQUIRE(parser.process("{if false then elsif false then else endif}", 0, nullptr, nullptr, nullptr) == ""); }
 }
+
+SCENARIO("Placeholder parser compiled templates", "[PlaceholderParser]") {
+    PlaceholderParser 	parser;
+    auto 				config = DynamicPrintConfig::full_print_config();
+    config.set_deserialize_strict({
+        { "printer_notes", "  PRINTER_VENDOR_PRUSA3D  PRINTER_MODEL_MK2  " },
+        { "temperature", "357;359;363;378" }
+    });
+    parser.apply_config(config);
+    parser.set("foo", 0);
+    parser.set("bar", 2);
+
+    SECTION("text only") { REQUIRE(parser.process("G92 E0 } ; comment\n") == "G92 E0 } ; comment\n"); }
+    SECTION("empty template") { REQUIRE(parser.process("") == ""); }
+    SECTION("text and code blocks") { REQUIRE(parser.process("M104 S[temperature_[foo]] T{bar}\nG1 Z{bar * 2}[bar]\n") == "M104 S357 T2\nG1 Z42\n"); }
+    SECTION("if / elsif / else chain") {
+        std::string script = "{if bar == 0}zero{elsif bar == 1}one{elsif bar == 2}two [bar]{else}many{endif};";
+        REQUIRE(parser.process(script) == "two 2;");
+        DynamicConfig config_override;
+        config_override.set_key_value("bar", new ConfigOptionInt(5));
+        REQUIRE(parser.process(script, 0, &config_override) == "many;");
+    }
+    SECTION("nested if with code and regular expressions inside") {
+        std::string script =
+            "{if printer_notes=~/.*MK2.*/}A{if foo == 1}B{else}{local x = \"}{\"}{x}{endif}{elsif bar}C{endif}"
+            "{if bar == 2 then \"D\" else \"E\" endif}";
+        REQUIRE(parser.process(script) == "A}{D");
+    }
+    SECTION("variables persist over the branches") { REQUIRE(parser.process("{local x = 1}{if x == 1}{x = 2}{endif}{x}") == "2"); }
+    SECTION("syntax error in a branch not taken") { REQUIRE_THROWS_AS(parser.process("{if true}ok{else}{1 +}{endif}"), Slic3r::PlaceholderParserError); }
+    SECTION("runtime error is reported at its line in the template") {
+        try {
+            parser.process("G1\n{if true}\n{unknown_variable}\n{endif}");
+            FAIL("Exception expected");
+        } catch (const Slic3r::PlaceholderParserError &ex) {
+            REQUIRE(std::string(ex.what()).find("Parsing error at line 3") != std::string::npos);
+        }
+    }
+    SECTION("compiled template is reused") {
+        auto templ = PlaceholderParser::compile("{if foo == 0}[temperature_[foo]]{else}0{endif}");
+        REQUIRE(parser.process(*templ, 0, nullptr, nullptr, nullptr) == "357");
+        parser.set("foo", 1);
+        REQUIRE(parser.process(*templ, 0, nullptr, nullptr, nullptr) == "0");
+    }
+}
+
+TEST_CASE("Placeholder parser per layer macro benchmark", "[PlaceholderParser][.Benchmarks]") {
+    PlaceholderParser parser;
+    parser.apply_config(DynamicPrintConfig::full_print_config());
+    parser.set("layer_num", 10);
+    parser.set("layer_z", 2.2);
+
+    std::string layer_gcode = ";LAYER_CHANGE\n;Z:{layer_z}\n;HEIGHT:[layer_height]\n";
+    for (int i = 0; i < 20; ++ i)
+        layer_gcode += (i == 0 ? "{if layer_num == " : "{elsif layer_num == ") + std::to_string(i) + "}M106 S" + std::to_string(i * 10) +
+            "\n{if layer_z > 1 and printer_notes =~ /.*PRINTER_MODEL_MK3.*/}M220 S90\n{endif}";
+    layer_gcode += "{else}M106 S255\n{endif}G92 E0\n";
+
+    // Not split, thus the whole template is parsed on every call, as process() did before templates were compiled.
+    auto whole = PlaceholderParser::compile(layer_gcode, false);
+    REQUIRE(parser.process(*whole, 0, nullptr, nullptr, nullptr) == parser.process(layer_gcode));
+
+    BENCHMARK("process() with a cached template") {
+        return parser.process(layer_gcode);
+    };
+    BENCHMARK("process() parsing the whole template on every call") {
+        return parser.process(*whole, 0, nullptr, nullptr, nullptr);
+    };
+}
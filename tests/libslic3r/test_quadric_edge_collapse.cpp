@@ -302,3 +302,58 @@ TEST_CASE("Simplified cube should not be empty.", "[its]")
     its_quadric_edge_collapse(its, wanted_count, &max_error);
     CHECK(!its.indices.empty());
 }
+
+TEST_CASE("Simplify frog_legs.obj to 5% by partitioned Quadric edge collapse", "[its][quadric_edge_collapse]")
+{
+    TriangleMesh mesh            = load_model("frog_legs.obj");
+    REQUIRE_FALSE(mesh.empty());
+    double       original_volume = its_volume(mesh.its);
+    uint32_t     wanted_count    = mesh.its.indices.size() * 0.05;
+    // Small clusters to exercise the partitioning on a small mesh.
+    size_t       cluster_size    = mesh.its.indices.size() / 8;
+
+    indexed_triangle_set its_serial = mesh.its; // copy
+    its_quadric_edge_collapse(its_serial, wanted_count);
+    indexed_triangle_set its = mesh.its; // copy
+    float max_error = std::numeric_limits<float>::max();
+    its_quadric_edge_collapse_partitioned(its, wanted_count, &max_error, nullptr, nullptr, cluster_size);
+
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(!Private::exist_triangle_with_twice_vertices(its.indices));
+    CHECK(its_num_open_edges(its) <= its_num_open_edges(mesh.its));
+    double volume = its_volume(its);
+    CHECK(fabs(original_volume - volume) < 33.);
+    Private::is_better_similarity(mesh.its, its, Private::frog_leg_5);
+
+    // Quality close to the one of the serial simplification.
+    Private::Similarity serial      = Private::get_similarity(mesh.its, its_serial);
+    Private::Similarity partitioned = Private::get_similarity(mesh.its, its);
+    CHECK(partitioned.average_distance < 1.5f * serial.average_distance);
+}
+
+TEST_CASE("Partitioned Quadric edge collapse of a large mesh", "[its][quadric_edge_collapse][.Benchmarks]")
+{
+    indexed_triangle_set sphere = its_make_sphere(10., PI / 350.);
+    REQUIRE(sphere.indices.size() > 400000);
+    uint32_t wanted_count = sphere.indices.size() / 20;
+
+    BENCHMARK("serial") {
+        indexed_triangle_set its = sphere; // copy
+        its_quadric_edge_collapse(its, wanted_count);
+        return its;
+    };
+    BENCHMARK("partitioned") {
+        indexed_triangle_set its = sphere; // copy
+        its_quadric_edge_collapse_partitioned(its, wanted_count, nullptr, nullptr, nullptr, sphere.indices.size() / 16);
+        return its;
+    };
+
+    indexed_triangle_set its_serial = sphere; // copy
+    its_quadric_edge_collapse(its_serial, wanted_count);
+    indexed_triangle_set its = sphere; // copy
+    its_quadric_edge_collapse_partitioned(its, wanted_count, nullptr, nullptr, nullptr, sphere.indices.size() / 16);
+    CHECK(its.indices.size() <= wanted_count);
+    CHECK(its_num_open_edges(its) == 0);
+    CHECK(its_volume(its) == Approx(its_volume(sphere)).epsilon(0.01));
+    CHECK(its_volume(its) == Approx(its_volume(its_serial)).epsilon(0.01));
+}
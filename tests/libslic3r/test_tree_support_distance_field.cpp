@@ -0,0 +1,41 @@
+#include <catch2/catch.hpp>
+
+#include <libslic3r/libslic3r.h>
+#include <libslic3r/ClipperUtils.hpp>
+#include <libslic3r/Support/TreeSupportDistanceField.hpp>
+
+using namespace Slic3r;
+using namespace Slic3r::FFFTreeSupport;
+
+SCENARIO("Tree support distance field", "[TreeSupport]") {
+    GIVEN("a square with a square hole") {
+        Polygon  contour{ { 0, 0 }, { scaled<coord_t>(10.), 0 }, { scaled<coord_t>(10.), scaled<coord_t>(10.) }, { 0, scaled<coord_t>(10.) } };
+        Polygon  hole{ { scaled<coord_t>(3.), scaled<coord_t>(3.) }, { scaled<coord_t>(3.), scaled<coord_t>(7.) }, { scaled<coord_t>(7.), scaled<coord_t>(7.) }, { scaled<coord_t>(7.), scaled<coord_t>(3.) } };
+        Polygons polygons{ contour, hole };
+        DistanceField field(get_extents(polygons).inflated(scaled<coord_t>(5.)), scaled<coord_t>(0.1), 4000000);
+        field.distance_to(polygons);
+        auto area_mm2 = [](const Polygons &polygons) { return area(polygons) * SCALING_FACTOR * SCALING_FACTOR; };
+        // Area of the contour is slightly lower than the area of the offset polygons, as the field is sampled at the cell centers.
+        const double tolerance = 0.1 * (area_mm2(offset(polygons, scaled<float>(2.5))) - area_mm2(polygons));
+        THEN("thresholding at zero returns the polygons") {
+            Polygons thresholded = field.contour(0.f);
+            REQUIRE(thresholded.size() == 2);
+            REQUIRE(area_mm2(thresholded) == Approx(area_mm2(polygons)).margin(tolerance));
+        }
+        THEN("thresholding at a distance returns the polygons offset by that distance") {
+            for (double distance : { 1., 2.5 })
+                REQUIRE(area_mm2(field.contour(scaled<float>(distance))) == Approx(area_mm2(offset(polygons, scaled<float>(distance), ClipperLib::jtRound))).margin(tolerance));
+            // The hole closes up at 2 mm.
+            REQUIRE(field.contour(scaled<float>(2.5)).size() == 1);
+        }
+        WHEN("the field is dilated") {
+            DistanceField dilated = field;
+            dilated.dilate(scaled<coord_t>(1.));
+            THEN("thresholded region is shrunk by at most the dilation radius") {
+                const double area_dilated = area_mm2(dilated.contour(scaled<float>(2.)));
+                REQUIRE(area_dilated >= area_mm2(field.contour(scaled<float>(1.))));
+                REQUIRE(area_dilated < area_mm2(field.contour(scaled<float>(2.))));
+            }
+        }
+    }
+}
@@ -0,0 +1,69 @@
+#include <catch2/catch.hpp>
+
+#include "sla_test_utils.hpp"
+
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
+#include <libslic3r/SLA/Hollowing.hpp>
+
+using namespace Slic3r;
+
+namespace {
+
+// 20 mm cube with a spherical negative volume in its center, like an FFF
+// object with a negative volume modifier.
+std::vector<indexed_triangle_set> cube_with_negative_sphere()
+{
+    indexed_triangle_set sphere = its_make_sphere(5., PI / 32.);
+    its_translate(sphere, Vec3f{ 10.f, 10.f, 10.f });
+
+    return { its_make_cube(20., 20., 20.), sphere };
+}
+
+// Model with drain holes drilled from its bottom, like the SLA drilling step.
+std::vector<indexed_triangle_set> model_with_drain_holes(const char *fname)
+{
+    TriangleMesh mesh = load_model(fname);
+    auto         bb   = mesh.bounding_box();
+
+    std::vector<indexed_triangle_set> out{ mesh.its };
+    for (double x = bb.min.x() + 5.; x < bb.max.x() - 5.; x += 10.) {
+        sla::DrainHole hole{ Vec3f(float(x), float(bb.center().y()), float(bb.min.z()) - sla::HoleStickOutLength),
+                             Vec3f::UnitZ(), 2.f, 10.f };
+        out.emplace_back(hole.to_mesh());
+    }
+
+    return out;
+}
+
+// The first mesh is the positive part, the other ones are subtracted from it.
+std::vector<csg::CSGPart> to_csgmesh(const std::vector<indexed_triangle_set> &meshes)
+{
+    std::vector<csg::CSGPart> out;
+    for (const indexed_triangle_set &its : meshes)
+        out.emplace_back(&its, out.empty() ? csg::CSGType::Union : csg::CSGType::Difference);
+
+    return out;
+}
+
+} // namespace
+
+TEST_CASE("CSG mesh boolean backends benchmarks", "[MeshBoolean][.Benchmarks]") {
+    const std::pair<std::string, std::vector<indexed_triangle_set>> cases[] = {
+        { "negative volume", cube_with_negative_sphere() },
+        { "drain holes", model_with_drain_holes("extruder_idler.obj") },
+    };
+
+    for (const auto &[name, meshes] : cases) {
+        std::vector<csg::CSGPart> csgmesh = to_csgmesh(meshes);
+
+        BENCHMARK("CGAL booleans, " + name) {
+            return csg::perform_csgmesh_booleans(range(csgmesh), csg::BooleanBackend::CGAL).indices.size();
+        };
+        for (float voxel_scale : { 2.f, 5.f, 10.f }) {
+            auto voxparams = csg::VoxelizeParams{}.voxel_scale(voxel_scale);
+            BENCHMARK("Voxel booleans with voxel scale " + std::to_string(int(voxel_scale)) + ", " + name) {
+                return csg::perform_csgmesh_booleans(range(csgmesh), csg::BooleanBackend::Voxel, voxparams).indices.size();
+            };
+        }
+    }
+}
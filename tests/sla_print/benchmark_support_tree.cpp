@@ -0,0 +1,49 @@
+#include <catch2/catch.hpp>
+
+#include "sla_test_utils.hpp"
+
+#include <libslic3r/TriangleMeshSlicer.hpp>
+#include <libslic3r/SLA/DefaultSupportTree.hpp>
+
+namespace {
+
+const char *const SUPPORT_TEST_MODELS[] = {
+    "cube_with_concave_hole_enlarged_standing.obj",
+    "A_upsidedown.obj",
+    "extruder_idler.obj"
+};
+
+} // namespace
+
+TEST_CASE("Default support tree benchmarks", "[SLASupportGeneration][.Benchmarks]") {
+    sla::SupportTreeConfig supportcfg;
+    supportcfg.object_elevation_mm = 10.;
+
+    for (const char *fname : SUPPORT_TEST_MODELS) {
+        TriangleMesh mesh = load_model(fname);
+        REQUIRE_FALSE(mesh.empty());
+
+        auto   bb      = mesh.bounding_box();
+        double gnd     = bb.min.z() - supportcfg.object_elevation_mm;
+        auto   layer_h = 0.05f;
+
+        std::vector<float> slicegrid = grid(float(gnd), float(bb.max.z()), layer_h);
+        std::vector<ExPolygons> slices = slice_mesh_ex(mesh.its, slicegrid, CLOSING_RADIUS);
+
+        sla::SupportableMesh sm{mesh.its, {}, supportcfg};
+
+        sla::SupportPointGenerator::Config autogencfg;
+        autogencfg.head_diameter = float(2 * supportcfg.head_front_radius_mm);
+        sla::SupportPointGenerator point_gen{sm.emesh, autogencfg, [] {}, [](int) {}};
+
+        point_gen.seed(0);
+        point_gen.execute(slices, slicegrid);
+        sm.pts = point_gen.output();
+
+        BENCHMARK(std::string("Default support tree ") + fname) {
+            sla::SupportTreeBuilder builder;
+            sla::DefaultSupportTree::execute(builder, sm);
+            return builder.pillarcount();
+        };
+    }
+}
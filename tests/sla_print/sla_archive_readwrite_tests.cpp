@@ -6,9 +6,14 @@
 #include "libslic3r/Format/SLAArchiveFormatRegistry.hpp"
 #include "libslic3r/Format/SLAArchiveWriter.hpp"
 #include "libslic3r/Format/SLAArchiveReader.hpp"
+#include "libslic3r/miniz_extension.hpp"
 
+#include <boost/algorithm/string/predicate.hpp>
 #include <boost/filesystem.hpp>
 
+#include <algorithm>
+#include <map>
+
 using namespace Slic3r;
 
 TEST_CASE("Archive export test", "[sla_archives]") {
@@ -68,3 +73,101 @@ TEST_CASE("Archive export test", "[sla_archives]") {
         }
     }
 }
+
+// Layer images of an archive, by their names in the zip.
+static std::map<std::string, std::string> read_png_entries(const std::string &fname)
+{
+    std::map<std::string, std::string> out;
+    mz_zip_archive zip;
+    mz_zip_zero_struct(&zip);
+    if (! open_zip_reader(&zip, fname))
+        return out;
+    for (mz_uint i = 0; i < mz_zip_reader_get_num_files(&zip); ++ i) {
+        mz_zip_archive_file_stat stat;
+        if (! mz_zip_reader_file_stat(&zip, i, &stat) || ! boost::iends_with(std::string(stat.m_filename), ".png"))
+            continue;
+        size_t size = 0;
+        if (void *data = mz_zip_reader_extract_to_heap(&zip, i, &size, 0); data) {
+            out[stat.m_filename] = std::string(static_cast<const char*>(data), size);
+            mz_free(data);
+        }
+    }
+    close_zip_reader(&zip);
+    return out;
+}
+
+TEST_CASE("Streaming rasterization exports the same SL1 archive as the buffered one", "[sla_archives]") {
+    auto m = Model::read_from_file(TEST_DATA_DIR PATH_SEPARATOR + std::string("20mm_cube") + ".obj", nullptr);
+
+    SLAFullPrintConfig fullcfg;
+    fullcfg.printer_technology.setInt(ptSLA);
+    fullcfg.set("sla_archive_format", "SL1");
+    fullcfg.set("supports_enable", false);
+    fullcfg.set("pad_enable", false);
+    DynamicPrintConfig cfg;
+    cfg.apply(fullcfg);
+
+    SLAPrint print;
+    print.set_status_callback([](const PrintBase::SlicingStatus&) {});
+    print.apply(m, cfg);
+
+    auto export_archive = [&print](bool streaming, const std::string &fname) {
+        print.set_streaming_rasterization(streaming);
+        print.process();
+        print.export_print(fname, "20mm_cube");
+        return read_png_entries(fname);
+    };
+    const std::map<std::string, std::string> buffered  = export_archive(false, "output_buffered.sl1");
+    const std::map<std::string, std::string> streaming = export_archive(true, "output_streaming.sl1");
+
+    REQUIRE(buffered.size() == print.print_layers().size());
+    REQUIRE(streaming.size() == buffered.size());
+    for (auto it_b = buffered.begin(), it_s = streaming.begin(); it_b != buffered.end(); ++ it_b, ++ it_s) {
+        INFO("Layer image " << it_b->first);
+        REQUIRE(it_s->first == it_b->first);
+        REQUIRE(it_s->second == it_b->second);
+    }
+
+    boost::filesystem::remove("output_buffered.sl1");
+    boost::filesystem::remove("output_streaming.sl1");
+}
+
+TEST_CASE("Streaming rasterization reports progress and can be canceled", "[sla_archives]") {
+    auto m = Model::read_from_file(TEST_DATA_DIR PATH_SEPARATOR + std::string("20mm_cube") + ".obj", nullptr);
+
+    SLAFullPrintConfig fullcfg;
+    fullcfg.printer_technology.setInt(ptSLA);
+    fullcfg.set("sla_archive_format", "SL1");
+    fullcfg.set("supports_enable", false);
+    fullcfg.set("pad_enable", false);
+    DynamicPrintConfig cfg;
+    cfg.apply(fullcfg);
+
+    SLAPrint print;
+    print.set_status_callback([](const PrintBase::SlicingStatus&) {});
+    print.apply(m, cfg);
+    print.set_streaming_rasterization(true);
+    print.process();
+
+    SECTION("the export reports the progress of the rasterization") {
+        std::vector<int> percents;
+        print.set_status_callback([&percents](const PrintBase::SlicingStatus &status) { percents.emplace_back(status.percent); });
+        print.export_print("output_streaming.sl1", "20mm_cube");
+        REQUIRE(percents.size() > 1);
+        REQUIRE(std::is_sorted(percents.begin(), percents.end()));
+        REQUIRE(percents.back() == 100);
+    }
+
+    SECTION("a canceled export throws") {
+        print.cancel();
+        REQUIRE_THROWS_AS(print.export_print("output_streaming.sl1", "20mm_cube"), CanceledException);
+        print.restart();
+    }
+
+    SECTION("the export is refused once the rasterization was invalidated") {
+        print.set_streaming_rasterization(false);
+        REQUIRE_THROWS_AS(print.export_print("output_streaming.sl1", "20mm_cube"), ExportError);
+    }
+
+    boost::filesystem::remove("output_streaming.sl1");
+}
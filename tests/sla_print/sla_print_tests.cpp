@@ -2,12 +2,16 @@
 #include <random>
 #include <numeric>
 #include <cstdint>
+#include <cstring>
 
 #include "sla_test_utils.hpp"
 
 #include <libslic3r/TriangleMeshSlicer.hpp>
 #include <libslic3r/SLA/SupportTreeMesher.hpp>
 #include <libslic3r/BranchingTree/PointCloud.hpp>
+#include <libslic3r/SLA/RLERaster.hpp>
+#include <libslic3r/SLA/RasterToPolygons.hpp>
+#include <libslic3r/CSGMesh/PerformCSGMeshBooleans.hpp>
 
 namespace {
 
@@ -252,6 +256,49 @@ TEST_CASE("RasterizedPolygonAreaShouldMatch", "[SLARasterOutput]") {
 }
 
 
+TEST_CASE("RLE raster should match the AGG raster", "[SLARasterOutput]") {
+    double disp_w = 120., disp_h = 68.;
+    sla::Resolution res{2560, 1440};
+    sla::PixelDim pixdim{disp_w / res.width_px, disp_h / res.height_px};
+
+    auto bb = BoundingBox({0, 0}, {scaled(disp_w), scaled(disp_h)});
+
+    sla::RasterBase::Trafo trafo{sla::RasterBase::roPortrait, sla::RasterBase::MirrorX};
+    trafo.center_x = bb.center().x();
+    trafo.center_y = bb.center().y();
+
+    sla::RasterGrayscaleAAGammaPower  agg_raster(res, pixdim, trafo, 1.);
+    sla::RasterGrayscaleRLEGammaPower rle_raster(res, pixdim, trafo, 1.);
+
+    // Overlapping polygons to exercise the merging of runs
+    for (double v : {10., 25., 40.}) {
+        ExPolygon poly = square_with_hole(v);
+        poly.rotate(v);
+        poly.translate(scaled(v / 4.), scaled(-v / 5.));
+        agg_raster.draw(poly);
+        rle_raster.draw(poly);
+    }
+
+    size_t diff = 0;
+    for (size_t r = 0; r < res.height_px; ++r)
+        for (size_t c = 0; c < res.width_px; ++c)
+            diff += agg_raster.read_pixel(c, r) != rle_raster.read_pixel(c, r);
+
+    REQUIRE(diff == 0);
+
+    sla::EncodedRaster agg_png = agg_raster.encode(sla::PNGRasterEncoder{});
+    sla::EncodedRaster rle_png = rle_raster.encode(sla::PNGRasterEncoder{});
+
+    REQUIRE(agg_png.size() == rle_png.size());
+    REQUIRE(std::memcmp(agg_png.data(), rle_png.data(), agg_png.size()) == 0);
+
+    ExPolygons agg_polys = sla::raster_to_polygons(agg_raster);
+    ExPolygons rle_polys = sla::raster_to_polygons(rle_raster);
+
+    REQUIRE(agg_polys.size() == rle_polys.size());
+    REQUIRE(area(agg_polys) == Approx(area(rle_polys)));
+}
+
 TEST_CASE("halfcone test", "[halfcone]") {
     sla::DiffBridge br{Vec3d{1., 1., 1.}, Vec3d{10., 10., 10.}, 0.25, 0.5};
 
@@ -271,3 +318,96 @@ TEST_CASE("Test concurrency")
 
     REQUIRE(s == Approx(ref));
 }
+
+// Interior subtracted from the object by hollowing, empty if the object is not hollowed.
+static indexed_triangle_set hollowing_interior(const SLAPrintObject &po)
+{
+    for (const csg::CSGPart &part : po.get_parts_to_slice(slaposHollowing))
+        if (csg::get_operation(part) == csg::CSGType::Difference)
+            return *csg::get_mesh(part);
+    return {};
+}
+
+TEST_CASE("Voxelized object is reused when the hollowing parameters change", "[Hollowing]") {
+    Model model = Model::read_from_file(TEST_DATA_DIR PATH_SEPARATOR + std::string("20mm_cube.obj"), nullptr);
+
+    SLAFullPrintConfig fullcfg;
+    fullcfg.printer_technology.setInt(ptSLA);
+    fullcfg.set("supports_enable", false);
+    fullcfg.set("pad_enable", false);
+    fullcfg.set("hollowing_enable", true);
+    fullcfg.set("hollowing_min_thickness", 3.);
+    DynamicPrintConfig cfg;
+    cfg.apply(fullcfg);
+
+    auto process = [&model, &cfg](SLAPrint &print) -> const SLAPrintObject& {
+        print.set_status_callback([](const PrintBase::SlicingStatus&) {});
+        print.apply(model, cfg);
+        print.process();
+        REQUIRE(print.objects().size() == 1);
+        REQUIRE(print.objects().front()->is_step_done(slaposHollowing));
+        return *print.objects().front();
+    };
+    // The interior must not depend on the parameters the object was hollowed with before.
+    auto require_same_as_fresh = [&process](const SLAPrintObject &po) {
+        SLAPrint             fresh;
+        indexed_triangle_set expected = hollowing_interior(process(fresh));
+        indexed_triangle_set interior = hollowing_interior(po);
+        REQUIRE_FALSE(interior.empty());
+        REQUIRE(interior.indices.size() == expected.indices.size());
+        REQUIRE(its_volume(interior) == Approx(its_volume(expected)));
+    };
+
+    SLAPrint         print;
+    const VoxelGrid *grid = process(print).hollowing_grid();
+    REQUIRE(grid != nullptr);
+
+    SECTION("Other closing distance reuses the grid") {
+        cfg.set_key_value("hollowing_closing_distance", new ConfigOptionFloat(1.));
+        const SLAPrintObject &po = process(print);
+        REQUIRE(po.hollowing_grid() == grid);
+        require_same_as_fresh(po);
+    }
+
+    SECTION("Thicker wall voxelizes again, the thinner wall reuses the first grid") {
+        cfg.set_key_value("hollowing_min_thickness", new ConfigOptionFloat(4.));
+        const SLAPrintObject &po = process(print);
+        REQUIRE(po.hollowing_grid() != nullptr);
+        REQUIRE(po.hollowing_grid() != grid);
+        require_same_as_fresh(po);
+
+        cfg.set_key_value("hollowing_min_thickness", new ConfigOptionFloat(3.));
+        REQUIRE(process(print).hollowing_grid() == grid);
+        require_same_as_fresh(process(print));
+    }
+
+    SECTION("Lower quality voxelizes again with a coarser grid") {
+        cfg.set_key_value("hollowing_quality", new ConfigOptionFloat(0.2));
+        const SLAPrintObject &po = process(print);
+        REQUIRE(po.hollowing_grid() != nullptr);
+        REQUIRE(po.hollowing_grid() != grid);
+        REQUIRE(get_voxel_scale(*po.hollowing_grid()) < get_voxel_scale(*grid));
+        require_same_as_fresh(po);
+    }
+}
+
+TEST_CASE("Voxel booleans approximate the CGAL ones", "[MeshBoolean]") {
+    // 20 mm cube with a spherical negative volume in its center.
+    indexed_triangle_set cube   = its_make_cube(20., 20., 20.);
+    indexed_triangle_set sphere = its_make_sphere(5., PI / 32.);
+    its_translate(sphere, Vec3f{ 10.f, 10.f, 10.f });
+    std::vector<csg::CSGPart> csgmesh;
+    csgmesh.emplace_back(&cube, csg::CSGType::Union);
+    csgmesh.emplace_back(&sphere, csg::CSGType::Difference);
+
+    REQUIRE(csg::check_csgmesh_booleans(range(csgmesh)) == range(csgmesh).end());
+    indexed_triangle_set cgal  = csg::perform_csgmesh_booleans(range(csgmesh), csg::BooleanBackend::CGAL);
+    indexed_triangle_set voxel = csg::perform_csgmesh_booleans(range(csgmesh), csg::BooleanBackend::Voxel,
+                                                               csg::VoxelizeParams{}.voxel_scale(4.f));
+    REQUIRE_FALSE(cgal.empty());
+    REQUIRE_FALSE(voxel.empty());
+
+    REQUIRE(its_volume(cgal) == Approx(its_volume(cube) - its_volume(sphere)).epsilon(0.001));
+    REQUIRE(its_volume(voxel) == Approx(its_volume(cgal)).epsilon(0.01));
+    REQUIRE(its_num_open_edges(voxel) == 0);
+}
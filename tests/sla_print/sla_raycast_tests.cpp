@@ -2,7 +2,11 @@
 #include <test_utils.hpp>
 
 #include <libslic3r/AABBMesh.hpp>
+#include <libslic3r/AABBTreeIndirect.hpp>
 #include <libslic3r/SLA/Hollowing.hpp>
+#include <libslic3r/SLA/SupportTreeUtils.hpp>
+#include <libslic3r/Execution/ExecutionSeq.hpp>
+#include <libslic3r/Execution/ExecutionTBB.hpp>
 
 #include "sla_test_utils.hpp"
 
@@ -39,6 +43,98 @@ TEST_CASE("Raycaster - find intersections of a line and cylinder")
     REQUIRE(std::abs(out[1].first - std::sqrt(72.f)) < 0.001f);
 }
 
+TEST_CASE("Raycaster - batch of rays should hit the same as single rays", "[sla_raycast]")
+{
+    TriangleMesh cube = load_model("20mm_cube.obj");
+    AABBMesh     emesh{cube};
+    Vec3d        center = cube.bounding_box().center();
+
+    // Bundles of parallel rays like the ones of a support beam, plus some
+    // rays pointing along the axes, missing the cube or starting on its faces.
+    std::vector<Vec3d> src, dir;
+    for (int b = 0; b < 13; ++b) {
+        double phi = b * 2. * PI / 13;
+        Vec3d  d   = Vec3d{std::cos(phi), std::sin(phi), b % 3 - 1.}.normalized();
+        for (int k = 0; k < 8; ++k) {
+            double a = k * 2. * PI / 8;
+            src.emplace_back(center + Vec3d{std::cos(a), std::sin(a), 0.} * 0.5);
+            dir.emplace_back(d);
+        }
+    }
+    src.emplace_back(center);  dir.emplace_back(Vec3d::UnitX());
+    src.emplace_back(center);  dir.emplace_back(-Vec3d::UnitZ());
+    src.emplace_back(center + Vec3d{0., 0., 20.}); dir.emplace_back(Vec3d::UnitZ());
+    src.emplace_back(center + Vec3d{10., 0., 0.}); dir.emplace_back(-Vec3d::UnitX());
+
+    std::vector<AABBMesh::hit_result> hits(src.size());
+    emesh.query_ray_hit(src.data(), dir.data(), src.size(), hits.data());
+
+    for (size_t i = 0; i < src.size(); ++i) {
+        AABBMesh::hit_result hit = emesh.query_ray_hit(src[i], dir[i]);
+        REQUIRE(hits[i].is_hit() == hit.is_hit());
+        REQUIRE(hits[i].face() == hit.face());
+        if (hit.is_hit())
+            REQUIRE(hits[i].distance() == hit.distance());
+    }
+}
+
+TEST_CASE("Raycaster - batch of rays benchmark", "[sla_raycast][.Benchmarks]")
+{
+    // About 40k triangles.
+    TriangleMesh sphere = make_sphere(10., 2 * PI / 200);
+    AABBMesh     emesh{sphere};
+
+    // Beams of coherent rays around the sphere, like the ones of the support tree collision checks.
+    std::vector<sla::Beam> beams;
+    std::vector<Vec3d>     src, dir;
+    for (int b = 0; b < 25000; ++b) {
+        double phi   = b * 2. * PI / 25000;
+        double theta = b * 0.37;
+        Vec3d  p     = Vec3d{std::cos(phi) * std::cos(theta), std::sin(phi) * std::cos(theta), std::sin(theta)} * 15.;
+        Vec3d  d     = (Vec3d{std::sin(theta), std::cos(phi), 0.3} - p).normalized();
+        beams.emplace_back(p, d, 0.5, 0.5);
+        for (int k = 0; k < 8; ++k) {
+            double a = k * 2. * PI / 8;
+            src.emplace_back(p + Vec3d{std::cos(a), std::sin(a), 0.} * 0.5);
+            dir.emplace_back(d);
+        }
+    }
+
+    const indexed_triangle_set &its  = sphere.its;
+    auto                        tree = AABBTreeIndirect::build_aabb_tree_over_indexed_triangle_set(its.vertices, its.indices);
+    std::vector<igl::Hit>       hits(src.size());
+
+    BENCHMARK("single rays") {
+        for (size_t i = 0; i < src.size(); ++i)
+            AABBTreeIndirect::intersect_ray_first_hit(its.vertices, its.indices, tree, src[i], dir[i], hits[i]);
+        return hits.back().t;
+    };
+    BENCHMARK("packets of 4 rays") {
+        return AABBTreeIndirect::intersect_rays_first_hit<4>(its.vertices, its.indices, tree, src.data(), dir.data(), src.size(), hits.data());
+    };
+    BENCHMARK("packets of 8 rays") {
+        return AABBTreeIndirect::intersect_rays_first_hit<8>(its.vertices, its.indices, tree, src.data(), dir.data(), src.size(), hits.data());
+    };
+
+    std::vector<AABBMesh::hit_result> mesh_hits(src.size());
+    BENCHMARK("AABBMesh batch of rays") {
+        emesh.query_ray_hit(src.data(), dir.data(), src.size(), mesh_hits.data());
+        return mesh_hits.back().distance();
+    };
+    BENCHMARK("beams, sequential") {
+        double d = 0.;
+        for (const sla::Beam &beam : beams)
+            d += sla::beam_mesh_hit(ex_seq, emesh, beam, 0.).distance();
+        return d;
+    };
+    BENCHMARK("beams, parallel") {
+        double d = 0.;
+        for (const sla::Beam &beam : beams)
+            d += sla::beam_mesh_hit(ex_tbb, emesh, beam, 0.).distance();
+        return d;
+    };
+}
+
 #ifdef SLIC3R_HOLE_RAYCASTER
 // Create a simple scene with a 20mm cube and a big hole in the front wall 
 // with 5mm radius. Then shoot rays from interesting positions and see where
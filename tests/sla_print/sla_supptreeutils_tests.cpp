@@ -6,6 +6,7 @@
 #include "libslic3r/Execution/ExecutionSeq.hpp"
 #include "libslic3r/SLA/SupportTreeUtils.hpp"
 #include "libslic3r/SLA/SupportTreeUtilsLegacy.hpp"
+#include "libslic3r/SLA/DefaultSupportTree.hpp"
 
 // Test pair hash for 'nums' random number pairs.
 template <class I, class II> void test_pairhash()
@@ -375,3 +376,44 @@ TEST_CASE("BranchingSupports::MergePointFinder", "[suptreeutils]") {
     }
 }
 
+
+TEST_CASE("PillarIndex queries should match brute force search", "[suptreeutils]") {
+    using namespace Slic3r;
+
+    std::mt19937 gen(42);
+    std::uniform_real_distribution<double> dxy(-100., 100.), dz(0., 30.);
+
+    std::vector<Vec3d> pts(2000);
+    for (Vec3d &p : pts)
+        p = {dxy(gen), dxy(gen), dz(gen)};
+
+    sla::PillarIndex index{10.};
+    execution::for_each(ex_tbb, size_t(0), pts.size(), [&index, &pts](size_t i) {
+        index.insert(pts[i], unsigned(i));
+    });
+
+    REQUIRE(index.size() == pts.size());
+
+    // Skip every third point to exercise the filtering as well
+    auto filter = [](const sla::PointIndexEl &el) { return el.second % 3 != 0; };
+
+    for (size_t q = 0; q < 100; ++q) {
+        Vec3d p{1.5 * dxy(gen), 1.5 * dxy(gen), dz(gen)};
+
+        double best = std::numeric_limits<double>::max();
+        for (size_t i = 0; i < pts.size(); ++i)
+            if (i % 3 != 0)
+                best = std::min(best, (pts[i] - p).norm());
+
+        auto nearest = index.nearest(p, filter);
+        REQUIRE(nearest);
+        REQUIRE((nearest->first - p).norm() == Approx(best));
+
+        const double r = 7.5;
+        size_t cnt = std::count_if(pts.begin(), pts.end(), [&p, r](const Vec3d &pt) {
+            return (pt - p).norm() < r;
+        });
+
+        REQUIRE(index.query(p, r).size() == cnt);
+    }
+}